@@ -0,0 +1,68 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+typedef std::chrono::high_resolution_clock Clock;
+
+const int NUM_RUNS = 5;
+
+double runOnce(const Benchmark &benchmark) {
+   Clock::time_point start = Clock::now();
+   benchmark.function(benchmark.iterations);
+   Clock::time_point end = Clock::now();
+
+   return std::chrono::duration<double, std::nano>(end - start).count() / benchmark.iterations;
+}
+
+volatile const void *sink = nullptr;
+
+} // namespace
+
+std::vector<BenchmarkResult> runBenchmarks(const std::vector<Benchmark> &benchmarks, const std::string &filter) {
+   std::vector<BenchmarkResult> results;
+
+   for (const Benchmark &benchmark : benchmarks) {
+      if (!filter.empty() && benchmark.name.find(filter) == std::string::npos) {
+         continue;
+      }
+
+      std::cout << "Running " << benchmark.name << "..." << std::endl;
+
+      // Warm up caches (and any lazily loaded assets)
+      runOnce(benchmark);
+
+      std::vector<double> timings;
+      for (int i = 0; i < NUM_RUNS; ++i) {
+         timings.push_back(runOnce(benchmark));
+      }
+      std::sort(timings.begin(), timings.end());
+
+      BenchmarkResult result;
+      result.name = benchmark.name;
+      result.iterations = benchmark.iterations;
+      result.minNanoseconds = timings.front();
+      result.medianNanoseconds = timings[timings.size() / 2];
+      results.push_back(result);
+   }
+
+   return results;
+}
+
+void printResults(const std::vector<BenchmarkResult> &results) {
+   std::cout << std::endl << std::left << std::setw(48) << "Benchmark" << std::right << std::setw(12) << "Iterations" << std::setw(16) << "Min (ns)" << std::setw(16) << "Median (ns)" << std::setw(16) << "Median (op/s)" << std::endl;
+   std::cout << std::string(108, '-') << std::endl;
+
+   std::cout << std::fixed << std::setprecision(1);
+   for (const BenchmarkResult &result : results) {
+      std::cout << std::left << std::setw(48) << result.name << std::right << std::setw(12) << result.iterations << std::setw(16) << result.minNanoseconds << std::setw(16) << result.medianNanoseconds << std::setw(16) << (1.0e9 / result.medianNanoseconds) << std::endl;
+   }
+}
+
+void doNotOptimize(const void *value) {
+   sink = value;
+}
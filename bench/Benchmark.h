@@ -0,0 +1,45 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Runs the given number of iterations of the benchmarked operation
+ */
+typedef std::function<void(long iterations)> BenchmarkFunction;
+
+struct Benchmark {
+   std::string name;
+   long iterations;
+   BenchmarkFunction function;
+
+   Benchmark(const std::string &name, long iterations, BenchmarkFunction function)
+      : name(name), iterations(iterations), function(function) {
+   }
+};
+
+struct BenchmarkResult {
+   std::string name;
+   long iterations;
+   double minNanoseconds;
+   double medianNanoseconds;
+};
+
+/**
+ * Runs each benchmark (whose name contains the filter) several times, returning the per-iteration timings
+ */
+std::vector<BenchmarkResult> runBenchmarks(const std::vector<Benchmark> &benchmarks, const std::string &filter);
+
+/**
+ * Prints the results as a table on stdout
+ */
+void printResults(const std::vector<BenchmarkResult> &results);
+
+/**
+ * Prevents the compiler from optimizing away a computed value
+ */
+void doNotOptimize(const void *value);
+
+#endif
@@ -0,0 +1,259 @@
+#include "MockGL.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace MockGL {
+
+namespace {
+
+MockUniformList activeUniforms;
+unsigned long numCalls = 0;
+unsigned long numDrawCalls = 0;
+GLuint nextID = 1;
+
+// Objects
+
+GLuint APIENTRY createObject() {
+   ++numCalls;
+   return nextID++;
+}
+
+GLuint APIENTRY createShader(GLenum type) {
+   ++numCalls;
+   return nextID++;
+}
+
+void APIENTRY genObjects(GLsizei n, GLuint *ids) {
+   ++numCalls;
+   for (GLsizei i = 0; i < n; ++i) {
+      ids[i] = nextID++;
+   }
+}
+
+void APIENTRY deleteObject(GLuint id) {
+   ++numCalls;
+}
+
+void APIENTRY deleteObjects(GLsizei n, const GLuint *ids) {
+   ++numCalls;
+}
+
+// Shaders / programs
+
+void APIENTRY shaderSource(GLuint shader, GLsizei count, const GLchar **string, const GLint *length) {
+   ++numCalls;
+}
+
+void APIENTRY operateOnObject(GLuint id) {
+   ++numCalls;
+}
+
+void APIENTRY attachShader(GLuint program, GLuint shader) {
+   ++numCalls;
+}
+
+void APIENTRY getShaderiv(GLuint shader, GLenum pname, GLint *params) {
+   ++numCalls;
+   *params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+
+void APIENTRY getProgramiv(GLuint program, GLenum pname, GLint *params) {
+   ++numCalls;
+   switch (pname) {
+      case GL_LINK_STATUS:
+         *params = GL_TRUE;
+         break;
+      case GL_ACTIVE_UNIFORMS:
+         *params = static_cast<GLint>(activeUniforms.size());
+         break;
+      default:
+         *params = 0;
+         break;
+   }
+}
+
+void APIENTRY getActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name) {
+   ++numCalls;
+   const std::pair<std::string, GLenum> &uniform = activeUniforms.at(index);
+
+   GLsizei nameLength = std::min(static_cast<GLsizei>(uniform.first.size()), bufSize - 1);
+   memcpy(name, uniform.first.c_str(), nameLength);
+   name[nameLength] = '\0';
+
+   *length = nameLength;
+   *size = 1;
+   *type = uniform.second;
+}
+
+GLint APIENTRY getUniformLocation(GLuint program, const GLchar *name) {
+   ++numCalls;
+   for (size_t i = 0; i < activeUniforms.size(); ++i) {
+      if (activeUniforms[i].first == name) {
+         return static_cast<GLint>(i);
+      }
+   }
+
+   return -1;
+}
+
+GLuint APIENTRY getUniformBlockIndex(GLuint program, const GLchar *uniformBlockName) {
+   ++numCalls;
+   return 0;
+}
+
+void APIENTRY uniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding) {
+   ++numCalls;
+}
+
+// Uniforms
+
+void APIENTRY uniform1i(GLint location, GLint v0) {
+   ++numCalls;
+}
+
+void APIENTRY uniform1f(GLint location, GLfloat v0) {
+   ++numCalls;
+}
+
+void APIENTRY uniformfv(GLint location, GLsizei count, const GLfloat *value) {
+   ++numCalls;
+}
+
+void APIENTRY uniformMatrixfv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) {
+   ++numCalls;
+}
+
+// Buffers / vertex arrays / textures
+
+void APIENTRY bindObject(GLenum target, GLuint id) {
+   ++numCalls;
+}
+
+void APIENTRY bufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage) {
+   ++numCalls;
+}
+
+void APIENTRY bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data) {
+   ++numCalls;
+}
+
+void APIENTRY bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+   ++numCalls;
+}
+
+void APIENTRY enableVertexAttribArray(GLuint index) {
+   ++numCalls;
+}
+
+void APIENTRY vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer) {
+   ++numCalls;
+}
+
+void APIENTRY bindVertexArray(GLuint array) {
+   ++numCalls;
+}
+
+void APIENTRY activeTexture(GLenum texture) {
+   ++numCalls;
+}
+
+void APIENTRY texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels) {
+   ++numCalls;
+}
+
+void APIENTRY compressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void *data) {
+   ++numCalls;
+}
+
+void APIENTRY texParameteri(GLenum target, GLenum pname, GLint param) {
+   ++numCalls;
+}
+
+void APIENTRY pixelStorei(GLenum pname, GLint param) {
+   ++numCalls;
+}
+
+void APIENTRY vertexAttribDivisor(GLuint index, GLuint divisor) {
+   ++numCalls;
+}
+
+void APIENTRY drawElements(GLenum mode, GLsizei count, GLenum type, const void *indices) {
+   ++numCalls;
+   ++numDrawCalls;
+}
+
+void APIENTRY drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instanceCount) {
+   ++numCalls;
+   ++numDrawCalls;
+}
+
+} // namespace
+
+void install() {
+   glad_glCreateProgram = createObject;
+   glad_glDeleteProgram = deleteObject;
+   glad_glCreateShader = createShader;
+   glad_glDeleteShader = deleteObject;
+   glad_glShaderSource = shaderSource;
+   glad_glCompileShader = operateOnObject;
+   glad_glGetShaderiv = getShaderiv;
+   glad_glAttachShader = attachShader;
+   glad_glLinkProgram = operateOnObject;
+   glad_glGetProgramiv = getProgramiv;
+   glad_glGetActiveUniform = getActiveUniform;
+   glad_glGetUniformLocation = getUniformLocation;
+   glad_glGetUniformBlockIndex = getUniformBlockIndex;
+   glad_glUniformBlockBinding = uniformBlockBinding;
+   glad_glUseProgram = operateOnObject;
+
+   glad_glUniform1i = uniform1i;
+   glad_glUniform1f = uniform1f;
+   glad_glUniform2fv = uniformfv;
+   glad_glUniform3fv = uniformfv;
+   glad_glUniform4fv = uniformfv;
+   glad_glUniformMatrix4fv = uniformMatrixfv;
+
+   glad_glGenBuffers = genObjects;
+   glad_glDeleteBuffers = deleteObjects;
+   glad_glBindBuffer = bindObject;
+   glad_glBufferData = bufferData;
+   glad_glBufferSubData = bufferSubData;
+   glad_glBindBufferBase = bindBufferBase;
+   glad_glGenVertexArrays = genObjects;
+   glad_glDeleteVertexArrays = deleteObjects;
+   glad_glBindVertexArray = bindVertexArray;
+   glad_glEnableVertexAttribArray = enableVertexAttribArray;
+   glad_glVertexAttribPointer = vertexAttribPointer;
+   glad_glVertexAttribDivisor = vertexAttribDivisor;
+   glad_glActiveTexture = activeTexture;
+   glad_glBindTexture = bindObject;
+   glad_glGenTextures = genObjects;
+   glad_glDeleteTextures = deleteObjects;
+   glad_glTexImage2D = texImage2D;
+   glad_glCompressedTexImage2D = compressedTexImage2D;
+   glad_glTexParameteri = texParameteri;
+   glad_glPixelStorei = pixelStorei;
+   glad_glDrawElements = drawElements;
+   glad_glDrawElementsInstanced = drawElementsInstanced;
+
+   // Every desktop driver supports S3TC, so textures take the compressed path
+   GLAD_GL_EXT_texture_compression_s3tc = 1;
+
+   numCalls = 0;
+   numDrawCalls = 0;
+}
+
+void setActiveUniforms(const MockUniformList &uniforms) {
+   activeUniforms = uniforms;
+}
+
+unsigned long getNumCalls() {
+   return numCalls;
+}
+
+unsigned long getNumDrawCalls() {
+   return numDrawCalls;
+}
+
+} // namespace MockGL
@@ -0,0 +1,39 @@
+#ifndef MOCK_GL_H
+#define MOCK_GL_H
+
+#include "GLIncludes.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::pair<std::string, GLenum>> MockUniformList;
+
+/**
+ * Fills the glad function table with no-op implementations, so that GL objects can be created without a context
+ */
+namespace MockGL {
+
+/**
+ * Installs the mock functions (only the ones the engine uses outside of actual draw calls)
+ */
+void install();
+
+/**
+ * Sets the active uniforms reported for any program linked after this call
+ */
+void setActiveUniforms(const MockUniformList &uniforms);
+
+/**
+ * Gets the number of mock GL calls made since installation
+ */
+unsigned long getNumCalls();
+
+/**
+ * Gets the number of mock draw calls (instanced or not) made since installation
+ */
+unsigned long getNumDrawCalls();
+
+} // namespace MockGL
+
+#endif
@@ -0,0 +1,680 @@
+#include "AssetPack.h"
+#include "Benchmark.h"
+#include "BoundingVolumeHierarchy.h"
+#include "Context.h"
+#include "DrawStateCache.h"
+#include "GameObject.h"
+#include "GeometricGraphicsComponent.h"
+#include "GhostPhysicsComponent.h"
+#include "IOUtils.h"
+#include "LevelData.h"
+#include "LightComponent.h"
+#include "LogHelper.h"
+#include "Mesh.h"
+#include "MeshAssetManager.h"
+#include "MockGL.h"
+#include "Model.h"
+#include "OSUtils.h"
+#include "PhongMaterial.h"
+#include "PhysicsManager.h"
+#include "PhysicsShapeCache.h"
+#include "RenderData.h"
+#include "RenderQueue.h"
+#include "Renderer.h"
+#include "Scene.h"
+#include "SceneLoader.h"
+#include "Shader.h"
+#include "ShaderProgram.h"
+#include "TextureAssetManager.h"
+#include "UniformBlocks.h"
+#include "UniformBuffer.h"
+#include "UploadQueue.h"
+
+#include <bullet/btBulletDynamicsCommon.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int NUM_LIGHTS = 10;
+const int NUM_SHADOWS = 5;
+const int NUM_CUBE_SHADOWS = 4;
+const int NUM_LEVELS = 4;
+const int NUM_CULLED_OBJECTS = 1000;
+const int NUM_DRAWN_OBJECTS = 1000;
+const int NUM_DRAWN_PROGRAMS = 2;
+const int NUM_DRAWN_MATERIALS = 4;
+const float TICK_DT = 1.0f / 60.0f;
+const int TICKED_OBJECT_COUNTS[] = { 1000, 2500, 5000, 10000 };
+const long TICKED_OBJECT_ITERATIONS = 2000000; // Divided by the object count
+const int CALLBACK_OBJECT_INTERVAL = 4;
+const int NUM_CROWDED_OBJECTS = 10000;
+const int NUM_STRESS_LEVEL_OBJECTS = 5000;
+const char *STRESS_LEVEL_FILE_NAME = "stress_level.tgil";
+const char *BENCH_PACK_FILE_NAME = "bench_data.pack";
+const int HULL_PILE_SIZE = 8; // Bodies per side of each layer
+const int HULL_PILE_LAYERS = 4;
+
+/**
+ * The active uniforms of the phong shader program, as reported by the driver
+ */
+MockUniformList buildPhongUniforms() {
+   MockUniformList uniforms;
+
+   // Lights, shadows and the camera are read from uniform blocks, whose members have no location (and aren't loaded)
+   uniforms.push_back({ "uMaterial.ambient", GL_FLOAT_VEC3 });
+   uniforms.push_back({ "uMaterial.diffuse", GL_FLOAT_VEC3 });
+   uniforms.push_back({ "uMaterial.specular", GL_FLOAT_VEC3 });
+   uniforms.push_back({ "uMaterial.emission", GL_FLOAT_VEC3 });
+   uniforms.push_back({ "uMaterial.shininess", GL_FLOAT });
+
+   for (int i = 0; i < NUM_SHADOWS; ++i) {
+      uniforms.push_back({ "uShadowMaps[" + std::to_string(i) + "]", GL_SAMPLER_2D_SHADOW });
+   }
+   for (int i = 0; i < NUM_CUBE_SHADOWS; ++i) {
+      uniforms.push_back({ "uCubeShadowMaps[" + std::to_string(i) + "]", GL_SAMPLER_CUBE_SHADOW });
+   }
+
+   uniforms.push_back({ "uModelMatrix", GL_FLOAT_MAT4 });
+   uniforms.push_back({ "uNormalMatrix", GL_FLOAT_MAT4 });
+   uniforms.push_back({ "uInstanced", GL_BOOL });
+
+   return uniforms;
+}
+
+SPtr<ShaderProgram> createPhongProgram() {
+   MockGL::setActiveUniforms(buildPhongUniforms());
+
+   SPtr<ShaderProgram> program(std::make_shared<ShaderProgram>());
+   program->attach(std::make_shared<Shader>(GL_VERTEX_SHADER));
+   program->attach(std::make_shared<Shader>(GL_FRAGMENT_SHADER));
+   program->link();
+
+   return program;
+}
+
+std::vector<SPtr<GameObject>> createBoxes(int count) {
+   std::default_random_engine generator;
+   std::uniform_real_distribution<float> positionDistribution(-100.0f, 100.0f);
+
+   std::vector<SPtr<GameObject>> boxes;
+   for (int i = 0; i < count; ++i) {
+      SPtr<GameObject> box(std::make_shared<GameObject>());
+      box->setPosition(glm::vec3(positionDistribution(generator), positionDistribution(generator), positionDistribution(generator)));
+      box->setPhysicsComponent(std::make_shared<GhostPhysicsComponent>(*box, false, CollisionGroup::Everything, glm::vec3(1.0f)));
+      box->snapshot();
+
+      boxes.push_back(box);
+   }
+
+   return boxes;
+}
+
+/**
+ * Builds objects spread around the origin, each drawing one of a few meshes with one of a few programs and materials
+ * (in no particular order, like objects added to a scene)
+ */
+std::vector<SPtr<GameObject>> createDrawnObjects(int count) {
+   const char *meshNames[] = { "meshes/rock_lg.obj", "meshes/trunk_lg.obj", "meshes/leaves_lg.obj" };
+
+   MeshAssetManager meshAssetManager;
+   std::vector<SPtr<Model>> models;
+   for (int i = 0; i < NUM_DRAWN_PROGRAMS; ++i) {
+      SPtr<ShaderProgram> program(createPhongProgram());
+
+      for (int j = 0; j < NUM_DRAWN_MATERIALS; ++j) {
+         glm::vec3 color(0.2f * j);
+         SPtr<Material> material(std::make_shared<PhongMaterial>(color * 0.3f, color * 0.7f, glm::vec3(0.2f), glm::vec3(0.0f), 5.0f));
+
+         for (const char *meshName : meshNames) {
+            SPtr<Model> model(std::make_shared<Model>(program, meshAssetManager.loadMesh(meshName)));
+            model->attachMaterial(material);
+            models.push_back(model);
+         }
+      }
+   }
+
+   std::default_random_engine generator;
+   std::uniform_real_distribution<float> positionDistribution(-100.0f, 100.0f);
+   std::uniform_int_distribution<std::size_t> modelDistribution(0, models.size() - 1);
+
+   std::vector<SPtr<GameObject>> objects;
+   for (int i = 0; i < count; ++i) {
+      SPtr<GameObject> object(std::make_shared<GameObject>());
+      object->setPosition(glm::vec3(positionDistribution(generator), positionDistribution(generator), positionDistribution(generator)));
+      object->setGraphicsComponent(std::make_shared<GeometricGraphicsComponent>(*object));
+      object->getGraphicsComponent().setModel(models[modelDistribution(generator)]);
+      object->snapshot();
+
+      objects.push_back(object);
+   }
+
+   return objects;
+}
+
+/**
+ * Draws the objects in the order given, like the renderer did before sorting draws
+ */
+void drawInOrder(const std::vector<SPtr<GameObject>> &objects) {
+   RenderData renderData;
+   for (const SPtr<GameObject> &object : objects) {
+      object->getGraphicsComponent().draw(renderData);
+   }
+}
+
+/**
+ * Draws the objects through a render queue (sorted, instanced, and skipping redundant state changes), like the
+ * renderer's opaque pass
+ */
+void drawQueued(const std::vector<SPtr<GameObject>> &objects, RenderQueue &renderQueue) {
+   renderQueue.clear();
+   for (const SPtr<GameObject> &object : objects) {
+      renderQueue.add(RenderPass::Opaque, *object, glm::length(object->getRenderTransform().position));
+   }
+   renderQueue.sort();
+
+   RenderData renderData;
+   renderQueue.draw(RenderPass::Opaque, renderData);
+}
+
+/**
+ * Builds a scene with the given number of objects, every few of which spin in a tick callback (the rest do nothing
+ * each tick, like most level geometry)
+ */
+SPtr<Scene> createTickedScene(int numObjects) {
+   SPtr<Scene> scene(std::make_shared<Scene>());
+
+   for (int i = 0; i < numObjects; ++i) {
+      SPtr<GameObject> object(std::make_shared<GameObject>());
+      object->setPosition(glm::vec3(static_cast<float>(i), 0.0f, 0.0f));
+
+      if (i % CALLBACK_OBJECT_INTERVAL == 0) {
+         object->setTickCallback([](GameObject &gameObject, const float dt) {
+            gameObject.setOrientation(glm::angleAxis(dt, glm::vec3(0.0f, 1.0f, 0.0f)) * gameObject.getOrientation());
+         });
+      }
+
+      scene->addObject(object);
+   }
+
+   return scene;
+}
+
+/**
+ * Builds a level with the given number of static objects (rocks and trees, sharing a few models) on a grid
+ */
+LevelData buildStressLevel(int numObjects) {
+   LevelData level;
+
+   LevelMaterial material;
+   material.color = glm::vec3(0.4f);
+   material.specular = 0.2f;
+   material.shininess = 5.0f;
+   material.emission = 0.0f;
+   uint32_t materialIndex = level.addMaterial(material);
+
+   const uint32_t models[] = {
+      level.addModel("meshes/rock_lg.obj", "shaders/phong", materialIndex),
+      level.addModel("meshes/trunk_lg.obj", "shaders/phong", materialIndex),
+      level.addModel("meshes/leaves_lg.obj", "shaders/phong", materialIndex)
+   };
+
+   int gridSize = static_cast<int>(glm::ceil(glm::sqrt(static_cast<float>(numObjects))));
+   for (int i = 0; i < numObjects; ++i) {
+      LevelObject object;
+      object.model = models[i % 3];
+      object.physics = LevelPhysics::Static;
+      object.position = glm::vec3((i % gridSize) * 4.0f, 0.0f, (i / gridSize) * 4.0f);
+      object.orientation = glm::quat();
+      object.scale = glm::vec3(1.0f);
+      object.friction = 1.0f;
+      object.restitution = 0.3f;
+      object.mass = 0.0f;
+      object.castShadows = 1;
+      level.addObject(object);
+   }
+
+   return level;
+}
+
+/**
+ * Projectiles resting in a pile on top of some rocks, all with convex hull shapes, so that ticking is dominated by the
+ * narrowphase
+ */
+struct HullPile {
+   PhysicsShapeCache shapeCache;
+   SPtr<PhysicsManager> physicsManager;
+   std::vector<SPtr<btCollisionShape>> shapes;
+   std::vector<UPtr<btRigidBody>> bodies;
+
+   HullPile(bool simplifyHulls)
+      : shapeCache(false, simplifyHulls), physicsManager(std::make_shared<PhysicsManager>()) {
+   }
+
+   ~HullPile() {
+      for (const UPtr<btRigidBody> &body : bodies) {
+         physicsManager->getDynamicsWorld().removeRigidBody(body.get());
+      }
+   }
+
+   void addBody(const SPtr<Mesh> &mesh, const glm::vec3 &position, const glm::vec3 &scale, float mass) {
+      SPtr<btCollisionShape> shape(shapeCache.getHullShape(mesh, scale));
+      btVector3 inertia(0.0f, 0.0f, 0.0f);
+      shape->calculateLocalInertia(mass, inertia);
+
+      UPtr<btRigidBody> body(new btRigidBody(mass, nullptr, shape.get(), inertia));
+      body->setWorldTransform(btTransform(btQuaternion::getIdentity(), btVector3(position.x, position.y, position.z)));
+      body->setActivationState(DISABLE_DEACTIVATION);
+      physicsManager->getDynamicsWorld().addRigidBody(body.get());
+
+      shapes.push_back(shape);
+      bodies.push_back(std::move(body));
+   }
+};
+
+SPtr<HullPile> createHullPile(const SPtr<Mesh> &groundMesh, const SPtr<Mesh> &bodyMesh, bool simplifyHulls) {
+   SPtr<HullPile> pile(std::make_shared<HullPile>(simplifyHulls));
+
+   pile->addBody(groundMesh, glm::vec3(0.0f), glm::vec3(10.0f, 1.0f, 10.0f), 0.0f);
+   for (int layer = 0; layer < HULL_PILE_LAYERS; ++layer) {
+      for (int i = 0; i < HULL_PILE_SIZE * HULL_PILE_SIZE; ++i) {
+         glm::vec3 position((i % HULL_PILE_SIZE - HULL_PILE_SIZE / 2) * 0.6f, 3.0f + layer * 0.6f, (i / HULL_PILE_SIZE - HULL_PILE_SIZE / 2) * 0.6f);
+         pile->addBody(bodyMesh, position, glm::vec3(1.0f), 0.05f);
+      }
+   }
+
+   // Let the pile settle, so that the benchmark measures resting contacts
+   for (int i = 0; i < 120; ++i) {
+      pile->physicsManager->tick(TICK_DT);
+   }
+
+   PhysicsShapeStats stats(pile->shapeCache.getStats());
+   LOG_INFO("Hull pile (" << (simplifyHulls ? "simplified" : "full") << "): " << stats.numSourceHullVertices << " mesh vertices, " << stats.numSimplifiedHullVertices << " hull points");
+
+   return pile;
+}
+
+std::vector<Benchmark> buildBenchmarks(Context &context) {
+   std::vector<Benchmark> benchmarks;
+
+   SPtr<ShaderProgram> phongProgram = createPhongProgram();
+
+   benchmarks.push_back(Benchmark("ShaderProgram::setUniformValue (matrix)", 1000000, [phongProgram](long iterations) {
+      glm::mat4 modelMatrix;
+      for (long i = 0; i < iterations; ++i) {
+         modelMatrix[3][0] = static_cast<float>(i);
+         phongProgram->setUniformValue("uModelMatrix", modelMatrix);
+      }
+   }));
+
+   benchmarks.push_back(Benchmark("ShaderProgram::setUniformValue (array element)", 1000000, [phongProgram](long iterations) {
+      for (long i = 0; i < iterations; ++i) {
+         phongProgram->setUniformValue("uShadowMaps[3]", static_cast<int>(i));
+      }
+   }));
+
+   UniformID modelMatrixUniform = ShaderProgram::getUniformID("uModelMatrix");
+   benchmarks.push_back(Benchmark("ShaderProgram::setUniformValue (matrix, by ID)", 1000000, [phongProgram, modelMatrixUniform](long iterations) {
+      glm::mat4 modelMatrix;
+      for (long i = 0; i < iterations; ++i) {
+         modelMatrix[3][0] = static_cast<float>(i);
+         phongProgram->setUniformValue(modelMatrixUniform, modelMatrix);
+      }
+   }));
+
+   UniformID shadowMapUniform = ShaderProgram::getUniformID("uShadowMaps[3]");
+   benchmarks.push_back(Benchmark("ShaderProgram::setUniformValue (array element, by ID)", 1000000, [phongProgram, shadowMapUniform](long iterations) {
+      for (long i = 0; i < iterations; ++i) {
+         phongProgram->setUniformValue(shadowMapUniform, static_cast<int>(i));
+      }
+   }));
+
+   benchmarks.push_back(Benchmark("ShaderProgram::commit (nothing changed)", 1000000, [phongProgram](long iterations) {
+      for (long i = 0; i < iterations; ++i) {
+         phongProgram->commit();
+      }
+   }));
+
+   benchmarks.push_back(Benchmark("ShaderProgram::commit", 100000, [phongProgram](long iterations) {
+      glm::mat4 modelMatrix;
+      for (long i = 0; i < iterations; ++i) {
+         modelMatrix[3][0] = static_cast<float>(i);
+         phongProgram->setUniformValue("uModelMatrix", modelMatrix);
+         phongProgram->commit();
+      }
+   }));
+
+   std::vector<SPtr<GameObject>> lights;
+   for (int i = 0; i < NUM_LIGHTS; ++i) {
+      SPtr<GameObject> light(std::make_shared<GameObject>());
+      light->setLightComponent(std::make_shared<LightComponent>(*light, LightComponent::Point, glm::vec3(1.0f)));
+      lights.push_back(light);
+   }
+
+   SPtr<UniformBuffer> lightsBuffer(std::make_shared<UniformBuffer>(UniformBlockBindings::LIGHTS, sizeof(LightsBlock)));
+   benchmarks.push_back(Benchmark("LightComponent::draw + UniformBuffer::update (" + std::to_string(NUM_LIGHTS) + " lights, no shadows)", 10000, [lights, lightsBuffer](long iterations) {
+      LightsBlock lightsBlock;
+      ShadowMapUnits shadowMapUnits;
+      for (long i = 0; i < iterations; ++i) {
+         int shadowIndex = 0;
+         int cubeShadowIndex = 0;
+
+         lightsBlock.numLights = static_cast<int32_t>(lights.size());
+         for (int j = 0; j < lights.size(); ++j) {
+            lights[j]->getLightComponent().draw(lightsBlock, shadowMapUnits, j, shadowIndex, cubeShadowIndex);
+         }
+
+         lightsBuffer->update(&lightsBlock);
+      }
+   }));
+
+   std::vector<SPtr<GameObject>> boxes = createBoxes(NUM_CULLED_OBJECTS);
+   SPtr<FrustumChecker> frustumChecker(std::make_shared<FrustumChecker>());
+   glm::mat4 proj = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+   glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 50.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+   frustumChecker->updateFrustum(proj * view);
+
+   benchmarks.push_back(Benchmark("FrustumChecker::inFrustum (" + std::to_string(NUM_CULLED_OBJECTS) + " objects)", 1000, [frustumChecker, boxes](long iterations) {
+      int numVisible = 0;
+      for (long i = 0; i < iterations; ++i) {
+         for (const SPtr<GameObject> &box : boxes) {
+            if (frustumChecker->inFrustum(*box)) {
+               ++numVisible;
+            }
+         }
+      }
+
+      doNotOptimize(&numVisible);
+   }));
+
+   SPtr<BoundingVolumeHierarchy> boxHierarchy(std::make_shared<BoundingVolumeHierarchy>());
+   boxHierarchy->update(boxes);
+
+   benchmarks.push_back(Benchmark("BoundingVolumeHierarchy::cull (" + std::to_string(NUM_CULLED_OBJECTS) + " objects)", 1000, [frustumChecker, boxHierarchy](long iterations) {
+      std::vector<GameObject*> visible;
+      CullStats stats;
+      for (long i = 0; i < iterations; ++i) {
+         visible.clear();
+         boxHierarchy->cull(frustumChecker->getPlanes(), visible, stats);
+      }
+
+      doNotOptimize(visible.data());
+   }));
+
+   std::vector<SPtr<GameObject>> drawnObjects = createDrawnObjects(NUM_DRAWN_OBJECTS);
+   SPtr<RenderQueue> renderQueue(std::make_shared<RenderQueue>());
+   {
+      // The first draw of each model creates its vertex array, so leave it out of the counts
+      drawInOrder(drawnObjects);
+
+      unsigned long numCalls = MockGL::getNumCalls();
+      unsigned long numDrawCalls = MockGL::getNumDrawCalls();
+      drawInOrder(drawnObjects);
+      unsigned long numInOrderCalls = MockGL::getNumCalls() - numCalls;
+      unsigned long numInOrderDrawCalls = MockGL::getNumDrawCalls() - numDrawCalls;
+
+      DrawStateCache &stateCache = context.getDrawStateCache();
+      stateCache.resetStats();
+      numCalls = MockGL::getNumCalls();
+      numDrawCalls = MockGL::getNumDrawCalls();
+      drawQueued(drawnObjects, *renderQueue);
+      unsigned long numQueuedCalls = MockGL::getNumCalls() - numCalls;
+      unsigned long numQueuedDrawCalls = MockGL::getNumDrawCalls() - numDrawCalls;
+
+      const DrawStats &stats = stateCache.getStats();
+      LOG_INFO("Drawing " << NUM_DRAWN_OBJECTS << " objects: " << numInOrderCalls << " GL calls (" << numInOrderDrawCalls << " draw calls) in insertion order, " << numQueuedCalls << " (" << numQueuedDrawCalls << " draw calls) through the render queue (" << stats.numInstancedDraws << " instanced draws of " << stats.numInstances << " objects, " << stats.numProgramChanges << " program changes, " << stats.numVertexArrayBinds << " vertex array binds, " << stats.numRedundantCalls << " redundant calls skipped)");
+      stateCache.resetStats();
+   }
+
+   benchmarks.push_back(Benchmark("Model::draw (" + std::to_string(NUM_DRAWN_OBJECTS) + " objects, insertion order)", 1000, [drawnObjects](long iterations) {
+      for (long i = 0; i < iterations; ++i) {
+         drawInOrder(drawnObjects);
+      }
+   }));
+
+   benchmarks.push_back(Benchmark("RenderQueue sort + instanced draw (" + std::to_string(NUM_DRAWN_OBJECTS) + " objects)", 1000, [drawnObjects, renderQueue](long iterations) {
+      for (long i = 0; i < iterations; ++i) {
+         drawQueued(drawnObjects, *renderQueue);
+      }
+   }));
+
+   SPtr<Scene> gridIsland = SceneLoader::loadGridIslandScene(context);
+   gridIsland->snapshot(false);
+   SPtr<FrustumChecker> islandFrustumChecker(std::make_shared<FrustumChecker>());
+   islandFrustumChecker->updateFrustum(proj * glm::lookAt(glm::vec3(0.0f, 20.0f, 60.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+
+   benchmarks.push_back(Benchmark("FrustumChecker::inFrustum (grid island)", 10000, [gridIsland, islandFrustumChecker](long iterations) {
+      const std::vector<SPtr<GameObject>> &objects = gridIsland->getSnapshot().objects;
+      int numVisible = 0;
+      for (long i = 0; i < iterations; ++i) {
+         for (const SPtr<GameObject> &object : objects) {
+            if (islandFrustumChecker->inFrustum(*object)) {
+               ++numVisible;
+            }
+         }
+      }
+
+      doNotOptimize(&numVisible);
+   }));
+
+   benchmarks.push_back(Benchmark("BoundingVolumeHierarchy::cull (grid island)", 10000, [gridIsland, islandFrustumChecker](long iterations) {
+      std::vector<GameObject*> visible;
+      CullStats stats;
+      for (long i = 0; i < iterations; ++i) {
+         visible.clear();
+         gridIsland->getSnapshot().objectHierarchy.cull(islandFrustumChecker->getPlanes(), visible, stats);
+      }
+
+      doNotOptimize(visible.data());
+   }));
+
+   benchmarks.push_back(Benchmark("BoundingVolumeHierarchy::update (grid island)", 10000, [gridIsland](long iterations) {
+      BoundingVolumeHierarchy hierarchy;
+      for (long i = 0; i < iterations; ++i) {
+         hierarchy.update(gridIsland->getSnapshot().objects);
+      }
+   }));
+
+   benchmarks.push_back(Benchmark("Scene::addObject + removeObject", 10000, [boxes](long iterations) {
+      SPtr<Scene> scene(std::make_shared<Scene>());
+      for (long i = 0; i < iterations; ++i) {
+         const SPtr<GameObject> &box = boxes[i % boxes.size()];
+         scene->addObject(box);
+         scene->removeObject(box);
+      }
+   }));
+
+   SPtr<Scene> crowdedScene = createTickedScene(NUM_CROWDED_OBJECTS);
+   std::vector<SPtr<GameObject>> crowd(crowdedScene->getObjects());
+
+   benchmarks.push_back(Benchmark("Scene::removeObject + addObject (" + std::to_string(NUM_CROWDED_OBJECTS) + " objects)", 100000, [crowdedScene, crowd](long iterations) {
+      for (long i = 0; i < iterations; ++i) {
+         const SPtr<GameObject> &object = crowd[i % crowd.size()];
+         crowdedScene->removeObject(object);
+         crowdedScene->addObject(object);
+      }
+   }));
+
+   benchmarks.push_back(Benchmark("MeshAssetManager::loadMesh (lava.obj, cold)", 20, [](long iterations) {
+      for (long i = 0; i < iterations; ++i) {
+         MeshAssetManager meshAssetManager(false);
+         SPtr<Mesh> mesh = meshAssetManager.loadMesh("meshes/lava.obj");
+         doNotOptimize(mesh.get());
+      }
+   }));
+
+   SPtr<Mesh> islandMesh(MeshAssetManager().loadMesh("meshes/island_sm.obj"));
+
+   benchmarks.push_back(Benchmark("PhysicsShapeCache::getBvhShape (island_sm.obj, built)", 20, [islandMesh](long iterations) {
+      for (long i = 0; i < iterations; ++i) {
+         PhysicsShapeCache shapeCache(false);
+         SPtr<btCollisionShape> shape(shapeCache.getBvhShape(islandMesh, glm::vec3(1.0f)));
+         doNotOptimize(shape.get());
+      }
+   }));
+
+   SPtr<Mesh> projectileMesh(MeshAssetManager().loadMesh("meshes/rock_attack.obj"));
+   SPtr<Mesh> rockMesh(MeshAssetManager().loadMesh("meshes/rock_lg.obj"));
+   for (bool simplifyHulls : { false, true }) {
+      SPtr<HullPile> pile(createHullPile(rockMesh, projectileMesh, simplifyHulls));
+      std::string name("PhysicsManager::tick (" + std::to_string(pile->bodies.size()) + " hull bodies, " + (simplifyHulls ? "simplified" : "full") + " hulls)");
+      benchmarks.push_back(Benchmark(name, 200, [pile](long iterations) {
+         for (long i = 0; i < iterations; ++i) {
+            pile->physicsManager->tick(TICK_DT);
+         }
+      }));
+   }
+
+   // Make sure the BVH is on disk, so that the next benchmark only measures reading it
+   PhysicsShapeCache().getBvhShape(islandMesh, glm::vec3(1.0f));
+
+   benchmarks.push_back(Benchmark("PhysicsShapeCache::getBvhShape (island_sm.obj, from disk)", 20, [islandMesh](long iterations) {
+      for (long i = 0; i < iterations; ++i) {
+         PhysicsShapeCache shapeCache;
+         SPtr<btCollisionShape> shape(shapeCache.getBvhShape(islandMesh, glm::vec3(1.0f)));
+         doNotOptimize(shape.get());
+      }
+   }));
+
+   SPtr<PhysicsShapeCache> sharedShapeCache(std::make_shared<PhysicsShapeCache>(false));
+   benchmarks.push_back(Benchmark("PhysicsShapeCache::getBvhShape (island_sm.obj, shared)", 10000, [islandMesh, sharedShapeCache](long iterations) {
+      for (long i = 0; i < iterations; ++i) {
+         SPtr<btCollisionShape> shape(sharedShapeCache->getBvhShape(islandMesh, glm::vec3(1.0f + i % 4)));
+         doNotOptimize(shape.get());
+      }
+   }));
+
+   // Make sure the mesh cache exists, so that the warm benchmark only measures mapping it
+   MeshAssetManager().loadMesh("meshes/lava.obj");
+
+   benchmarks.push_back(Benchmark("MeshAssetManager::loadMesh (lava.obj, warm)", 20, [](long iterations) {
+      for (long i = 0; i < iterations; ++i) {
+         MeshAssetManager meshAssetManager;
+         SPtr<Mesh> mesh = meshAssetManager.loadMesh("meshes/lava.obj");
+         doNotOptimize(mesh.get());
+      }
+   }));
+
+   benchmarks.push_back(Benchmark("TextureAssetManager::loadCubemap (space, cold)", 5, [](long iterations) {
+      for (long i = 0; i < iterations; ++i) {
+         UploadQueue uploadQueue;
+         TextureAssetManager textureAssetManager(uploadQueue, false);
+         SPtr<Texture> cubemap = textureAssetManager.loadCubemap("textures/space", "png");
+         doNotOptimize(cubemap.get());
+      }
+   }));
+
+   // Make sure the texture cache exists, so that the warm benchmark only measures mapping it
+   {
+      UploadQueue uploadQueue;
+      TextureAssetManager(uploadQueue).loadCubemap("textures/space", "png");
+   }
+
+   benchmarks.push_back(Benchmark("TextureAssetManager::loadCubemap (space, warm)", 20, [](long iterations) {
+      for (long i = 0; i < iterations; ++i) {
+         UploadQueue uploadQueue;
+         TextureAssetManager textureAssetManager(uploadQueue);
+         SPtr<Texture> cubemap = textureAssetManager.loadCubemap("textures/space", "png");
+         doNotOptimize(cubemap.get());
+      }
+   }));
+
+   if (buildStressLevel(NUM_STRESS_LEVEL_OBJECTS).save(STRESS_LEVEL_FILE_NAME)) {
+      benchmarks.push_back(Benchmark("LevelData::load (" + std::to_string(NUM_STRESS_LEVEL_OBJECTS) + " objects)", 100, [](long iterations) {
+         for (long i = 0; i < iterations; ++i) {
+            UPtr<LevelData> level(LevelData::load(STRESS_LEVEL_FILE_NAME));
+            doNotOptimize(level.get());
+         }
+      }));
+
+      benchmarks.push_back(Benchmark("SceneLoader::loadLevelFile (" + std::to_string(NUM_STRESS_LEVEL_OBJECTS) + " objects)", 5, [](long iterations) {
+         for (long i = 0; i < iterations; ++i) {
+            SPtr<Scene> scene(SceneLoader::loadLevelFile(Context::getInstance(), STRESS_LEVEL_FILE_NAME));
+            doNotOptimize(scene.get());
+         }
+      }));
+   } else {
+      LOG_WARNING("Unable to write stress level, skipping level load benchmarks");
+   }
+
+   benchmarks.push_back(Benchmark("SceneLoader::loadGridIslandScene", 20, [](long iterations) {
+      for (long i = 0; i < iterations; ++i) {
+         SPtr<Scene> scene(SceneLoader::loadGridIslandScene(Context::getInstance()));
+         doNotOptimize(scene.get());
+      }
+   }));
+
+   for (int numObjects : TICKED_OBJECT_COUNTS) {
+      SPtr<Scene> scene = createTickedScene(numObjects);
+
+      benchmarks.push_back(Benchmark("Scene::tick (" + std::to_string(numObjects) + " objects)", TICKED_OBJECT_ITERATIONS / numObjects, [scene](long iterations) {
+         for (long i = 0; i < iterations; ++i) {
+            scene->tick(TICK_DT);
+         }
+      }));
+   }
+
+   for (int i = 0; i < NUM_LEVELS; ++i) {
+      SPtr<Scene> level = SceneLoader::loadNextLevel(context);
+
+      benchmarks.push_back(Benchmark("Scene::tick (level " + std::to_string(i) + ")", 600, [level](long iterations) {
+         for (long j = 0; j < iterations; ++j) {
+            level->tick(TICK_DT);
+         }
+      }));
+   }
+
+   // Registered last, since mounting the pack changes where every later data file read comes from
+   std::vector<std::string> dataFileNames(OSUtils::listFiles(DATA_DIR));
+   std::string dataFileCount(std::to_string(dataFileNames.size()));
+   benchmarks.push_back(Benchmark("IOUtils::readDataFile (" + dataFileCount + " files, loose)", 20, [dataFileNames](long iterations) {
+      for (long i = 0; i < iterations; ++i) {
+         for (const std::string &fileName : dataFileNames) {
+            folly::Optional<IOUtils::DataFile> dataFile(IOUtils::readDataFile(fileName));
+            doNotOptimize(dataFile ? dataFile->data : nullptr);
+         }
+      }
+   }));
+
+   if (AssetPack::build(DATA_DIR, BENCH_PACK_FILE_NAME)) {
+      benchmarks.push_back(Benchmark("IOUtils::readDataFile (" + dataFileCount + " files, mounted asset pack)", 20, [dataFileNames](long iterations) {
+         for (long i = 0; i < iterations; ++i) {
+            IOUtils::mountDataPack(BENCH_PACK_FILE_NAME);
+            for (const std::string &fileName : dataFileNames) {
+               folly::Optional<IOUtils::DataFile> dataFile(IOUtils::readDataFile(fileName));
+               doNotOptimize(dataFile ? dataFile->data : nullptr);
+            }
+         }
+      }));
+   } else {
+      LOG_WARNING("Unable to build asset pack, skipping asset pack benchmark");
+   }
+
+   return benchmarks;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+   if (!OSUtils::fixWorkingDirectory()) {
+      LOG_ERROR("Unable to fix working directory");
+   }
+
+   // Run headless, with mock GL functions standing in for a real context
+   MockGL::install();
+   Context::load(nullptr);
+   Context &context = Context::getInstance();
+
+   std::string filter = argc > 1 ? argv[1] : "";
+   std::vector<BenchmarkResult> results = runBenchmarks(buildBenchmarks(context), filter);
+   printResults(results);
+
+   LOG_INFO("Made " << MockGL::getNumCalls() << " mock GL calls");
+
+   return EXIT_SUCCESS;
+}
@@ -1,7 +1,12 @@
 #version 330 core
 
-uniform mat4 uProjMatrix;
-uniform mat4 uViewMatrix;
+// Shared by every scene program, written once per view
+layout(std140) uniform Camera {
+   mat4 uProjMatrix;
+   mat4 uViewMatrix;
+   vec3 uCameraPos;
+};
+
 uniform mat4 uModelMatrix;
 uniform vec2 uUvScale = vec2(0.2);
 uniform float uScale = 200.0;
@@ -11,49 +11,46 @@
 #define LIGHT_TYPE_SPOT 2
 
 struct Light {
+   vec3 color;
    int type;
-   vec3 color, position, direction;
-   float linearFalloff, squareFalloff, beamAngle, cutoffAngle;
-
-#ifdef SHADOWS
-   float shadowWeight0;
-   float shadowWeight1;
-   float shadowWeight2;
-   float shadowWeight3;
-   float shadowWeight4;
-
-   float cubeShadowWeight0;
-   float cubeShadowWeight1;
-   float cubeShadowWeight2;
-   float cubeShadowWeight3;
-#endif
+   vec3 position;
+   float linearFalloff;
+   vec3 direction;
+   float squareFalloff;
+   float beamAngle;
+   float cutoffAngle;
+
+   // Index of the light's shadow / cube shadow (-1 if it has none)
+   int shadowIndex;
+   int cubeShadowIndex;
 };
 
-#ifdef SHADOWS
-struct Shadow {
-   mat4 shadowView, shadowProj;
-   sampler2DShadow shadowMap;
+// Shared by every scene program, written once per frame
+layout(std140) uniform Lights {
+   Light uLights[MAX_LIGHTS];
+   mat4 uShadowMatrices[MAX_SHADOWS];
+   vec4 uCubeShadowPlanes[MAX_CUBE_SHADOWS];
+   int uNumLights;
 };
 
-struct CubeShadow {
-   float near, far;
-   samplerCubeShadow shadowMap;
+// Shared by every scene program, written once per view
+layout(std140) uniform Camera {
+   mat4 uProjMatrix;
+   mat4 uViewMatrix;
+   vec3 uCameraPos;
 };
-#endif
 
 struct Material {
   vec3 ambient, diffuse, specular, emission;
   float shininess;
 };
 
-uniform Light uLights[MAX_LIGHTS];
-uniform int uNumLights;
 uniform Material uMaterial;
-uniform vec3 uCameraPos;
 
 #ifdef SHADOWS
-uniform Shadow uShadows[MAX_SHADOWS];
-uniform CubeShadow uCubeShadows[MAX_CUBE_SHADOWS];
+// Samplers can't be stored in uniform blocks
+uniform sampler2DShadow uShadowMaps[MAX_SHADOWS];
+uniform samplerCubeShadow uCubeShadowMaps[MAX_CUBE_SHADOWS];
 #endif
 
 in vec3 vWorldPosition;
@@ -86,31 +83,31 @@ float calcVisibility(in Light light, in float nDotL) {
    float shadowVisibilities[MAX_SHADOWS];
    float cubeShadowVisibilities[MAX_CUBE_SHADOWS];
 
-   shadowVisibilities[0] = textureProj(uShadows[0].shadowMap, vec4(vShadowCoords[0].xy, vShadowCoords[0].z - bias, vShadowCoords[0].w));
-   shadowVisibilities[1] = textureProj(uShadows[1].shadowMap, vec4(vShadowCoords[1].xy, vShadowCoords[1].z - bias, vShadowCoords[1].w));
-   shadowVisibilities[2] = textureProj(uShadows[2].shadowMap, vec4(vShadowCoords[2].xy, vShadowCoords[2].z - bias, vShadowCoords[2].w));
-   shadowVisibilities[3] = textureProj(uShadows[3].shadowMap, vec4(vShadowCoords[3].xy, vShadowCoords[3].z - bias, vShadowCoords[3].w));
-   shadowVisibilities[4] = textureProj(uShadows[4].shadowMap, vec4(vShadowCoords[4].xy, vShadowCoords[4].z - bias, vShadowCoords[4].w));
-
-   cubeShadowVisibilities[0] = texture(uCubeShadows[0].shadowMap,
-      vec4(nFromLight, vectorToDepthValue(fromLight, uCubeShadows[0].near, uCubeShadows[0].far) - bias));
-   cubeShadowVisibilities[1] = texture(uCubeShadows[1].shadowMap,
-      vec4(nFromLight, vectorToDepthValue(fromLight, uCubeShadows[1].near, uCubeShadows[1].far) - bias));
-   cubeShadowVisibilities[2] = texture(uCubeShadows[2].shadowMap,
-      vec4(nFromLight, vectorToDepthValue(fromLight, uCubeShadows[2].near, uCubeShadows[2].far) - bias));
-   cubeShadowVisibilities[3] = texture(uCubeShadows[3].shadowMap,
-      vec4(nFromLight, vectorToDepthValue(fromLight, uCubeShadows[3].near, uCubeShadows[3].far) - bias));
-
-   return
-      shadowVisibilities[0] * light.shadowWeight0 +
-      shadowVisibilities[1] * light.shadowWeight1 +
-      shadowVisibilities[2] * light.shadowWeight2 +
-      shadowVisibilities[3] * light.shadowWeight3 +
-      shadowVisibilities[4] * light.shadowWeight4 +
-      cubeShadowVisibilities[0] * light.cubeShadowWeight0 +
-      cubeShadowVisibilities[1] * light.cubeShadowWeight1 +
-      cubeShadowVisibilities[2] * light.cubeShadowWeight2 +
-      cubeShadowVisibilities[3] * light.cubeShadowWeight3;
+   shadowVisibilities[0] = textureProj(uShadowMaps[0], vec4(vShadowCoords[0].xy, vShadowCoords[0].z - bias, vShadowCoords[0].w));
+   shadowVisibilities[1] = textureProj(uShadowMaps[1], vec4(vShadowCoords[1].xy, vShadowCoords[1].z - bias, vShadowCoords[1].w));
+   shadowVisibilities[2] = textureProj(uShadowMaps[2], vec4(vShadowCoords[2].xy, vShadowCoords[2].z - bias, vShadowCoords[2].w));
+   shadowVisibilities[3] = textureProj(uShadowMaps[3], vec4(vShadowCoords[3].xy, vShadowCoords[3].z - bias, vShadowCoords[3].w));
+   shadowVisibilities[4] = textureProj(uShadowMaps[4], vec4(vShadowCoords[4].xy, vShadowCoords[4].z - bias, vShadowCoords[4].w));
+
+   cubeShadowVisibilities[0] = texture(uCubeShadowMaps[0],
+      vec4(nFromLight, vectorToDepthValue(fromLight, uCubeShadowPlanes[0].x, uCubeShadowPlanes[0].y) - bias));
+   cubeShadowVisibilities[1] = texture(uCubeShadowMaps[1],
+      vec4(nFromLight, vectorToDepthValue(fromLight, uCubeShadowPlanes[1].x, uCubeShadowPlanes[1].y) - bias));
+   cubeShadowVisibilities[2] = texture(uCubeShadowMaps[2],
+      vec4(nFromLight, vectorToDepthValue(fromLight, uCubeShadowPlanes[2].x, uCubeShadowPlanes[2].y) - bias));
+   cubeShadowVisibilities[3] = texture(uCubeShadowMaps[3],
+      vec4(nFromLight, vectorToDepthValue(fromLight, uCubeShadowPlanes[3].x, uCubeShadowPlanes[3].y) - bias));
+
+   // Samplers can only be indexed with constants, so look up every shadow and keep the light's own
+   float visibility = 0.0;
+   for (int i = 0; i < MAX_SHADOWS; ++i) {
+      visibility += shadowVisibilities[i] * float(light.shadowIndex == i);
+   }
+   for (int i = 0; i < MAX_CUBE_SHADOWS; ++i) {
+      visibility += cubeShadowVisibilities[i] * float(light.cubeShadowIndex == i);
+   }
+
+   return visibility;
 }
 #endif
 
@@ -2,30 +2,52 @@
 
 #define SHADOWS
 
+#define MAX_LIGHTS 10
 #define MAX_SHADOWS 5
+#define MAX_CUBE_SHADOWS 4
 
-#ifdef SHADOWS
-struct Shadow {
-   mat4 shadowView, shadowProj;
-   sampler2DShadow shadowMap;
+struct Light {
+   vec3 color;
+   int type;
+   vec3 position;
+   float linearFalloff;
+   vec3 direction;
+   float squareFalloff;
+   float beamAngle;
+   float cutoffAngle;
+
+   // Index of the light's shadow / cube shadow (-1 if it has none)
+   int shadowIndex;
+   int cubeShadowIndex;
 };
-#endif
 
-uniform mat4 uProjMatrix;
-uniform mat4 uViewMatrix;
-uniform mat4 uModelMatrix;
-uniform mat4 uNormalMatrix;
+// Shared by every scene program, written once per frame
+layout(std140) uniform Lights {
+   Light uLights[MAX_LIGHTS];
+   mat4 uShadowMatrices[MAX_SHADOWS];
+   vec4 uCubeShadowPlanes[MAX_CUBE_SHADOWS];
+   int uNumLights;
+};
 
-uniform int uNumLights;
+// Shared by every scene program, written once per view
+layout(std140) uniform Camera {
+   mat4 uProjMatrix;
+   mat4 uViewMatrix;
+   vec3 uCameraPos;
+};
 
-#ifdef SHADOWS
-uniform Shadow uShadows[MAX_SHADOWS];
-#endif
+uniform mat4 uModelMatrix;
+uniform mat4 uNormalMatrix;
+uniform bool uInstanced = false;
 
 layout(location = 0) in vec3 aPosition;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aTexCoord;
 
+// Used instead of the model / normal matrix uniforms when drawing instances
+layout(location = 4) in mat4 aInstanceModelMatrix;
+layout(location = 8) in mat4 aInstanceNormalMatrix;
+
 out vec3 vWorldPosition;
 flat out vec3 vNormal;
 #ifdef SHADOWS
@@ -34,7 +56,8 @@ out vec4 vShadowCoords[MAX_SHADOWS];
 
 void main() {
    // Transforms
-   vec4 lPosition = uModelMatrix * vec4(aPosition.xyz, 1.0);
+   mat4 modelMatrix = uInstanced ? aInstanceModelMatrix : uModelMatrix;
+   vec4 lPosition = modelMatrix * vec4(aPosition.xyz, 1.0);
    vWorldPosition = lPosition.xyz;
    gl_Position = uProjMatrix * uViewMatrix * lPosition;
 
@@ -42,15 +65,13 @@ void main() {
    // Shadow coordinates
    const float offsetAmount = 0.1;
    vec4 offsetPosition = lPosition + vec4(normalize(aNormal) * offsetAmount, 0.0);
-   vShadowCoords[0] = uShadows[0].shadowProj * uShadows[0].shadowView * offsetPosition;
-   vShadowCoords[1] = uShadows[1].shadowProj * uShadows[1].shadowView * offsetPosition;
-   vShadowCoords[2] = uShadows[2].shadowProj * uShadows[2].shadowView * offsetPosition;
-   vShadowCoords[3] = uShadows[3].shadowProj * uShadows[3].shadowView * offsetPosition;
-   vShadowCoords[4] = uShadows[4].shadowProj * uShadows[4].shadowView * offsetPosition;
+   for (int i = 0; i < MAX_SHADOWS; ++i) {
+      vShadowCoords[i] = uShadowMatrices[i] * offsetPosition;
+   }
 #endif
 
    // Calculate the relative normal
    vec4 lNormal = vec4(aNormal.xyz, 0.0);
-   lNormal = uNormalMatrix * lNormal;
+   lNormal = (uInstanced ? aInstanceNormalMatrix : uNormalMatrix) * lNormal;
    vNormal = lNormal.xyz;
 }
\ No newline at end of file
@@ -1,14 +1,23 @@
 #version 330 core
 
-uniform mat4 uProjMatrix;
-uniform mat4 uViewMatrix;
+// Shared by every scene program, written once per view
+layout(std140) uniform Camera {
+   mat4 uProjMatrix;
+   mat4 uViewMatrix;
+   vec3 uCameraPos;
+};
+
 uniform mat4 uModelMatrix;
 uniform vec3 uLightDir;
 uniform bool uDisableNormalOffsetting = false;
+uniform bool uInstanced = false;
 
 layout(location = 0) in vec3 aPosition;
 layout(location = 1) in vec3 aNormal;
 
+// Used instead of the model matrix uniform when drawing instances
+layout(location = 4) in mat4 aInstanceModelMatrix;
+
 void main() {
    const float baseOffset = 0.05;
    const float maxOffset = 0.1;
@@ -21,5 +30,6 @@ void main() {
    }
    vec3 offset = vec3(normalize(aNormal) * offsetAmount);
 
-   gl_Position = uProjMatrix * uViewMatrix * uModelMatrix * vec4(aPosition - offset, 1.0);
+   mat4 modelMatrix = uInstanced ? aInstanceModelMatrix : uModelMatrix;
+   gl_Position = uProjMatrix * uViewMatrix * modelMatrix * vec4(aPosition - offset, 1.0);
 }
@@ -1,7 +1,12 @@
 #version 330 core
 
-uniform mat4 uProjMatrix;
-uniform mat4 uViewMatrix;
+// Shared by every scene program, written once per view
+layout(std140) uniform Camera {
+   mat4 uProjMatrix;
+   mat4 uViewMatrix;
+   vec3 uCameraPos;
+};
+
 uniform mat4 uModelMatrix;
 
 layout(location = 0) in vec3 aPosition;
@@ -2,6 +2,7 @@
 #define ABILITY_H
 
 class GameObject;
+class Scene;
 
 class Ability {
 private:
@@ -39,6 +40,13 @@ public:
       timeSinceLastUse += dt;
    }
 
+   /**
+    * Builds the objects the ability uses ahead of time, in the given scene's object pool (must not be called while the
+    * scene is ticking)
+    */
+   virtual void prewarm(Scene &scene) {
+   }
+
    virtual bool use() = 0;
 };
 
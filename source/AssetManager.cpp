@@ -1,21 +1,175 @@
 #include "AssetManager.h"
+#include "LogHelper.h"
+#include "Profiler.h"
 
-AssetManager::AssetManager() {
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+   return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool isRunning(const std::future<void> &future) {
+   return future.valid() && future.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+} // namespace
+
+AssetManager::AssetManager(bool headless)
+   : headless(headless), textureAssetManager(uploadQueue), memoryBudget(DEFAULT_ASSET_MEMORY_BUDGET), numEvicted(0), evictedBytes(0) {
 }
 
 AssetManager::~AssetManager() {
+   // A background reload may be waiting for the main thread to upload its textures
+   while (isRunning(backgroundReload)) {
+      uploadQueue.waitAndProcess(std::chrono::milliseconds(10));
+   }
 }
 
 void AssetManager::reloadAssets() {
-   shaderAssetManager.reloadShaders();
+   if (headless) {
+      return;
+   }
+
+   PROFILE_ZONE("AssetManager::reloadAssets");
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+   int numShaderPrograms = shaderAssetManager.reloadChangedShaders();
+   if (numShaderPrograms > 0) {
+      LOG_INFO("Reloaded " << numShaderPrograms << " shader programs in " << (secondsSince(start) * 1000.0) << " ms");
+   }
+
+   // Changes made while a reload is still running are picked up by the next one
+   if (isRunning(backgroundReload)) {
+      return;
+   }
+
+   backgroundReload = std::async(std::launch::async, [this, start]() {
+      int numTextures = textureAssetManager.reloadChangedTextures();
+      int numMeshes = meshAssetManager.reloadChangedMeshes();
+
+      if (numTextures > 0 || numMeshes > 0) {
+         LOG_INFO("Reloaded " << numTextures << " textures and " << numMeshes << " meshes in the background, " << (secondsSince(start) * 1000.0) << " ms after checking for changes");
+      }
+   });
+}
+
+void AssetManager::setMemoryBudget(std::size_t budget) {
+   memoryBudget = budget;
+}
+
+int AssetManager::evictUnusedAssets() {
+   PROFILE_ZONE("AssetManager::evictUnusedAssets");
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+   meshAssetManager.releaseReplacedMeshes();
+
+   std::size_t totalBytes = getMemoryReport().totalBytes();
+   if (totalBytes <= memoryBudget) {
+      return 0;
+   }
+
+   // Shapes are cheap to rebuild (BVHs are stored on disk), and hold references to their meshes, so they go first
+   std::size_t releasedBytes = physicsShapeCache.releaseUnusedShapes();
+   totalBytes -= releasedBytes;
+
+   std::vector<EvictionCandidate> candidates(meshAssetManager.getEvictionCandidates());
+   std::vector<EvictionCandidate> textureCandidates(textureAssetManager.getEvictionCandidates());
+   candidates.insert(candidates.end(), textureCandidates.begin(), textureCandidates.end());
+   std::sort(candidates.begin(), candidates.end(), [](const EvictionCandidate &first, const EvictionCandidate &second) {
+      return first.lastUse < second.lastUse;
+   });
+
+   int numEvictedNow = 0;
+   for (const EvictionCandidate &candidate : candidates) {
+      if (totalBytes <= memoryBudget) {
+         break;
+      }
+
+      if (candidate.evict()) {
+         LOG_DEBUG("Evicted " << candidate.name << " (" << (candidate.bytes / 1024) << " KB)");
+         totalBytes -= std::min(candidate.bytes, totalBytes);
+         releasedBytes += candidate.bytes;
+         ++numEvictedNow;
+      }
+   }
+
+   numEvicted += numEvictedNow;
+   evictedBytes += releasedBytes;
+
+   LOG_INFO("Evicted " << numEvictedNow << " unused assets and released unused physics shapes in " << (secondsSince(start) * 1000.0) << " ms, freeing " << (releasedBytes / 1024) << " KB");
+   if (totalBytes > memoryBudget) {
+      LOG_WARNING("Assets in use take " << (totalBytes / 1024) << " KB, over the budget of " << (memoryBudget / 1024) << " KB");
+   }
+
+   return numEvictedNow;
+}
+
+AssetMemoryReport AssetManager::getMemoryReport() {
+   AssetMemoryReport report;
+   report.meshes = meshAssetManager.getMemoryUsage();
+   report.physicsShapes = physicsShapeCache.getMemoryUsage();
+   report.textures = textureAssetManager.getMemoryUsage();
+   report.shaderPrograms = shaderAssetManager.getMemoryUsage();
+   report.budget = memoryBudget;
+   report.numEvicted = numEvicted;
+   report.evictedBytes = evictedBytes;
+
+   return report;
+}
+
+void AssetManager::logMemoryReport() {
+   AssetMemoryReport report(getMemoryReport());
+   LOG_INFO("Asset memory: " << (report.totalBytes() / 1024) << " KB of " << (report.budget / 1024) << " KB budget; "
+            << report.meshes.numAssets << " meshes (" << report.meshes.numUnreferenced << " unused, " << (report.meshes.cpuBytes / 1024) << " KB CPU, " << (report.meshes.gpuBytes / 1024) << " KB GPU), "
+            << report.physicsShapes.numAssets << " physics shapes (" << report.physicsShapes.numUnreferenced << " unused, " << (report.physicsShapes.cpuBytes / 1024) << " KB CPU), "
+            << report.textures.numAssets << " textures (" << report.textures.numUnreferenced << " unused, " << (report.textures.gpuBytes / 1024) << " KB GPU), "
+            << report.shaderPrograms.numAssets << " shader programs; " << report.numEvicted << " assets evicted so far (" << (report.evictedBytes / 1024) << " KB)");
+}
+
+void AssetManager::processUploads() {
+   uploadQueue.process();
+}
+
+void AssetManager::waitAndProcessUploads(std::chrono::milliseconds maxWait) {
+   uploadQueue.waitAndProcess(maxWait);
 }
 
 SPtr<Shader> AssetManager::loadShader(const std::string &fileName, const GLenum type) {
-   return shaderAssetManager.loadShader(fileName, type);
+   if (headless) {
+      return nullptr;
+   }
+
+   // Cached shaders can be shared with any thread, but new ones have to be compiled on the main thread
+   SPtr<Shader> shader = shaderAssetManager.findShader(fileName);
+   if (!shader) {
+      uploadQueue.run([this, &shader, &fileName, type]() {
+         shader = shaderAssetManager.loadShader(fileName, type);
+      });
+   }
+
+   return shader;
 }
 
 SPtr<ShaderProgram> AssetManager::loadShaderProgram(const std::string &fileName) {
-   return shaderAssetManager.loadShaderProgram(fileName);
+   if (headless) {
+      return nullptr;
+   }
+
+   SPtr<ShaderProgram> shaderProgram = shaderAssetManager.findShaderProgram(fileName);
+   if (!shaderProgram) {
+      uploadQueue.run([this, &shaderProgram, &fileName]() {
+         shaderProgram = shaderAssetManager.loadShaderProgram(fileName);
+      });
+   }
+
+   return shaderProgram;
+}
+
+ShaderStats AssetManager::getShaderStats() {
+   return shaderAssetManager.getStats();
 }
 
 SPtr<Mesh> AssetManager::loadMesh(const std::string &fileName) {
@@ -26,10 +180,34 @@ SPtr<Mesh> AssetManager::getMeshForShape(MeshShape shape) {
    return meshAssetManager.getMeshForShape(shape);
 }
 
+SPtr<btCollisionShape> AssetManager::getBvhShape(const SPtr<Mesh> &mesh, const glm::vec3 &scale) {
+   return physicsShapeCache.getBvhShape(mesh, scale);
+}
+
+SPtr<btCollisionShape> AssetManager::getHullShape(const SPtr<Mesh> &mesh, const glm::vec3 &scale) {
+   return physicsShapeCache.getHullShape(mesh, scale);
+}
+
+PhysicsShapeStats AssetManager::getPhysicsShapeStats() {
+   return physicsShapeCache.getStats();
+}
+
 SPtr<Texture> AssetManager::loadTexture(const std::string &fileName, TextureWrap::Type wrap) {
+   if (headless) {
+      return nullptr;
+   }
+
    return textureAssetManager.loadTexture(fileName, wrap);
 }
 
 SPtr<Texture> AssetManager::loadCubemap(const std::string &path, const std::string &extension) {
+   if (headless) {
+      return nullptr;
+   }
+
    return textureAssetManager.loadCubemap(path, extension);
 }
+
+TextureStats AssetManager::getTextureStats() {
+   return textureAssetManager.getStats();
+}
@@ -1,27 +1,111 @@
 #ifndef ASSET_MANAGER_H
 #define ASSET_MANAGER_H
 
+#include "AssetMemory.h"
 #include "MeshAssetManager.h"
+#include "PhysicsShapeCache.h"
 #include "ShaderAssetManager.h"
 #include "TextureAssetManager.h"
 #include "Types.h"
+#include "UploadQueue.h"
+
+#include <chrono>
+#include <cstddef>
+#include <future>
 
 class Mesh;
 class Shader;
 
+namespace {
+
+// Cached assets that nothing references are kept until the total goes over this
+const std::size_t DEFAULT_ASSET_MEMORY_BUDGET = 256 * 1024 * 1024;
+
+} // namespace
+
+/**
+ * Memory currently used by each category of cached assets, along with the budget and what has been evicted (since the
+ * manager was created) to stay within it
+ */
+struct AssetMemoryReport {
+   AssetMemoryUsage meshes;
+   AssetMemoryUsage physicsShapes;
+   AssetMemoryUsage textures;
+   AssetMemoryUsage shaderPrograms;
+   std::size_t budget;
+   long numEvicted;
+   std::size_t evictedBytes;
+
+   AssetMemoryReport()
+      : budget(0), numEvicted(0), evictedBytes(0) {
+   }
+
+   std::size_t totalBytes() const {
+      return meshes.totalBytes() + physicsShapes.totalBytes() + textures.totalBytes() + shaderPrograms.totalBytes();
+   }
+};
+
+/**
+ * Assets can be loaded from any thread (e.g. by a background scene load), but all GL work is done on the main thread,
+ * which has to call processUploads() regularly
+ */
 class AssetManager {
 protected:
+   /**
+    * If true, there is no GL context, so shaders and textures are never loaded (meshes are still loaded for physics)
+    */
+   const bool headless;
+
+   UploadQueue uploadQueue;
    MeshAssetManager meshAssetManager;
+   PhysicsShapeCache physicsShapeCache;
    ShaderAssetManager shaderAssetManager;
    TextureAssetManager textureAssetManager;
 
+   /**
+    * Reload of changed textures and meshes running in the background (if any)
+    */
+   std::future<void> backgroundReload;
+
+   std::size_t memoryBudget;
+   long numEvicted;
+   std::size_t evictedBytes;
+
 public:
-   AssetManager();
+   AssetManager(bool headless = false);
 
    virtual ~AssetManager();
 
+   /**
+    * Reloads the assets whose files changed since they were loaded. Shaders are recompiled right away, while textures
+    * and meshes are decoded in the background (textures are then uploaded through processUploads()). Must be called from
+    * the main thread
+    */
    void reloadAssets();
 
+   void setMemoryBudget(std::size_t budget);
+
+   /**
+    * If the cached assets use more memory than the budget, evicts those that nothing references, least recently used
+    * first, until they fit. Returns the number of assets evicted. Must be called from the main thread, between scenes
+    */
+   int evictUnusedAssets();
+
+   AssetMemoryReport getMemoryReport();
+
+   void logMemoryReport();
+
+   /**
+    * Does all GL work requested by other threads. Must be called from the main thread
+    */
+   void processUploads();
+
+   /**
+    * Waits up to the given time for GL work to be requested by other threads, then does it. Must be called from the main
+    * thread
+    */
+   void waitAndProcessUploads(std::chrono::milliseconds maxWait);
+
    /**
     * Loads the shader with the given file name and type, using a cached version if possible
     */
@@ -32,6 +116,8 @@ public:
     */
    SPtr<ShaderProgram> loadShaderProgram(const std::string &fileName);
 
+   ShaderStats getShaderStats();
+
    /**
     * Loads the mesh with the given file name, using a cached version if possible
     */
@@ -42,6 +128,18 @@ public:
     */
    SPtr<Mesh> getMeshForShape(MeshShape shape);
 
+   /**
+    * Gets a triangle mesh collision shape for the mesh, sharing its BVH with other instances
+    */
+   SPtr<btCollisionShape> getBvhShape(const SPtr<Mesh> &mesh, const glm::vec3 &scale);
+
+   /**
+    * Gets a convex hull collision shape for the mesh, shared with other instances with the same scale
+    */
+   SPtr<btCollisionShape> getHullShape(const SPtr<Mesh> &mesh, const glm::vec3 &scale);
+
+   PhysicsShapeStats getPhysicsShapeStats();
+
    /**
     * Loads the texture with the given file name, using a cached version if possible
     */
@@ -51,6 +149,8 @@ public:
     * Loads the cubemap at the given path, using a cached version if possible
     */
    SPtr<Texture> loadCubemap(const std::string &path, const std::string &extension = "png");
+
+   TextureStats getTextureStats();
 };
 
 #endif
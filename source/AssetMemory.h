@@ -0,0 +1,53 @@
+#ifndef ASSET_MEMORY_H
+#define ASSET_MEMORY_H
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+
+/**
+ * Memory currently used by one category of cached assets
+ */
+struct AssetMemoryUsage {
+   long numAssets;
+
+   /**
+    * Assets that nothing but the cache references (which can be evicted)
+    */
+   long numUnreferenced;
+
+   /**
+    * Data kept in memory (e.g. vertices and indices for physics)
+    */
+   std::size_t cpuBytes;
+
+   /**
+    * Buffers and textures uploaded to the GPU
+    */
+   std::size_t gpuBytes;
+
+   AssetMemoryUsage()
+      : numAssets(0), numUnreferenced(0), cpuBytes(0), gpuBytes(0) {
+   }
+
+   std::size_t totalBytes() const {
+      return cpuBytes + gpuBytes;
+   }
+};
+
+/**
+ * A cached asset that nothing but the cache references, which can be evicted to free memory
+ */
+struct EvictionCandidate {
+   std::string name;
+   std::size_t bytes;
+   std::chrono::steady_clock::time_point lastUse;
+
+   /**
+    * Removes the asset from its cache, returning false if it was referenced again in the meantime (and so was kept)
+    */
+   std::function<bool()> evict;
+};
+
+#endif
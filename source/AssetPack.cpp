@@ -0,0 +1,219 @@
+#include "AssetPack.h"
+#include "FancyAssert.h"
+#include "LogHelper.h"
+#include "Lz4.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+const char MAGIC[4] = { 'T', 'G', 'I', 'A' };
+
+// Bump whenever the layout changes, so that old packs are rejected (and the loose files used instead)
+const uint32_t VERSION = 1;
+
+// Entries start on 16 byte boundaries (the mapping itself is page aligned)
+const uint64_t ENTRY_ALIGNMENT = 16;
+
+// Only keep the compressed version of a file if it saves at least this fraction of its size
+const double MIN_COMPRESSION_SAVINGS = 0.1;
+
+const uint32_t FLAG_COMPRESSED = 1;
+
+struct Header {
+   char magic[4];
+   uint32_t version;
+   uint32_t numEntries;
+   uint32_t nameDataSize;
+};
+
+struct TocEntry {
+   uint64_t offset;
+   uint64_t storedSize;
+   uint64_t size;
+   uint32_t nameOffset;
+   uint32_t nameLength;
+   uint32_t flags;
+   uint32_t padding;
+};
+
+static_assert(sizeof(Header) == 16 && sizeof(TocEntry) == 40, "Asset pack layout must not depend on the compiler");
+
+uint64_t align(uint64_t offset) {
+   return (offset + ENTRY_ALIGNMENT - 1) & ~(ENTRY_ALIGNMENT - 1);
+}
+
+bool blockFits(uint64_t offset, uint64_t size, std::size_t fileSize) {
+   return offset <= fileSize && size <= fileSize - offset;
+}
+
+} // namespace
+
+AssetPack::AssetPack(const SPtr<MappedFile> &mappedFile, const OSUtils::FileStatus &status)
+   : mappedFile(mappedFile), status(status) {
+}
+
+AssetPack::~AssetPack() {
+}
+
+// static
+SPtr<AssetPack> AssetPack::open(const std::string &fileName) {
+   ASSERT(!fileName.empty(), "Trying to open asset pack with empty file name");
+
+   folly::Optional<OSUtils::FileStatus> status(OSUtils::getFileStatus(fileName));
+   SPtr<MappedFile> mappedFile(MappedFile::open(fileName));
+   if (!status || !mappedFile || mappedFile->getSize() < sizeof(Header)) {
+      return nullptr;
+   }
+
+   Header header;
+   memcpy(&header, mappedFile->getData(), sizeof(header));
+   if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+      LOG_WARNING("Invalid asset pack: " << fileName);
+      return nullptr;
+   }
+
+   std::size_t size = mappedFile->getSize();
+   uint64_t tocSize = static_cast<uint64_t>(header.numEntries) * sizeof(TocEntry);
+   if (!blockFits(sizeof(Header), tocSize + header.nameDataSize, size)) {
+      LOG_WARNING("Invalid asset pack: " << fileName);
+      return nullptr;
+   }
+
+   const char *data = mappedFile->getData();
+   const char *names = data + sizeof(Header) + tocSize;
+   SPtr<AssetPack> pack(new AssetPack(mappedFile, *status));
+   pack->entries.reserve(header.numEntries);
+
+   for (uint32_t i = 0; i < header.numEntries; ++i) {
+      TocEntry tocEntry;
+      memcpy(&tocEntry, data + sizeof(Header) + i * sizeof(TocEntry), sizeof(tocEntry));
+
+      bool compressed = (tocEntry.flags & FLAG_COMPRESSED) != 0;
+      if (!blockFits(tocEntry.nameOffset, tocEntry.nameLength, header.nameDataSize)
+         || !blockFits(tocEntry.offset, tocEntry.storedSize, size)
+         || (!compressed && tocEntry.storedSize != tocEntry.size)
+         || (compressed && tocEntry.size > Lz4::decompressBound(tocEntry.storedSize))) {
+         LOG_WARNING("Invalid asset pack entry " << i << " in " << fileName);
+         return nullptr;
+      }
+
+      Entry entry;
+      entry.data = data + tocEntry.offset;
+      entry.storedSize = static_cast<std::size_t>(tocEntry.storedSize);
+      entry.size = static_cast<std::size_t>(tocEntry.size);
+      entry.compressed = compressed;
+      pack->entries.emplace(std::string(names + tocEntry.nameOffset, tocEntry.nameLength), entry);
+   }
+
+   return pack;
+}
+
+// static
+bool AssetPack::build(const std::string &directory, const std::string &fileName) {
+   ASSERT(!fileName.empty(), "Trying to build asset pack with empty file name");
+
+   std::vector<std::string> names(OSUtils::listFiles(directory));
+   std::sort(names.begin(), names.end());
+
+   Header header;
+   memcpy(header.magic, MAGIC, sizeof(MAGIC));
+   header.version = VERSION;
+   header.numEntries = static_cast<uint32_t>(names.size());
+   header.nameDataSize = 0;
+   for (const std::string &name : names) {
+      header.nameDataSize += static_cast<uint32_t>(name.size());
+   }
+
+   // Read (and compress) every file up front, so that the table of contents can be written first
+   std::vector<TocEntry> toc(names.size());
+   std::vector<std::vector<char>> contents(names.size());
+   uint64_t offset = align(sizeof(Header) + toc.size() * sizeof(TocEntry) + header.nameDataSize);
+   uint32_t nameOffset = 0;
+   uint64_t totalSize = 0;
+   int numCompressed = 0;
+
+   for (std::size_t i = 0; i < names.size(); ++i) {
+      std::string path(directory + "/" + names[i]);
+      std::ifstream in(path, std::ifstream::binary);
+      if (!in) {
+         LOG_WARNING("Unable to read file for asset pack: " << path);
+         return false;
+      }
+      std::vector<char> &content = contents[i];
+      content.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+      TocEntry &tocEntry = toc[i];
+      memset(&tocEntry, 0, sizeof(tocEntry));
+      tocEntry.size = content.size();
+      tocEntry.nameOffset = nameOffset;
+      tocEntry.nameLength = static_cast<uint32_t>(names[i].size());
+      nameOffset += tocEntry.nameLength;
+      totalSize += content.size();
+
+      std::vector<char> compressed(Lz4::compressBound(content.size()));
+      std::size_t compressedSize = Lz4::compress(content.data(), content.size(), compressed.data(), compressed.size());
+      if (compressedSize < content.size() * (1.0 - MIN_COMPRESSION_SAVINGS)) {
+         compressed.resize(compressedSize);
+         content.swap(compressed);
+         tocEntry.flags |= FLAG_COMPRESSED;
+         ++numCompressed;
+      }
+
+      tocEntry.storedSize = content.size();
+      tocEntry.offset = offset;
+      offset = align(offset + content.size());
+   }
+
+   // Write to a temporary file first, so that a running game never maps a partially written pack
+   std::string tempFileName(fileName + ".tmp");
+   {
+      std::ofstream out(tempFileName, std::ofstream::binary);
+      if (!out) {
+         LOG_WARNING("Unable to write asset pack: " << fileName);
+         return false;
+      }
+
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      out.write(reinterpret_cast<const char*>(toc.data()), toc.size() * sizeof(TocEntry));
+      for (const std::string &name : names) {
+         out.write(name.data(), name.size());
+      }
+
+      static const char padding[ENTRY_ALIGNMENT] = {};
+      for (std::size_t i = 0; i < contents.size(); ++i) {
+         std::streamoff position = out.tellp();
+         out.write(padding, toc[i].offset - position);
+         out.write(contents[i].data(), contents[i].size());
+      }
+
+      if (!out) {
+         out.close();
+         std::remove(tempFileName.c_str());
+         LOG_WARNING("Unable to write asset pack: " << fileName);
+         return false;
+      }
+   }
+
+   // Renaming over an existing file fails on Windows
+   std::remove(fileName.c_str());
+   if (std::rename(tempFileName.c_str(), fileName.c_str()) != 0) {
+      LOG_WARNING("Unable to write asset pack: " << fileName);
+      return false;
+   }
+
+   LOG_INFO("Packed " << names.size() << " files (" << numCompressed << " compressed) from " << directory << " into " << fileName << ": " << totalSize << " bytes stored in " << offset << " bytes");
+   return true;
+}
+
+const AssetPack::Entry* AssetPack::find(const std::string &name) const {
+   std::unordered_map<std::string, Entry>::const_iterator itr = entries.find(name);
+   return itr == entries.end() ? nullptr : &itr->second;
+}
@@ -0,0 +1,74 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include "OSUtils.h"
+#include "Types.h"
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+
+class MappedFile;
+
+/**
+ * A single file holding every data file, mapped into memory once so that loading a file is a table lookup instead of
+ * opening and reading it. Each entry starts on a 16 byte boundary, and is stored LZ4 compressed when that makes it
+ * noticeably smaller (already compressed formats like PNG and OGG are stored as-is)
+ */
+class AssetPack {
+public:
+   struct Entry {
+      /**
+       * Stored (possibly compressed) contents, pointing into the mapped pack
+       */
+      const char *data;
+      std::size_t storedSize;
+      std::size_t size;
+      bool compressed;
+   };
+
+protected:
+   SPtr<MappedFile> mappedFile;
+   OSUtils::FileStatus status;
+   std::unordered_map<std::string, Entry> entries;
+
+   AssetPack(const SPtr<MappedFile> &mappedFile, const OSUtils::FileStatus &status);
+
+public:
+   virtual ~AssetPack();
+
+   /**
+    * Maps the pack with the given name, returning null if it is missing or invalid
+    */
+   static SPtr<AssetPack> open(const std::string &fileName);
+
+   /**
+    * Packs every file in the given directory (recursively) into a pack with the given name, returning true on success
+    */
+   static bool build(const std::string &directory, const std::string &fileName);
+
+   /**
+    * Gets the entry for the file with the given (relative to the packed directory) name, or null if it isn't packed
+    */
+   const Entry* find(const std::string &name) const;
+
+   /**
+    * Gets the mapping that entries point into, so that users of an entry's data can keep it alive
+    */
+   const SPtr<MappedFile>& getMappedFile() const {
+      return mappedFile;
+   }
+
+   /**
+    * Gets the status of the pack file, as of when it was mapped
+    */
+   const OSUtils::FileStatus& getStatus() const {
+      return status;
+   }
+
+   std::size_t getNumEntries() const {
+      return entries.size();
+   }
+};
+
+#endif
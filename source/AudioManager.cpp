@@ -2,10 +2,12 @@
 #include "FancyAssert.h"
 #include "IOUtils.h"
 #include "LogHelper.h"
+#include "Profiler.h"
 
 #include <FMOD/fmod.hpp>
 #include <FMOD/fmod_errors.h>
 
+#include <cstring>
 #include <random>
 #include <sstream>
 
@@ -155,6 +157,36 @@ void AudioManager::release() {
    }
 }
 
+FMOD::Sound* AudioManager::createSound(const std::string &fileName, unsigned int mode, bool stream) {
+   FMOD::Sound *sound = nullptr;
+
+   // Packed sounds are played from memory (without copying, since the pack stays mapped) instead of opening the loose file
+   folly::Optional<IOUtils::DataFile> dataFile;
+   if (IOUtils::isDataFilePacked(fileName)) {
+      dataFile = IOUtils::readDataFile(fileName);
+   }
+
+   if (dataFile) {
+      FMOD_CREATESOUNDEXINFO info;
+      memset(&info, 0, sizeof(info));
+      info.cbsize = sizeof(info);
+      info.length = static_cast<unsigned int>(dataFile->size);
+
+      mode |= FMOD_OPENMEMORY_POINT;
+      FMOD_RESULT result = stream ? system->createStream(dataFile->data, mode, &info, &sound) : system->createSound(dataFile->data, mode, &info, &sound);
+      if (!check(result)) {
+         return nullptr;
+      }
+
+      soundData.push_back(dataFile->storage);
+      return sound;
+   }
+
+   std::string path(IOUtils::dataPath(fileName));
+   FMOD_RESULT result = stream ? system->createStream(path.c_str(), mode, nullptr, &sound) : system->createSound(path.c_str(), mode, nullptr, &sound);
+   return check(result) ? sound : nullptr;
+}
+
 void AudioManager::load(const SoundGroup &soundGroup) {
    ASSERT(system, "Audio system not initialized");
 
@@ -167,15 +199,15 @@ void AudioManager::load(const SoundGroup &soundGroup) {
       mode |= FMOD_LOOP_NORMAL;
 
       for (const std::string &fileName : soundGroup.getSoundFiles()) {
-         FMOD::Sound *sound;
-         if (check(system->createStream(IOUtils::dataPath(fileName).c_str(), mode, nullptr, &sound))) {
+         FMOD::Sound *sound = createSound(fileName, mode, true);
+         if (sound) {
             soundMap[fileName] = sound;
          }
       }
    } else {
       for (const std::string &fileName : soundGroup.getSoundFiles()) {
-         FMOD::Sound *sound;
-         if (check(system->createSound(IOUtils::dataPath(fileName).c_str(), mode, nullptr, &sound))) {
+         FMOD::Sound *sound = createSound(fileName, mode, false);
+         if (sound) {
             if (soundGroup.isThreeDimensional()) {
                sound->set3DMinMaxDistance(soundGroup.getMinDistance(), MAX_DISTANCE);
             }
@@ -234,11 +266,20 @@ void AudioManager::init() {
 }
 
 void AudioManager::update() {
+   if (!system) {
+      return;
+   }
+
+   PROFILE_ZONE("AudioManager::update");
+
    check(system->update());
 }
 
 void AudioManager::updateAttributes(const std::vector<ListenerAttributes> &attributesVec) {
-   ASSERT(system, "Audio system not initialized");
+   if (!system) {
+      return;
+   }
+
    ASSERT(attributesVec.size() < 5, "Invalid number of listeners");
 
    if (numListeners != attributesVec.size()) {
@@ -258,7 +299,9 @@ void AudioManager::updateAttributes(const std::vector<ListenerAttributes> &attri
 }
 
 void AudioManager::play(const SoundGroup &soundGroup, const glm::vec3 &pos, const glm::vec3 &vel) {
-   ASSERT(system, "Audio system not initialized");
+   if (!system) {
+      return;
+   }
 
    const std::string &fileName = soundGroup.getSoundFile();
    if (!soundMap.count(fileName)) {
@@ -1,6 +1,8 @@
 #ifndef AUDIO_MANAGER_H
 #define AUDIO_MANAGER_H
 
+#include "Types.h"
+
 #include <glm/glm.hpp>
 
 #include <string>
@@ -90,10 +92,20 @@ protected:
 
    SoundMap soundMap;
 
+   /**
+    * Keeps the data of sounds played straight from memory alive
+    */
+   std::vector<SPtr<const void>> soundData;
+
    int numListeners;
 
    void release();
 
+   /**
+    * Creates the sound (or stream) for the given data file, playing it from the mounted asset pack if it is packed
+    */
+   FMOD::Sound* createSound(const std::string &fileName, unsigned int mode, bool stream);
+
    void load(const SoundGroup &soundGroup);
 
 public:
@@ -0,0 +1,266 @@
+#include "BoundingVolumeHierarchy.h"
+#include "FancyAssert.h"
+#include "GameObject.h"
+#include "PhysicsComponent.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+namespace {
+
+const int NUM_PLANES = 6;
+const int MAX_LEAF_OBJECTS = 4;
+const int MAX_STACK_SIZE = 64;
+
+// Moving objects make the refit bounds overlap more and more, so rebuild the tree every so often
+const int REBUILD_INTERVAL = 120;
+
+/**
+ * Frustum planes in structure-of-arrays form, so that the per-plane math in classify() vectorizes
+ */
+struct PlaneSet {
+   float nx[NUM_PLANES];
+   float ny[NUM_PLANES];
+   float nz[NUM_PLANES];
+   float absX[NUM_PLANES];
+   float absY[NUM_PLANES];
+   float absZ[NUM_PLANES];
+   float d[NUM_PLANES];
+
+   PlaneSet(const std::array<glm::vec4, 6> &planes) {
+      for (int i = 0; i < NUM_PLANES; ++i) {
+         nx[i] = planes[i].x;
+         ny[i] = planes[i].y;
+         nz[i] = planes[i].z;
+         absX[i] = glm::abs(planes[i].x);
+         absY[i] = glm::abs(planes[i].y);
+         absZ[i] = glm::abs(planes[i].z);
+         d[i] = planes[i].w;
+      }
+   }
+};
+
+enum class Containment {
+   Outside,
+   Inside,
+   Intersecting
+};
+
+/**
+ * Classifies a box against the frustum. A box is outside when its most positive corner is behind any plane, and inside
+ * when its most negative corner is in front of all of them
+ */
+Containment classify(const PlaneSet &planes, const glm::vec3 &center, const glm::vec3 &extents) {
+   float distance[NUM_PLANES];
+   float radius[NUM_PLANES];
+
+   for (int i = 0; i < NUM_PLANES; ++i) {
+      distance[i] = planes.nx[i] * center.x + planes.ny[i] * center.y + planes.nz[i] * center.z + planes.d[i];
+      radius[i] = planes.absX[i] * extents.x + planes.absY[i] * extents.y + planes.absZ[i] * extents.z;
+   }
+
+   bool inside = true;
+   for (int i = 0; i < NUM_PLANES; ++i) {
+      if (distance[i] + radius[i] < 0.0f) {
+         return Containment::Outside;
+      }
+      if (distance[i] - radius[i] < 0.0f) {
+         inside = false;
+      }
+   }
+
+   return inside ? Containment::Inside : Containment::Intersecting;
+}
+
+} // namespace
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+   : numRefits(0) {
+}
+
+BoundingVolumeHierarchy::~BoundingVolumeHierarchy() {
+}
+
+void BoundingVolumeHierarchy::update(const std::vector<SPtr<GameObject>> &gameObjects) {
+   PROFILE_ZONE("BoundingVolumeHierarchy::update");
+
+   bool changed = gameObjects.size() != sourceObjects.size();
+   for (std::size_t i = 0; !changed && i < gameObjects.size(); ++i) {
+      changed = gameObjects[i].get() != sourceObjects[i];
+   }
+
+   if (changed || numRefits >= REBUILD_INTERVAL) {
+      rebuild(gameObjects);
+   } else {
+      refit();
+   }
+}
+
+void BoundingVolumeHierarchy::rebuild(const std::vector<SPtr<GameObject>> &gameObjects) {
+   nodes.clear();
+   objects.clear();
+   objectBounds.clear();
+   unboundedObjects.clear();
+   sourceObjects.clear();
+   numRefits = 0;
+
+   std::vector<GameObject*> boundedObjects;
+   std::vector<Bounds> boundedObjectBounds;
+   std::vector<glm::vec3> centroids;
+   for (const SPtr<GameObject> &gameObject : gameObjects) {
+      sourceObjects.push_back(gameObject.get());
+
+      const folly::Optional<AABB> &aabb = gameObject->getPhysicsComponent().getRenderAABB();
+      if (!aabb) {
+         unboundedObjects.push_back(gameObject.get());
+         continue;
+      }
+
+      boundedObjects.push_back(gameObject.get());
+      boundedObjectBounds.push_back({ aabb->min, aabb->max });
+      centroids.push_back((aabb->min + aabb->max) * 0.5f);
+   }
+
+   if (boundedObjects.empty()) {
+      return;
+   }
+
+   // Build over indices, then put the objects in leaf order
+   objects = boundedObjects;
+   objectBounds = boundedObjectBounds;
+   std::vector<int> order(boundedObjects.size());
+   for (std::size_t i = 0; i < order.size(); ++i) {
+      order[i] = static_cast<int>(i);
+   }
+
+   buildNode(order, centroids, 0, static_cast<int>(order.size()));
+
+   for (std::size_t i = 0; i < order.size(); ++i) {
+      objects[i] = boundedObjects[order[i]];
+      objectBounds[i] = boundedObjectBounds[order[i]];
+   }
+
+   refitNodes();
+}
+
+int BoundingVolumeHierarchy::buildNode(std::vector<int> &order, const std::vector<glm::vec3> &centroids, int first, int count) {
+   int nodeIndex = static_cast<int>(nodes.size());
+   nodes.push_back(Node());
+   nodes[nodeIndex].first = first;
+   nodes[nodeIndex].numObjects = count;
+   nodes[nodeIndex].rightChild = -1;
+
+   if (count <= MAX_LEAF_OBJECTS) {
+      return nodeIndex;
+   }
+
+   // Split at the median centroid along the axis the centroids are most spread out on
+   glm::vec3 centroidMin(centroids[order[first]]);
+   glm::vec3 centroidMax(centroidMin);
+   for (int i = first + 1; i < first + count; ++i) {
+      centroidMin = glm::min(centroidMin, centroids[order[i]]);
+      centroidMax = glm::max(centroidMax, centroids[order[i]]);
+   }
+   glm::vec3 spread(centroidMax - centroidMin);
+   int axis = spread.x > spread.y ? (spread.x > spread.z ? 0 : 2) : (spread.y > spread.z ? 1 : 2);
+
+   int middle = first + count / 2;
+   std::nth_element(order.begin() + first, order.begin() + middle, order.begin() + first + count, [&centroids, axis](int a, int b) {
+      return centroids[a][axis] < centroids[b][axis];
+   });
+
+   buildNode(order, centroids, first, middle - first);
+   int rightChild = buildNode(order, centroids, middle, first + count - middle);
+   nodes[nodeIndex].rightChild = rightChild;
+
+   return nodeIndex;
+}
+
+void BoundingVolumeHierarchy::refit() {
+   for (std::size_t i = 0; i < objects.size(); ++i) {
+      // Objects that lose their bounds keep their last ones until the next rebuild
+      const folly::Optional<AABB> &aabb = objects[i]->getPhysicsComponent().getRenderAABB();
+      if (aabb) {
+         objectBounds[i].min = aabb->min;
+         objectBounds[i].max = aabb->max;
+      }
+   }
+
+   refitNodes();
+   ++numRefits;
+}
+
+void BoundingVolumeHierarchy::refitNodes() {
+   // Children always come after their parents, so going backwards visits children first
+   for (int i = static_cast<int>(nodes.size()) - 1; i >= 0; --i) {
+      Node &node = nodes[i];
+
+      Bounds bounds;
+      if (node.rightChild < 0) {
+         bounds = objectBounds[node.first];
+         for (int j = node.first + 1; j < node.first + node.numObjects; ++j) {
+            bounds.min = glm::min(bounds.min, objectBounds[j].min);
+            bounds.max = glm::max(bounds.max, objectBounds[j].max);
+         }
+      } else {
+         const Node &left = nodes[i + 1];
+         const Node &right = nodes[node.rightChild];
+         bounds.min = glm::min(left.center - left.extents, right.center - right.extents);
+         bounds.max = glm::max(left.center + left.extents, right.center + right.extents);
+      }
+
+      node.center = (bounds.min + bounds.max) * 0.5f;
+      node.extents = (bounds.max - bounds.min) * 0.5f;
+   }
+}
+
+void BoundingVolumeHierarchy::cull(const std::array<glm::vec4, 6> &planes, std::vector<GameObject*> &visible, CullStats &stats) const {
+   ++stats.numQueries;
+
+   visible.insert(visible.end(), unboundedObjects.begin(), unboundedObjects.end());
+   stats.numVisible += unboundedObjects.size();
+
+   if (nodes.empty()) {
+      return;
+   }
+
+   PlaneSet planeSet(planes);
+   std::size_t numVisibleBefore = visible.size();
+
+   int stack[MAX_STACK_SIZE];
+   int stackSize = 0;
+   stack[stackSize++] = 0;
+
+   while (stackSize > 0) {
+      const Node &node = nodes[stack[--stackSize]];
+      ++stats.numNodesVisited;
+
+      Containment containment = classify(planeSet, node.center, node.extents);
+      if (containment == Containment::Outside) {
+         continue;
+      }
+
+      if (containment == Containment::Inside) {
+         visible.insert(visible.end(), objects.begin() + node.first, objects.begin() + node.first + node.numObjects);
+         continue;
+      }
+
+      if (node.rightChild >= 0) {
+         ASSERT(stackSize + 2 <= MAX_STACK_SIZE, "Bounding volume hierarchy is too deep");
+         stack[stackSize++] = node.rightChild;
+         stack[stackSize++] = static_cast<int>(&node - &nodes[0]) + 1;
+         continue;
+      }
+
+      for (int i = node.first; i < node.first + node.numObjects; ++i) {
+         const Bounds &bounds = objectBounds[i];
+         if (classify(planeSet, (bounds.min + bounds.max) * 0.5f, (bounds.max - bounds.min) * 0.5f) != Containment::Outside) {
+            visible.push_back(objects[i]);
+         }
+      }
+   }
+
+   long numVisibleObjects = static_cast<long>(visible.size() - numVisibleBefore);
+   stats.numVisible += numVisibleObjects;
+   stats.numCulled += static_cast<long>(objects.size()) - numVisibleObjects;
+}
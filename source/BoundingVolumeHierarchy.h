@@ -0,0 +1,106 @@
+#ifndef BOUNDING_VOLUME_HIERARCHY_H
+#define BOUNDING_VOLUME_HIERARCHY_H
+
+#include "Types.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <vector>
+
+class GameObject;
+
+/**
+ * Culling work, accumulated over any number of queries
+ */
+struct CullStats {
+   long numQueries;
+   long numNodesVisited;
+   long numVisible;
+   long numCulled;
+   double time; // Seconds
+
+   CullStats()
+      : numQueries(0), numNodesVisited(0), numVisible(0), numCulled(0), time(0.0) {
+   }
+
+   void add(const CullStats &other) {
+      numQueries += other.numQueries;
+      numNodesVisited += other.numNodesVisited;
+      numVisible += other.numVisible;
+      numCulled += other.numCulled;
+      time += other.time;
+   }
+};
+
+/**
+ * Bounding volume hierarchy over the render bounding boxes of a set of objects, for frustum culling. Rebuilt when the
+ * set of objects changes (and every so often, since moving objects loosen the tree), otherwise refit to the objects'
+ * current bounds
+ */
+class BoundingVolumeHierarchy {
+protected:
+   struct Node {
+      glm::vec3 center;
+      glm::vec3 extents;
+
+      // Range of objects in the node's subtree (subtrees are contiguous, since objects are stored in leaf order)
+      int first;
+      int numObjects;
+
+      // Index of the right child, or -1 for leaves (the left child directly follows its parent)
+      int rightChild;
+   };
+
+   struct Bounds {
+      glm::vec3 min;
+      glm::vec3 max;
+   };
+
+   std::vector<Node> nodes;
+
+   // Bounded objects (in leaf order) and their bounds
+   std::vector<GameObject*> objects;
+   std::vector<Bounds> objectBounds;
+
+   // Objects without bounds, which are always visible
+   std::vector<GameObject*> unboundedObjects;
+
+   // The objects the tree was built from, in their original order (to detect changes)
+   std::vector<GameObject*> sourceObjects;
+
+   int numRefits;
+
+   void rebuild(const std::vector<SPtr<GameObject>> &gameObjects);
+
+   int buildNode(std::vector<int> &order, const std::vector<glm::vec3> &centroids, int first, int count);
+
+   /**
+    * Updates the objects' bounds, then the nodes' bounds
+    */
+   void refit();
+
+   void refitNodes();
+
+public:
+   BoundingVolumeHierarchy();
+
+   virtual ~BoundingVolumeHierarchy();
+
+   /**
+    * Updates the tree to the current render bounds of the given objects (call after snapshotting them)
+    */
+   void update(const std::vector<SPtr<GameObject>> &gameObjects);
+
+   /**
+    * Appends the objects that may be inside the frustum with the given (normalized, inward facing) planes to the given
+    * vector. Subtrees entirely inside the frustum are accepted without testing their objects
+    */
+   void cull(const std::array<glm::vec4, 6> &planes, std::vector<GameObject*> &visible, CullStats &stats) const;
+
+   int getNumNodes() const {
+      return static_cast<int>(nodes.size());
+   }
+};
+
+#endif
@@ -3,12 +3,10 @@
 
 #include "PhysicsComponent.h"
 
-class btTriangleIndexVertexArray;
-
+/**
+ * Static triangle mesh, sharing the mesh's BVH with every other instance of it
+ */
 class BvhMeshPhysicsComponent : public PhysicsComponent {
-protected:
-   UPtr<btTriangleIndexVertexArray> triangles;
-
 public:
    BvhMeshPhysicsComponent(GameObject &gameObject, const CollisionGroup::Group collisionGroup, const short collisionMask);
 
@@ -6,12 +6,30 @@
 #include <glm/glm.hpp>
 
 class CameraComponent : public Component {
+protected:
+   // View matrix and camera position as of the last snapshot
+   glm::mat4 renderViewMatrix;
+   glm::vec3 renderCameraPosition;
+
 public:
    CameraComponent(GameObject &gameObject)
-      : Component(gameObject) {}
+      : Component(gameObject), renderCameraPosition(0.0f) {}
 
    virtual ~CameraComponent() {}
 
+   virtual void snapshot() {
+      renderViewMatrix = getViewMatrix();
+      renderCameraPosition = getCameraPosition();
+   }
+
+   const glm::mat4& getRenderViewMatrix() const {
+      return renderViewMatrix;
+   }
+
+   const glm::vec3& getRenderCameraPosition() const {
+      return renderCameraPosition;
+   }
+
    virtual glm::vec3 getFrontVector() const = 0;
 
    virtual glm::vec3 getRightVector() const = 0;
@@ -14,6 +14,11 @@ public:
       : gameObject(gameObject) {}
 
    virtual ~Component() {}
+
+   /**
+    * Copies any state read while rendering into the component's render state (called between ticks)
+    */
+   virtual void snapshot() {}
 };
 
 #endif
@@ -1,8 +1,11 @@
 #include "AssetManager.h"
 #include "AudioManager.h"
 #include "Context.h"
+#include "DrawStateCache.h"
 #include "FancyAssert.h"
 #include "InputHandler.h"
+#include "LogHelper.h"
+#include "Profiler.h"
 #include "Renderer.h"
 #include "Scene.h"
 #include "SceneLoader.h"
@@ -10,14 +13,29 @@
 
 #include <boxer/boxer.h>
 
+#include <chrono>
+
+namespace {
+
+typedef std::chrono::high_resolution_clock Clock;
+
+// How long to wait for upload requests at a time while waiting for a level to finish loading
+const std::chrono::milliseconds UPLOAD_WAIT_TIME(1);
+
+double secondsSince(Clock::time_point start) {
+   return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+} // namespace
+
 // Static members
 
 UPtr<Context> Context::instance;
 
-void Context::load(GLFWwindow *const window) {
+void Context::load(GLFWwindow *const window, const LaunchOptions &launchOptions) {
    ASSERT(!instance, "Trying to reload existing Context");
    if (!instance) {
-      instance = std::move(UPtr<Context>(new Context(window)));
+      instance = std::move(UPtr<Context>(new Context(window, launchOptions)));
       instance->init();
    }
 }
@@ -29,16 +47,42 @@ Context& Context::getInstance() {
 
 // Normal class members
 
-Context::Context(GLFWwindow* const window)
-   : window(window), assetManager(new AssetManager), audioManager(new AudioManager), inputHandler(new InputHandler(window)), renderer(new Renderer), textureUnitManager(new TextureUnitManager), state(ContextState::INIT), musicChangeInitiated(false), runningTime(0.0f), activeShaderProgramID(0), menuAfterCurrentScene(false), quitAfterCurrentScene(false) {
+Context::Context(GLFWwindow* const window, const LaunchOptions &launchOptions)
+   : window(window), headless(window == nullptr), launchOptions(launchOptions), assetManager(new AssetManager(headless)), audioManager(new AudioManager), drawStateCache(new DrawStateCache), inputHandler(new InputHandler(window)), renderer(headless ? nullptr : new Renderer), textureUnitManager(headless ? nullptr : new TextureUnitManager), state(ContextState::INIT), musicChangeInitiated(false), runningTime(0.0f), activeShaderProgramID(0), menuAfterCurrentScene(false), quitAfterCurrentScene(false), skipMenus(headless), sceneTicked(false), nextLevelLoadTime(0.0) {
 }
 
 Context::~Context() {
 }
 
 void Context::init() {
-   audioManager->init();
-   textureUnitManager->init();
+   if (launchOptions.assetMemoryBudget > 0) {
+      assetManager->setMemoryBudget(launchOptions.assetMemoryBudget);
+   }
+
+   if (!launchOptions.profileFileName.empty()) {
+#ifdef ENABLE_PROFILER
+      Profiler::setEnabled(true);
+#else
+      LOG_WARNING("Built without ENABLE_PROFILER, no profile will be written");
+#endif
+   }
+
+   // When headless, the audio manager is left uninitialized (so it never creates an FMOD system)
+   if (!headless) {
+      audioManager->init();
+      textureUnitManager->init();
+   }
+
+   // Replaying changes the number of input devices, so it has to start before players are created
+   if (!launchOptions.replayFileName.empty()) {
+      folly::Optional<unsigned int> seed = inputHandler->startReplay(launchOptions.replayFileName);
+      if (seed) {
+         SceneLoader::setSeed(*seed);
+         skipMenus = true;
+      } else {
+         LOG_WARNING("Unable to replay input from " << launchOptions.replayFileName);
+      }
+   }
 
    // TODO Decouple player number from device number
    int numDevices = inputHandler->getNumDevices();
@@ -48,10 +92,17 @@ void Context::init() {
 
       session.players.push_back(player);
    }
+
+   if (!launchOptions.recordFileName.empty()) {
+      inputHandler->startRecording(launchOptions.recordFileName, SceneLoader::getSeed());
+      skipMenus = true;
+   }
 }
 
 void Context::quit() const {
-   glfwSetWindowShouldClose(window, true);
+   if (window) {
+      glfwSetWindowShouldClose(window, true);
+   }
 }
 
 void Context::quitAfterScene() {
@@ -68,7 +119,7 @@ void Context::handleSpecialInputs(const InputValues &inputValues) const {
 
    RUN_DEBUG(
    static bool actionHeld = false;
-   if (inputValues.action) {
+   if (inputValues.action && renderer) {
       if (!actionHeld) {
          renderer->enableDebugRendering(!renderer->debugRenderingEnabled());
       }
@@ -82,6 +133,7 @@ void Context::handleSpecialInputs(const InputValues &inputValues) const {
 
 void Context::setScene(SPtr<Scene> scene) {
    session.currentLevelEnded = false;
+   sceneTicked = false;
    this->scene = scene;
 }
 
@@ -95,27 +147,81 @@ void Context::updateSession() {
    }
 }
 
+void Context::resetScores() {
+   for (Player &player : session.players) {
+      player.score = 0;
+   }
+}
+
+void Context::prefetchNextLevel() {
+   if (nextLevel.valid()) {
+      return;
+   }
+
+   nextLevel = std::async(std::launch::async, [this]() {
+      PROFILE_ZONE("Context::prefetchNextLevel");
+      Clock::time_point start = Clock::now();
+
+      SPtr<Scene> level = SceneLoader::loadNextLevel(*this);
+
+      // Read by the main thread only after the future is ready
+      nextLevelLoadTime = secondsSince(start);
+      return level;
+   });
+}
+
+SPtr<Scene> Context::takeNextLevel(SceneLoadStats &loadStats) {
+   prefetchNextLevel();
+
+   loadStats.prefetched = nextLevel.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+   if (!loadStats.prefetched) {
+      PROFILE_ZONE("Context::waitForNextLevel");
+
+      // The loader can't finish without its GL work, which has to be done here
+      while (nextLevel.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+         assetManager->waitAndProcessUploads(UPLOAD_WAIT_TIME);
+      }
+   }
+
+   SPtr<Scene> level = nextLevel.get();
+   loadStats.loadTime = nextLevelLoadTime;
+
+   return level;
+}
+
 void Context::checkForSceneChange() {
    if (scene && scene->getTimeSinceEnd() < TIME_TO_NEXT_LEVEL) {
       return;
    }
 
+   PROFILE_ZONE("Context::checkForSceneChange");
+
    ContextState nextState = determineNextState();
 
+   if (skipMenus && (nextState == ContextState::MENU || nextState == ContextState::WIN)) {
+      // The menu and win scenes depend on the mouse and rendered text (neither of which are available when headless or
+      // part of input recordings), so just keep cycling through levels
+      if (nextState == ContextState::WIN) {
+         resetScores();
+      }
+
+      nextState = ContextState::GAMEPLAY;
+   }
+
+   Clock::time_point changeStart = Clock::now();
+   SceneLoadStats loadStats;
+
    switch (nextState) {
       case ContextState::MENU:
          setScene(SceneLoader::loadMenuScene(*this));
          menuAfterCurrentScene = false;
          break;
       case ContextState::GAMEPLAY:
-         setScene(SceneLoader::loadNextLevel(*this));
+         setScene(takeNextLevel(loadStats));
          break;
       case ContextState::WIN:
          setScene(SceneLoader::loadWinScene(*this));
-
-         for (Player &player : session.players) {
-            player.score = 0;
-         }
+         resetScores();
 
          menuAfterCurrentScene = true;
          break;
@@ -128,9 +234,39 @@ void Context::checkForSceneChange() {
 
    state = nextState;
    musicChangeInitiated = false;
+
+   if (nextState == ContextState::QUIT) {
+      return;
+   }
+
+   // Includes destroying the previous scene
+   loadStats.hitchTime = secondsSince(changeStart);
+   if (nextState != ContextState::GAMEPLAY) {
+      loadStats.loadTime = loadStats.hitchTime;
+   }
+   sceneLoadStats = loadStats;
+
+   LOG_INFO("Changed scene in " << (loadStats.hitchTime * 1000.0) << " ms (" << (loadStats.loadTime * 1000.0) << " ms loading" << (loadStats.prefetched ? " in the background)" : ")"));
+
+   PhysicsShapeStats shapeStats(assetManager->getPhysicsShapeStats());
+   LOG_INFO("Physics shapes: " << shapeStats.numBvhShapes << " BVHs (" << shapeStats.numBvhsLoaded << " read from disk, " << (shapeStats.bvhBytes / 1024) << " KB), " << shapeStats.numHullShapes << " hulls (" << (shapeStats.hullBytes / 1024) << " KB, simplified from " << shapeStats.numSourceHullVertices << " to " << shapeStats.numSimplifiedHullVertices << " points), " << shapeStats.numHits << "/" << shapeStats.numRequests << " requests shared, " << (shapeStats.buildTime * 1000.0) << " ms building");
+
+   TextureStats textureStats(assetManager->getTextureStats());
+   LOG_INFO("Textures: " << textureStats.numTextures << " textures and " << textureStats.numCubemaps << " cubemaps (" << textureStats.numImagesCached << " images read from cache, " << textureStats.numImagesDecoded << " decoded), " << (textureStats.gpuBytes / 1024) << " KB with mipmaps (" << (textureStats.uncompressedBytes / 1024) << " KB uncompressed without), " << (textureStats.loadTime * 1000.0) << " ms loading");
+
+   // The previous scene is gone, so whatever it alone used can go too (before the next level starts loading)
+   assetManager->evictUnusedAssets();
+   assetManager->logMemoryReport();
+
+   // Build the next level while this scene runs, so that switching to it doesn't stall
+   prefetchNextLevel();
 }
 
 void Context::checkForMusicChange() {
+   if (headless) {
+      return;
+   }
+
    if ((scene && scene->getTimeSinceEnd() < (TIME_TO_NEXT_LEVEL - MUSIC_FADE_TIME)) || musicChangeInitiated) {
       return;
    }
@@ -181,27 +317,56 @@ ContextState Context::determineNextState() {
    return ContextState::GAMEPLAY;
 }
 
-void Context::tick(const float dt) {
+void Context::beginFrame() {
+   PROFILE_ZONE("Context::beginFrame");
+
+   assetManager->processUploads();
    checkForMusicChange();
    checkForSceneChange();
 
+   inputHandler->sampleInput();
+
+   handleSpecialInputs(inputHandler->getKeyMouseInputValues());
+}
+
+void Context::tick(const float dt) {
+   PROFILE_ZONE("Context::tick");
+
    updateSession();
 
    inputHandler->pollInput();
 
-   handleSpecialInputs(inputHandler->getKeyMouseInputValues());
-
    scene->tick(dt);
 
    audioManager->update();
 
    runningTime += dt;
+   sceneTicked = true;
+}
+
+bool Context::canTickConcurrently() const {
+   return state == ContextState::GAMEPLAY && sceneTicked;
 }
 
 void Context::onWindowFocusGained() const {
    assetManager->reloadAssets();
 }
 
+void Context::onExit() {
+   inputHandler->stopRecording();
+
+   // Let any level being loaded finish, so that it (and its GL resources) can be released while there's still a context
+   if (nextLevel.valid()) {
+      SceneLoadStats loadStats;
+      takeNextLevel(loadStats);
+   }
+
+   if (Profiler::isEnabled()) {
+      Profiler::setEnabled(false);
+      Profiler::writeTrace(launchOptions.profileFileName);
+   }
+}
+
 AssetManager& Context::getAssetManager() const {
    return *assetManager;
 }
@@ -210,6 +375,10 @@ AudioManager& Context::getAudioManager() const {
    return *audioManager;
 }
 
+DrawStateCache& Context::getDrawStateCache() const {
+   return *drawStateCache;
+}
+
 InputHandler& Context::getInputHandler() const {
    return *inputHandler;
 }
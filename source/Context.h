@@ -3,10 +3,14 @@
 
 #include "Types.h"
 
+#include <cstddef>
+#include <future>
+#include <string>
 #include <vector>
 
 class AssetManager;
 class AudioManager;
+class DrawStateCache;
 class InputHandler;
 class Renderer;
 class Scene;
@@ -39,6 +43,39 @@ struct GameSession {
    }
 };
 
+struct LaunchOptions {
+   // If not empty, all input is recorded to this file
+   std::string recordFileName;
+
+   // If not empty, all input is replayed from this file instead of being read from devices
+   std::string replayFileName;
+
+   // If not empty, profiler zones are recorded and written to this file (as a Chrome trace) on exit
+   std::string profileFileName;
+
+   // If not 0, overrides the default memory budget of cached assets (in bytes)
+   std::size_t assetMemoryBudget;
+
+   LaunchOptions()
+      : assetMemoryBudget(0) {
+   }
+};
+
+struct SceneLoadStats {
+   // Seconds spent building the scene (on a background thread, for prefetched levels)
+   double loadTime;
+
+   // Seconds the main thread was blocked switching to the scene
+   double hitchTime;
+
+   // Whether the scene had finished loading in the background by the time it was needed
+   bool prefetched;
+
+   SceneLoadStats()
+      : loadTime(0.0), hitchTime(0.0), prefetched(false) {
+   }
+};
+
 enum class ContextState {
    INIT, MENU, GAMEPLAY, WIN, QUIT
 };
@@ -47,12 +84,15 @@ class Context {
 private:
    static UPtr<Context> instance;
 
-   Context(GLFWwindow* const window);
+   Context(GLFWwindow* const window, const LaunchOptions &launchOptions);
 
 protected:
    GLFWwindow* const window;
+   const bool headless;
+   const LaunchOptions launchOptions;
    const UPtr<AssetManager> assetManager;
    const UPtr<AudioManager> audioManager;
+   const UPtr<DrawStateCache> drawStateCache;
    const UPtr<InputHandler> inputHandler;
    const UPtr<Renderer> renderer;
    const UPtr<TextureUnitManager> textureUnitManager;
@@ -64,6 +104,11 @@ protected:
    unsigned int activeShaderProgramID;
    bool menuAfterCurrentScene;
    bool quitAfterCurrentScene;
+   bool skipMenus;
+   bool sceneTicked;
+   std::future<SPtr<Scene>> nextLevel;
+   double nextLevelLoadTime;
+   SceneLoadStats sceneLoadStats;
 
    void handleSpecialInputs(const InputValues &inputValues) const;
 
@@ -71,6 +116,18 @@ protected:
 
    void updateSession();
 
+   void resetScores();
+
+   /**
+    * Starts building the next level on a background thread, if it isn't already being built
+    */
+   void prefetchNextLevel();
+
+   /**
+    * Gets the next level, waiting for it to finish loading if necessary
+    */
+   SPtr<Scene> takeNextLevel(SceneLoadStats &loadStats);
+
    void checkForSceneChange();
 
    void checkForMusicChange();
@@ -78,7 +135,10 @@ protected:
    ContextState determineNextState();
 
 public:
-   static void load(GLFWwindow* const window);
+   /**
+    * Loads the context. If the window is null, runs headless (no rendering, audio, or window input)
+    */
+   static void load(GLFWwindow* const window, const LaunchOptions &launchOptions = LaunchOptions());
    static Context& getInstance();
 
    virtual ~Context();
@@ -89,12 +149,34 @@ public:
 
    void quitAfterScene();
 
+   /**
+    * Handles everything that has to happen on the main thread between ticks (scene / music changes and reading window
+    * input). Must be called at least once per frame, while no ticks are running
+    */
+   void beginFrame();
+
    void tick(const float dt);
 
+   /**
+    * Returns whether ticks can currently run on another thread while the last snapshot is rendered. Only gameplay
+    * scenes qualify (menus render text to textures from their callbacks), and only after their first tick
+    */
+   bool canTickConcurrently() const;
+
    void onWindowFocusGained() const;
 
+   /**
+    * Called once the main loop has finished, before the context is destroyed
+    */
+   void onExit();
+
+   bool isHeadless() const {
+      return headless;
+   }
+
    AssetManager& getAssetManager() const;
    AudioManager& getAudioManager() const;
+   DrawStateCache& getDrawStateCache() const;
    InputHandler& getInputHandler() const;
    Renderer& getRenderer() const;
    Scene& getScene() const;
@@ -120,6 +202,13 @@ public:
       return session;
    }
 
+   /**
+    * Gets the load time and hitch duration of the most recent scene change
+    */
+   const SceneLoadStats& getSceneLoadStats() const {
+      return sceneLoadStats;
+   }
+
    void changeScoreCap();
 };
 
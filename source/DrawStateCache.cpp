@@ -0,0 +1,114 @@
+#include "Context.h"
+#include "DrawStateCache.h"
+#include "ShaderProgram.h"
+#include "Texture.h"
+
+namespace {
+
+// Marks state that hasn't been set since tracking began
+const GLuint UNKNOWN = static_cast<GLuint>(-1);
+
+} // namespace
+
+DrawStateCache::DrawStateCache()
+   : tracking(false), vertexArray(UNKNOWN), activeTextureUnit(UNKNOWN) {
+}
+
+DrawStateCache::~DrawStateCache() {
+}
+
+void DrawStateCache::begin() {
+   tracking = true;
+   vertexArray = UNKNOWN;
+   activeTextureUnit = UNKNOWN;
+   boundTextures.assign(boundTextures.size(), UNKNOWN);
+}
+
+void DrawStateCache::end() {
+   if (tracking && vertexArray != 0) {
+      glBindVertexArray(0);
+   }
+
+   tracking = false;
+}
+
+void DrawStateCache::bindVertexArray(GLuint vertexArray) {
+   if (!tracking) {
+      glBindVertexArray(vertexArray);
+      return;
+   }
+
+   if (vertexArray == this->vertexArray) {
+      ++stats.numRedundantCalls;
+      return;
+   }
+
+   glBindVertexArray(vertexArray);
+   this->vertexArray = vertexArray;
+   ++stats.numVertexArrayBinds;
+}
+
+void DrawStateCache::unbindVertexArray() {
+   if (tracking) {
+      ++stats.numRedundantCalls;
+      return;
+   }
+
+   glBindVertexArray(0);
+}
+
+void DrawStateCache::bindTexture(GLenum textureUnit, Texture &texture) {
+   if (!tracking) {
+      glActiveTexture(GL_TEXTURE0 + textureUnit);
+      texture.bind();
+      return;
+   }
+
+   if (textureUnit >= boundTextures.size()) {
+      boundTextures.resize(textureUnit + 1, UNKNOWN);
+   }
+
+   // Selecting the unit is only needed to bind to it
+   if (boundTextures[textureUnit] == texture.id()) {
+      stats.numRedundantCalls += 2;
+      return;
+   }
+
+   if (activeTextureUnit != textureUnit) {
+      glActiveTexture(GL_TEXTURE0 + textureUnit);
+      activeTextureUnit = textureUnit;
+   } else {
+      ++stats.numRedundantCalls;
+   }
+
+   texture.bind();
+   boundTextures[textureUnit] = texture.id();
+   ++stats.numTextureBinds;
+}
+
+void DrawStateCache::useProgram(ShaderProgram &program) {
+   if (tracking) {
+      // The program itself skips switching to the active program, but the skipped call is still worth counting
+      if (program.getID() == Context::getInstance().getActiveShaderProgramID()) {
+         ++stats.numRedundantCalls;
+      } else {
+         ++stats.numProgramChanges;
+      }
+   }
+
+   program.commit();
+}
+
+void DrawStateCache::countDraw() {
+   if (tracking) {
+      ++stats.numDraws;
+   }
+}
+
+void DrawStateCache::countInstancedDraw(long numInstances) {
+   if (tracking) {
+      ++stats.numDraws;
+      ++stats.numInstancedDraws;
+      stats.numInstances += numInstances;
+   }
+}
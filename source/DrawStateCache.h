@@ -0,0 +1,107 @@
+#ifndef DRAW_STATE_CACHE_H
+#define DRAW_STATE_CACHE_H
+
+#include "GLIncludes.h"
+
+#include <vector>
+
+class ShaderProgram;
+class Texture;
+
+/**
+ * State changes made by tracked draws, accumulated over any number of frames
+ */
+struct DrawStats {
+   long numDraws;
+
+   /**
+    * Draws of several instances at once (included in numDraws), and the objects they drew
+    */
+   long numInstancedDraws;
+   long numInstances;
+
+   long numProgramChanges;
+   long numVertexArrayBinds;
+   long numTextureBinds;
+
+   /**
+    * GL calls that weren't made because the state they would have set was already current
+    */
+   long numRedundantCalls;
+
+   DrawStats()
+      : numDraws(0), numInstancedDraws(0), numInstances(0), numProgramChanges(0), numVertexArrayBinds(0), numTextureBinds(0), numRedundantCalls(0) {
+   }
+
+   void add(const DrawStats &other) {
+      numDraws += other.numDraws;
+      numInstancedDraws += other.numInstancedDraws;
+      numInstances += other.numInstances;
+      numProgramChanges += other.numProgramChanges;
+      numVertexArrayBinds += other.numVertexArrayBinds;
+      numTextureBinds += other.numTextureBinds;
+      numRedundantCalls += other.numRedundantCalls;
+   }
+};
+
+/**
+ * Remembers the vertex array and textures bound by the draws between begin() and end(), so that consecutive draws
+ * sharing state (e.g. from a sorted render queue) skip binding it again. Outside of begin() / end(), every call goes
+ * straight to GL, since other renderers bind state without going through the cache
+ */
+class DrawStateCache {
+protected:
+   bool tracking;
+   GLuint vertexArray;
+   GLenum activeTextureUnit;
+
+   /**
+    * Texture bound to each unit (0 when unknown)
+    */
+   std::vector<GLuint> boundTextures;
+
+   DrawStats stats;
+
+public:
+   DrawStateCache();
+
+   virtual ~DrawStateCache();
+
+   /**
+    * Starts tracking state, assuming nothing about what is currently bound
+    */
+   void begin();
+
+   /**
+    * Stops tracking state, unbinding the vertex array left bound by the last draw
+    */
+   void end();
+
+   void bindVertexArray(GLuint vertexArray);
+
+   /**
+    * Unbinds the current vertex array, unless tracking (when the next draw will most likely bind its own anyway)
+    */
+   void unbindVertexArray();
+
+   void bindTexture(GLenum textureUnit, Texture &texture);
+
+   /**
+    * Makes the given program active and commits its uniforms
+    */
+   void useProgram(ShaderProgram &program);
+
+   void countDraw();
+
+   void countInstancedDraw(long numInstances);
+
+   const DrawStats& getStats() const {
+      return stats;
+   }
+
+   void resetStats() {
+      stats = DrawStats();
+   }
+};
+
+#endif
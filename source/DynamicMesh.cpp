@@ -3,6 +3,7 @@
 DynamicMesh::DynamicMesh()
    : Mesh(nullptr, 0, nullptr, 0, nullptr, 0, nullptr, 0, GL_DYNAMIC_DRAW) {
    hasTextureBufferObject = true;
+   upload();
 }
 
 DynamicMesh::~DynamicMesh() {
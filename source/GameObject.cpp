@@ -6,14 +6,19 @@
 #include "LightComponent.h"
 #include "LogicComponent.h"
 #include "PhysicsComponent.h"
+#include "Scene.h"
+
+long GameObject::numMatrixRecomputes = 0;
 
 GameObject::GameObject()
-   : cameraComponent(std::make_shared<NullCameraComponent>(*this)),
+   : transformDirty(true), renderModelMatrixDirty(true), renderNormalMatrixDirty(true),
+     cameraComponent(std::make_shared<NullCameraComponent>(*this)),
      graphicsComponent(std::make_shared<NullGraphicsComponent>(*this)),
      inputComponent(std::make_shared<NullInputComponent>(*this)),
      lightComponent(std::make_shared<LightComponent>(*this)),
      logicComponent(std::make_shared<NullLogicComponent>(*this)),
-     physicsComponent(std::make_shared<NullPhysicsComponent>(*this)) {
+     physicsComponent(std::make_shared<NullPhysicsComponent>(*this)),
+     inputActive(false), logicActive(false) {
 }
 
 GameObject::~GameObject() {
@@ -23,11 +28,72 @@ void GameObject::tick(const float dt) {
    inputComponent->update();
    logicComponent->tick(dt);
 
-   if (tickCallback) {
-      tickCallback(*this, dt);
+   runTickCallback(dt);
+}
+
+void GameObject::onTickStateChange(SPtr<void> replacedComponent) {
+   SPtr<Scene> scene = wScene.lock();
+   if (scene) {
+      scene->onTickStateChange(replacedComponent);
+   }
+}
+
+void GameObject::snapshot() {
+   if (transformDirty) {
+      renderTransform = transform;
+      transformDirty = false;
+
+      renderModelMatrixDirty = true;
+      renderNormalMatrixDirty = true;
+   }
+
+   // Audio and input are only used while ticking
+   cameraComponent->snapshot();
+   graphicsComponent->snapshot();
+   lightComponent->snapshot();
+   logicComponent->snapshot();
+   physicsComponent->snapshot();
+}
+
+const glm::mat4& GameObject::getRenderModelMatrix() const {
+   if (renderModelMatrixDirty) {
+      renderModelMatrix = renderTransform.toMatrix();
+      renderModelMatrixDirty = false;
+      ++numMatrixRecomputes;
+   }
+
+   return renderModelMatrix;
+}
+
+const glm::mat4& GameObject::getRenderNormalMatrix() const {
+   if (renderNormalMatrixDirty) {
+      renderNormalMatrix = glm::transpose(glm::inverse(getRenderModelMatrix()));
+      renderNormalMatrixDirty = false;
+      ++numMatrixRecomputes;
+   }
+
+   return renderNormalMatrix;
+}
+
+long GameObject::resetNumMatrixRecomputes() {
+   long count = numMatrixRecomputes;
+   numMatrixRecomputes = 0;
+   return count;
+}
+
+void GameObject::setTickCallback(std::function<void(GameObject&, const float dt)> tickCallback) {
+   bool hadTickCallback = hasTickCallback();
+   this->tickCallback = tickCallback;
+
+   if (hasTickCallback() != hadTickCallback) {
+      onTickStateChange();
    }
 }
 
+void GameObject::clearTickCallback() {
+   setTickCallback(nullptr);
+}
+
 void GameObject::setScene(WPtr<Scene> scene) {
    wScene = scene;
 
@@ -66,7 +132,10 @@ InputComponent& GameObject::getInputComponent() const {
 }
 
 void GameObject::setInputComponent(SPtr<InputComponent> inputComponent) {
+   SPtr<InputComponent> replacedComponent(this->inputComponent);
    this->inputComponent = inputComponent;
+   inputActive = !dynamic_cast<NullInputComponent*>(inputComponent.get());
+   onTickStateChange(replacedComponent);
 }
 
 LightComponent& GameObject::getLightComponent() const {
@@ -82,7 +151,10 @@ LogicComponent& GameObject::getLogicComponent() const {
 }
 
 void GameObject::setLogicComponent(SPtr<LogicComponent> logicComponent) {
+   SPtr<LogicComponent> replacedComponent(this->logicComponent);
    this->logicComponent = logicComponent;
+   logicActive = !dynamic_cast<NullLogicComponent*>(logicComponent.get());
+   onTickStateChange(replacedComponent);
 }
 
 PhysicsComponent& GameObject::getPhysicsComponent() const {
@@ -1,6 +1,7 @@
 #ifndef GAME_OBJECT_H
 #define GAME_OBJECT_H
 
+#include "SlotMap.h"
 #include "Subject.h"
 #include "Transform.h"
 #include "Types.h"
@@ -19,14 +20,43 @@ class LogicComponent;
 class PhysicsComponent;
 class Scene;
 
+/**
+ * The lists that a scene keeps objects in
+ */
+enum class SceneList : int {
+   Players,
+   Cameras,
+   Lights,
+   Objects,
+   Count
+};
+
 class GameObject : public Subject<GameObject> {
 protected:
    // Position and orientation
    Transform transform;
 
+   // Whether the transform has changed since the last snapshot
+   bool transformDirty;
+
+   // Position and orientation as of the last snapshot (read while rendering)
+   Transform renderTransform;
+
+   // Matrices of the render transform, computed the first time they're needed after it changes
+   mutable glm::mat4 renderModelMatrix;
+   mutable glm::mat4 renderNormalMatrix;
+   mutable bool renderModelMatrixDirty;
+   mutable bool renderNormalMatrixDirty;
+
+   // Number of render matrices computed since the last reset (only accessed on the main thread)
+   static long numMatrixRecomputes;
+
    // The scene that the object resides in
    WPtr<Scene> wScene;
 
+   // Handles to the object in each of its scene's lists (stale for lists the object isn't in)
+   SlotHandle sceneHandles[static_cast<int>(SceneList::Count)];
+
    // Components
    SPtr<AudioComponent> audioComponent;
    SPtr<CameraComponent> cameraComponent;
@@ -39,6 +69,16 @@ protected:
    // Tick callback
    std::function<void(GameObject&, const float dt)> tickCallback;
 
+   // Whether the input / logic components do anything when ticked (false for null components)
+   bool inputActive;
+   bool logicActive;
+
+   /**
+    * Lets the scene know that what the object runs each tick has changed (handing it the replaced component, if any, to
+    * keep alive until the end of the tick)
+    */
+   void onTickStateChange(SPtr<void> replacedComponent = nullptr);
+
 public:
    GameObject();
 
@@ -46,6 +86,33 @@ public:
 
    virtual void tick(const float dt);
 
+   /**
+    * Runs only the tick callback (the scene ticks input, logic, and callbacks in separate passes)
+    */
+   void runTickCallback(const float dt) {
+      if (tickCallback) {
+         tickCallback(*this, dt);
+      }
+   }
+
+   bool hasTickCallback() const {
+      return !!tickCallback;
+   }
+
+   bool hasActiveInput() const {
+      return inputActive;
+   }
+
+   bool hasActiveLogic() const {
+      return logicActive;
+   }
+
+   /**
+    * Copies the object's transform and component state into their render state, so that the object can keep ticking
+    * while a frame is rendered
+    */
+   void snapshot();
+
    const glm::vec3& getPosition() const {
       return transform.position;
    }
@@ -58,32 +125,65 @@ public:
       return transform.scale;
    }
 
+   const Transform& getRenderTransform() const {
+      return renderTransform;
+   }
+
+   /**
+    * The model matrix of the render transform (cached until the next snapshot that changes the transform)
+    */
+   const glm::mat4& getRenderModelMatrix() const;
+
+   /**
+    * The inverse transpose of the render model matrix (cached the same way)
+    */
+   const glm::mat4& getRenderNormalMatrix() const;
+
+   /**
+    * Records that render matrices were computed outside of the object (e.g. by components with their own matrices)
+    */
+   static void countMatrixRecomputes(int count) {
+      numMatrixRecomputes += count;
+   }
+
+   /**
+    * Returns the number of render matrices computed since the last reset, and resets it
+    */
+   static long resetNumMatrixRecomputes();
+
    void setScene(WPtr<Scene> scene);
 
+   const SlotHandle& getSceneHandle(SceneList list) const {
+      return sceneHandles[static_cast<int>(list)];
+   }
+
+   void setSceneHandle(SceneList list, const SlotHandle &handle) {
+      sceneHandles[static_cast<int>(list)] = handle;
+   }
+
    WPtr<Scene> getScene() const {
       return wScene;
    }
 
    void setPosition(const glm::vec3 &position) {
       transform.position = position;
+      transformDirty = true;
    }
 
    void setOrientation(const glm::quat &orientation) {
       transform.orientation = orientation;
+      transformDirty = true;
    }
 
    void setScale(const glm::vec3 &scale) {
       transform.scale = scale;
+      transformDirty = true;
       notify(*this, Event::SCALE);
    }
 
-   void setTickCallback(std::function<void(GameObject&, const float dt)> tickCallback) {
-      this->tickCallback = tickCallback;
-   }
+   void setTickCallback(std::function<void(GameObject&, const float dt)> tickCallback);
 
-   void clearTickCallback() {
-      tickCallback = nullptr;
-   }
+   void clearTickCallback();
 
    AudioComponent& getAudioComponent() const;
    CameraComponent& getCameraComponent() const;
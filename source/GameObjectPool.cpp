@@ -0,0 +1,95 @@
+#include "FancyAssert.h"
+#include "GameObject.h"
+#include "GameObjectPool.h"
+#include "LightComponent.h"
+#include "PhysicsComponent.h"
+#include "Scene.h"
+
+GameObjectPool::GameObjectPool(Scene &scene)
+   : scene(scene) {
+}
+
+GameObjectPool::~GameObjectPool() {
+}
+
+GameObjectPool::Entry& GameObjectPool::create(const PoolKey &key, const CreateFunction &createFunction) {
+   SPtr<GameObject> object(createFunction());
+   ASSERT(object, "Pool create function returned a null object");
+
+   // Free objects are kept in the physics world (just disabled), so that using them never adds a broadphase proxy
+   PhysicsComponent &physicsComponent = object->getPhysicsComponent();
+   physicsComponent.addToManager(scene.getPhysicsManager());
+   physicsComponent.setEnabled(false);
+
+   entries.push_back(Entry(key, object));
+   return entries.back();
+}
+
+void GameObjectPool::prewarm(const PoolKey &key, int count, const CreateFunction &createFunction) {
+   int numFree = 0;
+   for (const Entry &entry : entries) {
+      if (!entry.inUse && entry.key == key) {
+         ++numFree;
+      }
+   }
+
+   for (int i = numFree; i < count; ++i) {
+      create(key, createFunction);
+   }
+}
+
+SPtr<GameObject> GameObjectPool::acquire(const PoolKey &key, const CreateFunction &createFunction) {
+   for (Entry &entry : entries) {
+      if (!entry.inUse && entry.key == key) {
+         ++stats.hits;
+         entry.inUse = true;
+         return entry.object;
+      }
+   }
+
+   ++stats.misses;
+   Entry &entry = create(key, createFunction);
+   entry.inUse = true;
+   return entry.object;
+}
+
+void GameObjectPool::release(const GameObject &object) {
+   for (Entry &entry : entries) {
+      if (entry.object.get() == &object) {
+         ASSERT(entry.inUse, "Trying to release pooled object that isn't in use");
+
+         scene.removeObject(entry.object);
+         scene.removeLight(entry.object);
+         return;
+      }
+   }
+
+   ASSERT(false, "Trying to release object that doesn't belong to the pool");
+}
+
+void GameObjectPool::onRemoved(const GameObject &object) {
+   for (Entry &entry : entries) {
+      if (entry.object.get() == &object) {
+         entry.inUse = false;
+         return;
+      }
+   }
+}
+
+bool GameObjectPool::owns(const GameObject &object) const {
+   for (const Entry &entry : entries) {
+      if (entry.object.get() == &object) {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+void GameObjectPool::releaseShadowMaps() {
+   for (Entry &entry : entries) {
+      if (!entry.inUse) {
+         entry.object->getLightComponent().setShadowMap(nullptr);
+      }
+   }
+}
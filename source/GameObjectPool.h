@@ -0,0 +1,117 @@
+#ifndef GAME_OBJECT_POOL_H
+#define GAME_OBJECT_POOL_H
+
+#include "Types.h"
+
+#include <functional>
+#include <vector>
+
+class GameObject;
+class Scene;
+
+/**
+ * Identifies a kind of pooled object. Objects are only reused by the same owner (e.g. the ability that uses them), so
+ * owner-specific state (colors, collision callbacks) only has to be set up when an object is built
+ */
+struct PoolKey {
+   const void *owner;
+   int type;
+
+   PoolKey(const void *owner, int type)
+      : owner(owner), type(type) {
+   }
+
+   bool operator==(const PoolKey &other) const {
+      return owner == other.owner && type == other.type;
+   }
+};
+
+struct PoolStats {
+   // Objects handed out that had already been built
+   long hits;
+
+   // Objects that had to be built because none were free
+   long misses;
+
+   PoolStats()
+      : hits(0), misses(0) {
+   }
+
+   float hitRate() const {
+      long total = hits + misses;
+      return total > 0 ? (float)hits / total : 0.0f;
+   }
+};
+
+/**
+ * Recycles short-lived objects (projectiles, explosions, etc.) within a scene. Pooled objects keep their models,
+ * materials, lights, and collision objects between uses, and stay in the scene's physics world while they aren't in use
+ * (with collisions and simulation disabled), so using them neither allocates nor adds / removes broadphase proxies
+ */
+class GameObjectPool {
+public:
+   typedef std::function<SPtr<GameObject>()> CreateFunction;
+
+protected:
+   struct Entry {
+      PoolKey key;
+      SPtr<GameObject> object;
+      bool inUse;
+
+      Entry(const PoolKey &key, SPtr<GameObject> object)
+         : key(key), object(object), inUse(false) {
+      }
+   };
+
+   Scene &scene;
+   std::vector<Entry> entries;
+   PoolStats stats;
+
+   Entry& create(const PoolKey &key, const CreateFunction &createFunction);
+
+public:
+   GameObjectPool(Scene &scene);
+
+   virtual ~GameObjectPool();
+
+   /**
+    * Builds objects until there are at least the given number of free objects with the given key. Must not be called
+    * while the scene is ticking
+    */
+   void prewarm(const PoolKey &key, int count, const CreateFunction &createFunction);
+
+   /**
+    * Gets a free object with the given key (building one if there are none) and marks it as in use. The caller is
+    * responsible for setting it up and adding it to the scene
+    */
+   SPtr<GameObject> acquire(const PoolKey &key, const CreateFunction &createFunction);
+
+   /**
+    * Removes the given object from the scene. It only becomes free to be acquired again once the removal has been
+    * processed (removals made while the scene is ticking are deferred), so that a pending removal never hits an object
+    * that was handed out again in the meantime
+    */
+   void release(const GameObject &object);
+
+   /**
+    * Frees the given object to be acquired again. Called by the scene once the object has actually been removed
+    */
+   void onRemoved(const GameObject &object);
+
+   /**
+    * Returns whether the given object was built by the pool
+    */
+   bool owns(const GameObject &object) const;
+
+   /**
+    * Gives the shadow maps claimed by the lights of free objects back to the renderer. Must be called between ticks,
+    * while nothing is being rendered
+    */
+   void releaseShadowMaps();
+
+   const PoolStats& getStats() const {
+      return stats;
+   }
+};
+
+#endif
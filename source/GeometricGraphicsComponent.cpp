@@ -13,6 +13,13 @@
 
 #include <string>
 
+namespace {
+
+const UniformID MODEL_MATRIX_UNIFORM = ShaderProgram::getUniformID("uModelMatrix");
+const UniformID NORMAL_MATRIX_UNIFORM = ShaderProgram::getUniformID("uNormalMatrix");
+
+} // namespace
+
 GeometricGraphicsComponent::GeometricGraphicsComponent(GameObject &gameObject)
    : GraphicsComponent(gameObject), castShadows(true) {
 }
@@ -32,22 +39,28 @@ void GeometricGraphicsComponent::draw(const RenderData &renderData) {
    SPtr<ShaderProgram> overrideProgram = renderData.getOverrideProgram();
    SPtr<ShaderProgram> shaderProgram = overrideProgram ? overrideProgram : model->getShaderProgram();
 
-   if (shaderProgram->hasUniform("uModelMatrix")) {
-      const glm::mat4 &transMatrix = glm::translate(gameObject.getPosition());
-      const glm::mat4 &rotMatrix = glm::toMat4(gameObject.getOrientation());
-      const glm::mat4 &scaleMatrix = glm::scale(gameObject.getScale());
-      const glm::mat4 &modelMatrix = transMatrix * rotMatrix * scaleMatrix;
-      shaderProgram->setUniformValue("uModelMatrix", modelMatrix);
+   if (shaderProgram->hasUniform(MODEL_MATRIX_UNIFORM)) {
+      shaderProgram->setUniformValue(MODEL_MATRIX_UNIFORM, gameObject.getRenderModelMatrix());
 
-      if (shaderProgram->hasUniform("uNormalMatrix")) {
-         const glm::mat4 &normalMatrix = glm::transpose(glm::inverse(modelMatrix));
-         shaderProgram->setUniformValue("uNormalMatrix", normalMatrix);
+      if (shaderProgram->hasUniform(NORMAL_MATRIX_UNIFORM)) {
+         shaderProgram->setUniformValue(NORMAL_MATRIX_UNIFORM, gameObject.getRenderNormalMatrix());
       }
    }
 
    model->draw(renderData);
 }
 
+bool GeometricGraphicsComponent::getInstanceTransform(const RenderData &renderData, InstanceTransform &instance) const {
+   if (!model || (renderData.getRenderState() == RenderState::Shadow && !castShadows)) {
+      return false;
+   }
+
+   instance.modelMatrix = gameObject.getRenderModelMatrix();
+   instance.normalMatrix = gameObject.getRenderNormalMatrix();
+
+   return true;
+}
+
 void GeometricGraphicsComponent::enableCastingShadows(bool enabled) {
    castShadows = enabled;
 }
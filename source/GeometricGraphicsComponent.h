@@ -14,6 +14,8 @@ public:
 
    virtual void draw(const RenderData &renderData);
 
+   virtual bool getInstanceTransform(const RenderData &renderData, InstanceTransform &instance) const;
+
    void enableCastingShadows(bool enabled);
 };
 
@@ -6,6 +6,7 @@
 
 class Model;
 class RenderData;
+struct InstanceTransform;
 
 class GraphicsComponent : public Component {
 protected:
@@ -21,6 +22,14 @@ public:
 
    virtual void draw(const RenderData &renderData) = 0;
 
+   /**
+    * Gets the transforms to draw the model with as one instance of an instanced draw, returning false if the component
+    * has to be drawn on its own
+    */
+   virtual bool getInstanceTransform(const RenderData &renderData, InstanceTransform &instance) const {
+      return false;
+   }
+
    SPtr<Model> getModel() const {
       return model;
    }
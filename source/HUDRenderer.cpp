@@ -1,4 +1,3 @@
-#include "Ability.h"
 #include "AssetManager.h"
 #include "Context.h"
 #include "FancyAssert.h"
@@ -25,17 +24,18 @@ const float COOLDOWN_OPACITY = 0.5f;
 const glm::vec3 COOLDOWN_OCCURING_COLOR(1.0f);
 const glm::vec3 COOLDOWN_OVER_COLOR(0.2f, 1.0f, 0.2f);
 
-std::function<void(HUDElement &element, const PlayerLogicComponent &playerLogic)> getFillUpdateLogic(bool primary) {
-   return [primary](HUDElement &element, const PlayerLogicComponent &playerLogic) {
-      const Ability &ability = primary ? playerLogic.getPrimaryAbility() : playerLogic.getSecondaryAbility();
+const UniformID OPACITY_UNIFORM = ShaderProgram::getUniformID("uOpacity");
+const UniformID FILL_UNIFORM = ShaderProgram::getUniformID("uFill");
+const UniformID TINT_UNIFORM = ShaderProgram::getUniformID("uTint");
+const UniformID TRANSFORM_UNIFORM = ShaderProgram::getUniformID("uTransform");
 
-      float cooldownTime = ability.getCooldownTime();
-      float remainingCooldown = ability.getRemainingCooldownTime();
-      float cooldownPercent = cooldownTime == 0.0f ? 1.0f : 1.0f - remainingCooldown / cooldownTime;
+std::function<void(HUDElement &element, const PlayerRenderState &playerState)> getFillUpdateLogic(bool primary) {
+   return [primary](HUDElement &element, const PlayerRenderState &playerState) {
+      float cooldownPercent = primary ? playerState.primaryCooldownProgress : playerState.secondaryCooldownProgress;
 
       element.fill = glm::vec2(cooldownPercent, 1.0f);
       element.opacity = COOLDOWN_OPACITY * cooldownPercent;
-      element.tint = ability.isOnCooldown() ? COOLDOWN_OCCURING_COLOR : COOLDOWN_OVER_COLOR;
+      element.tint = cooldownPercent < 1.0f ? COOLDOWN_OCCURING_COLOR : COOLDOWN_OVER_COLOR;
    };
 }
 
@@ -48,9 +48,9 @@ HUDElement::HUDElement(SPtr<Texture> texture, glm::vec2 position, glm::vec2 scal
 HUDElement::~HUDElement() {
 }
 
-void HUDElement::update(const PlayerLogicComponent &playerLogic) {
+void HUDElement::update(const PlayerRenderState &playerState) {
    if (updateLogic) {
-      updateLogic(*this, playerLogic);
+      updateLogic(*this, playerState);
    }
 }
 
@@ -104,24 +104,24 @@ void HUDRenderer::attach(const HUDElement &element) {
    elements.push_back(element);
 }
 
-void HUDRenderer::render(const PlayerLogicComponent &playerLogic, int width, int height) {
+void HUDRenderer::render(const PlayerRenderState &playerState, int width, int height) {
    ASSERT(width > 0 && height > 0, "Width and height must be positive");
 
    for (HUDElement &element : elements) {
-      element.update(playerLogic);
+      element.update(playerState);
       textureMaterial->setTexture(element.texture);
 
       SPtr<ShaderProgram> shaderProgram(xyPlane->getShaderProgram());
-      shaderProgram->setUniformValue("uOpacity", element.opacity);
-      shaderProgram->setUniformValue("uFill", element.fill);
-      shaderProgram->setUniformValue("uTint", element.tint);
+      shaderProgram->setUniformValue(OPACITY_UNIFORM, element.opacity);
+      shaderProgram->setUniformValue(FILL_UNIFORM, element.fill);
+      shaderProgram->setUniformValue(TINT_UNIFORM, element.tint);
 
       glm::mat4 scale(glm::scale(glm::vec3(element.scale.x, element.scale.y, 1.0f) / 100.0f));
       glm::mat4 ratio(glm::scale(glm::vec3((float)height / width, 1.0f, 1.0f)));
       glm::mat4 translate(glm::translate(glm::vec3((element.position.x / 50.0f) - 1.0f, (element.position.y / 50.0f) - 1.0f, 0.0f)));
 
       glm::mat4 transform = translate * ratio * scale;
-      shaderProgram->setUniformValue("uTransform", transform);
+      shaderProgram->setUniformValue(TRANSFORM_UNIFORM, transform);
 
       RenderData renderData;
       xyPlane->draw(renderData);
@@ -11,7 +11,7 @@
 #include <vector>
 
 class Model;
-class PlayerLogicComponent;
+struct PlayerRenderState;
 class Texture;
 class TextureMaterial;
 class Uniform;
@@ -36,17 +36,17 @@ public:
    // Opacity of the texture
    float opacity;
 
-   std::function<void(HUDElement &element, const PlayerLogicComponent &playerLogic)> updateLogic;
+   std::function<void(HUDElement &element, const PlayerRenderState &playerState)> updateLogic;
 
    HUDElement(SPtr<Texture> texture, glm::vec2 position, glm::vec2 scale);
 
    virtual ~HUDElement();
 
-   void setUpdateLogic(std::function<void(HUDElement &element, const PlayerLogicComponent &playerLogic)> updateLogic) {
+   void setUpdateLogic(std::function<void(HUDElement &element, const PlayerRenderState &playerState)> updateLogic) {
       this->updateLogic = updateLogic;
    }
 
-   void update(const PlayerLogicComponent &playerLogic);
+   void update(const PlayerRenderState &playerState);
 };
 
 class HUDRenderer {
@@ -70,7 +70,7 @@ public:
 
    void attach(const HUDElement &element);
 
-   void render(const PlayerLogicComponent &playerLogic, int width, int height);
+   void render(const PlayerRenderState &playerState, int width, int height);
 };
 
 #endif
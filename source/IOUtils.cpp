@@ -1,11 +1,117 @@
+#include "AssetPack.h"
 #include "FancyAssert.h"
 #include "IOUtils.h"
+#include "LogHelper.h"
+#include "Lz4.h"
 #include "OSUtils.h"
 
+#include <atomic>
+#include <cstring>
 #include <fstream>
+#include <iterator>
+#include <vector>
 
 namespace IOUtils {
 
+namespace {
+
+// Only set while starting up, before any other threads read data files
+SPtr<AssetPack> dataPack;
+
+std::atomic<long> numPackLookups(0);
+std::atomic<long> numFileAccesses(0);
+
+const AssetPack::Entry* findPackEntry(const std::string &fileName) {
+   const AssetPack::Entry *entry = dataPack ? dataPack->find(fileName) : nullptr;
+   if (entry) {
+      ++numPackLookups;
+   } else {
+      ++numFileAccesses;
+   }
+
+   return entry;
+}
+
+folly::Optional<DataFile> readPackEntry(const std::string &fileName, const AssetPack::Entry &entry) {
+   DataFile dataFile;
+   dataFile.size = entry.size;
+
+   if (!entry.compressed) {
+      dataFile.storage = dataPack->getMappedFile();
+      dataFile.data = entry.data;
+      return dataFile;
+   }
+
+   SPtr<std::vector<char>> buffer(std::make_shared<std::vector<char>>(entry.size));
+   if (!Lz4::decompress(entry.data, entry.storedSize, buffer->data(), buffer->size())) {
+      LOG_WARNING("Unable to decompress packed file: " << fileName);
+      return folly::none;
+   }
+
+   dataFile.storage = buffer;
+   dataFile.data = buffer->data();
+   return dataFile;
+}
+
+} // namespace
+
+bool mountDataPack(const std::string &fileName) {
+   SPtr<AssetPack> pack(AssetPack::open(fileName));
+   if (!pack) {
+      return false;
+   }
+
+   LOG_DEBUG("Mounted asset pack " << fileName << " with " << pack->getNumEntries() << " files");
+   dataPack = pack;
+   return true;
+}
+
+bool isDataFilePacked(const std::string &fileName) {
+   return dataPack && dataPack->find(fileName);
+}
+
+folly::Optional<DataFile> readDataFile(const std::string &fileName) {
+   ASSERT(!fileName.empty(), "Trying to read from empty file name");
+
+   const AssetPack::Entry *entry = findPackEntry(fileName);
+   if (entry) {
+      return readPackEntry(fileName, *entry);
+   }
+
+   std::ifstream in(dataPath(fileName), std::ifstream::binary);
+   if (!in) {
+      return folly::none;
+   }
+
+   SPtr<std::vector<char>> buffer(std::make_shared<std::vector<char>>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>()));
+
+   DataFile dataFile;
+   dataFile.storage = buffer;
+   dataFile.data = buffer->data();
+   dataFile.size = buffer->size();
+   return dataFile;
+}
+
+folly::Optional<OSUtils::FileStatus> getDataFileStatus(const std::string &fileName) {
+   ASSERT(!fileName.empty(), "Trying to get status of empty file name");
+
+   const AssetPack::Entry *entry = findPackEntry(fileName);
+   if (entry) {
+      OSUtils::FileStatus status(dataPack->getStatus());
+      status.size = static_cast<int64_t>(entry->size);
+      return status;
+   }
+
+   return OSUtils::getFileStatus(dataPath(fileName));
+}
+
+DataFileStats getDataFileStats() {
+   DataFileStats stats;
+   stats.numPackLookups = numPackLookups;
+   stats.numFileAccesses = numFileAccesses;
+   return stats;
+}
+
 folly::Optional<std::string> appDataPath(const std::string &fileName) {
    folly::Optional<std::string> appDataFolder = OSUtils::getAppDataPath();
    if (!appDataFolder) {
@@ -22,7 +128,7 @@ bool canRead(const std::string &fileName) {
 
 bool canReadData(const std::string &fileName) {
    ASSERT(!fileName.empty(), "Trying to check empty file name");
-   return canRead(dataPath(fileName));
+   return findPackEntry(fileName) || canRead(dataPath(fileName));
 }
 
 folly::Optional<std::string> readFromFile(const std::string& fileName) {
@@ -65,11 +171,35 @@ UPtr<unsigned char[]> readFromBinaryFile(const std::string &fileName) {
 
 UPtr<unsigned char[]> readFromBinaryDataFile(const std::string &fileName) {
    ASSERT(!fileName.empty(), "Trying to read from empty file name");
+
+   const AssetPack::Entry *entry = findPackEntry(fileName);
+   if (entry) {
+      folly::Optional<DataFile> dataFile(readPackEntry(fileName, *entry));
+      if (!dataFile) {
+         return nullptr;
+      }
+
+      UPtr<unsigned char[]> data(new unsigned char[dataFile->size]);
+      memcpy(data.get(), dataFile->data, dataFile->size);
+      return std::move(data);
+   }
+
    return std::move(readFromBinaryFile(dataPath(fileName)));
 }
 
 folly::Optional<std::string> readFromDataFile(const std::string &fileName) {
    ASSERT(!fileName.empty(), "Trying to read from empty file name");
+
+   const AssetPack::Entry *entry = findPackEntry(fileName);
+   if (entry) {
+      folly::Optional<DataFile> dataFile(readPackEntry(fileName, *entry));
+      if (!dataFile) {
+         return folly::none;
+      }
+
+      return std::string(dataFile->data, dataFile->size);
+   }
+
    return readFromFile(dataPath(fileName));
 }
 
@@ -2,10 +2,12 @@
 #define IOUTILS_H
 
 #include "Constants.h"
+#include "OSUtils.h"
 #include "Types.h"
 
 #include <folly/Optional.h>
 
+#include <cstddef>
 #include <string>
 
 /**
@@ -20,6 +22,51 @@ inline std::string dataPath(const std::string &fileName) {
    return DATA_DIR "/" + fileName;
 }
 
+/**
+ * The contents of a data file, either pointing into the mounted asset pack or held in memory owned by the object
+ */
+struct DataFile {
+   /**
+    * Keeps the data alive
+    */
+   SPtr<const void> storage;
+   const char *data;
+   std::size_t size;
+};
+
+/**
+ * Counts of data file accesses, to compare loading from the asset pack against loading loose files
+ */
+struct DataFileStats {
+   long numPackLookups;
+   long numFileAccesses;
+};
+
+/**
+ * Maps the asset pack with the given name, so that data files are read from it instead of the data directory (files
+ * that aren't in the pack are still read from the directory). Returns true if the pack was mounted
+ */
+bool mountDataPack(const std::string &fileName);
+
+/**
+ * Determines if the data file with the given name is read from the mounted asset pack
+ */
+bool isDataFilePacked(const std::string &fileName);
+
+/**
+ * Reads the entire contents of the data file with the given name, without copying it if it is stored uncompressed in
+ * the mounted asset pack
+ */
+folly::Optional<DataFile> readDataFile(const std::string &fileName);
+
+/**
+ * Gets the status of the data file with the given name. Packed files report the status of the pack (as of when it was
+ * mounted) with their own size, since the pack can't change while it is mapped
+ */
+folly::Optional<OSUtils::FileStatus> getDataFileStatus(const std::string &fileName);
+
+DataFileStats getDataFileStats();
+
 /**
  * Gets the absolute path of a resource stored in the app data folder, given a relative path
  */
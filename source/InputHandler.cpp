@@ -4,7 +4,11 @@
 #include "GLIncludes.h"
 #include "InputComponent.h"
 #include "InputHandler.h"
+#include "InputRecording.h"
 #include "KeyMouseInputDevice.h"
+#include "LogHelper.h"
+#include "NullInputDevice.h"
+#include "Profiler.h"
 
 namespace {
 
@@ -13,7 +17,17 @@ const InputValues DEFAULT_INPUT_VALUES = { 0 };
 } // namespace
 
 InputHandler::InputHandler(GLFWwindow* const window)
-   : window(window) {
+   : window(window), sampleConsumed(false), keyMouseInputValues(DEFAULT_INPUT_VALUES), replayTick(0) {
+   if (!window) {
+      // Headless, so give every player slot a device that never sends input
+      for (int i = 0; i < MAX_PLAYERS; ++i) {
+         inputDevices.push_back(std::make_shared<NullInputDevice>());
+      }
+
+      resetValues();
+      return;
+   }
+
    // Add any attached controllers
    for (int controller = GLFW_JOYSTICK_1; controller <= GLFW_JOYSTICK_LAST && inputDevices.size() < MAX_PLAYERS; ++controller) {
       if (glfwJoystickPresent(controller)) {
@@ -31,21 +45,117 @@ InputHandler::InputHandler(GLFWwindow* const window)
       //glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
    }
    )
+
+   resetValues();
 }
 
 InputHandler::~InputHandler() {
 }
 
-void InputHandler::pollInput() {
+void InputHandler::resetValues() {
+   inputValues.assign(inputDevices.size(), DEFAULT_INPUT_VALUES);
+   sampledValues = inputValues;
+   sampleConsumed = false;
+}
+
+void InputHandler::sampleInput() {
+   PROFILE_ZONE("InputHandler::sampleInput");
+
    // TODO Handle controllers being attached / detached
    ASSERT(inputDevices.size() <= MAX_PLAYERS, "More input devices than max number of players");
 
-   inputValues.clear();
+   std::vector<InputValues> previousValues;
+   previousValues.swap(sampledValues);
+
    for (SPtr<InputDevice> inputDevice : inputDevices) {
-      inputValues.push_back(inputDevice->getInputValues());
+      sampledValues.push_back(inputDevice->getInputValues());
+   }
+
+   // Mouse movement is relative, so if no tick used the last sample, carry its movement over to this one
+   if (!sampleConsumed && previousValues.size() == sampledValues.size()) {
+      for (size_t i = 0; i < inputDevices.size(); ++i) {
+         if (inputDevices[i] == keyMouseInputDevice) {
+            sampledValues[i].lookX += previousValues[i].lookX;
+            sampledValues[i].lookY += previousValues[i].lookY;
+         }
+      }
+   }
+   sampleConsumed = false;
+
+   if (keyMouseInputDevice) {
+      keyMouseInputValues = keyMouseInputDevice->getInputValues();
+   }
+}
+
+void InputHandler::pollInput() {
+   PROFILE_ZONE("InputHandler::pollInput");
+
+   if (replay) {
+      inputValues.clear();
+      if (!replay->getTick(replayTick++, inputValues)) {
+         // Recording is over, so stop all input
+         inputValues.assign(inputDevices.size(), DEFAULT_INPUT_VALUES);
+      }
+   } else {
+      inputValues = sampledValues;
+
+      // Only the first tick after a sample gets the mouse movement (the same as if the mouse was read every tick)
+      if (sampleConsumed) {
+         for (size_t i = 0; i < inputDevices.size(); ++i) {
+            if (inputDevices[i] == keyMouseInputDevice) {
+               inputValues[i].lookX = inputValues[i].lookY = 0.0f;
+            }
+         }
+      }
+      sampleConsumed = true;
+   }
+
+   if (recording) {
+      recording->record(inputValues);
+   }
+}
+
+void InputHandler::startRecording(const std::string &fileName, unsigned int seed) {
+   ASSERT(!recording, "Already recording input");
+   ASSERT(!fileName.empty(), "Trying to record to empty file name");
+
+   recording = UPtr<InputRecording>(new InputRecording(seed, getNumDevices()));
+   recordingFileName = fileName;
+}
+
+void InputHandler::stopRecording() {
+   if (!recording) {
+      return;
+   }
+
+   if (recording->save(recordingFileName)) {
+      LOG_INFO("Saved " << recording->getNumTicks() << " ticks of input to " << recordingFileName);
+   } else {
+      LOG_WARNING("Unable to save input recording to " << recordingFileName);
+   }
+
+   recording = nullptr;
+}
+
+folly::Optional<unsigned int> InputHandler::startReplay(const std::string &fileName) {
+   UPtr<InputRecording> loadedReplay = InputRecording::load(fileName);
+   if (!loadedReplay) {
+      return folly::none;
    }
 
-   keyMouseInputValues = keyMouseInputDevice->getInputValues();
+   // Live devices are never polled during a replay, but the number of devices (and therefore players) has to match
+   inputDevices.clear();
+   for (int i = 0; i < loadedReplay->getNumDevices(); ++i) {
+      inputDevices.push_back(std::make_shared<NullInputDevice>());
+   }
+
+   LOG_INFO("Replaying " << loadedReplay->getNumTicks() << " ticks of input from " << fileName);
+
+   replay = std::move(loadedReplay);
+   replayTick = 0;
+   resetValues();
+
+   return replay->getSeed();
 }
 
 const InputValues& InputHandler::getInputValues(int device) const {
@@ -66,18 +176,34 @@ int InputHandler::getNumDevices() const {
 }
 
 double InputHandler::getMouseX() const {
+   if (!keyMouseInputDevice) {
+      return 0.0;
+   }
+
    return keyMouseInputDevice->getMouseX();
 }
 
 double InputHandler::getMouseY() const {
+   if (!keyMouseInputDevice) {
+      return 0.0;
+   }
+
    return keyMouseInputDevice->getMouseY();
 }
 
 bool InputHandler::isLeftMouseClicked() const {
+   if (!keyMouseInputDevice) {
+      return false;
+   }
+
    return keyMouseInputDevice->isLeftMouseClicked();
 }
 
 bool InputHandler::isRightMouseClicked() const {
+   if (!keyMouseInputDevice) {
+      return false;
+   }
+
    return keyMouseInputDevice->isRightMouseClicked();
 }
 
@@ -4,9 +4,13 @@
 #include "InputDevice.h"
 #include "Types.h"
 
+#include <folly/Optional.h>
+
+#include <string>
 #include <vector>
 
 class InputComponent;
+class InputRecording;
 class KeyMouseInputDevice;
 
 class InputHandler {
@@ -14,16 +18,52 @@ protected:
    GLFWwindow* const window;
    std::vector<SPtr<InputDevice>> inputDevices;
    std::vector<InputValues> inputValues;
+   std::vector<InputValues> sampledValues;
+   bool sampleConsumed;
    SPtr<KeyMouseInputDevice> keyMouseInputDevice;
    InputValues keyMouseInputValues;
+   UPtr<InputRecording> recording;
+   std::string recordingFileName;
+   UPtr<InputRecording> replay;
+   size_t replayTick;
+
+   void resetValues();
 
 public:
    InputHandler(GLFWwindow* const window);
 
    virtual ~InputHandler();
 
+   /**
+    * Reads the current values of all input devices. Devices query the window, so this has to be called on the main
+    * thread (while no ticks are running)
+    */
+   void sampleInput();
+
+   /**
+    * Updates the input values used by a tick, from the active replay or the last sample
+    */
    void pollInput();
 
+   /**
+    * Starts capturing the input values of every tick, to be written to the given file by stopRecording()
+    */
+   void startRecording(const std::string &fileName, unsigned int seed);
+
+   /**
+    * Writes out the active recording (if any)
+    */
+   void stopRecording();
+
+   /**
+    * Replaces all input devices with the recording in the given file, returning the recording's seed if it was loaded
+    */
+   folly::Optional<unsigned int> startReplay(const std::string &fileName);
+
+   bool isReplaying() const {
+      return !!replay;
+   }
+
    const InputValues& getInputValues(int device) const;
 
    const InputValues& getKeyMouseInputValues() const;
@@ -0,0 +1,171 @@
+#include "Constants.h"
+#include "FancyAssert.h"
+#include "InputRecording.h"
+#include "LogHelper.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+const char MAGIC[4] = { 'T', 'G', 'I', 'R' };
+const uint32_t VERSION = 1;
+
+// Buttons are packed into a single byte
+const uint8_t ACTION_BIT = 1 << 0;
+const uint8_t PRIMARY_ATTACK_BIT = 1 << 1;
+const uint8_t SECONDARY_ATTACK_BIT = 1 << 2;
+const uint8_t JUMP_BIT = 1 << 3;
+const uint8_t QUIT_BIT = 1 << 4;
+
+struct Header {
+   char magic[4];
+   uint32_t version;
+   uint32_t seed;
+   uint32_t numDevices;
+   uint32_t numTicks;
+};
+
+// Six axes followed by the button byte (no padding, to keep files compact)
+const size_t VALUE_SIZE = sizeof(float) * 6 + sizeof(uint8_t);
+
+void write(std::ofstream &out, const InputValues &inputValues) {
+   const float axes[6] = { inputValues.moveForward, inputValues.moveBackward, inputValues.moveLeft, inputValues.moveRight, inputValues.lookX, inputValues.lookY };
+
+   uint8_t buttons = 0;
+   buttons |= inputValues.action ? ACTION_BIT : 0;
+   buttons |= inputValues.primaryAttack ? PRIMARY_ATTACK_BIT : 0;
+   buttons |= inputValues.secondaryAttack ? SECONDARY_ATTACK_BIT : 0;
+   buttons |= inputValues.jump ? JUMP_BIT : 0;
+   buttons |= inputValues.quit ? QUIT_BIT : 0;
+
+   out.write(reinterpret_cast<const char*>(axes), sizeof(axes));
+   out.write(reinterpret_cast<const char*>(&buttons), sizeof(buttons));
+}
+
+InputValues read(const char *data) {
+   float axes[6];
+   memcpy(axes, data, sizeof(axes));
+   uint8_t buttons = static_cast<uint8_t>(data[sizeof(axes)]);
+
+   InputValues inputValues = { 0 };
+   inputValues.moveForward = axes[0];
+   inputValues.moveBackward = axes[1];
+   inputValues.moveLeft = axes[2];
+   inputValues.moveRight = axes[3];
+   inputValues.lookX = axes[4];
+   inputValues.lookY = axes[5];
+   inputValues.action = (buttons & ACTION_BIT) != 0;
+   inputValues.primaryAttack = (buttons & PRIMARY_ATTACK_BIT) != 0;
+   inputValues.secondaryAttack = (buttons & SECONDARY_ATTACK_BIT) != 0;
+   inputValues.jump = (buttons & JUMP_BIT) != 0;
+   inputValues.quit = (buttons & QUIT_BIT) != 0;
+
+   return inputValues;
+}
+
+} // namespace
+
+InputRecording::InputRecording(unsigned int seed, int numDevices)
+   : seed(seed), numDevices(numDevices) {
+   ASSERT(numDevices >= 0, "Invalid number of devices: %d", numDevices);
+}
+
+InputRecording::~InputRecording() {
+}
+
+UPtr<InputRecording> InputRecording::load(const std::string &fileName) {
+   ASSERT(!fileName.empty(), "Trying to load recording from empty file name");
+   std::ifstream in(fileName, std::ifstream::binary);
+   if (!in) {
+      LOG_WARNING("Unable to open input recording: " << fileName);
+      return nullptr;
+   }
+
+   Header header;
+   in.read(reinterpret_cast<char*>(&header), sizeof(header));
+   if (!in || memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+      LOG_WARNING("Invalid input recording: " << fileName);
+      return nullptr;
+   }
+
+   if (header.version != VERSION) {
+      LOG_WARNING("Input recording " << fileName << " has version " << header.version << ", expected " << VERSION);
+      return nullptr;
+   }
+
+   if (header.numDevices > static_cast<uint32_t>(MAX_PLAYERS)) {
+      LOG_WARNING("Input recording " << fileName << " has " << header.numDevices << " devices, expected at most " << MAX_PLAYERS);
+      return nullptr;
+   }
+
+   // Check the size against what's left of the file before allocating anything, so that a corrupt header can't
+   // request an arbitrarily large buffer
+   std::streamoff dataStart = in.tellg();
+   in.seekg(0, std::ifstream::end);
+   std::streamoff fileEnd = in.tellg();
+   in.seekg(dataStart);
+   uint64_t dataSize = static_cast<uint64_t>(header.numTicks) * header.numDevices * VALUE_SIZE;
+   if (!in || dataStart < 0 || fileEnd < dataStart || dataSize > static_cast<uint64_t>(fileEnd - dataStart)) {
+      LOG_WARNING("Input recording " << fileName << " is truncated");
+      return nullptr;
+   }
+
+   size_t numValues = static_cast<size_t>(header.numTicks) * header.numDevices;
+   std::vector<char> data(numValues * VALUE_SIZE);
+   in.read(data.data(), data.size());
+   if (!in) {
+      LOG_WARNING("Input recording " << fileName << " is truncated");
+      return nullptr;
+   }
+
+   UPtr<InputRecording> recording(new InputRecording(header.seed, header.numDevices));
+   recording->values.reserve(numValues);
+   for (size_t i = 0; i < numValues; ++i) {
+      recording->values.push_back(read(data.data() + i * VALUE_SIZE));
+   }
+
+   return recording;
+}
+
+bool InputRecording::save(const std::string &fileName) const {
+   ASSERT(!fileName.empty(), "Trying to save recording to empty file name");
+   std::ofstream out(fileName, std::ofstream::binary);
+   if (!out) {
+      return false;
+   }
+
+   Header header;
+   memcpy(header.magic, MAGIC, sizeof(MAGIC));
+   header.version = VERSION;
+   header.seed = seed;
+   header.numDevices = numDevices;
+   header.numTicks = static_cast<uint32_t>(getNumTicks());
+   out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+   for (const InputValues &inputValues : values) {
+      write(out, inputValues);
+   }
+
+   return !!out;
+}
+
+void InputRecording::record(const std::vector<InputValues> &tickValues) {
+   ASSERT(tickValues.size() == numDevices, "Recording %lu devices, expected %d", tickValues.size(), numDevices);
+   values.insert(values.end(), tickValues.begin(), tickValues.end());
+}
+
+bool InputRecording::getTick(size_t tick, std::vector<InputValues> &tickValues) const {
+   if (tick >= getNumTicks()) {
+      return false;
+   }
+
+   std::vector<InputValues>::const_iterator begin = values.begin() + tick * numDevices;
+   tickValues.assign(begin, begin + numDevices);
+   return true;
+}
+
+size_t InputRecording::getNumTicks() const {
+   return numDevices > 0 ? values.size() / numDevices : 0;
+}
@@ -0,0 +1,59 @@
+#ifndef INPUT_RECORDING_H
+#define INPUT_RECORDING_H
+
+#include "InputDevice.h"
+#include "Types.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Per-tick input values for every device, plus the level generation seed, so that a session can be replayed exactly
+ */
+class InputRecording {
+protected:
+   const unsigned int seed;
+   const int numDevices;
+
+   /**
+    * Input values for all devices, tick-major (tick 0 device 0, tick 0 device 1, ...)
+    */
+   std::vector<InputValues> values;
+
+public:
+   InputRecording(unsigned int seed, int numDevices);
+
+   virtual ~InputRecording();
+
+   /**
+    * Loads a recording from the binary file with the given name, returning null if it can't be read
+    */
+   static UPtr<InputRecording> load(const std::string &fileName);
+
+   /**
+    * Writes the recording to a binary file with the given name
+    */
+   bool save(const std::string &fileName) const;
+
+   /**
+    * Appends the input values for a single tick (one per device)
+    */
+   void record(const std::vector<InputValues> &tickValues);
+
+   /**
+    * Gets the input values for the given tick, returning false if the recording has ended
+    */
+   bool getTick(size_t tick, std::vector<InputValues> &tickValues) const;
+
+   unsigned int getSeed() const {
+      return seed;
+   }
+
+   int getNumDevices() const {
+      return numDevices;
+   }
+
+   size_t getNumTicks() const;
+};
+
+#endif
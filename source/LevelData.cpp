@@ -0,0 +1,246 @@
+#include "FancyAssert.h"
+#include "LevelData.h"
+#include "LogHelper.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+const char MAGIC[4] = { 'T', 'G', 'I', 'L' };
+const uint32_t VERSION = 1;
+
+// LightComponent::Spot
+const uint32_t MAX_LIGHT_TYPE = 2;
+
+struct Header {
+   char magic[4];
+   uint32_t version;
+   uint32_t numStrings;
+   uint32_t stringDataSize;
+   uint32_t numMaterials;
+   uint32_t numModels;
+   uint32_t numObjects;
+   uint32_t numLights;
+   float spawnLocations[LevelData::NUM_SPAWN_LOCATIONS * 3];
+};
+
+// Records are copied to / from the file as-is, so they must not contain padding
+static_assert(sizeof(LevelMaterial) == 6 * sizeof(float), "LevelMaterial must be tightly packed");
+static_assert(sizeof(LevelModel) == 3 * sizeof(uint32_t), "LevelModel must be tightly packed");
+static_assert(sizeof(LevelObject) == 16 * sizeof(float), "LevelObject must be tightly packed");
+static_assert(sizeof(LevelLight) == 14 * sizeof(float), "LevelLight must be tightly packed");
+
+template<class T>
+void writeRecords(std::ofstream &out, const std::vector<T> &records) {
+   out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(T));
+}
+
+template<class T>
+const char* readRecords(const char *data, uint32_t count, std::vector<T> &records) {
+   records.resize(count);
+   memcpy(records.data(), data, count * sizeof(T));
+   return data + count * sizeof(T);
+}
+
+} // namespace
+
+LevelData::LevelData() {
+   spawnLocations.fill(glm::vec3(0.0f));
+}
+
+LevelData::~LevelData() {
+}
+
+UPtr<LevelData> LevelData::load(const std::string &fileName) {
+   ASSERT(!fileName.empty(), "Trying to load level from empty file name");
+   std::ifstream in(fileName, std::ifstream::binary);
+   if (!in) {
+      LOG_WARNING("Unable to open level: " << fileName);
+      return nullptr;
+   }
+
+   // Read the whole file at once, then parse it in memory
+   in.seekg(0, std::ios_base::end);
+   std::size_t size = static_cast<std::size_t>(in.tellg());
+   in.seekg(0, std::ios_base::beg);
+   std::vector<char> data(size);
+   in.read(data.data(), size);
+   if (!in) {
+      LOG_WARNING("Invalid level: " << fileName);
+      return nullptr;
+   }
+
+   return loadFromMemory(data.data(), size, fileName);
+}
+
+UPtr<LevelData> LevelData::loadFromMemory(const char *data, std::size_t size, const std::string &fileName) {
+   if (size < sizeof(Header)) {
+      LOG_WARNING("Invalid level: " << fileName);
+      return nullptr;
+   }
+
+   Header header;
+   memcpy(&header, data, sizeof(header));
+   if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+      LOG_WARNING("Invalid level: " << fileName);
+      return nullptr;
+   }
+
+   if (header.version != VERSION) {
+      LOG_WARNING("Level " << fileName << " has version " << header.version << ", expected " << VERSION);
+      return nullptr;
+   }
+
+   std::size_t expectedSize = sizeof(Header) + header.numStrings * sizeof(uint32_t) + header.stringDataSize + header.numMaterials * sizeof(LevelMaterial) + header.numModels * sizeof(LevelModel) + header.numObjects * sizeof(LevelObject) + header.numLights * sizeof(LevelLight);
+   if (size != expectedSize) {
+      LOG_WARNING("Level " << fileName << " is " << size << " bytes, expected " << expectedSize);
+      return nullptr;
+   }
+
+   UPtr<LevelData> level(new LevelData);
+   for (int i = 0; i < NUM_SPAWN_LOCATIONS; ++i) {
+      level->spawnLocations[i] = glm::vec3(header.spawnLocations[i * 3], header.spawnLocations[i * 3 + 1], header.spawnLocations[i * 3 + 2]);
+   }
+
+   const char *position = data + sizeof(Header);
+   std::vector<uint32_t> stringLengths;
+   position = readRecords(position, header.numStrings, stringLengths);
+
+   const char *stringData = position;
+   std::size_t stringDataUsed = 0;
+   level->strings.reserve(header.numStrings);
+   for (uint32_t length : stringLengths) {
+      if (stringDataUsed + length > header.stringDataSize) {
+         LOG_WARNING("Level " << fileName << " has an invalid string table");
+         return nullptr;
+      }
+
+      level->strings.push_back(std::string(stringData + stringDataUsed, length));
+      stringDataUsed += length;
+   }
+   position += header.stringDataSize;
+
+   position = readRecords(position, header.numMaterials, level->materials);
+   position = readRecords(position, header.numModels, level->models);
+   position = readRecords(position, header.numObjects, level->objects);
+   readRecords(position, header.numLights, level->lights);
+
+   // Validate references up front, so that loading the scene doesn't have to
+   for (const LevelModel &model : level->models) {
+      if (model.mesh >= level->strings.size() || model.shaderProgram >= level->strings.size() || model.material >= level->materials.size()) {
+         LOG_WARNING("Level " << fileName << " has a model with an invalid reference");
+         return nullptr;
+      }
+   }
+   for (const LevelObject &object : level->objects) {
+      if (object.model >= level->models.size() || object.physics > LevelPhysics::Dynamic) {
+         LOG_WARNING("Level " << fileName << " has an invalid object");
+         return nullptr;
+      }
+   }
+   for (const LevelLight &light : level->lights) {
+      if (light.type > MAX_LIGHT_TYPE) {
+         LOG_WARNING("Level " << fileName << " has an invalid light");
+         return nullptr;
+      }
+   }
+
+   return level;
+}
+
+bool LevelData::save(const std::string &fileName) const {
+   ASSERT(!fileName.empty(), "Trying to save level to empty file name");
+   std::ofstream out(fileName, std::ofstream::binary);
+   if (!out) {
+      return false;
+   }
+
+   std::vector<uint32_t> stringLengths;
+   uint32_t stringDataSize = 0;
+   for (const std::string &string : strings) {
+      stringLengths.push_back(static_cast<uint32_t>(string.size()));
+      stringDataSize += static_cast<uint32_t>(string.size());
+   }
+
+   Header header;
+   memcpy(header.magic, MAGIC, sizeof(MAGIC));
+   header.version = VERSION;
+   header.numStrings = static_cast<uint32_t>(strings.size());
+   header.stringDataSize = stringDataSize;
+   header.numMaterials = static_cast<uint32_t>(materials.size());
+   header.numModels = static_cast<uint32_t>(models.size());
+   header.numObjects = static_cast<uint32_t>(objects.size());
+   header.numLights = static_cast<uint32_t>(lights.size());
+   for (int i = 0; i < NUM_SPAWN_LOCATIONS; ++i) {
+      header.spawnLocations[i * 3] = spawnLocations[i].x;
+      header.spawnLocations[i * 3 + 1] = spawnLocations[i].y;
+      header.spawnLocations[i * 3 + 2] = spawnLocations[i].z;
+   }
+   out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+   writeRecords(out, stringLengths);
+   for (const std::string &string : strings) {
+      out.write(string.data(), string.size());
+   }
+   writeRecords(out, materials);
+   writeRecords(out, models);
+   writeRecords(out, objects);
+   writeRecords(out, lights);
+
+   return !!out;
+}
+
+uint32_t LevelData::addString(const std::string &string) {
+   for (uint32_t i = 0; i < strings.size(); ++i) {
+      if (strings[i] == string) {
+         return i;
+      }
+   }
+
+   strings.push_back(string);
+   return static_cast<uint32_t>(strings.size() - 1);
+}
+
+uint32_t LevelData::addMaterial(const LevelMaterial &material) {
+   for (uint32_t i = 0; i < materials.size(); ++i) {
+      if (materials[i] == material) {
+         return i;
+      }
+   }
+
+   materials.push_back(material);
+   return static_cast<uint32_t>(materials.size() - 1);
+}
+
+uint32_t LevelData::addModel(const std::string &meshName, const std::string &shaderProgramName, uint32_t material) {
+   ASSERT(material < materials.size(), "Invalid material index: %u", material);
+
+   LevelModel model;
+   model.mesh = addString(meshName);
+   model.shaderProgram = addString(shaderProgramName);
+   model.material = material;
+
+   for (uint32_t i = 0; i < models.size(); ++i) {
+      if (models[i] == model) {
+         return i;
+      }
+   }
+
+   models.push_back(model);
+   return static_cast<uint32_t>(models.size() - 1);
+}
+
+void LevelData::addObject(const LevelObject &object) {
+   ASSERT(object.model < models.size(), "Invalid model index: %u", object.model);
+   objects.push_back(object);
+}
+
+void LevelData::addLight(const LevelLight &light) {
+   lights.push_back(light);
+}
+
+void LevelData::setSpawnLocation(int index, const glm::vec3 &location) {
+   ASSERT(index >= 0 && index < NUM_SPAWN_LOCATIONS, "Invalid spawn location index: %d", index);
+   spawnLocations[index] = location;
+}
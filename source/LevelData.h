@@ -0,0 +1,150 @@
+#ifndef LEVEL_DATA_H
+#define LEVEL_DATA_H
+
+#include "Types.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Phong material parameters (ambient and diffuse are derived from the color)
+ */
+struct LevelMaterial {
+   glm::vec3 color;
+   float specular;
+   float shininess;
+   float emission;
+
+   bool operator==(const LevelMaterial &other) const {
+      return color == other.color && specular == other.specular && shininess == other.shininess && emission == other.emission;
+   }
+};
+
+/**
+ * A mesh drawn with a shader program and material (names index into the level's string table)
+ */
+struct LevelModel {
+   uint32_t mesh;
+   uint32_t shaderProgram;
+   uint32_t material;
+
+   bool operator==(const LevelModel &other) const {
+      return mesh == other.mesh && shaderProgram == other.shaderProgram && material == other.material;
+   }
+};
+
+enum class LevelPhysics : uint32_t {
+   Static = 0, // Static rigid body with a convex mesh shape
+   Bvh = 1,    // Static triangle mesh (for terrain)
+   Dynamic = 2 // Rigid body with the given mass
+};
+
+struct LevelObject {
+   uint32_t model;
+   LevelPhysics physics;
+   glm::vec3 position;
+   glm::quat orientation;
+   glm::vec3 scale;
+   float friction;
+   float restitution;
+   float mass;
+   uint32_t castShadows;
+};
+
+struct LevelLight {
+   uint32_t type; // LightComponent::LightType
+   glm::vec3 position;
+   glm::vec3 color;
+   glm::vec3 direction;
+   float linearFalloff;
+   float squareFalloff;
+   float beamAngle;
+   float cutoffAngle;
+};
+
+/**
+ * Description of a level's content, stored in a compact binary file that is read in one go. Shared resources (names,
+ * materials, models) are stored once and referenced by index, so loading only creates each of them once
+ */
+class LevelData {
+public:
+   static const int NUM_SPAWN_LOCATIONS = 4;
+
+protected:
+   std::vector<std::string> strings;
+   std::vector<LevelMaterial> materials;
+   std::vector<LevelModel> models;
+   std::vector<LevelObject> objects;
+   std::vector<LevelLight> lights;
+   std::array<glm::vec3, NUM_SPAWN_LOCATIONS> spawnLocations;
+
+   uint32_t addString(const std::string &string);
+
+public:
+   LevelData();
+
+   virtual ~LevelData();
+
+   /**
+    * Loads a level from the binary file with the given name, returning null if it can't be read
+    */
+   static UPtr<LevelData> load(const std::string &fileName);
+
+   /**
+    * Loads a level from binary data already in memory (e.g. in the asset pack), using the file name for warnings
+    */
+   static UPtr<LevelData> loadFromMemory(const char *data, std::size_t size, const std::string &fileName);
+
+   /**
+    * Writes the level to a binary file with the given name
+    */
+   bool save(const std::string &fileName) const;
+
+   /**
+    * Adds a material, returning its index (existing identical materials are reused)
+    */
+   uint32_t addMaterial(const LevelMaterial &material);
+
+   /**
+    * Adds a model, returning its index (existing identical models are reused)
+    */
+   uint32_t addModel(const std::string &meshName, const std::string &shaderProgramName, uint32_t material);
+
+   void addObject(const LevelObject &object);
+
+   void addLight(const LevelLight &light);
+
+   void setSpawnLocation(int index, const glm::vec3 &location);
+
+   const std::string& getString(uint32_t index) const {
+      return strings[index];
+   }
+
+   const std::vector<LevelMaterial>& getMaterials() const {
+      return materials;
+   }
+
+   const std::vector<LevelModel>& getModels() const {
+      return models;
+   }
+
+   const std::vector<LevelObject>& getObjects() const {
+      return objects;
+   }
+
+   const std::vector<LevelLight>& getLights() const {
+      return lights;
+   }
+
+   const std::array<glm::vec3, NUM_SPAWN_LOCATIONS>& getSpawnLocations() const {
+      return spawnLocations;
+   }
+};
+
+#endif
@@ -1,14 +1,10 @@
 #include "FancyAssert.h"
 #include "GameObject.h"
 #include "LightComponent.h"
-#include "ShaderProgram.h"
 #include "ShadowMap.h"
+#include "UniformBlocks.h"
 
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-
-#include <sstream>
-#include <string>
 
 // Yup, defined in windows.h for whatever reason
 #ifdef _WIN32
@@ -24,82 +20,60 @@ const float DIRECTIONAL_LIGHT_WIDTH = 60.0f;
 } // namespace
 
 LightComponent::LightComponent(GameObject &gameObject, LightType type, const glm::vec3 &color, const glm::vec3 &direction, float linearFalloff, float squareFalloff, float beamAngle, float cutoffAngle)
-   : Component(gameObject), type(type), color(color), direction(direction), linearFalloff(linearFalloff), squareFalloff(squareFalloff), beamAngle(beamAngle), cutoffAngle(cutoffAngle) {
+   : Component(gameObject), type(type), color(color), direction(direction), linearFalloff(linearFalloff), squareFalloff(squareFalloff), beamAngle(beamAngle), cutoffAngle(cutoffAngle), renderPosition(0.0f), renderDirection(direction), renderSquareFalloff(squareFalloff) {
 }
 
 LightComponent::~LightComponent() {
 }
 
-void LightComponent::draw(ShaderProgram &shaderProgram, const unsigned int index, int &shadowIndex, int &cubeShadowIndex) {
-   std::stringstream ss;
-   ss << "uLights[" << index << "]";
-   const std::string &lightName = ss.str();
-
-   shaderProgram.setUniformValue(lightName + ".type", type);
-   shaderProgram.setUniformValue(lightName + ".color", color);
-   shaderProgram.setUniformValue(lightName + ".position", gameObject.getPosition());
-   shaderProgram.setUniformValue(lightName + ".direction", direction);
-   shaderProgram.setUniformValue(lightName + ".linearFalloff", linearFalloff);
-   shaderProgram.setUniformValue(lightName + ".squareFalloff", squareFalloff);
-   shaderProgram.setUniformValue(lightName + ".beamAngle", beamAngle);
-   shaderProgram.setUniformValue(lightName + ".cutoffAngle", cutoffAngle);
-
-   if (shadowMap) {
-      // Shadow index
-      int usedShadowIndex = -1;
-      int usedCubeShadowIndex = -1;
-
-      if (type == Point) {
-         usedCubeShadowIndex = cubeShadowIndex++;
-      } else {
-         usedShadowIndex = shadowIndex++;
-      }
-
-      // Shadow weights
-      for (int i = 0; i < 5; ++i) {
-         ss.str(std::string());
-         ss.clear();
-         ss << ".shadowWeight" << i;
-
-         shaderProgram.setUniformValue(lightName + ss.str(), i == usedShadowIndex ? 1.0f : 0.0f);
-      }
-      for (int i = 0; i < 4; ++i) {
-         ss.str(std::string());
-         ss.clear();
-         ss << ".cubeShadowWeight" << i;
-
-         shaderProgram.setUniformValue(lightName + ss.str(), i == usedCubeShadowIndex ? 1.0f : 0.0f);
-      }
-
-      // Shadow
-      ss.str(std::string());
-      ss.clear();
-      if (usedShadowIndex != -1) {
-         ss << "uShadows[" << usedShadowIndex << "]";
-      } else {
-         ss << "uCubeShadows[" << usedCubeShadowIndex << "]";
-      }
-      const std::string &shadowName = ss.str();
-
-      if (shaderProgram.hasUniform(shadowName + ".near")) {
-         shaderProgram.setUniformValue(shadowName + ".near", getNearPlaneDist());
-         shaderProgram.setUniformValue(shadowName + ".far", getFarPlaneDist());
-      }
-
-      if (shaderProgram.hasUniform(shadowName + ".shadowProj")) {
-         shaderProgram.setUniformValue(shadowName + ".shadowProj", getBiasedProjectionMatrix());
-         shaderProgram.setUniformValue(shadowName + ".shadowView", getViewMatrix(-1));
-      }
-
-      GLenum shadowTextureUnit = shadowMap->bindTexture();;
-      shaderProgram.setUniformValue(shadowName + ".shadowMap", shadowTextureUnit);
+void LightComponent::snapshot() {
+   renderPosition = gameObject.getPosition();
+   renderDirection = direction;
+   renderSquareFalloff = squareFalloff;
+}
+
+void LightComponent::draw(LightsBlock &lightsBlock, ShadowMapUnits &shadowMapUnits, const unsigned int index, int &shadowIndex, int &cubeShadowIndex) {
+   ASSERT(index < MAX_LIGHTS, "Invalid light index: %u", index);
+
+   LightData &light = lightsBlock.lights[index];
+   light.type = type;
+   light.color = color;
+   light.position = renderPosition;
+   light.direction = renderDirection;
+   light.linearFalloff = linearFalloff;
+   light.squareFalloff = renderSquareFalloff;
+   light.beamAngle = beamAngle;
+   light.cutoffAngle = cutoffAngle;
+   light.shadowIndex = -1;
+   light.cubeShadowIndex = -1;
+
+   if (!shadowMap) {
+      return;
+   }
+
+   GLenum shadowTextureUnit = shadowMap->bindTexture();
+
+   if (type == Point) {
+      ASSERT(cubeShadowIndex < UniformBlocks::MAX_CUBE_SHADOWS, "Too many cube shadows: %d", cubeShadowIndex);
+
+      light.cubeShadowIndex = cubeShadowIndex;
+      lightsBlock.cubeShadowPlanes[cubeShadowIndex] = glm::vec4(getNearPlaneDist(), getFarPlaneDist(), 0.0f, 0.0f);
+      shadowMapUnits.cubeShadowMaps[cubeShadowIndex] = shadowTextureUnit;
+      ++cubeShadowIndex;
+   } else {
+      ASSERT(shadowIndex < UniformBlocks::MAX_SHADOWS, "Too many shadows: %d", shadowIndex);
+
+      light.shadowIndex = shadowIndex;
+      lightsBlock.shadowMatrices[shadowIndex] = getBiasedProjectionMatrix() * getViewMatrix(-1);
+      shadowMapUnits.shadowMaps[shadowIndex] = shadowTextureUnit;
+      ++shadowIndex;
    }
 }
 
 glm::mat4 LightComponent::getViewMatrix(int face) const {
    ASSERT(face >= 0 && face < 6 || face == -1, "Invalid face value");
 
-   const glm::vec3 &pos = gameObject.getPosition();
+   const glm::vec3 &pos = renderPosition;
    glm::vec3 look;
    glm::vec3 up(0.0f, 1.0f, 0.0f);
    switch (face) {
@@ -133,9 +107,9 @@ glm::mat4 LightComponent::getViewMatrix(int face) const {
       case Point:
          return glm::lookAt(pos, pos + look, up);
       case Directional:
-         return glm::lookAt(glm::normalize(-direction), glm::vec3(0.0f), up);
+         return glm::lookAt(glm::normalize(-renderDirection), glm::vec3(0.0f), up);
       case Spot:
-         return glm::lookAt(pos, pos + direction, up);
+         return glm::lookAt(pos, pos + renderDirection, up);
    }
 }
 
@@ -175,8 +149,8 @@ float LightComponent::getFarPlaneDist() const {
    const float lightCutoffAttenuation = 0.01f;
    float cutoffDist = LIGHT_CUTOFF_DIST;
 
-   if (squareFalloff * lightCutoffAttenuation > 0.0f) {
-      cutoffDist = glm::sqrt(1.0f / (squareFalloff * lightCutoffAttenuation));
+   if (renderSquareFalloff * lightCutoffAttenuation > 0.0f) {
+      cutoffDist = glm::sqrt(1.0f / (renderSquareFalloff * lightCutoffAttenuation));
    }
 
    return cutoffDist;
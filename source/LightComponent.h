@@ -5,8 +5,9 @@
 
 #include <glm/glm.hpp>
 
-class ShaderProgram;
 class ShadowMap;
+struct LightsBlock;
+struct ShadowMapUnits;
 
 class LightComponent : public Component {
 public:
@@ -26,6 +27,11 @@ protected:
    float cutoffAngle;
    SPtr<ShadowMap> shadowMap;
 
+   // State that can change while ticking, as of the last snapshot (used by everything that draws the light)
+   glm::vec3 renderPosition;
+   glm::vec3 renderDirection;
+   float renderSquareFalloff;
+
 public:
    static const int MAX_LIGHTS = 10;
 
@@ -33,7 +39,13 @@ public:
 
    virtual ~LightComponent();
 
-   virtual void draw(ShaderProgram &shaderProgram, const unsigned int index, int &shadowIndex, int &cubeShadowIndex);
+   virtual void snapshot();
+
+   /**
+    * Writes the light (and its shadow, if it has a shadow map) into the given slot of the Lights block, binding the
+    * shadow map to a texture unit
+    */
+   virtual void draw(LightsBlock &lightsBlock, ShadowMapUnits &shadowMapUnits, const unsigned int index, int &shadowIndex, int &cubeShadowIndex);
 
    LightType getLightType() const {
       return type;
@@ -49,6 +61,10 @@ public:
       return direction;
    }
 
+   const glm::vec3& getRenderDirection() const {
+      return renderDirection;
+   }
+
    float getNearPlaneDist() const;
 
    float getFarPlaneDist() const;
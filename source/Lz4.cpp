@@ -0,0 +1,197 @@
+#include "FancyAssert.h"
+#include "Lz4.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Lz4 {
+
+namespace {
+
+const std::size_t MIN_MATCH = 4;
+
+// The block format requires the last 5 bytes to be literals, and the last match to start at least 12 bytes from the end
+const std::size_t LAST_LITERALS = 5;
+const std::size_t MATCH_FIND_LIMIT = 12;
+
+const std::size_t MAX_OFFSET = 65535;
+const int HASH_BITS = 16;
+
+// Token nibbles saturate at 15, after which the length continues in extra bytes
+const std::size_t RUN_MASK = 15;
+
+uint32_t read32(const uint8_t *data) {
+   uint32_t value;
+   memcpy(&value, data, sizeof(value));
+   return value;
+}
+
+uint32_t hash(uint32_t sequence) {
+   return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+uint8_t* writeLength(uint8_t *out, std::size_t length) {
+   while (length >= 255) {
+      *out++ = 255;
+      length -= 255;
+   }
+   *out++ = static_cast<uint8_t>(length);
+
+   return out;
+}
+
+bool readLength(const uint8_t **in, const uint8_t *inEnd, std::size_t *length) {
+   uint8_t byte;
+   do {
+      if (*in >= inEnd) {
+         return false;
+      }
+      byte = *(*in)++;
+      *length += byte;
+   } while (byte == 255);
+
+   return true;
+}
+
+uint8_t* writeSequence(uint8_t *out, const uint8_t *literals, std::size_t literalLength, std::size_t offset, std::size_t matchLength) {
+   uint8_t *token = out++;
+   std::size_t matchCode = matchLength - MIN_MATCH;
+   *token = static_cast<uint8_t>((literalLength < RUN_MASK ? literalLength : RUN_MASK) << 4 | (matchCode < RUN_MASK ? matchCode : RUN_MASK));
+
+   if (literalLength >= RUN_MASK) {
+      out = writeLength(out, literalLength - RUN_MASK);
+   }
+   memcpy(out, literals, literalLength);
+   out += literalLength;
+
+   *out++ = static_cast<uint8_t>(offset & 0xFF);
+   *out++ = static_cast<uint8_t>(offset >> 8);
+   if (matchCode >= RUN_MASK) {
+      out = writeLength(out, matchCode - RUN_MASK);
+   }
+
+   return out;
+}
+
+uint8_t* writeLastLiterals(uint8_t *out, const uint8_t *literals, std::size_t literalLength) {
+   *out++ = static_cast<uint8_t>((literalLength < RUN_MASK ? literalLength : RUN_MASK) << 4);
+   if (literalLength >= RUN_MASK) {
+      out = writeLength(out, literalLength - RUN_MASK);
+   }
+   memcpy(out, literals, literalLength);
+
+   return out + literalLength;
+}
+
+} // namespace
+
+std::size_t compressBound(std::size_t size) {
+   return size + size / 255 + 16;
+}
+
+uint64_t decompressBound(uint64_t compressedSize) {
+   return compressedSize * 255 + 16;
+}
+
+std::size_t compress(const char *source, std::size_t sourceSize, char *dest, std::size_t destCapacity) {
+   ASSERT(destCapacity >= compressBound(sourceSize), "LZ4 destination too small: %lu bytes", destCapacity);
+
+   const uint8_t *in = reinterpret_cast<const uint8_t*>(source);
+   const uint8_t *inEnd = in + sourceSize;
+   const uint8_t *anchor = in;
+   uint8_t *out = reinterpret_cast<uint8_t*>(dest);
+
+   if (sourceSize > MATCH_FIND_LIMIT) {
+      // Positions of the last occurrence of each hashed 4 byte sequence
+      std::vector<uint32_t> table(1 << HASH_BITS, 0);
+      const uint8_t *matchLimit = inEnd - LAST_LITERALS;
+      const uint8_t *position = in + 1;
+
+      while (position < inEnd - MATCH_FIND_LIMIT) {
+         uint32_t sequence = read32(position);
+         uint32_t &entry = table[hash(sequence)];
+         const uint8_t *candidate = in + entry;
+         entry = static_cast<uint32_t>(position - in);
+
+         if (static_cast<std::size_t>(position - candidate) > MAX_OFFSET || read32(candidate) != sequence) {
+            ++position;
+            continue;
+         }
+
+         // Extend the match forwards, then backwards over literals that also match
+         const uint8_t *matchEnd = position + MIN_MATCH;
+         const uint8_t *reference = candidate + MIN_MATCH;
+         while (matchEnd < matchLimit && *matchEnd == *reference) {
+            ++matchEnd;
+            ++reference;
+         }
+         while (position > anchor && candidate > in && position[-1] == candidate[-1]) {
+            --position;
+            --candidate;
+         }
+
+         out = writeSequence(out, anchor, position - anchor, position - candidate, matchEnd - position);
+         position = anchor = matchEnd;
+      }
+   }
+
+   out = writeLastLiterals(out, anchor, inEnd - anchor);
+   return out - reinterpret_cast<uint8_t*>(dest);
+}
+
+bool decompress(const char *source, std::size_t sourceSize, char *dest, std::size_t destSize) {
+   const uint8_t *in = reinterpret_cast<const uint8_t*>(source);
+   const uint8_t *inEnd = in + sourceSize;
+   uint8_t *outStart = reinterpret_cast<uint8_t*>(dest);
+   uint8_t *out = outStart;
+   uint8_t *outEnd = out + destSize;
+
+   while (in < inEnd) {
+      uint8_t token = *in++;
+
+      std::size_t literalLength = token >> 4;
+      if (literalLength == RUN_MASK && !readLength(&in, inEnd, &literalLength)) {
+         return false;
+      }
+      if (literalLength > static_cast<std::size_t>(inEnd - in) || literalLength > static_cast<std::size_t>(outEnd - out)) {
+         return false;
+      }
+      memcpy(out, in, literalLength);
+      in += literalLength;
+      out += literalLength;
+
+      // The last sequence has no match
+      if (in == inEnd) {
+         break;
+      }
+
+      if (inEnd - in < 2) {
+         return false;
+      }
+      std::size_t offset = in[0] | (in[1] << 8);
+      in += 2;
+      if (offset == 0 || offset > static_cast<std::size_t>(out - outStart)) {
+         return false;
+      }
+
+      std::size_t matchLength = token & RUN_MASK;
+      if (matchLength == RUN_MASK && !readLength(&in, inEnd, &matchLength)) {
+         return false;
+      }
+      matchLength += MIN_MATCH;
+      if (matchLength > static_cast<std::size_t>(outEnd - out)) {
+         return false;
+      }
+
+      // Matches may overlap the bytes they produce, so copy one byte at a time
+      const uint8_t *match = out - offset;
+      for (std::size_t i = 0; i < matchLength; ++i) {
+         *out++ = *match++;
+      }
+   }
+
+   return out == outEnd;
+}
+
+} // namespace Lz4
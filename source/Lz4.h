@@ -0,0 +1,39 @@
+#ifndef LZ4_H
+#define LZ4_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Compression and decompression of single LZ4 blocks (the raw block format, without the frame format's headers or
+ * checksums). Decompression is fast enough to run on every load, and never reads or writes out of bounds, even when
+ * given corrupt data
+ */
+namespace Lz4 {
+
+/**
+ * Gets the largest compressed size a block with the given size can have
+ */
+std::size_t compressBound(std::size_t size);
+
+/**
+ * Gets the largest size a block with the given compressed size can decompress to (each extra length byte adds at most
+ * 255 bytes of output)
+ */
+uint64_t decompressBound(uint64_t compressedSize);
+
+/**
+ * Compresses the source into the destination (which must hold at least compressBound(sourceSize) bytes), returning the
+ * compressed size
+ */
+std::size_t compress(const char *source, std::size_t sourceSize, char *dest, std::size_t destCapacity);
+
+/**
+ * Decompresses the source into the destination, returning true if the block was valid and decompressed to exactly
+ * destSize bytes
+ */
+bool decompress(const char *source, std::size_t sourceSize, char *dest, std::size_t destSize);
+
+} // namespace Lz4
+
+#endif
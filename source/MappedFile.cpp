@@ -0,0 +1,104 @@
+#include "FancyAssert.h"
+#include "MappedFile.h"
+
+#if defined(__APPLE__) || defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // defined(__APPLE__) || defined(__linux__)
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif // _WIN32
+
+#if defined(__APPLE__) || defined(__linux__)
+MappedFile::MappedFile()
+   : data(nullptr), size(0) {
+}
+
+MappedFile::~MappedFile() {
+   if (data) {
+      munmap(data, size);
+   }
+}
+
+// static
+SPtr<MappedFile> MappedFile::open(const std::string &fileName) {
+   ASSERT(!fileName.empty(), "Trying to map empty file name");
+
+   int fileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+   if (fileDescriptor == -1) {
+      return nullptr;
+   }
+
+   struct stat info;
+   if (fstat(fileDescriptor, &info) != 0 || info.st_size == 0) {
+      close(fileDescriptor);
+      return nullptr;
+   }
+
+   void *mapping = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0);
+
+   // The mapping keeps its own reference to the file
+   close(fileDescriptor);
+
+   if (mapping == MAP_FAILED) {
+      return nullptr;
+   }
+
+   SPtr<MappedFile> mappedFile(new MappedFile);
+   mappedFile->data = static_cast<char*>(mapping);
+   mappedFile->size = static_cast<std::size_t>(info.st_size);
+
+   return mappedFile;
+}
+#endif // defined(__APPLE__) || defined(__linux__)
+
+#ifdef _WIN32
+MappedFile::MappedFile()
+   : data(nullptr), size(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr) {
+}
+
+MappedFile::~MappedFile() {
+   if (data) {
+      UnmapViewOfFile(data);
+   }
+   if (mappingHandle) {
+      CloseHandle(mappingHandle);
+   }
+   if (fileHandle != INVALID_HANDLE_VALUE) {
+      CloseHandle(fileHandle);
+   }
+}
+
+// static
+SPtr<MappedFile> MappedFile::open(const std::string &fileName) {
+   ASSERT(!fileName.empty(), "Trying to map empty file name");
+
+   SPtr<MappedFile> mappedFile(new MappedFile);
+
+   mappedFile->fileHandle = CreateFile(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+   if (mappedFile->fileHandle == INVALID_HANDLE_VALUE) {
+      return nullptr;
+   }
+
+   LARGE_INTEGER fileSize;
+   if (!GetFileSizeEx(mappedFile->fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+      return nullptr;
+   }
+
+   mappedFile->mappingHandle = CreateFileMapping(mappedFile->fileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+   if (!mappedFile->mappingHandle) {
+      return nullptr;
+   }
+
+   mappedFile->data = static_cast<char*>(MapViewOfFile(mappedFile->mappingHandle, FILE_MAP_COPY, 0, 0, 0));
+   if (!mappedFile->data) {
+      return nullptr;
+   }
+   mappedFile->size = static_cast<std::size_t>(fileSize.QuadPart);
+
+   return mappedFile;
+}
+#endif // _WIN32
@@ -0,0 +1,42 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include "Types.h"
+
+#include <cstddef>
+#include <string>
+
+/**
+ * A file mapped into memory (copy-on-write, so the data can be modified without changing the file). The mapping lives
+ * as long as the object
+ */
+class MappedFile {
+protected:
+   char *data;
+   std::size_t size;
+
+#ifdef _WIN32
+   void *fileHandle;
+   void *mappingHandle;
+#endif // _WIN32
+
+   MappedFile();
+
+public:
+   virtual ~MappedFile();
+
+   /**
+    * Maps the file with the given name, returning null if it can't be mapped
+    */
+   static SPtr<MappedFile> open(const std::string &fileName);
+
+   char* getData() const {
+      return data;
+   }
+
+   std::size_t getSize() const {
+      return size;
+   }
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include "Types.h"
 
 class ShaderProgram;
+class Texture;
 
 class Material {
 public:
@@ -20,6 +21,13 @@ public:
     * Disables any changed states that were set in apply
     */
    virtual void disable() = 0;
+
+   /**
+    * Gets the texture bound by the material, if any (used to sort draws that share textures together)
+    */
+   virtual const Texture* getTexture() const {
+      return nullptr;
+   }
 };
 
 #endif
@@ -1,5 +1,62 @@
 #include "FancyAssert.h"
+#include "MappedFile.h"
 #include "Mesh.h"
+#include "ShaderProgram.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+const unsigned int MAX_SHORT_INDEX = 0xFFFF;
+
+// Largest texture coordinate error allowed when storing them as half floats (an eighth of a texel at 512 x 512)
+const float MAX_TEX_COORD_ERROR = 1.0f / 4096.0f;
+
+bool texCoordsFitHalfFloats(const float *texCoords, unsigned int numTexCoords) {
+   for (unsigned int i = 0; i < numTexCoords * 2; ++i) {
+      if (glm::abs(glm::unpackHalf1x16(glm::packHalf1x16(texCoords[i])) - texCoords[i]) > MAX_TEX_COORD_ERROR) {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+std::vector<char> interleave(VertexFormat format, GLsizei stride, unsigned int numVertices, const float *vertices, const float *normals, const float *texCoords) {
+   std::vector<char> data(stride * numVertices);
+
+   for (unsigned int i = 0; i < numVertices; ++i) {
+      char *vertex = data.data() + i * stride;
+      memcpy(vertex, vertices + i * 3, sizeof(float) * 3);
+
+      if (format == VertexFormat::Quantized) {
+         uint32_t normal = glm::packSnorm3x10_1x2(glm::vec4(normals[i * 3], normals[i * 3 + 1], normals[i * 3 + 2], 0.0f));
+         memcpy(vertex + sizeof(float) * 3, &normal, sizeof(normal));
+
+         if (texCoords) {
+            uint16_t texCoord[2] = { glm::packHalf1x16(texCoords[i * 2]), glm::packHalf1x16(texCoords[i * 2 + 1]) };
+            memcpy(vertex + sizeof(float) * 3 + sizeof(normal), texCoord, sizeof(texCoord));
+         }
+      } else {
+         memcpy(vertex + sizeof(float) * 3, normals + i * 3, sizeof(float) * 3);
+
+         if (texCoords) {
+            memcpy(vertex + sizeof(float) * 6, texCoords + i * 2, sizeof(float) * 2);
+         }
+      }
+   }
+
+   return data;
+}
+
+} // namespace
+
+// static
+bool Mesh::quantizationEnabled = true;
 
 Mesh::Mesh(UPtr<float[]> vertices, unsigned int numVertices, UPtr<float[]> normals, unsigned int numNormals,
            UPtr<unsigned int[]> indices, unsigned int numIndices, UPtr<float[]> texCoords, unsigned int numTexCoords,
@@ -10,44 +67,216 @@ Mesh::Mesh(UPtr<float[]> vertices, unsigned int numVertices, UPtr<float[]> norma
    ASSERT(numTexCoords == 0 || texCoords, "numTexCoords > 0, but no texCoords provided");
    ASSERT(usage == GL_STATIC_DRAW || usage == GL_DYNAMIC_DRAW, "Invalid usage: %u", usage);
 
-   // Prepare the vertex buffer object
-   glGenBuffers(1, &vbo);
-   glBindBuffer(GL_ARRAY_BUFFER, vbo);
-   glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 3 * numVertices, vertices.get(), usage);
+   this->vertices = std::move(vertices);
+   this->numVertices = numVertices;
+   this->normals = std::move(normals);
+   this->numNormals = numNormals;
+   this->indices = std::move(indices);
+   this->numIndices = numIndices;
+   this->texCoords = std::move(texCoords);
+   this->numTexCoords = numTexCoords;
+   this->usage = usage;
+   vertexData = this->vertices.get();
+   normalData = this->normals.get();
+   indexData = this->indices.get();
+   texCoordData = this->texCoords.get();
+   hasTextureBufferObject = numTexCoords > 0;
+   uploaded = false;
+   vbo = nbo = ibo = tbo = 0;
+
+   boundsMin = boundsMax = glm::vec3(0.0f);
+   for (unsigned int i = 0; i < numVertices; ++i) {
+      glm::vec3 vertex(vertexData[i * 3], vertexData[i * 3 + 1], vertexData[i * 3 + 2]);
+      boundsMin = i == 0 ? vertex : glm::min(boundsMin, vertex);
+      boundsMax = i == 0 ? vertex : glm::max(boundsMax, vertex);
+   }
+
+   chooseLayout();
+
+   // GL objects are created on first use, so meshes can be loaded without a GL context (e.g. when headless)
+}
+
+Mesh::Mesh(SPtr<MappedFile> mappedFile, float *vertices, unsigned int numVertices, float *normals, unsigned int numNormals,
+           unsigned int *indices, unsigned int numIndices, float *texCoords, unsigned int numTexCoords,
+           const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+   : vbo(0), nbo(0), ibo(0), tbo(0), mappedFile(mappedFile), vertexData(vertices), normalData(normals),
+     indexData(indices), texCoordData(texCoords), numVertices(numVertices), numNormals(numNormals),
+     numIndices(numIndices), numTexCoords(numTexCoords), boundsMin(boundsMin), boundsMax(boundsMax), usage(GL_STATIC_DRAW),
+     uploaded(false), hasTextureBufferObject(numTexCoords > 0) {
+   ASSERT(mappedFile, "Trying to create mapped mesh without a mapped file");
+   ASSERT(numVertices == 0 || vertices, "numVertices > 0, but no vertices provided");
+   ASSERT(numNormals == 0 || normals, "numNormals > 0, but no normals provided");
+   ASSERT(numIndices == 0 || indices, "numIndices > 0, but no indices provided");
+   ASSERT(numTexCoords == 0 || texCoords, "numTexCoords > 0, but no texCoords provided");
+
+   chooseLayout();
+}
+
+Mesh::~Mesh() {
+   if (!uploaded) {
+      return;
+   }
+
+   glDeleteBuffers(1, &vbo);
+   glDeleteBuffers(1, &nbo);
+   glDeleteBuffers(1, &ibo);
+   glDeleteBuffers(1, &tbo);
+}
+
+void Mesh::chooseLayout() {
+   vertexFormat = VertexFormat::Separate;
+   vertexStride = 0;
+   indexType = GL_UNSIGNED_INT;
 
-   // Prepare the normal buffer object
-   glGenBuffers(1, &nbo);
-   glBindBuffer(GL_ARRAY_BUFFER, nbo);
-   glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 3 * numNormals, normals.get(), usage);
+   // Dynamic meshes replace each of their buffers on their own, so they keep one buffer per attribute and 32-bit indices
+   if (usage == GL_DYNAMIC_DRAW) {
+      return;
+   }
+
+   unsigned int maxIndex = 0;
+   for (unsigned int i = 0; i < numIndices; ++i) {
+      maxIndex = glm::max(maxIndex, indexData[i]);
+   }
+   if (maxIndex <= MAX_SHORT_INDEX) {
+      indexType = GL_UNSIGNED_SHORT;
+   }
+
+   // Interleaving needs exactly one normal (and texture coordinate, if there are any) per vertex
+   if (numNormals != numVertices || (numTexCoords != 0 && numTexCoords != numVertices)) {
+      return;
+   }
+
+   if (quantizationEnabled && texCoordsFitHalfFloats(texCoordData, numTexCoords)) {
+      vertexFormat = VertexFormat::Quantized;
+      vertexStride = sizeof(float) * 3 + sizeof(uint32_t) + (numTexCoords > 0 ? sizeof(uint16_t) * 2 : 0);
+   } else {
+      vertexFormat = VertexFormat::Interleaved;
+      vertexStride = sizeof(float) * (numTexCoords > 0 ? 8 : 6);
+   }
+}
+
+void Mesh::upload() {
+   if (uploaded) {
+      return;
+   }
+
+   if (vertexFormat == VertexFormat::Separate) {
+      // Prepare the vertex buffer object
+      glGenBuffers(1, &vbo);
+      glBindBuffer(GL_ARRAY_BUFFER, vbo);
+      glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 3 * numVertices, vertexData, usage);
+
+      // Prepare the normal buffer object
+      glGenBuffers(1, &nbo);
+      glBindBuffer(GL_ARRAY_BUFFER, nbo);
+      glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 3 * numNormals, normalData, usage);
+
+      // Buffer for vertex texture coordinates
+      glGenBuffers(1, &tbo);
+      glBindBuffer(GL_ARRAY_BUFFER, tbo);
+      glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 2 * numTexCoords, texCoordData, usage);
+   } else {
+      // All attributes share the vertex buffer object
+      std::vector<char> interleaved(interleave(vertexFormat, vertexStride, numVertices, vertexData, normalData, numTexCoords > 0 ? texCoordData : nullptr));
+      glGenBuffers(1, &vbo);
+      glBindBuffer(GL_ARRAY_BUFFER, vbo);
+      glBufferData(GL_ARRAY_BUFFER, interleaved.size(), interleaved.data(), usage);
+   }
 
    // Prepare the index buffer object
    glGenBuffers(1, &ibo);
    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-   glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * numIndices, indices.get(), usage);
-
-   // Buffer for vertex texture coordinates
-   glGenBuffers(1, &tbo);
-   glBindBuffer(GL_ARRAY_BUFFER, tbo);
-   glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 2 * numTexCoords, texCoords.get(), usage);
+   if (indexType == GL_UNSIGNED_SHORT) {
+      std::vector<uint16_t> shortIndices(indexData, indexData + numIndices);
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * numIndices, shortIndices.data(), usage);
+   } else {
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * numIndices, indexData, usage);
+   }
 
    // Unbind
    glBindBuffer(GL_ARRAY_BUFFER, 0);
    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-   this->vertices = std::move(vertices);
-   this->numVertices = numVertices;
-   this->indices = std::move(indices);
-   this->numIndices = numIndices;
-   hasTextureBufferObject = numTexCoords > 0;
+   // Vertices and indices are kept for physics, but normals and texture coordinates are only needed by the GPU
+   normals.reset();
+   texCoords.reset();
+   normalData = nullptr;
+   texCoordData = nullptr;
+
+   uploaded = true;
 }
 
-Mesh::~Mesh() {
-   glDeleteBuffers(1, &vbo);
-   glDeleteBuffers(1, &nbo);
-   glDeleteBuffers(1, &ibo);
-   if (hasTextureBufferObject) {
-      glDeleteBuffers(1, &tbo);
+void Mesh::setUpVertexArray() const {
+   ASSERT(uploaded, "Trying to set up vertex array for mesh that hasn't been uploaded");
+
+   switch (vertexFormat) {
+      case VertexFormat::Separate:
+         glBindBuffer(GL_ARRAY_BUFFER, vbo);
+         glEnableVertexAttribArray(ShaderAttributes::POSITION);
+         glVertexAttribPointer(ShaderAttributes::POSITION, 3, GL_FLOAT, GL_FALSE, 0, 0);
+
+         glBindBuffer(GL_ARRAY_BUFFER, nbo);
+         glEnableVertexAttribArray(ShaderAttributes::NORMAL);
+         glVertexAttribPointer(ShaderAttributes::NORMAL, 3, GL_FLOAT, GL_FALSE, 0, 0);
+
+         if (hasTextureBufferObject) {
+            glBindBuffer(GL_ARRAY_BUFFER, tbo);
+            glEnableVertexAttribArray(ShaderAttributes::TEX_COORD);
+            glVertexAttribPointer(ShaderAttributes::TEX_COORD, 2, GL_FLOAT, GL_FALSE, 0, 0);
+         }
+         break;
+      case VertexFormat::Interleaved:
+         glBindBuffer(GL_ARRAY_BUFFER, vbo);
+         glEnableVertexAttribArray(ShaderAttributes::POSITION);
+         glVertexAttribPointer(ShaderAttributes::POSITION, 3, GL_FLOAT, GL_FALSE, vertexStride, 0);
+         glEnableVertexAttribArray(ShaderAttributes::NORMAL);
+         glVertexAttribPointer(ShaderAttributes::NORMAL, 3, GL_FLOAT, GL_FALSE, vertexStride, (const GLvoid*)(sizeof(float) * 3));
+
+         if (hasTextureBufferObject) {
+            glEnableVertexAttribArray(ShaderAttributes::TEX_COORD);
+            glVertexAttribPointer(ShaderAttributes::TEX_COORD, 2, GL_FLOAT, GL_FALSE, vertexStride, (const GLvoid*)(sizeof(float) * 6));
+         }
+         break;
+      case VertexFormat::Quantized:
+         glBindBuffer(GL_ARRAY_BUFFER, vbo);
+         glEnableVertexAttribArray(ShaderAttributes::POSITION);
+         glVertexAttribPointer(ShaderAttributes::POSITION, 3, GL_FLOAT, GL_FALSE, vertexStride, 0);
+         glEnableVertexAttribArray(ShaderAttributes::NORMAL);
+         glVertexAttribPointer(ShaderAttributes::NORMAL, 4, GL_INT_2_10_10_10_REV, GL_TRUE, vertexStride, (const GLvoid*)(sizeof(float) * 3));
+
+         if (hasTextureBufferObject) {
+            glEnableVertexAttribArray(ShaderAttributes::TEX_COORD);
+            glVertexAttribPointer(ShaderAttributes::TEX_COORD, 2, GL_HALF_FLOAT, GL_FALSE, vertexStride, (const GLvoid*)(sizeof(float) * 3 + sizeof(uint32_t)));
+         }
+         break;
+   }
+
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+}
+
+std::size_t Mesh::getBufferSize() const {
+   std::size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+   if (vertexFormat == VertexFormat::Separate) {
+      return sizeof(float) * (3 * numVertices + 3 * numNormals + 2 * numTexCoords) + indexSize * numIndices;
    }
+
+   return vertexStride * numVertices + indexSize * numIndices;
+}
+
+std::size_t Mesh::getUnpackedBufferSize() const {
+   return sizeof(float) * (3 * numVertices + 3 * numNormals + 2 * numTexCoords) + sizeof(unsigned int) * numIndices;
+}
+
+std::size_t Mesh::getCpuSize() const {
+   std::size_t size = sizeof(float) * 3 * numVertices + sizeof(unsigned int) * numIndices;
+   if (normalData) {
+      size += sizeof(float) * 3 * numNormals;
+   }
+   if (texCoordData) {
+      size += sizeof(float) * 2 * numTexCoords;
+   }
+
+   return size;
 }
 
 GLuint Mesh::getTBO() const {
@@ -4,6 +4,18 @@
 #include "GLIncludes.h"
 #include "Types.h"
 
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+class MappedFile;
+
+enum class VertexFormat {
+   Separate,    // One float buffer per attribute (for meshes that replace their buffers, e.g. DynamicMesh)
+   Interleaved, // Position, normal and texture coordinates as floats in one buffer
+   Quantized    // Interleaved, with normals packed into 10 bits per component and half float texture coordinates
+};
+
 class Mesh {
 protected:
    /**
@@ -31,33 +43,159 @@ protected:
     */
    UPtr<float[]> vertices;
 
+   /**
+    * Packed array of normals, released once uploaded
+    */
+   UPtr<float[]> normals;
+
+   /**
+    * Packed array of texture coordinates, released once uploaded
+    */
+   UPtr<float[]> texCoords;
+
    /**
     * Packed array of indices
     */
    UPtr<unsigned int[]> indices;
 
+   /**
+    * Memory-mapped file that the mesh data lives in, when loaded from the mesh cache instead of owning its arrays
+    */
+   SPtr<MappedFile> mappedFile;
+
+   /**
+    * Pointers to the mesh data (into either the owned arrays or the mapped file)
+    */
+   float *vertexData;
+   float *normalData;
+   unsigned int *indexData;
+   float *texCoordData;
+
    /**
     * Number of vertices
     */
    unsigned int numVertices;
 
+   /**
+    * Number of normals
+    */
+   unsigned int numNormals;
+
    /**
     * Number of indices
     */
    unsigned int numIndices;
 
+   /**
+    * Number of texture coordinates
+    */
+   unsigned int numTexCoords;
+
+   /**
+    * Axis-aligned bounds of the vertices
+    */
+   glm::vec3 boundsMin;
+   glm::vec3 boundsMax;
+
+   /**
+    * Buffer usage hint
+    */
+   GLenum usage;
+
+   /**
+    * If the buffer objects have been created
+    */
+   bool uploaded;
+
    /**
     * If the mesh has a texture buffer object
     */
    bool hasTextureBufferObject;
 
+   /**
+    * Layout of the vertex buffer(s), chosen when the mesh is created
+    */
+   VertexFormat vertexFormat;
+
+   /**
+    * Size of each vertex in the interleaved vertex buffer (unused for separate buffers)
+    */
+   GLsizei vertexStride;
+
+   /**
+    * Type of the uploaded indices (GL_UNSIGNED_SHORT when every index fits in 16 bits)
+    */
+   GLenum indexType;
+
+   /**
+    * If meshes may use the quantized vertex format
+    */
+   static bool quantizationEnabled;
+
+   /**
+    * Chooses the vertex format and index type based on the mesh data
+    */
+   void chooseLayout();
+
 public:
    Mesh(UPtr<float[]> vertices, unsigned int numVertices, UPtr<float[]> normals, unsigned int numNormals,
         UPtr<unsigned int[]> indices, unsigned int numIndices, UPtr<float[]> texCoords, unsigned int numTexCoords,
         GLenum usage = GL_STATIC_DRAW);
 
+   /**
+    * Creates a mesh whose data lives in a memory-mapped file (with precomputed bounds), so that it can be uploaded
+    * straight from the mapping
+    */
+   Mesh(SPtr<MappedFile> mappedFile, float *vertices, unsigned int numVertices, float *normals, unsigned int numNormals,
+        unsigned int *indices, unsigned int numIndices, float *texCoords, unsigned int numTexCoords,
+        const glm::vec3 &boundsMin, const glm::vec3 &boundsMax);
+
    virtual ~Mesh();
 
+   /**
+    * Creates the buffer objects (if they haven't been already). Requires a GL context.
+    */
+   void upload();
+
+   /**
+    * Binds the buffer objects and describes their layout to the currently bound vertex array object
+    */
+   void setUpVertexArray() const;
+
+   /**
+    * Allows or disallows the quantized vertex format for meshes created afterwards (e.g. to compare rendering output)
+    */
+   static void setQuantizationEnabled(bool enabled) {
+      quantizationEnabled = enabled;
+   }
+
+   bool isUploaded() const {
+      return uploaded;
+   }
+
+   VertexFormat getVertexFormat() const {
+      return vertexFormat;
+   }
+
+   GLenum getIndexType() const {
+      return indexType;
+   }
+
+   /**
+    * Gets the size of the vertex and index buffers, in bytes
+    */
+   std::size_t getBufferSize() const;
+
+   /**
+    * Gets the size the vertex and index buffers would have as separate float buffers with 32-bit indices, in bytes
+    */
+   std::size_t getUnpackedBufferSize() const;
+
+   /**
+    * Gets the size of the mesh data kept in memory (owned or mapped), in bytes
+    */
+   std::size_t getCpuSize() const;
+
    GLuint getVBO() const {
      return vbo;
    }
@@ -81,16 +219,46 @@ public:
    }
 
    unsigned int* getIndices() const {
-      return indices.get();
+      return indexData;
    }
 
    float* getVertices() const {
-      return vertices.get();
+      return vertexData;
    }
 
    unsigned int getNumVertices() const {
       return numVertices;
    }
+
+   /**
+    * Gets the normals (null once uploaded)
+    */
+   const float* getNormals() const {
+      return normalData;
+   }
+
+   unsigned int getNumNormals() const {
+      return numNormals;
+   }
+
+   /**
+    * Gets the texture coordinates (null once uploaded)
+    */
+   const float* getTexCoords() const {
+      return texCoordData;
+   }
+
+   unsigned int getNumTexCoords() const {
+      return numTexCoords;
+   }
+
+   const glm::vec3& getBoundsMin() const {
+      return boundsMin;
+   }
+
+   const glm::vec3& getBoundsMax() const {
+      return boundsMax;
+   }
 };
 
 #endif
@@ -3,10 +3,16 @@
 #include "LogHelper.h"
 #include "Mesh.h"
 #include "MeshAssetManager.h"
+#include "MeshCache.h"
+#include "OSUtils.h"
+#include "Profiler.h"
 
 #include <tinyobj/tiny_obj_loader.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>
+#include <vector>
 
 namespace tinyobj {
 
@@ -25,6 +31,9 @@ public:
 
 namespace {
 
+const char* CACHE_DIRECTORY_NAME = "mesh_cache";
+const char* CACHE_EXTENSION = ".tgim";
+
 const char* CUBE_MESH_SOURCE = "v -0.500000 -0.500000 0.500000\nv 0.500000 -0.500000 0.500000\nv -0.500000 0.500000 0.500000\nv 0.500000 0.500000 0.500000\nv -0.500000 0.500000 -0.500000\nv 0.500000 0.500000 -0.500000\nv -0.500000 -0.500000 -0.500000\nv 0.500000 -0.500000 -0.500000\n\nvt 0.000000 0.000000\nvt 1.000000 0.000000\nvt 0.000000 1.000000\nvt 1.000000 1.000000\n\nvn 0.000000 0.000000 1.000000\nvn 0.000000 1.000000 0.000000\nvn 0.000000 0.000000 -1.000000\nvn 0.000000 -1.000000 0.000000\nvn 1.000000 0.000000 0.000000\nvn -1.000000 0.000000 0.000000\n\ns 1\nf 1/1/1 2/2/1 3/3/1\nf 3/3/1 2/2/1 4/4/1\ns 2\nf 3/1/2 4/2/2 5/3/2\nf 5/3/2 4/2/2 6/4/2\ns 3\nf 5/4/3 6/3/3 7/2/3\nf 7/2/3 6/3/3 8/1/3\ns 4\nf 7/1/4 8/2/4 1/3/4\nf 1/3/4 8/2/4 2/4/4\ns 5\nf 2/1/5 8/2/5 4/3/5\nf 4/3/5 8/2/5 6/4/5\ns 6\nf 7/1/6 1/2/6 5/3/6\nf 5/3/6 1/2/6 3/4/6\n";
 
 const char* XY_PLANE_MESH_SOURCE = "v -1.000000 -1.000000 -0.000000\nv 1.000000 -1.000000 -0.000000\nv -1.000000 1.000000 0.000000\nv 1.000000 1.000000 0.000000\nvt 1.000000 0.000000\nvt 1.000000 1.000000\nvt 0.000000 1.000000\nvt 0.000000 0.000000\nvn 0.000000 -0.000000 1.000000\ns off\nf 2/1/1 4/2/1 3/3/1\nf 1/4/1 2/1/1 3/3/1\n";
@@ -78,41 +87,218 @@ SPtr<Mesh> getMeshFromMemory(const char *data) {
    return meshFromStream(ss);
 }
 
+std::string getCacheFileName(const std::string &directory, const std::string &fileName) {
+   // Flatten the mesh's path into a single file name
+   std::string flatFileName(fileName);
+   std::replace(flatFileName.begin(), flatFileName.end(), '/', '_');
+   std::replace(flatFileName.begin(), flatFileName.end(), '\\', '_');
+
+   return directory + "/" + flatFileName + CACHE_EXTENSION;
+}
+
+std::string describeBuffers(const Mesh &mesh) {
+   static const char* FORMAT_NAMES[] = { "separate", "interleaved", "quantized" };
+
+   std::stringstream ss;
+   ss << mesh.getBufferSize() << " bytes of " << FORMAT_NAMES[static_cast<int>(mesh.getVertexFormat())] << " vertices with " << (mesh.getIndexType() == GL_UNSIGNED_SHORT ? 16 : 32) << "-bit indices (" << (mesh.getUnpackedBufferSize() - mesh.getBufferSize()) << " bytes saved)";
+   return ss.str();
+}
+
 } // namespace
 
-MeshAssetManager::MeshAssetManager() {
+MeshAssetManager::MeshAssetManager(bool useCache) {
+   if (useCache) {
+      cacheDirectory = OSUtils::createAppDataSubdirectory(CACHE_DIRECTORY_NAME);
+      if (!cacheDirectory) {
+         LOG_WARNING("Unable to create mesh cache directory");
+      }
+   }
 }
 
 MeshAssetManager::~MeshAssetManager() {
 }
 
 SPtr<Mesh> MeshAssetManager::loadMesh(const std::string &fileName) {
-   if (meshMap.count(fileName) > 0) {
-      return meshMap[fileName];
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      MeshMap::iterator itr = meshMap.find(fileName);
+      if (itr != meshMap.end()) {
+         lastUses[fileName] = std::chrono::steady_clock::now();
+         return itr->second;
+      }
    }
 
+   PROFILE_ZONE("MeshAssetManager::loadMesh", fileName);
+
    if (!IOUtils::canReadData(fileName)) {
       LOG_WARNING("Unable to load mesh from file \"" << fileName << "\", reverting to default mesh");
       return getMeshForShape(MeshShape::Cube);
    }
 
-   std::ifstream in(IOUtils::dataPath(fileName));
-   SPtr<Mesh> mesh(meshFromStream(in));
+   SPtr<Mesh> mesh(loadMeshFromFile(fileName));
 
    if (!mesh) {
       LOG_WARNING("Unable to import mesh \"" << fileName << "\", reverting to default mesh");
       return getMeshForShape(MeshShape::Cube);
    }
 
-   meshMap[fileName] = mesh;
+   // If another thread loaded the same mesh in the meantime, keep theirs so that all users share one copy
+   std::lock_guard<std::mutex> lock(mutex);
+   lastUses[fileName] = std::chrono::steady_clock::now();
+   return meshMap.emplace(fileName, mesh).first->second;
+}
+
+SPtr<Mesh> MeshAssetManager::loadMeshFromFile(const std::string &fileName) {
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+   folly::Optional<OSUtils::FileStatus> sourceStatus(IOUtils::getDataFileStatus(fileName));
+   folly::Optional<std::string> cacheFileName;
+   if (cacheDirectory && sourceStatus) {
+      cacheFileName = getCacheFileName(*cacheDirectory, fileName);
+   }
+
+   if (sourceStatus) {
+      std::lock_guard<std::mutex> lock(mutex);
+      sourceStatuses[fileName] = sourceStatus;
+   }
+
+   // Warm load: map the cache
+   if (cacheFileName) {
+      SPtr<Mesh> mesh(MeshCache::load(*cacheFileName, *sourceStatus));
+      if (mesh) {
+         LOG_INFO("Loaded mesh \"" << fileName << "\" from cache in " << (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1000.0) << " ms, " << describeBuffers(*mesh));
+         return mesh;
+      }
+   }
+
+   // Cold load: parse the OBJ, then (re)generate the cache
+   folly::Optional<IOUtils::DataFile> dataFile(IOUtils::readDataFile(fileName));
+   if (!dataFile) {
+      return nullptr;
+   }
+   std::stringstream in(std::string(dataFile->data, dataFile->size));
+   SPtr<Mesh> mesh(meshFromStream(in));
+   if (!mesh) {
+      return nullptr;
+   }
+
+   bool cached = cacheFileName && MeshCache::save(*cacheFileName, *mesh, *sourceStatus);
+   if (cacheFileName && !cached) {
+      LOG_WARNING("Unable to write mesh cache: " << *cacheFileName);
+   }
+
+   LOG_INFO("Loaded mesh \"" << fileName << "\" from OBJ in " << (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1000.0) << " ms" << (cached ? " (cache written), " : ", ") << describeBuffers(*mesh));
    return mesh;
 }
 
+int MeshAssetManager::reloadChangedMeshes() {
+   std::vector<std::string> changedFileNames;
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (const std::pair<const std::string, folly::Optional<OSUtils::FileStatus>> &entry : sourceStatuses) {
+         if (IOUtils::getDataFileStatus(entry.first) != entry.second) {
+            changedFileNames.push_back(entry.first);
+         }
+      }
+   }
+
+   int numReloaded = 0;
+   for (const std::string &fileName : changedFileNames) {
+      PROFILE_ZONE("MeshAssetManager::reloadMesh", fileName);
+
+      SPtr<Mesh> mesh(loadMeshFromFile(fileName));
+
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!mesh) {
+         // Only warn once per change (the file is probably still being written)
+         LOG_WARNING("Unable to reload mesh \"" << fileName << "\", keeping the old version");
+         sourceStatuses[fileName] = IOUtils::getDataFileStatus(fileName);
+         continue;
+      }
+
+      // Reloads run in the background, so the old mesh (and its buffers) must not be destroyed here
+      SPtr<Mesh> &cachedMesh = meshMap[fileName];
+      if (cachedMesh) {
+         replacedMeshes.push_back(cachedMesh);
+      }
+      cachedMesh = mesh;
+      ++numReloaded;
+   }
+
+   return numReloaded;
+}
+
+AssetMemoryUsage MeshAssetManager::getMemoryUsage() {
+   std::lock_guard<std::mutex> lock(mutex);
+
+   AssetMemoryUsage usage;
+   for (const std::pair<const std::string, SPtr<Mesh>> &entry : meshMap) {
+      const Mesh &mesh = *entry.second;
+      ++usage.numAssets;
+      if (entry.second.use_count() == 1) {
+         ++usage.numUnreferenced;
+      }
+      usage.cpuBytes += mesh.getCpuSize();
+      if (mesh.isUploaded()) {
+         usage.gpuBytes += mesh.getBufferSize();
+      }
+   }
+
+   return usage;
+}
+
+std::vector<EvictionCandidate> MeshAssetManager::getEvictionCandidates() {
+   std::lock_guard<std::mutex> lock(mutex);
+
+   std::vector<EvictionCandidate> candidates;
+   for (const std::pair<const std::string, SPtr<Mesh>> &entry : meshMap) {
+      if (entry.second.use_count() != 1) {
+         continue;
+      }
+
+      const Mesh &mesh = *entry.second;
+      EvictionCandidate candidate;
+      candidate.name = entry.first;
+      candidate.bytes = mesh.getCpuSize() + (mesh.isUploaded() ? mesh.getBufferSize() : 0);
+      candidate.lastUse = lastUses[entry.first];
+
+      std::string fileName(entry.first);
+      candidate.evict = [this, fileName]() {
+         std::lock_guard<std::mutex> lock(mutex);
+
+         // A background scene load may have picked the mesh up since the candidates were collected
+         MeshMap::iterator itr = meshMap.find(fileName);
+         if (itr == meshMap.end() || itr->second.use_count() != 1) {
+            return false;
+         }
+
+         meshMap.erase(itr);
+         lastUses.erase(fileName);
+         sourceStatuses.erase(fileName);
+         return true;
+      };
+
+      candidates.push_back(candidate);
+   }
+
+   return candidates;
+}
+
+void MeshAssetManager::releaseReplacedMeshes() {
+   std::lock_guard<std::mutex> lock(mutex);
+
+   replacedMeshes.erase(std::remove_if(replacedMeshes.begin(), replacedMeshes.end(), [](const SPtr<Mesh> &mesh) {
+      return mesh.use_count() == 1;
+   }), replacedMeshes.end());
+}
+
 SPtr<Mesh> MeshAssetManager::getMeshForShape(MeshShape shape) {
    static SPtr<Mesh> cubeMesh = nullptr;
    static SPtr<Mesh> xyPlaneMesh = nullptr;
    static SPtr<Mesh> openTopCubeMesh = nullptr;
 
+   std::lock_guard<std::mutex> lock(mutex);
+
    switch (shape) {
       case MeshShape::Cube:
          if (!cubeMesh) {
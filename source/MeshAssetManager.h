@@ -1,10 +1,17 @@
 #ifndef MESH_ASSET_MANAGER_H
 #define MESH_ASSET_MANAGER_H
 
+#include "AssetMemory.h"
+#include "OSUtils.h"
 #include "Types.h"
 
+#include <folly/Optional.h>
+
+#include <chrono>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 class Mesh;
 
@@ -14,12 +21,39 @@ enum class MeshShape {
    Cube, XYPlane, OpenTopCube
 };
 
+/**
+ * Thread safe, so that scenes can be loaded in the background. Meshes are parsed without holding the lock. Parsed OBJ
+ * files are written to a binary mesh cache, which later runs memory-map instead of parsing the OBJ again
+ */
 class MeshAssetManager {
 protected:
+   std::mutex mutex;
    MeshMap meshMap;
 
+   /**
+    * Status of the source file of each mesh loaded from a file, as of when it was loaded
+    */
+   std::unordered_map<std::string, folly::Optional<OSUtils::FileStatus>> sourceStatuses;
+
+   /**
+    * When each cached mesh was last requested
+    */
+   std::unordered_map<std::string, std::chrono::steady_clock::time_point> lastUses;
+
+   /**
+    * Meshes replaced by a reload, kept until releaseReplacedMeshes() so that their buffers are deleted on the main thread
+    */
+   std::vector<SPtr<Mesh>> replacedMeshes;
+
+   /**
+    * Directory that mesh cache files live in (none if the cache is disabled or can't be created)
+    */
+   folly::Optional<std::string> cacheDirectory;
+
+   SPtr<Mesh> loadMeshFromFile(const std::string &fileName);
+
 public:
-   MeshAssetManager();
+   MeshAssetManager(bool useCache = true);
 
    virtual ~MeshAssetManager();
 
@@ -32,6 +66,29 @@ public:
     * Gets a mesh with the given shape
     */
    SPtr<Mesh> getMeshForShape(MeshShape shape);
+
+   /**
+    * Reloads the meshes whose source files changed since they were loaded, returning the number reloaded. Objects that
+    * already use a mesh keep the old version (so that physics shapes built from it stay valid), while objects loaded
+    * afterwards get the new one
+    */
+   int reloadChangedMeshes();
+
+   /**
+    * Gets the memory used by the cached meshes (meshes only referenced by the cache count as unreferenced)
+    */
+   AssetMemoryUsage getMemoryUsage();
+
+   /**
+    * Gets the cached meshes that only the cache references. Must be called from the main thread, as must the
+    * candidates' evict functions (since evicting a mesh deletes its buffers)
+    */
+   std::vector<EvictionCandidate> getEvictionCandidates();
+
+   /**
+    * Releases the meshes replaced by reloads that nothing uses anymore. Must be called from the main thread
+    */
+   void releaseReplacedMeshes();
 };
 
 #endif
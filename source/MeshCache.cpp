@@ -0,0 +1,193 @@
+#include "FancyAssert.h"
+#include "LogHelper.h"
+#include "MappedFile.h"
+#include "Mesh.h"
+#include "MeshCache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace MeshCache {
+
+namespace {
+
+const char MAGIC[4] = { 'T', 'G', 'I', 'M' };
+
+// Bump whenever the layout or the OBJ import changes, so that existing caches are regenerated
+const uint32_t VERSION = 1;
+
+// Data blocks start on 16 byte boundaries (the mapping itself is page aligned)
+const uint32_t BLOCK_ALIGNMENT = 16;
+
+struct Header {
+   char magic[4];
+   uint32_t version;
+   int64_t sourceModificationTime;
+   int64_t sourceSize;
+   uint32_t numVertices;
+   uint32_t numNormals;
+   uint32_t numIndices;
+   uint32_t numTexCoords;
+   uint32_t vertexOffset;
+   uint32_t normalOffset;
+   uint32_t indexOffset;
+   uint32_t texCoordOffset;
+   float boundsMin[3];
+   float boundsMax[3];
+};
+
+static_assert(sizeof(Header) % BLOCK_ALIGNMENT == 0, "Mesh cache header must keep the data blocks aligned");
+
+uint32_t align(uint32_t offset) {
+   return (offset + BLOCK_ALIGNMENT - 1) & ~(BLOCK_ALIGNMENT - 1);
+}
+
+/**
+ * Checks that a block of count elements starts aligned at offset and ends within the file. The count is compared
+ * against the space left rather than multiplied out, so that a corrupt count can't overflow into a size that fits
+ */
+bool blockFits(uint32_t offset, uint32_t count, std::size_t elementSize, std::size_t fileSize) {
+   return offset % BLOCK_ALIGNMENT == 0 && offset <= fileSize && count <= (fileSize - offset) / elementSize;
+}
+
+/**
+ * Gets the size of a block of count elements, or false if it doesn't fit in a 32 bit offset
+ */
+bool getBlockSize(uint64_t count, std::size_t elementSize, uint32_t &size) {
+   uint64_t blockSize = count * elementSize;
+   if (blockSize > UINT32_MAX) {
+      return false;
+   }
+
+   size = static_cast<uint32_t>(blockSize);
+   return true;
+}
+
+void writeBlock(std::ofstream &out, uint32_t offset, const void *data, uint32_t size) {
+   static const char padding[BLOCK_ALIGNMENT] = {};
+
+   std::streamoff position = out.tellp();
+   ASSERT(position <= offset && offset - position < BLOCK_ALIGNMENT, "Invalid mesh cache block offset");
+   out.write(padding, offset - position);
+   if (size > 0) {
+      out.write(static_cast<const char*>(data), size);
+   }
+}
+
+} // namespace
+
+SPtr<Mesh> load(const std::string &fileName, const OSUtils::FileStatus &sourceStatus) {
+   ASSERT(!fileName.empty(), "Trying to load mesh cache from empty file name");
+
+   SPtr<MappedFile> mappedFile(MappedFile::open(fileName));
+   if (!mappedFile || mappedFile->getSize() < sizeof(Header)) {
+      return nullptr;
+   }
+
+   Header header;
+   memcpy(&header, mappedFile->getData(), sizeof(header));
+   if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+      return nullptr;
+   }
+
+   if (header.sourceModificationTime != sourceStatus.modificationTime || header.sourceSize != sourceStatus.size) {
+      LOG_DEBUG("Mesh cache " << fileName << " is stale");
+      return nullptr;
+   }
+
+   std::size_t size = mappedFile->getSize();
+   if (!blockFits(header.vertexOffset, header.numVertices, 3 * sizeof(float), size)
+      || !blockFits(header.normalOffset, header.numNormals, 3 * sizeof(float), size)
+      || !blockFits(header.indexOffset, header.numIndices, sizeof(unsigned int), size)
+      || !blockFits(header.texCoordOffset, header.numTexCoords, 2 * sizeof(float), size)) {
+      LOG_WARNING("Invalid mesh cache: " << fileName);
+      return nullptr;
+   }
+
+   char *data = mappedFile->getData();
+
+   // Physics shapes look vertices up by index on the CPU, so the indices have to stay within the vertex block too
+   const unsigned int *indices = reinterpret_cast<const unsigned int*>(data + header.indexOffset);
+   for (uint32_t i = 0; i < header.numIndices; ++i) {
+      if (indices[i] >= header.numVertices) {
+         LOG_WARNING("Invalid mesh cache (index out of range): " << fileName);
+         return nullptr;
+      }
+   }
+
+   return std::make_shared<Mesh>(mappedFile,
+                                 reinterpret_cast<float*>(data + header.vertexOffset), header.numVertices,
+                                 reinterpret_cast<float*>(data + header.normalOffset), header.numNormals,
+                                 reinterpret_cast<unsigned int*>(data + header.indexOffset), header.numIndices,
+                                 reinterpret_cast<float*>(data + header.texCoordOffset), header.numTexCoords,
+                                 glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]),
+                                 glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]));
+}
+
+bool save(const std::string &fileName, const Mesh &mesh, const OSUtils::FileStatus &sourceStatus) {
+   ASSERT(!fileName.empty(), "Trying to save mesh cache to empty file name");
+   ASSERT(!mesh.isUploaded(), "Trying to cache a mesh that has already been uploaded");
+
+   // Offsets are 32 bit, so meshes too big to address that way aren't cached
+   uint32_t vertexSize, normalSize, indexSize, texCoordSize;
+   if (!getBlockSize(mesh.getNumVertices(), 3 * sizeof(float), vertexSize)
+      || !getBlockSize(mesh.getNumNormals(), 3 * sizeof(float), normalSize)
+      || !getBlockSize(mesh.getNumIndices(), sizeof(unsigned int), indexSize)
+      || !getBlockSize(mesh.getNumTexCoords(), 2 * sizeof(float), texCoordSize)) {
+      return false;
+   }
+
+   // Each block after the first can be padded by up to BLOCK_ALIGNMENT - 1 bytes
+   uint64_t maxFileSize = static_cast<uint64_t>(sizeof(Header)) + vertexSize + normalSize + indexSize + texCoordSize
+      + 3 * BLOCK_ALIGNMENT;
+   if (maxFileSize > UINT32_MAX) {
+      return false;
+   }
+
+   Header header;
+   memcpy(header.magic, MAGIC, sizeof(MAGIC));
+   header.version = VERSION;
+   header.sourceModificationTime = sourceStatus.modificationTime;
+   header.sourceSize = sourceStatus.size;
+   header.numVertices = mesh.getNumVertices();
+   header.numNormals = mesh.getNumNormals();
+   header.numIndices = mesh.getNumIndices();
+   header.numTexCoords = mesh.getNumTexCoords();
+   header.vertexOffset = sizeof(Header);
+   header.normalOffset = align(header.vertexOffset + vertexSize);
+   header.indexOffset = align(header.normalOffset + normalSize);
+   header.texCoordOffset = align(header.indexOffset + indexSize);
+   for (int i = 0; i < 3; ++i) {
+      header.boundsMin[i] = mesh.getBoundsMin()[i];
+      header.boundsMax[i] = mesh.getBoundsMax()[i];
+   }
+
+   // Write to a temporary file first, so that other processes never map a partially written cache
+   std::string tempFileName(fileName + ".tmp");
+   {
+      std::ofstream out(tempFileName, std::ofstream::binary);
+      if (!out) {
+         return false;
+      }
+
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      writeBlock(out, header.vertexOffset, mesh.getVertices(), vertexSize);
+      writeBlock(out, header.normalOffset, mesh.getNormals(), normalSize);
+      writeBlock(out, header.indexOffset, mesh.getIndices(), indexSize);
+      writeBlock(out, header.texCoordOffset, mesh.getTexCoords(), texCoordSize);
+
+      if (!out) {
+         out.close();
+         std::remove(tempFileName.c_str());
+         return false;
+      }
+   }
+
+   // Renaming over an existing file fails on Windows
+   std::remove(fileName.c_str());
+   return std::rename(tempFileName.c_str(), fileName.c_str()) == 0;
+}
+
+} // namespace MeshCache
@@ -0,0 +1,30 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include "OSUtils.h"
+#include "Types.h"
+
+#include <string>
+
+class Mesh;
+
+/**
+ * Binary mesh cache files, which are memory-mapped and uploaded as-is instead of parsing the source OBJ file. Each file
+ * records the status of the source file it was generated from, so that stale caches are ignored
+ */
+namespace MeshCache {
+
+/**
+ * Maps the cache file with the given name, returning null if it is missing, invalid, or was generated from a source file
+ * with a different status
+ */
+SPtr<Mesh> load(const std::string &fileName, const OSUtils::FileStatus &sourceStatus);
+
+/**
+ * Writes the given (not yet uploaded) mesh to the cache file with the given name, returning true on success
+ */
+bool save(const std::string &fileName, const Mesh &mesh, const OSUtils::FileStatus &sourceStatus);
+
+} // namespace MeshCache
+
+#endif
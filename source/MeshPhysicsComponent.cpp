@@ -1,7 +1,8 @@
+#include "AssetManager.h"
+#include "Context.h"
 #include "Conversions.h"
 #include "GameObject.h"
 #include "GraphicsComponent.h"
-#include "Mesh.h"
 #include "Model.h"
 #include "MeshPhysicsComponent.h"
 #include "GameObjectMotionState.h"
@@ -14,17 +15,15 @@ MeshPhysicsComponent::MeshPhysicsComponent(GameObject &gameObject, float mass, c
 : PhysicsComponent(gameObject, collisionGroup, collisionMask) {
    SPtr<Model> model = gameObject.getGraphicsComponent().getModel();
    if (model) {
-      const Mesh &mesh = model->getMesh();
-      collisionShape = UPtr<btCollisionShape>(new btConvexHullShape(mesh.getVertices(), mesh.getNumVertices(), sizeof(float) * 3));
-
-      // TODO Handle mesh simplification
+      // Simplified, and shared with every other object with the same mesh and scale
+      mesh = model->getSharedMesh();
+      collisionShape = Context::getInstance().getAssetManager().getHullShape(mesh, gameObject.getScale());
    } else {
       // If there is no model, use a unit cube as the default collision shape
       collisionShape = UPtr<btCollisionShape>(new btBoxShape(btVector3(0.5f, 0.5f, 0.5f)));
+      collisionShape->setLocalScaling(toBt(gameObject.getScale()));
    }
 
-   collisionShape->setLocalScaling(toBt(gameObject.getScale()));
-
    motionState = UPtr<btMotionState>(new GameObjectMotionState(gameObject));
 
    btVector3 inertia(0.0f, 0.0f, 0.0f);
@@ -36,3 +35,22 @@ MeshPhysicsComponent::MeshPhysicsComponent(GameObject &gameObject, float mass, c
 
 MeshPhysicsComponent::~MeshPhysicsComponent() {
 }
+
+void MeshPhysicsComponent::onNotify(const GameObject &gameObject, Event event) {
+   if (event != Event::SCALE || !mesh) {
+      PhysicsComponent::onNotify(gameObject, event);
+      return;
+   }
+
+   // The hull is shared, so switch to the one for the new scale instead of rescaling it
+   collisionShape = Context::getInstance().getAssetManager().getHullShape(mesh, gameObject.getScale());
+
+   btRigidBody *rigidBody = static_cast<btRigidBody*>(collisionObject.get());
+   rigidBody->setCollisionShape(collisionShape.get());
+
+   btScalar mass = rigidBody->getInvMass() > 0.0f ? 1.0f / rigidBody->getInvMass() : 0.0f;
+   btVector3 inertia(0.0f, 0.0f, 0.0f);
+   collisionShape->calculateLocalInertia(mass, inertia);
+   rigidBody->setMassProps(mass, inertia);
+   rigidBody->updateInertiaTensor();
+}
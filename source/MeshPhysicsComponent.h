@@ -5,16 +5,22 @@
 
 class btCollisionShape;
 class btMotionState;
+class Mesh;
 
 // TODO Doesn't necessarily have to be a rigid body - different classes?
 class MeshPhysicsComponent : public PhysicsComponent {
 protected:
    UPtr<btMotionState> motionState;
 
+   // Mesh that the (shared) convex hull was created from, if any
+   SPtr<Mesh> mesh;
+
 public:
    MeshPhysicsComponent(GameObject &gameObject, float mass, const CollisionGroup::Group collisionGroup, const short collisionMask);
 
    virtual ~MeshPhysicsComponent();
+
+   virtual void onNotify(const GameObject &gameObject, Event event);
 };
 
 #endif
@@ -1,50 +1,78 @@
 #include "Model.h"
 
+#include "Context.h"
+#include "DrawStateCache.h"
+#include "FancyAssert.h"
 #include "Material.h"
 #include "Mesh.h"
 #include "RenderData.h"
 #include "ShaderProgram.h"
 
+#include <cstddef>
 #include <string>
 
+namespace {
+
+const UniformID INSTANCED_UNIFORM = ShaderProgram::getUniformID("uInstanced");
+
+} // namespace
+
 Model::Model(SPtr<ShaderProgram> shaderProgram, SPtr<Mesh> mesh)
-   : shaderProgram(shaderProgram), mesh(mesh) {
-   glGenVertexArrays(1, &vao);
-   glBindVertexArray(vao);
+   : shaderProgram(shaderProgram), mesh(mesh), vao(0), instanceBuffer(0) {
+}
 
-   // Prepare the vertex buffer object
-   glBindBuffer(GL_ARRAY_BUFFER, mesh->getVBO());
-   glEnableVertexAttribArray(ShaderAttributes::POSITION);
-   glVertexAttribPointer(ShaderAttributes::POSITION, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-   // Prepare the normal buffer object
-   glBindBuffer(GL_ARRAY_BUFFER, mesh->getNBO());
-   glEnableVertexAttribArray(ShaderAttributes::NORMAL);
-   glVertexAttribPointer(ShaderAttributes::NORMAL, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-   if (mesh->hasTBO()) {
-      // Prepare the texture buffer object
-      glBindBuffer(GL_ARRAY_BUFFER, mesh->getTBO());
-      glEnableVertexAttribArray(ShaderAttributes::TEX_COORD);
-      glVertexAttribPointer(ShaderAttributes::TEX_COORD, 2, GL_FLOAT, GL_FALSE, 0, 0);
+Model::~Model() {
+   if (vao) {
+      glDeleteVertexArrays(1, &vao);
    }
 
-   // Prepare the index buffer object
-   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->getIBO());
+   if (instanceBuffer) {
+      glDeleteBuffers(1, &instanceBuffer);
+   }
+}
+
+void Model::prepareVertexArray() {
+   mesh->upload();
+
+   glGenVertexArrays(1, &vao);
+   glBindVertexArray(vao);
+
+   mesh->setUpVertexArray();
 
    glBindVertexArray(0);
 }
 
-Model::~Model() {
-   glDeleteVertexArrays(1, &vao);
+void Model::prepareInstanceBuffer() {
+   glGenBuffers(1, &instanceBuffer);
+   glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+   for (GLuint column = 0; column < 4; ++column) {
+      GLuint modelMatrixLocation = ShaderAttributes::INSTANCE_MODEL_MATRIX + column;
+      glEnableVertexAttribArray(modelMatrixLocation);
+      glVertexAttribPointer(modelMatrixLocation, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceTransform), (const GLvoid*)(offsetof(InstanceTransform, modelMatrix) + sizeof(glm::vec4) * column));
+      glVertexAttribDivisor(modelMatrixLocation, 1);
+
+      GLuint normalMatrixLocation = ShaderAttributes::INSTANCE_NORMAL_MATRIX + column;
+      glEnableVertexAttribArray(normalMatrixLocation);
+      glVertexAttribPointer(normalMatrixLocation, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceTransform), (const GLvoid*)(offsetof(InstanceTransform, normalMatrix) + sizeof(glm::vec4) * column));
+      glVertexAttribDivisor(normalMatrixLocation, 1);
+   }
 }
 
 void Model::draw(const RenderData &renderData) {
+   DrawStateCache &stateCache = Context::getInstance().getDrawStateCache();
+
+   if (!vao) {
+      // Uploading binds the mesh's index buffer, which must not end up in the vertex array left bound by the last draw
+      stateCache.bindVertexArray(0);
+      prepareVertexArray();
+   }
+
    SPtr<ShaderProgram> overrideProgram = renderData.getOverrideProgram();
    SPtr<ShaderProgram> program = overrideProgram ? overrideProgram : shaderProgram;
 
    // Bind
-   glBindVertexArray(vao);
+   stateCache.bindVertexArray(vao);
 
    if (!overrideProgram) {
       // Apply the material properties
@@ -53,10 +81,11 @@ void Model::draw(const RenderData &renderData) {
       }
    }
 
-   program->commit();
+   stateCache.useProgram(*program);
 
    // Draw
-   glDrawElements(GL_TRIANGLES, mesh->getNumIndices(), GL_UNSIGNED_INT, 0);
+   glDrawElements(GL_TRIANGLES, mesh->getNumIndices(), mesh->getIndexType(), 0);
+   stateCache.countDraw();
 
    if (!overrideProgram) {
       // Disable the material properties
@@ -66,7 +95,77 @@ void Model::draw(const RenderData &renderData) {
    }
 
    // Unbind
-   glBindVertexArray(0);
+   stateCache.unbindVertexArray();
+}
+
+void Model::drawInstanced(const RenderData &renderData, const std::vector<InstanceTransform> &instances) {
+   ASSERT(supportsInstancing(renderData), "Trying to draw instances with a program that doesn't support instancing");
+
+   DrawStateCache &stateCache = Context::getInstance().getDrawStateCache();
+
+   if (!vao) {
+      stateCache.bindVertexArray(0);
+      prepareVertexArray();
+   }
+
+   SPtr<ShaderProgram> overrideProgram = renderData.getOverrideProgram();
+   SPtr<ShaderProgram> program = overrideProgram ? overrideProgram : shaderProgram;
+
+   // Bind
+   stateCache.bindVertexArray(vao);
+
+   if (!instanceBuffer) {
+      prepareInstanceBuffer();
+   }
+
+   // Respecifying the whole buffer lets the driver hand out new storage instead of waiting for earlier draws from it
+   glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+   glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(InstanceTransform), instances.data(), GL_STREAM_DRAW);
+
+   if (!overrideProgram) {
+      // Apply the material properties
+      for (SPtr<Material> material : materials) {
+         material->apply(*program);
+      }
+   }
+
+   program->setUniformValue(INSTANCED_UNIFORM, true);
+   stateCache.useProgram(*program);
+
+   // Draw
+   glDrawElementsInstanced(GL_TRIANGLES, mesh->getNumIndices(), mesh->getIndexType(), 0, static_cast<GLsizei>(instances.size()));
+   stateCache.countInstancedDraw(static_cast<long>(instances.size()));
+
+   // Only committed if the next draw with the program isn't instanced too
+   program->setUniformValue(INSTANCED_UNIFORM, false);
+
+   if (!overrideProgram) {
+      // Disable the material properties
+      for (SPtr<Material> material : materials) {
+         material->disable();
+      }
+   }
+
+   // Unbind
+   stateCache.unbindVertexArray();
+}
+
+bool Model::supportsInstancing(const RenderData &renderData) const {
+   SPtr<ShaderProgram> overrideProgram = renderData.getOverrideProgram();
+   return (overrideProgram ? overrideProgram : shaderProgram)->hasUniform(INSTANCED_UNIFORM);
+}
+
+bool Model::canShareInstancedDraw(const Model &other, const RenderData &renderData) const {
+   if (&other == this) {
+      return true;
+   }
+
+   if (other.mesh != mesh) {
+      return false;
+   }
+
+   // Materials aren't applied when drawing with an override program
+   return renderData.getOverrideProgram() || (other.shaderProgram == shaderProgram && other.materials == materials);
 }
 
 void Model::attachMaterial(SPtr<Material> material) {
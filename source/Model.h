@@ -4,6 +4,8 @@
 #include "GLIncludes.h"
 #include "Types.h"
 
+#include <glm/glm.hpp>
+
 #include <vector>
 
 class Material;
@@ -11,6 +13,14 @@ class Mesh;
 class RenderData;
 class ShaderProgram;
 
+/**
+ * Transforms of one instance in an instanced draw, as laid out in the instance buffer
+ */
+struct InstanceTransform {
+   glm::mat4 modelMatrix;
+   glm::mat4 normalMatrix;
+};
+
 class Model {
 protected:
    std::vector<SPtr<Material>> materials;
@@ -20,6 +30,15 @@ protected:
    // Vertex array object
    GLuint vao;
 
+   // Buffer of instance transforms, refilled for every instanced draw (created by the first one)
+   GLuint instanceBuffer;
+
+   // Creates the vertex array object (deferred until the first draw, so models can be built without a GL context)
+   void prepareVertexArray();
+
+   // Creates the instance buffer, and adds its attributes to the (bound) vertex array
+   void prepareInstanceBuffer();
+
 public:
    Model(SPtr<ShaderProgram> shaderProgram, SPtr<Mesh> mesh);
 
@@ -27,12 +46,36 @@ public:
 
    virtual void draw(const RenderData &renderData);
 
+   /**
+    * Draws the model once for each of the given transforms, with a single draw call
+    */
+   void drawInstanced(const RenderData &renderData, const std::vector<InstanceTransform> &instances);
+
+   /**
+    * Returns whether the program the model would be drawn with can draw instances
+    */
+   bool supportsInstancing(const RenderData &renderData) const;
+
+   /**
+    * Returns whether the other model draws the same mesh with the same state, so that both can be drawn in one
+    * instanced draw
+    */
+   bool canShareInstancedDraw(const Model &other, const RenderData &renderData) const;
+
    void attachMaterial(SPtr<Material> material);
 
    void clearMaterials();
 
+   const std::vector<SPtr<Material>>& getMaterials() const {
+      return materials;
+   }
+
    const Mesh& getMesh() const;
 
+   const SPtr<Mesh>& getSharedMesh() const {
+      return mesh;
+   }
+
    const SPtr<ShaderProgram> getShaderProgram() const;
 };
 
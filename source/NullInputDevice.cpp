@@ -0,0 +1,13 @@
+#include "NullInputDevice.h"
+
+NullInputDevice::NullInputDevice()
+   : InputDevice(nullptr) {
+}
+
+NullInputDevice::~NullInputDevice() {
+}
+
+InputValues NullInputDevice::getInputValues() {
+   InputValues inputValues = { 0 };
+   return inputValues;
+}
@@ -0,0 +1,18 @@
+#ifndef NULL_INPUT_DEVICE_H
+#define NULL_INPUT_DEVICE_H
+
+#include "InputDevice.h"
+
+/**
+ * Input device that never produces any input, used when running without a window
+ */
+class NullInputDevice : public InputDevice {
+public:
+   NullInputDevice();
+
+   virtual ~NullInputDevice();
+
+   virtual InputValues getInputValues();
+};
+
+#endif
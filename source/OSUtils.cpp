@@ -3,6 +3,7 @@
 
 #ifdef __APPLE__
 #include <CoreServices/CoreServices.h>
+#include <dirent.h>
 #include <mach-o/dyld.h>
 #include <stdlib.h>
 #include <sys/param.h>
@@ -13,6 +14,7 @@
 
 #ifdef __linux__
 #include <cstring>
+#include <dirent.h>
 #include <limits.h>
 #include <pwd.h>
 #include <stdlib.h>
@@ -108,10 +110,40 @@ bool setWorkingDirectory(const std::string &dir) {
 }
 
 bool createDirectory(const std::string &dir) {
-   return false;
+   return mkdir(dir.c_str(), 0755) == 0;
 }
 #endif // __linux__
 
+#if defined(__APPLE__) || defined(__linux__)
+void listFiles(const std::string &dir, const std::string &prefix, std::vector<std::string> &files) {
+   DIR *directory = opendir(dir.c_str());
+   if (!directory) {
+      return;
+   }
+
+   while (struct dirent *entry = readdir(directory)) {
+      std::string name(entry->d_name);
+      if (name == "." || name == "..") {
+         continue;
+      }
+
+      std::string path(dir + "/" + name);
+      struct stat info;
+      if (stat(path.c_str(), &info) != 0) {
+         continue;
+      }
+
+      if (S_ISDIR(info.st_mode)) {
+         listFiles(path, prefix + name + "/", files);
+      } else if (S_ISREG(info.st_mode)) {
+         files.push_back(prefix + name);
+      }
+   }
+
+   closedir(directory);
+}
+#endif // defined(__APPLE__) || defined(__linux__)
+
 #ifdef _WIN32
 folly::Optional<std::string> getExecutablePath() {
    TCHAR buffer[MAX_PATH + 1];
@@ -157,6 +189,29 @@ bool setWorkingDirectory(const std::string &dir) {
 bool createDirectory(const std::string &dir) {
    return CreateDirectory(dir.c_str(), nullptr);
 }
+
+void listFiles(const std::string &dir, const std::string &prefix, std::vector<std::string> &files) {
+   WIN32_FIND_DATA findData;
+   HANDLE findHandle = FindFirstFile((dir + "/*").c_str(), &findData);
+   if (findHandle == INVALID_HANDLE_VALUE) {
+      return;
+   }
+
+   do {
+      std::string name(findData.cFileName);
+      if (name == "." || name == "..") {
+         continue;
+      }
+
+      if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+         listFiles(dir + "/" + name, prefix + name + "/", files);
+      } else {
+         files.push_back(prefix + name);
+      }
+   } while (FindNextFile(findHandle, &findData));
+
+   FindClose(findHandle);
+}
 #endif // _WIN32
 
 bool createAppDataDirectory() {
@@ -173,6 +228,24 @@ bool createAppDataDirectory() {
    return createDirectory(*appDataPath);
 }
 
+folly::Optional<std::string> createAppDataSubdirectory(const std::string &name) {
+   if (!createAppDataDirectory()) {
+      return folly::none;
+   }
+
+   folly::Optional<std::string> appDataPath(getAppDataPath());
+   if (!appDataPath) {
+      return folly::none;
+   }
+
+   std::string directory(*appDataPath + "/" + name);
+   if (!directoryExists(directory) && !createDirectory(directory)) {
+      return folly::none;
+   }
+
+   return directory;
+}
+
 folly::Optional<std::string> getDirectoryFromPath(const std::string &path) {
    size_t pos = path.find_last_of("/\\");
    if (pos == std::string::npos) {
@@ -210,4 +283,23 @@ bool directoryExists(const std::string &dir) {
    return (info.st_mode & S_IFDIR) != 0;
 }
 
+folly::Optional<FileStatus> getFileStatus(const std::string &path) {
+   struct stat info;
+
+   if (stat(path.c_str(), &info) != 0) {
+      return folly::none;
+   }
+
+   FileStatus status;
+   status.modificationTime = static_cast<int64_t>(info.st_mtime);
+   status.size = static_cast<int64_t>(info.st_size);
+   return status;
+}
+
+std::vector<std::string> listFiles(const std::string &dir) {
+   std::vector<std::string> files;
+   listFiles(dir, "", files);
+   return files;
+}
+
 } // namespace OSUtils
@@ -3,10 +3,25 @@
 
 #include <folly/Optional.h>
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace OSUtils {
 
+struct FileStatus {
+   int64_t modificationTime;
+   int64_t size;
+
+   bool operator==(const FileStatus &other) const {
+      return modificationTime == other.modificationTime && size == other.size;
+   }
+
+   bool operator!=(const FileStatus &other) const {
+      return !(*this == other);
+   }
+};
+
 /**
  * Gets the path to the running executable
  */
@@ -38,6 +53,21 @@ bool createDirectory(const std::string &dir);
 
 bool createAppDataDirectory();
 
+/**
+ * Creates (if needed) the directory with the given name inside the app data directory, returning its path on success
+ */
+folly::Optional<std::string> createAppDataSubdirectory(const std::string &name);
+
+/**
+ * Gets the modification time and size of the file at the given path (none if it doesn't exist)
+ */
+folly::Optional<FileStatus> getFileStatus(const std::string &path);
+
+/**
+ * Lists the files in the given directory and all of its subdirectories, as paths relative to it (separated by '/')
+ */
+std::vector<std::string> listFiles(const std::string &dir);
+
 } // namespace OSUtils
 
 #endif
@@ -6,6 +6,16 @@
 
 #include <string>
 
+namespace {
+
+const UniformID AMBIENT_UNIFORM = ShaderProgram::getUniformID("uMaterial.ambient");
+const UniformID DIFFUSE_UNIFORM = ShaderProgram::getUniformID("uMaterial.diffuse");
+const UniformID SPECULAR_UNIFORM = ShaderProgram::getUniformID("uMaterial.specular");
+const UniformID EMISSION_UNIFORM = ShaderProgram::getUniformID("uMaterial.emission");
+const UniformID SHININESS_UNIFORM = ShaderProgram::getUniformID("uMaterial.shininess");
+
+} // namespace
+
 PhongMaterial::PhongMaterial(const glm::vec3 &ambient,
               const glm::vec3 &diffuse,
               const glm::vec3 &specular,
@@ -18,11 +28,11 @@ PhongMaterial::~PhongMaterial() {
 }
 
 void PhongMaterial::apply(ShaderProgram &shaderProgram) {
-   shaderProgram.setUniformValue("uMaterial.ambient", ambient);
-   shaderProgram.setUniformValue("uMaterial.diffuse", diffuse);
-   shaderProgram.setUniformValue("uMaterial.specular", specular);
-   shaderProgram.setUniformValue("uMaterial.emission", emission);
-   shaderProgram.setUniformValue("uMaterial.shininess", shininess);
+   shaderProgram.setUniformValue(AMBIENT_UNIFORM, ambient);
+   shaderProgram.setUniformValue(DIFFUSE_UNIFORM, diffuse);
+   shaderProgram.setUniformValue(SPECULAR_UNIFORM, specular);
+   shaderProgram.setUniformValue(EMISSION_UNIFORM, emission);
+   shaderProgram.setUniformValue(SHININESS_UNIFORM, shininess);
 }
 
 void PhongMaterial::disable() {
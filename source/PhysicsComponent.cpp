@@ -8,7 +8,7 @@
 #include <bullet/btBulletDynamicsCommon.h>
 
 PhysicsComponent::PhysicsComponent(GameObject &gameObject, const CollisionGroup::Group collisionGroup, const short collisionMask)
-   : Component(gameObject), collisionGroup(collisionGroup), collisionMask(collisionMask) {
+   : Component(gameObject), collisionGroup(collisionGroup), collisionMask(collisionMask), enabled(true) {
 }
 
 PhysicsComponent::~PhysicsComponent() {
@@ -63,6 +63,57 @@ void PhysicsComponent::removeFromManager(SPtr<PhysicsManager> manager) {
    physicsManagers.erase(manager);
 }
 
+void PhysicsComponent::setEnabled(bool enabled) {
+   if (!collisionObject || this->enabled == enabled) {
+      return;
+   }
+   this->enabled = enabled;
+
+   btBroadphaseProxy *proxy = collisionObject->getBroadphaseHandle();
+   btRigidBody *rigidBody = dynamic_cast<btRigidBody*>(collisionObject.get());
+
+   if (!enabled) {
+      // Filter out all collisions rather than removing the proxy from the broadphase, and drop the existing pairs
+      if (proxy) {
+         proxy->m_collisionFilterGroup = CollisionGroup::Nothing;
+         proxy->m_collisionFilterMask = CollisionGroup::Nothing;
+      }
+
+      for (const WPtr<PhysicsManager> &wManager : physicsManagers) {
+         SPtr<PhysicsManager> manager = wManager.lock();
+         if (manager && proxy) {
+            btCollisionWorld &world = manager->getDynamicsWorld();
+            world.getBroadphase()->getOverlappingPairCache()->removeOverlappingPairsContainingProxy(proxy, world.getDispatcher());
+         }
+      }
+
+      if (rigidBody) {
+         rigidBody->setLinearVelocity(btVector3(0.0f, 0.0f, 0.0f));
+         rigidBody->setAngularVelocity(btVector3(0.0f, 0.0f, 0.0f));
+         rigidBody->clearForces();
+      }
+      collisionObject->forceActivationState(DISABLE_SIMULATION);
+
+      return;
+   }
+
+   if (proxy) {
+      proxy->m_collisionFilterGroup = collisionGroup;
+      proxy->m_collisionFilterMask = collisionMask;
+   }
+
+   btTransform transform(toBt(gameObject.getOrientation()), toBt(gameObject.getPosition()));
+   collisionObject->setWorldTransform(transform);
+   collisionObject->setInterpolationWorldTransform(transform);
+   if (rigidBody) {
+      rigidBody->setCenterOfMassTransform(transform);
+   }
+
+   // Forces applied while disabled are kept, so they can be set up before the object is enabled
+   collisionObject->forceActivationState(ACTIVE_TAG);
+   collisionObject->activate(true);
+}
+
 void PhysicsComponent::onNotify(const GameObject &gameObject, Event event) {
    switch (event) {
       case Event::SCALE: {
@@ -92,6 +143,14 @@ AABB PhysicsComponent::getAABB() const {
    return aabb;
 }
 
+void PhysicsComponent::snapshot() {
+   if (collisionObject && collisionShape) {
+      renderAABB = getAABB();
+   } else {
+      renderAABB = folly::none;
+   }
+}
+
 NullPhysicsComponent::NullPhysicsComponent(GameObject &gameObject)
    : PhysicsComponent(gameObject, CollisionGroup::Nothing, CollisionGroup::Nothing) {
 }
@@ -4,6 +4,7 @@
 #include "Component.h"
 #include "Observer.h"
 
+#include <folly/Optional.h>
 #include <glm/glm.hpp>
 
 #include <set>
@@ -53,8 +54,13 @@ protected:
    const CollisionGroup::Group collisionGroup;
    const short collisionMask;
    UPtr<btCollisionObject> collisionObject;
-   UPtr<btCollisionShape> collisionShape;
+   // Shared, since shapes can come from the physics shape cache
+   SPtr<btCollisionShape> collisionShape;
    std::set<WPtr<PhysicsManager>, std::owner_less<WPtr<PhysicsManager>>> physicsManagers;
+   bool enabled;
+
+   // Bounding box as of the last snapshot (none if there is no collision object)
+   folly::Optional<AABB> renderAABB;
 
 public:
    PhysicsComponent(GameObject &gameObject, const CollisionGroup::Group collisionGroup, const short collisionMask);
@@ -79,9 +85,29 @@ public:
 
    virtual void removeFromManager(SPtr<PhysicsManager> manager);
 
+   bool isInManager(SPtr<PhysicsManager> manager) const {
+      return physicsManagers.count(manager) > 0;
+   }
+
+   bool isEnabled() const {
+      return enabled;
+   }
+
+   /**
+    * Disabling keeps the collision object in its physics managers, but stops it from colliding or being simulated (and
+    * drops any contacts it had). Enabling moves it to its game object's current transform and wakes it up
+    */
+   virtual void setEnabled(bool enabled);
+
    virtual void onNotify(const GameObject &gameObject, Event event);
 
    virtual AABB getAABB() const;
+
+   virtual void snapshot();
+
+   const folly::Optional<AABB>& getRenderAABB() const {
+      return renderAABB;
+   }
 };
 
 class NullPhysicsComponent : public PhysicsComponent {
@@ -2,6 +2,7 @@
 #include "GameObject.h"
 #include "PhysicsComponent.h"
 #include "PhysicsManager.h"
+#include "Profiler.h"
 
 #include <bullet/btBulletDynamicsCommon.h>
 #include <bullet/BulletCollision/CollisionDispatch/btGhostObject.h>
@@ -49,6 +50,7 @@ void PhysicsManager::debugDraw() {
 }
 
 void PhysicsManager::tick(const float dt) {
+   PROFILE_ZONE("PhysicsManager::tick");
    dynamicsWorld->stepSimulation(dt, 15);
 }
 
@@ -0,0 +1,442 @@
+#include "Conversions.h"
+#include "FancyAssert.h"
+#include "LogHelper.h"
+#include "MappedFile.h"
+#include "Mesh.h"
+#include "OSUtils.h"
+#include "PhysicsShapeCache.h"
+
+#include <bullet/btBulletDynamicsCommon.h>
+#include <bullet/BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
+#include <bullet/BulletCollision/CollisionShapes/btOptimizedBvh.h>
+#include <bullet/BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h>
+#include <bullet/BulletCollision/CollisionShapes/btShapeHull.h>
+#include <bullet/BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <tuple>
+#include <unordered_set>
+
+namespace {
+
+const char* BVH_DIRECTORY_NAME = "bvh_cache";
+const char* BVH_EXTENSION = ".bvh";
+
+const char MAGIC[4] = { 'T', 'G', 'I', 'B' };
+const uint32_t VERSION = 1;
+
+struct Header {
+   char magic[4];
+   uint32_t version;
+   uint32_t bulletVersion;
+   uint32_t pointerSize;
+   uint64_t meshHash;
+   uint32_t bvhSize;
+   uint32_t padding;
+};
+
+// Largest distance that a mesh vertex may end up outside of its simplified hull, relative to the mesh's size
+const float MAX_HULL_ERROR = 0.02f;
+
+// BVHs are deserialized in place, which needs them to be 16 byte aligned (the mapping itself is page aligned)
+static_assert(sizeof(Header) % 16 == 0, "BVH file header must keep the BVH aligned");
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+   return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+uint64_t hashBytes(uint64_t hash, const void *data, std::size_t size) {
+   // FNV-1a
+   const unsigned char *bytes = static_cast<const unsigned char*>(data);
+   for (std::size_t i = 0; i < size; ++i) {
+      hash = (hash ^ bytes[i]) * 1099511628211ULL;
+   }
+
+   return hash;
+}
+
+/**
+ * Identifies a BVH file by the triangles it was built from, so that a changed mesh never uses an old BVH
+ */
+uint64_t hashMesh(const Mesh &mesh) {
+   uint64_t hash = 14695981039346656037ULL;
+   hash = hashBytes(hash, mesh.getVertices(), sizeof(float) * 3 * mesh.getNumVertices());
+   hash = hashBytes(hash, mesh.getIndices(), sizeof(unsigned int) * mesh.getNumIndices());
+   return hash;
+}
+
+std::string getBvhFileName(const std::string &directory, uint64_t meshHash) {
+   std::stringstream ss;
+   ss << directory << "/" << std::hex << std::setw(16) << std::setfill('0') << meshHash << BVH_EXTENSION;
+   return ss.str();
+}
+
+/**
+ * Maps the BVH file with the given name and deserializes the BVH in place, returning null if it is missing or doesn't
+ * match the mesh / Bullet build
+ */
+btOptimizedBvh* loadBvh(const std::string &fileName, uint64_t meshHash, SPtr<MappedFile> &bvhFile) {
+   SPtr<MappedFile> file(MappedFile::open(fileName));
+   if (!file || file->getSize() < sizeof(Header)) {
+      return nullptr;
+   }
+
+   Header header;
+   memcpy(&header, file->getData(), sizeof(header));
+   if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.bulletVersion != BT_BULLET_VERSION
+      || header.pointerSize != sizeof(void*) || header.meshHash != meshHash || file->getSize() != sizeof(Header) + header.bvhSize) {
+      return nullptr;
+   }
+
+   btOptimizedBvh *bvh = btOptimizedBvh::deSerializeInPlace(file->getData() + sizeof(Header), header.bvhSize, false);
+   if (bvh) {
+      bvhFile = file;
+   }
+
+   return bvh;
+}
+
+bool saveBvh(const std::string &fileName, uint64_t meshHash, const btOptimizedBvh &bvh) {
+   unsigned int bvhSize = bvh.calculateSerializeBufferSize();
+   void *buffer = btAlignedAlloc(bvhSize, 16);
+   bool serialized = bvh.serializeInPlace(buffer, bvhSize, false);
+
+   Header header;
+   memcpy(header.magic, MAGIC, sizeof(MAGIC));
+   header.version = VERSION;
+   header.bulletVersion = BT_BULLET_VERSION;
+   header.pointerSize = sizeof(void*);
+   header.meshHash = meshHash;
+   header.bvhSize = bvhSize;
+   header.padding = 0;
+
+   // Write to a temporary file first, so that other processes never map a partially written BVH
+   std::string tempFileName(fileName + ".tmp");
+   bool written = false;
+   if (serialized) {
+      std::ofstream out(tempFileName, std::ofstream::binary);
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      out.write(static_cast<const char*>(buffer), bvhSize);
+      written = !!out;
+   }
+   btAlignedFree(buffer);
+
+   if (!written) {
+      std::remove(tempFileName.c_str());
+      return false;
+   }
+
+   // Renaming over an existing file fails on Windows
+   std::remove(fileName.c_str());
+   return std::rename(tempFileName.c_str(), fileName.c_str()) == 0;
+}
+
+/**
+ * Gets the largest distance that any of the mesh's vertices lies outside of the given hull (measured against the planes
+ * of the hull's faces)
+ */
+float getHullError(const Mesh &mesh, const btShapeHull &hull) {
+   const btVector3 *hullVertices = hull.getVertexPointer();
+   const unsigned int *hullIndices = hull.getIndexPointer();
+
+   btVector3 centroid(0.0f, 0.0f, 0.0f);
+   for (int i = 0; i < hull.numVertices(); ++i) {
+      centroid += hullVertices[i];
+   }
+   centroid /= static_cast<btScalar>(hull.numVertices());
+
+   float error = 0.0f;
+   for (int i = 0; i < hull.numTriangles(); ++i) {
+      const btVector3 &a = hullVertices[hullIndices[i * 3]];
+      const btVector3 &b = hullVertices[hullIndices[i * 3 + 1]];
+      const btVector3 &c = hullVertices[hullIndices[i * 3 + 2]];
+
+      btVector3 normal = (b - a).cross(c - a);
+      if (normal.length2() < SIMD_EPSILON) {
+         continue;
+      }
+      normal.normalize();
+      if (normal.dot(a - centroid) < 0.0f) {
+         normal = -normal;
+      }
+
+      const float *vertices = mesh.getVertices();
+      for (unsigned int j = 0; j < mesh.getNumVertices(); ++j) {
+         btVector3 vertex(vertices[j * 3], vertices[j * 3 + 1], vertices[j * 3 + 2]);
+         error = glm::max(error, static_cast<float>(normal.dot(vertex - a)));
+      }
+   }
+
+   return error;
+}
+
+/**
+ * Reduces the mesh's vertices to the points of a simplified convex hull (sampled in a fixed set of directions by
+ * btShapeHull). If the simplified hull is too far off, every vertex of the mesh is used instead
+ */
+std::vector<float> simplifyHull(const Mesh &mesh) {
+   std::vector<float> allPoints(mesh.getVertices(), mesh.getVertices() + mesh.getNumVertices() * 3);
+
+   btConvexHullShape sourceShape(mesh.getVertices(), mesh.getNumVertices(), sizeof(float) * 3);
+   btShapeHull hull(&sourceShape);
+   if (!hull.buildHull(sourceShape.getMargin()) || hull.numVertices() == 0 || hull.numVertices() >= static_cast<int>(mesh.getNumVertices())) {
+      return allPoints;
+   }
+
+   float size = glm::length(mesh.getBoundsMax() - mesh.getBoundsMin());
+   float error = getHullError(mesh, hull);
+   if (error > MAX_HULL_ERROR * size) {
+      LOG_DEBUG("Not simplifying convex hull of " << mesh.getNumVertices() << " points, error of " << error << " is too large");
+      return allPoints;
+   }
+
+   std::vector<float> points;
+   points.reserve(hull.numVertices() * 3);
+   for (int i = 0; i < hull.numVertices(); ++i) {
+      const btVector3 &point = hull.getVertexPointer()[i];
+      points.push_back(point.x());
+      points.push_back(point.y());
+      points.push_back(point.z());
+   }
+
+   LOG_DEBUG("Simplified convex hull from " << mesh.getNumVertices() << " to " << hull.numVertices() << " points (error " << error << ")");
+   return points;
+}
+
+} // namespace
+
+PhysicsShapeCache::BvhData::BvhData()
+   : bvhSize(0), loadedFromDisk(false), buildTime(0.0) {
+}
+
+PhysicsShapeCache::BvhData::~BvhData() {
+}
+
+bool PhysicsShapeCache::HullKey::operator<(const HullKey &other) const {
+   return std::tie(mesh, scale.x, scale.y, scale.z) < std::tie(other.mesh, other.scale.x, other.scale.y, other.scale.z);
+}
+
+PhysicsShapeCache::PhysicsShapeCache(bool storeBvhs, bool simplifyHulls)
+   : simplifyHulls(simplifyHulls) {
+   if (storeBvhs) {
+      bvhDirectory = OSUtils::createAppDataSubdirectory(BVH_DIRECTORY_NAME);
+      if (!bvhDirectory) {
+         LOG_WARNING("Unable to create BVH cache directory");
+      }
+   }
+}
+
+PhysicsShapeCache::~PhysicsShapeCache() {
+}
+
+SPtr<PhysicsShapeCache::BvhData> PhysicsShapeCache::createBvh(const SPtr<Mesh> &mesh) {
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+   SPtr<BvhData> data(std::make_shared<BvhData>());
+   data->mesh = mesh;
+   data->triangles = UPtr<btTriangleIndexVertexArray>(new btTriangleIndexVertexArray(mesh->getNumIndices() / 3, (int*)mesh->getIndices(), 3 * sizeof(unsigned int), mesh->getNumVertices(), mesh->getVertices(), 3 * sizeof(float)));
+
+   uint64_t meshHash = 0;
+   folly::Optional<std::string> fileName;
+   if (bvhDirectory) {
+      meshHash = hashMesh(*mesh);
+      fileName = getBvhFileName(*bvhDirectory, meshHash);
+   }
+
+   btOptimizedBvh *bvh = fileName ? loadBvh(*fileName, meshHash, data->bvhFile) : nullptr;
+   if (bvh) {
+      data->shape = UPtr<btBvhTriangleMeshShape>(new btBvhTriangleMeshShape(data->triangles.get(), true, false));
+      data->shape->setOptimizedBvh(bvh);
+      data->loadedFromDisk = true;
+   } else {
+      data->shape = UPtr<btBvhTriangleMeshShape>(new btBvhTriangleMeshShape(data->triangles.get(), true, true));
+      if (fileName && !saveBvh(*fileName, meshHash, *data->shape->getOptimizedBvh())) {
+         LOG_WARNING("Unable to write BVH: " << *fileName);
+      }
+   }
+
+   data->bvhSize = data->shape->getOptimizedBvh()->calculateSerializeBufferSize();
+   data->buildTime = secondsSince(start);
+
+   return data;
+}
+
+SPtr<btCollisionShape> PhysicsShapeCache::getBvhShape(const SPtr<Mesh> &mesh, const glm::vec3 &scale) {
+   ASSERT(mesh, "Trying to get BVH shape for null mesh");
+
+   SPtr<BvhData> data;
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++stats.numRequests;
+
+      std::unordered_map<const Mesh*, SPtr<BvhData>>::iterator itr = bvhMap.find(mesh.get());
+      if (itr != bvhMap.end()) {
+         ++stats.numHits;
+         data = itr->second;
+      }
+   }
+
+   if (!data) {
+      // Built without holding the lock. If another thread built the same BVH in the meantime, keep theirs
+      SPtr<BvhData> createdData(createBvh(mesh));
+
+      std::lock_guard<std::mutex> lock(mutex);
+      std::pair<std::unordered_map<const Mesh*, SPtr<BvhData>>::iterator, bool> result = bvhMap.emplace(mesh.get(), createdData);
+      if (result.second) {
+         ++stats.numBvhShapes;
+         stats.bvhBytes += createdData->bvhSize;
+         stats.buildTime += createdData->buildTime;
+         if (createdData->loadedFromDisk) {
+            ++stats.numBvhsLoaded;
+         }
+      }
+      data = result.first->second;
+   }
+
+   // The scaled shape only references the shared one, so it keeps the BVH data alive for as long as it exists
+   return SPtr<btCollisionShape>(new btScaledBvhTriangleMeshShape(data->shape.get(), toBt(scale)), [data](btCollisionShape *shape) {
+      delete shape;
+   });
+}
+
+SPtr<btCollisionShape> PhysicsShapeCache::getHullShape(const SPtr<Mesh> &mesh, const glm::vec3 &scale) {
+   ASSERT(mesh, "Trying to get hull shape for null mesh");
+
+   HullKey key;
+   key.mesh = mesh.get();
+   key.scale = scale;
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++stats.numRequests;
+
+      std::map<HullKey, HullEntry>::iterator itr = hullMap.find(key);
+      if (itr != hullMap.end()) {
+         ++stats.numHits;
+         return itr->second.shape;
+      }
+   }
+
+   SPtr<HullPoints> hullPoints(getHullPoints(mesh));
+
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+   HullEntry entry;
+   entry.mesh = mesh;
+   entry.shape = SPtr<btConvexHullShape>(new btConvexHullShape(hullPoints->points.data(), hullPoints->numPoints, sizeof(float) * 3));
+   entry.shape->setLocalScaling(toBt(scale));
+   double buildTime = secondsSince(start);
+
+   std::lock_guard<std::mutex> lock(mutex);
+   std::pair<std::map<HullKey, HullEntry>::iterator, bool> result = hullMap.emplace(key, entry);
+   if (result.second) {
+      ++stats.numHullShapes;
+      stats.hullBytes += entry.shape->getNumPoints() * sizeof(btVector3);
+      stats.buildTime += buildTime;
+   }
+
+   return result.first->second.shape;
+}
+
+SPtr<PhysicsShapeCache::HullPoints> PhysicsShapeCache::getHullPoints(const SPtr<Mesh> &mesh) {
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      std::unordered_map<const Mesh*, SPtr<HullPoints>>::iterator itr = hullPointsMap.find(mesh.get());
+      if (itr != hullPointsMap.end()) {
+         return itr->second;
+      }
+   }
+
+   // Computed without holding the lock. If another thread computed the same hull in the meantime, keep theirs
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+   SPtr<HullPoints> hullPoints(std::make_shared<HullPoints>());
+   hullPoints->mesh = mesh;
+   if (simplifyHulls) {
+      hullPoints->points = simplifyHull(*mesh);
+   } else {
+      hullPoints->points.assign(mesh->getVertices(), mesh->getVertices() + mesh->getNumVertices() * 3);
+   }
+   hullPoints->numPoints = static_cast<int>(hullPoints->points.size() / 3);
+   hullPoints->buildTime = secondsSince(start);
+
+   std::lock_guard<std::mutex> lock(mutex);
+   std::pair<std::unordered_map<const Mesh*, SPtr<HullPoints>>::iterator, bool> result = hullPointsMap.emplace(mesh.get(), hullPoints);
+   if (result.second) {
+      stats.numSourceHullVertices += mesh->getNumVertices();
+      stats.numSimplifiedHullVertices += hullPoints->numPoints;
+      stats.buildTime += hullPoints->buildTime;
+   }
+
+   return result.first->second;
+}
+
+PhysicsShapeStats PhysicsShapeCache::getStats() {
+   std::lock_guard<std::mutex> lock(mutex);
+   return stats;
+}
+
+AssetMemoryUsage PhysicsShapeCache::getMemoryUsage() {
+   std::lock_guard<std::mutex> lock(mutex);
+
+   AssetMemoryUsage usage;
+   for (const std::pair<const Mesh* const, SPtr<BvhData>> &entry : bvhMap) {
+      ++usage.numAssets;
+      if (entry.second.use_count() == 1) {
+         ++usage.numUnreferenced;
+      }
+      usage.cpuBytes += entry.second->bvhSize;
+   }
+   for (const std::pair<const HullKey, HullEntry> &entry : hullMap) {
+      ++usage.numAssets;
+      if (entry.second.shape.use_count() == 1) {
+         ++usage.numUnreferenced;
+      }
+      usage.cpuBytes += entry.second.shape->getNumPoints() * sizeof(btVector3);
+   }
+   for (const std::pair<const Mesh* const, SPtr<HullPoints>> &entry : hullPointsMap) {
+      usage.cpuBytes += entry.second->points.size() * sizeof(float);
+   }
+
+   return usage;
+}
+
+std::size_t PhysicsShapeCache::releaseUnusedShapes() {
+   std::lock_guard<std::mutex> lock(mutex);
+
+   // Scaled BVH shapes keep their shared data alive, so data only referenced by the map is unused
+   std::size_t releasedBytes = 0;
+   for (std::unordered_map<const Mesh*, SPtr<BvhData>>::iterator itr = bvhMap.begin(); itr != bvhMap.end();) {
+      if (itr->second.use_count() == 1) {
+         releasedBytes += itr->second->bvhSize;
+         itr = bvhMap.erase(itr);
+      } else {
+         ++itr;
+      }
+   }
+
+   std::unordered_set<const Mesh*> hullMeshes;
+   for (std::map<HullKey, HullEntry>::iterator itr = hullMap.begin(); itr != hullMap.end();) {
+      if (itr->second.shape.use_count() == 1) {
+         releasedBytes += itr->second.shape->getNumPoints() * sizeof(btVector3);
+         itr = hullMap.erase(itr);
+      } else {
+         hullMeshes.insert(itr->first.mesh);
+         ++itr;
+      }
+   }
+
+   // Hull points are only kept while some scale of the hull is in use
+   for (std::unordered_map<const Mesh*, SPtr<HullPoints>>::iterator itr = hullPointsMap.begin(); itr != hullPointsMap.end();) {
+      if (hullMeshes.count(itr->first) == 0) {
+         releasedBytes += itr->second->points.size() * sizeof(float);
+         itr = hullPointsMap.erase(itr);
+      } else {
+         ++itr;
+      }
+   }
+
+   return releasedBytes;
+}
@@ -0,0 +1,155 @@
+#ifndef PHYSICS_SHAPE_CACHE_H
+#define PHYSICS_SHAPE_CACHE_H
+
+#include "AssetMemory.h"
+#include "Types.h"
+
+#include <folly/Optional.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class btBvhTriangleMeshShape;
+class btCollisionShape;
+class btConvexHullShape;
+class btTriangleIndexVertexArray;
+class MappedFile;
+class Mesh;
+
+/**
+ * Shape counts, memory and build time, accumulated since the cache was created
+ */
+struct PhysicsShapeStats {
+   long numBvhShapes;
+   long numHullShapes;
+   long numRequests;
+   long numHits;
+   long numBvhsLoaded;
+   long numSourceHullVertices;
+   long numSimplifiedHullVertices;
+   std::size_t bvhBytes;
+   std::size_t hullBytes;
+   double buildTime;
+
+   PhysicsShapeStats()
+      : numBvhShapes(0), numHullShapes(0), numRequests(0), numHits(0), numBvhsLoaded(0), numSourceHullVertices(0),
+        numSimplifiedHullVertices(0), bvhBytes(0), hullBytes(0), buildTime(0.0) {
+   }
+};
+
+/**
+ * Shares collision shapes between objects with the same mesh. Triangle mesh BVHs are built once per mesh and scaled per
+ * instance, while convex hulls are simplified once per mesh and shared by instances with the same mesh and scale.
+ * Optionally, BVHs are also stored on disk so that later runs don't have to build them. Thread safe, so that scenes can
+ * be loaded in the background
+ */
+class PhysicsShapeCache {
+protected:
+   /**
+    * A triangle mesh BVH, shared by every instance of the mesh (members are destroyed bottom to top, so the shape goes
+    * before the data it references)
+    */
+   struct BvhData {
+      SPtr<Mesh> mesh;
+      UPtr<btTriangleIndexVertexArray> triangles;
+
+      // Backing storage of a BVH read from disk (the shape doesn't own it)
+      SPtr<MappedFile> bvhFile;
+
+      UPtr<btBvhTriangleMeshShape> shape;
+
+      std::size_t bvhSize;
+      bool loadedFromDisk;
+      double buildTime;
+
+      BvhData();
+      ~BvhData();
+   };
+
+   /**
+    * Points of a mesh's (simplified) convex hull, shared by the hull shapes of every scale
+    */
+   struct HullPoints {
+      SPtr<Mesh> mesh;
+      std::vector<float> points;
+      int numPoints;
+      double buildTime;
+   };
+
+   struct HullKey {
+      const Mesh *mesh;
+      glm::vec3 scale;
+
+      bool operator<(const HullKey &other) const;
+   };
+
+   struct HullEntry {
+      SPtr<Mesh> mesh;
+      SPtr<btConvexHullShape> shape;
+   };
+
+   std::mutex mutex;
+   std::unordered_map<const Mesh*, SPtr<BvhData>> bvhMap;
+   std::unordered_map<const Mesh*, SPtr<HullPoints>> hullPointsMap;
+   std::map<HullKey, HullEntry> hullMap;
+   PhysicsShapeStats stats;
+
+   /**
+    * Directory that serialized BVHs live in (none if they aren't stored on disk)
+    */
+   folly::Optional<std::string> bvhDirectory;
+
+   /**
+    * If convex hulls are reduced to fewer points (otherwise every vertex of the mesh is used)
+    */
+   const bool simplifyHulls;
+
+   /**
+    * Gets the points of the mesh's convex hull, computing them the first time
+    */
+   SPtr<HullPoints> getHullPoints(const SPtr<Mesh> &mesh);
+
+   /**
+    * Builds (or reads from disk) the BVH for the given mesh
+    */
+   SPtr<BvhData> createBvh(const SPtr<Mesh> &mesh);
+
+public:
+   PhysicsShapeCache(bool storeBvhs = true, bool simplifyHulls = true);
+
+   virtual ~PhysicsShapeCache();
+
+   /**
+    * Gets a triangle mesh shape for the mesh with the given scale. The BVH is shared with every other instance of the
+    * mesh, but the returned shape belongs to the caller, so it can be rescaled freely
+    */
+   SPtr<btCollisionShape> getBvhShape(const SPtr<Mesh> &mesh, const glm::vec3 &scale);
+
+   /**
+    * Gets a convex hull shape for the mesh with the given scale, shared with every other instance with the same mesh
+    * and scale (so it must not be rescaled)
+    */
+   SPtr<btCollisionShape> getHullShape(const SPtr<Mesh> &mesh, const glm::vec3 &scale);
+
+   PhysicsShapeStats getStats();
+
+   /**
+    * Gets the memory currently used by the cached shapes (shapes that no object uses count as unreferenced)
+    */
+   AssetMemoryUsage getMemoryUsage();
+
+   /**
+    * Releases the shapes that no object uses (along with their references to meshes, so that those can be evicted too),
+    * returning the number of bytes released. Must be called from the main thread, since it may release the last
+    * reference to a mesh
+    */
+   std::size_t releaseUnusedShapes();
+};
+
+#endif
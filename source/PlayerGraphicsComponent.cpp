@@ -13,55 +13,65 @@
 
 #include <string>
 
+namespace {
+
+const UniformID MODEL_MATRIX_UNIFORM = ShaderProgram::getUniformID("uModelMatrix");
+const UniformID NORMAL_MATRIX_UNIFORM = ShaderProgram::getUniformID("uNormalMatrix");
+
+} // namespace
+
 PlayerGraphicsComponent::PlayerGraphicsComponent(GameObject &gameObject)
-   : GraphicsComponent(gameObject), headOffset(0.0f), leftHandOffset(0.0f), rightHandOffset(0.0f), leftFootOffset(0.0f), rightFootOffset(0.0f) {
+   : GraphicsComponent(gameObject), matricesDirty(true) {
    normalOffsetShadows = false;
 }
 
 PlayerGraphicsComponent::~PlayerGraphicsComponent() {
 }
 
-void PlayerGraphicsComponent::drawAppendages(const RenderData &renderData, const glm::mat4 &rotMatrix, const glm::mat4 &scaleMatrix) {
-   if (headModel && !renderData.isRenderingCameraObject()) {
-      glm::quat vertRot = gameObject.getOrientation();
-      vertRot.x *= -1.0f;
-      vertRot.y = 0.0f;
-      vertRot.z = 0.0f;
-      vertRot = glm::normalize(vertRot);
-      const glm::mat4 &vertRotMatrix = glm::toMat4(vertRot);
-      drawAppendage(renderData, rotMatrix, vertRotMatrix, scaleMatrix, headModel, headOffset);
-   }
+void PlayerGraphicsComponent::updateMatrices() {
+   const Transform &transform = gameObject.getRenderTransform();
+   const glm::mat4 &transMatrix = glm::translate(transform.position);
 
-   if (handModel) {
-      glm::quat vertRot = gameObject.getOrientation();
-      vertRot.x *= -1.0f;
-      vertRot.y = 0.0f;
-      vertRot.z = 0.0f;
-      vertRot = glm::normalize(vertRot);
-      vertRot /= 2.0f;
-      const glm::mat4 &vertRotMatrix = glm::toMat4(vertRot);
-      drawAppendage(renderData, rotMatrix, vertRotMatrix, scaleMatrix, handModel, leftHandOffset);
-      drawAppendage(renderData, rotMatrix, vertRotMatrix, scaleMatrix, handModel, rightHandOffset);
-   }
+   // Eliminate x and z rotations, flip y (to account for perspective)
+   glm::quat rot = transform.orientation;
+   rot.x = 0.0f;
+   rot.y *= -1.0f;
+   rot.z = 0.0f;
+   rot = glm::normalize(rot);
+   const glm::mat4 &rotMatrix = glm::toMat4(rot);
 
-   if (footModel) {
-      drawAppendage(renderData, rotMatrix, glm::mat4(1.0f), scaleMatrix, footModel, leftFootOffset);
-      drawAppendage(renderData, rotMatrix, glm::mat4(1.0f), scaleMatrix, footModel, rightFootOffset);
+   const glm::mat4 &scaleMatrix = glm::scale(transform.scale);
+
+   // The head and hands tilt with the camera, the feet don't
+   glm::quat vertRot = transform.orientation;
+   vertRot.x *= -1.0f;
+   vertRot.y = 0.0f;
+   vertRot.z = 0.0f;
+   vertRot = glm::normalize(vertRot);
+   const glm::mat4 &headRotMatrix = glm::toMat4(vertRot);
+   const glm::mat4 &handRotMatrix = glm::toMat4(vertRot / 2.0f);
+
+   modelMatrices[Body] = transMatrix * rotMatrix * scaleMatrix;
+   modelMatrices[Head] = transMatrix * glm::translate(renderOffsets.head) * rotMatrix * headRotMatrix * scaleMatrix;
+   modelMatrices[LeftHand] = transMatrix * glm::translate(renderOffsets.leftHand) * rotMatrix * handRotMatrix * scaleMatrix;
+   modelMatrices[RightHand] = transMatrix * glm::translate(renderOffsets.rightHand) * rotMatrix * handRotMatrix * scaleMatrix;
+   modelMatrices[LeftFoot] = transMatrix * glm::translate(renderOffsets.leftFoot) * rotMatrix * scaleMatrix;
+   modelMatrices[RightFoot] = transMatrix * glm::translate(renderOffsets.rightFoot) * rotMatrix * scaleMatrix;
+
+   for (int i = 0; i < NumParts; ++i) {
+      normalMatrices[i] = glm::transpose(glm::inverse(modelMatrices[i]));
    }
+
+   GameObject::countMatrixRecomputes(NumParts * 2);
+   matricesDirty = false;
 }
 
-void PlayerGraphicsComponent::drawAppendage(const RenderData &renderData, const glm::mat4 &rotMatrix, const glm::mat4 &vertRotMatrix, const glm::mat4 &scaleMatrix, SPtr<Model> model, const glm::vec3 &offset) {
+void PlayerGraphicsComponent::drawPart(const RenderData &renderData, SPtr<Model> model, Part part) {
    SPtr<ShaderProgram> overrideProgram = renderData.getOverrideProgram();
-
-   const glm::mat4 &offsetMatrix = glm::translate(offset);
-   const glm::mat4 &transMatrix = glm::translate(gameObject.getPosition());
-   const glm::mat4 &modelMatrix = transMatrix * offsetMatrix * rotMatrix * vertRotMatrix * scaleMatrix;
-   const glm::mat4 &normalMatrix = glm::transpose(glm::inverse(modelMatrix));
-
    SPtr<ShaderProgram> shaderProgram = overrideProgram ? overrideProgram : model->getShaderProgram();
 
-   shaderProgram->setUniformValue("uModelMatrix", modelMatrix, true);
-   shaderProgram->setUniformValue("uNormalMatrix", normalMatrix, true);
+   shaderProgram->setUniformValue(MODEL_MATRIX_UNIFORM, modelMatrices[part], true);
+   shaderProgram->setUniformValue(NORMAL_MATRIX_UNIFORM, normalMatrices[part], true);
 
    model->draw(renderData);
 }
@@ -71,27 +81,23 @@ void PlayerGraphicsComponent::draw(const RenderData &renderData) {
       return;
    }
 
-   const glm::mat4 &transMatrix = glm::translate(gameObject.getPosition());
-
-   // Eliminate x and z rotations, flip y (to account for perspective)
-   glm::quat rot = gameObject.getOrientation();
-   rot.x = 0.0f;
-   rot.y *= -1.0f;
-   rot.z = 0.0f;
-   rot = glm::normalize(rot);
-   const glm::mat4 &rotMatrix = glm::toMat4(rot);
+   if (matricesDirty) {
+      updateMatrices();
+   }
 
-   const glm::mat4 &scaleMatrix = glm::scale(gameObject.getScale());
-   const glm::mat4 &modelMatrix = transMatrix * rotMatrix * scaleMatrix;
-   const glm::mat4 &normalMatrix = glm::transpose(glm::inverse(modelMatrix));
+   drawPart(renderData, model, Body);
 
-   SPtr<ShaderProgram> overrideProgram = renderData.getOverrideProgram();
-   SPtr<ShaderProgram> shaderProgram = overrideProgram ? overrideProgram : model->getShaderProgram();
-
-   shaderProgram->setUniformValue("uModelMatrix", modelMatrix, true);
-   shaderProgram->setUniformValue("uNormalMatrix", normalMatrix, true);
+   if (headModel && !renderData.isRenderingCameraObject()) {
+      drawPart(renderData, headModel, Head);
+   }
 
-   model->draw(renderData);
+   if (handModel) {
+      drawPart(renderData, handModel, LeftHand);
+      drawPart(renderData, handModel, RightHand);
+   }
 
-   drawAppendages(renderData, rotMatrix, scaleMatrix);
+   if (footModel) {
+      drawPart(renderData, footModel, LeftFoot);
+      drawPart(renderData, footModel, RightFoot);
+   }
 }
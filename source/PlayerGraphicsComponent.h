@@ -3,20 +3,49 @@
 
 #include "GraphicsComponent.h"
 
+#include <glm/glm.hpp>
+
+struct AppendageOffsets {
+   glm::vec3 head;
+   glm::vec3 leftHand;
+   glm::vec3 rightHand;
+   glm::vec3 leftFoot;
+   glm::vec3 rightFoot;
+
+   AppendageOffsets()
+      : head(0.0f), leftHand(0.0f), rightHand(0.0f), leftFoot(0.0f), rightFoot(0.0f) {
+   }
+};
+
 class PlayerGraphicsComponent : public GraphicsComponent {
 protected:
+   enum Part {
+      Body,
+      Head,
+      LeftHand,
+      RightHand,
+      LeftFoot,
+      RightFoot,
+      NumParts
+   };
+
    SPtr<Model> headModel;
    SPtr<Model> handModel;
    SPtr<Model> footModel;
-   glm::vec3 headOffset;
-   glm::vec3 leftHandOffset;
-   glm::vec3 rightHandOffset;
-   glm::vec3 leftFootOffset;
-   glm::vec3 rightFootOffset;
+   AppendageOffsets offsets;
+
+   // Offsets as of the last snapshot
+   AppendageOffsets renderOffsets;
+
+   // Model and normal matrices of each part, computed on the first draw after a snapshot (the player is drawn once per
+   // camera and shadow map face)
+   glm::mat4 modelMatrices[NumParts];
+   glm::mat4 normalMatrices[NumParts];
+   bool matricesDirty;
 
-   void drawAppendages(const RenderData &renderData, const glm::mat4 &rotMatrix, const glm::mat4 &scaleMatrix);
+   void updateMatrices();
 
-   void drawAppendage(const RenderData &renderData, const glm::mat4 &rotMatrix, const glm::mat4 &vertRotMatrix, const glm::mat4 &scaleMatrix, SPtr<Model> model, const glm::vec3 &offset);
+   void drawPart(const RenderData &renderData, SPtr<Model> model, Part part);
 
 public:
    PlayerGraphicsComponent(GameObject &gameObject);
@@ -25,6 +54,11 @@ public:
 
    virtual void draw(const RenderData &renderData);
 
+   virtual void snapshot() {
+      renderOffsets = offsets;
+      matricesDirty = true;
+   }
+
    void setHeadModel(SPtr<Model> headModel) {
       this->headModel = headModel;
    }
@@ -38,43 +72,43 @@ public:
    }
 
    const glm::vec3& getHeadOffset() const {
-      return headOffset;
+      return offsets.head;
    }
 
    const glm::vec3& getLeftHandOffset() const {
-      return leftHandOffset;
+      return offsets.leftHand;
    }
 
    const glm::vec3& getRightHandOffset() const {
-      return rightHandOffset;
+      return offsets.rightHand;
    }
 
    const glm::vec3& getLeftFootOffset() const {
-      return leftFootOffset;
+      return offsets.leftFoot;
    }
 
    const glm::vec3& getRightFootOffset() const {
-      return rightFootOffset;
+      return offsets.rightFoot;
    }
 
    void setHeadOffset(const glm::vec3 &offset) {
-      headOffset = offset;
+      offsets.head = offset;
    }
 
    void setLeftHandOffset(const glm::vec3 &offset) {
-      leftHandOffset = offset;
+      offsets.leftHand = offset;
    }
 
    void setRightHandOffset(const glm::vec3 &offset) {
-      rightHandOffset = offset;
+      offsets.rightHand = offset;
    }
 
    void setLeftFootOffset(const glm::vec3 &offset) {
-      leftFootOffset = offset;
+      offsets.leftFoot = offset;
    }
 
    void setRightFootOffset(const glm::vec3 &offset) {
-      rightFootOffset = offset;
+      offsets.rightFoot = offset;
    }
 };
 
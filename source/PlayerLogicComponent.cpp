@@ -1,3 +1,4 @@
+#include "Ability.h"
 #include "CameraComponent.h"
 #include "Conversions.h"
 #include "Context.h"
@@ -124,6 +125,15 @@ glm::vec3 footPos(const glm::vec3 &playerPos, const glm::vec3 &baseFootPos, SPtr
    return toGlm(callback.m_hitPointWorld) - playerPos;
 }
 
+float cooldownProgress(const Ability &ability) {
+   float cooldownTime = ability.getCooldownTime();
+   if (cooldownTime == 0.0f) {
+      return 1.0f;
+   }
+
+   return 1.0f - ability.getRemainingCooldownTime() / cooldownTime;
+}
+
 } // namespace
 
 PlayerLogicComponent::PlayerLogicComponent(GameObject &gameObject, int playerNum, const glm::vec3 &color)
@@ -474,6 +484,13 @@ float PlayerLogicComponent::timeSinceDeath() const {
    return Context::getInstance().getRunningTime() - deathTime;
 }
 
+void PlayerLogicComponent::snapshot() {
+   renderState.alive = alive;
+   renderState.timeSinceDeath = timeSinceDeath();
+   renderState.primaryCooldownProgress = cooldownProgress(*primaryAbility);
+   renderState.secondaryCooldownProgress = cooldownProgress(*secondaryAbility);
+}
+
 const Ability& PlayerLogicComponent::getPrimaryAbility() const {
    return *primaryAbility;
 }
@@ -481,3 +498,8 @@ const Ability& PlayerLogicComponent::getPrimaryAbility() const {
 const Ability& PlayerLogicComponent::getSecondaryAbility() const {
    return *secondaryAbility;
 }
+
+void PlayerLogicComponent::prewarmAbilities(Scene &scene) {
+   primaryAbility->prewarm(scene);
+   secondaryAbility->prewarm(scene);
+}
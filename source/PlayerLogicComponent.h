@@ -20,6 +20,22 @@ struct Ground {
    }
 };
 
+/**
+ * The state of a player that is shown on their HUD, as of the last snapshot
+ */
+struct PlayerRenderState {
+   bool alive;
+   float timeSinceDeath;
+
+   // Fraction of each ability's cooldown that has passed (1 = ready to use)
+   float primaryCooldownProgress;
+   float secondaryCooldownProgress;
+
+   PlayerRenderState()
+      : alive(true), timeSinceDeath(0.0f), primaryCooldownProgress(1.0f), secondaryCooldownProgress(1.0f) {
+   }
+};
+
 class PlayerLogicComponent : public LogicComponent {
 protected:
    int playerNum;
@@ -36,6 +52,7 @@ protected:
    glm::vec3 color;
    SPtr<Ability> primaryAbility;
    SPtr<Ability> secondaryAbility;
+   PlayerRenderState renderState;
 
    folly::Optional<Ground> getGround(SPtr<PhysicsManager> physicsManager) const;
 
@@ -60,6 +77,8 @@ public:
 
    virtual void tick(const float dt);
 
+   virtual void snapshot();
+
    int getPlayerNum() const {
       return playerNum;
    }
@@ -79,6 +98,15 @@ public:
    const Ability &getPrimaryAbility() const;
 
    const Ability &getSecondaryAbility() const;
+
+   /**
+    * Builds the objects used by the player's abilities in the given scene's object pool
+    */
+   void prewarmAbilities(Scene &scene);
+
+   const PlayerRenderState& getRenderState() const {
+      return renderState;
+   }
 };
 
 #endif
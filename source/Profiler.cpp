@@ -0,0 +1,169 @@
+#include "FancyAssert.h"
+#include "LogHelper.h"
+#include "Profiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace Profiler {
+
+namespace {
+
+typedef std::chrono::high_resolution_clock Clock;
+
+// Stop recording after this many zones, to avoid growing without bound during long sessions (~100 MB)
+const size_t MAX_ZONES = 2 * 1024 * 1024;
+
+struct Zone {
+   const char *name;
+   std::string detail;
+   int64_t start;
+   int64_t duration;
+   int threadID;
+   int depth;
+};
+
+struct OpenZone {
+   const char *name;
+   std::string detail;
+   Clock::time_point start;
+};
+
+std::atomic<bool> enabled(false);
+std::atomic<int> nextThreadID(0);
+const Clock::time_point startTime = Clock::now();
+
+std::mutex zoneMutex;
+std::vector<Zone> zones;
+bool zonesDropped = false;
+
+thread_local std::vector<OpenZone> openZones;
+thread_local int threadID = -1;
+
+int64_t toMicroseconds(Clock::duration duration) {
+   return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+// Writes a string as a JSON string literal
+void writeEscaped(std::ostream &out, const char *str) {
+   out << '"';
+   for (const char *c = str; *c; ++c) {
+      switch (*c) {
+         case '"':
+            out << "\\\"";
+            break;
+         case '\\':
+            out << "\\\\";
+            break;
+         case '\n':
+            out << "\\n";
+            break;
+         default:
+            out << *c;
+            break;
+      }
+   }
+   out << '"';
+}
+
+} // namespace
+
+void setEnabled(bool enable) {
+   enabled = enable;
+}
+
+bool isEnabled() {
+   return enabled;
+}
+
+void beginZone(const char *name, const std::string &detail) {
+   ASSERT(name, "Trying to begin zone with null name");
+
+   OpenZone zone;
+   zone.name = name;
+   zone.detail = detail;
+   zone.start = Clock::now();
+
+   openZones.push_back(zone);
+}
+
+void endZone() {
+   Clock::time_point now = Clock::now();
+
+   ASSERT(!openZones.empty(), "Trying to end zone when none are open");
+   if (openZones.empty()) {
+      return;
+   }
+
+   if (threadID < 0) {
+      threadID = nextThreadID++;
+   }
+
+   const OpenZone &openZone = openZones.back();
+
+   Zone zone;
+   zone.name = openZone.name;
+   zone.detail = openZone.detail;
+   zone.start = toMicroseconds(openZone.start - startTime);
+   zone.duration = toMicroseconds(now - openZone.start);
+   zone.threadID = threadID;
+   zone.depth = openZones.size() - 1;
+
+   openZones.pop_back();
+
+   std::lock_guard<std::mutex> lock(zoneMutex);
+   if (zones.size() >= MAX_ZONES) {
+      if (!zonesDropped) {
+         LOG_WARNING("Profiler zone limit reached, dropping any further zones");
+         zonesDropped = true;
+      }
+
+      return;
+   }
+
+   zones.push_back(std::move(zone));
+}
+
+bool writeTrace(const std::string &fileName) {
+   ASSERT(!fileName.empty(), "Trying to write trace to empty file name");
+
+   std::ofstream out(fileName);
+   if (!out) {
+      LOG_WARNING("Unable to open profiler trace file: " << fileName);
+      return false;
+   }
+
+   std::lock_guard<std::mutex> lock(zoneMutex);
+
+   // Complete ("X") events, which chrome://tracing nests by time range on each thread
+   out << "{\"traceEvents\":[\n";
+   for (size_t i = 0; i < zones.size(); ++i) {
+      const Zone &zone = zones[i];
+
+      out << "{\"name\":";
+      writeEscaped(out, zone.name);
+      out << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << zone.threadID << ",\"ts\":" << zone.start << ",\"dur\":" << zone.duration;
+      out << ",\"args\":{\"depth\":" << zone.depth;
+      if (!zone.detail.empty()) {
+         out << ",\"detail\":";
+         writeEscaped(out, zone.detail.c_str());
+      }
+      out << "}}";
+
+      if (i + 1 < zones.size()) {
+         out << ',';
+      }
+      out << '\n';
+   }
+   out << "],\"displayTimeUnit\":\"ms\"}\n";
+
+   LOG_INFO("Wrote " << zones.size() << " profiler zones to " << fileName);
+
+   return !!out;
+}
+
+} // namespace Profiler
@@ -0,0 +1,76 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "Constants.h"
+
+#include <string>
+
+/**
+ * Hierarchical frame profiler, which records nested timing zones and writes them out as a Chrome trace
+ * (viewable in chrome://tracing)
+ */
+namespace Profiler {
+
+/**
+ * Starts or stops recording zones (zones are free apart from a single branch while not recording)
+ */
+void setEnabled(bool enabled);
+
+bool isEnabled();
+
+/**
+ * Begins a zone with the given name, which must outlive the profiler (e.g. a string literal), and optional detail text
+ */
+void beginZone(const char *name, const std::string &detail = std::string());
+
+/**
+ * Ends the most recently begun zone on the current thread
+ */
+void endZone();
+
+/**
+ * Writes all recorded zones to the given file in the Chrome trace event format
+ */
+bool writeTrace(const std::string &fileName);
+
+/**
+ * Begins a zone on construction, and ends it on destruction
+ */
+class ScopedZone {
+protected:
+   const bool active;
+
+public:
+   ScopedZone(const char *name)
+      : active(isEnabled()) {
+      if (active) {
+         beginZone(name);
+      }
+   }
+
+   ScopedZone(const char *name, const std::string &detail)
+      : active(isEnabled()) {
+      if (active) {
+         beginZone(name, detail);
+      }
+   }
+
+   ~ScopedZone() {
+      if (active) {
+         endZone();
+      }
+   }
+};
+
+} // namespace Profiler
+
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_IMPL(a, b)
+
+#ifdef ENABLE_PROFILER
+#define PROFILE_ZONE(...) Profiler::ScopedZone PROFILER_CONCAT(profileZone, __LINE__)(__VA_ARGS__)
+#else
+#define PROFILE_ZONE(...)
+#endif
+
+#endif
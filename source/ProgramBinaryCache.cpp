@@ -0,0 +1,158 @@
+#include "FancyAssert.h"
+#include "GLIncludes.h"
+#include "LogHelper.h"
+#include "MappedFile.h"
+#include "ProgramBinaryCache.h"
+#include "ShaderProgram.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace ProgramBinaryCache {
+
+namespace {
+
+const char MAGIC[4] = { 'T', 'G', 'I', 'P' };
+
+// Bump whenever the layout changes, so that existing binaries are regenerated
+const uint32_t VERSION = 1;
+
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+
+struct Header {
+   char magic[4];
+   uint32_t version;
+   uint64_t sourceHash;
+   uint64_t driverHash;
+   uint32_t format;
+   uint32_t size;
+};
+
+uint64_t hashBytes(uint64_t hash, const void *data, std::size_t size) {
+   // FNV-1a
+   const unsigned char *bytes = static_cast<const unsigned char*>(data);
+   for (std::size_t i = 0; i < size; ++i) {
+      hash = (hash ^ bytes[i]) * 1099511628211ULL;
+   }
+
+   return hash;
+}
+
+uint64_t hashString(uint64_t hash, const char *string) {
+   // Include the terminator, so that consecutive strings can't run into each other
+   return string ? hashBytes(hash, string, strlen(string) + 1) : hashBytes(hash, "", 1);
+}
+
+/**
+ * Identifies the driver, since binaries are only valid for the driver (and GPU) that produced them
+ */
+uint64_t getDriverHash() {
+   uint64_t hash = FNV_OFFSET_BASIS;
+   hash = hashString(hash, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+   hash = hashString(hash, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+   hash = hashString(hash, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+   return hash;
+}
+
+} // namespace
+
+bool isSupported() {
+   if (!GLAD_GL_ARB_get_program_binary && !GLAD_GL_VERSION_4_1) {
+      return false;
+   }
+
+   // Drivers may support the extension without supporting any binary formats
+   GLint numFormats = 0;
+   glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+   return numFormats > 0;
+}
+
+uint64_t hashSources(const std::vector<std::string> &sources) {
+   uint64_t hash = FNV_OFFSET_BASIS;
+   for (const std::string &source : sources) {
+      hash = hashString(hash, source.c_str());
+   }
+
+   return hash;
+}
+
+bool load(const std::string &fileName, uint64_t sourceHash, ShaderProgram &program) {
+   ASSERT(!fileName.empty(), "Trying to load program binary from empty file name");
+
+   SPtr<MappedFile> mappedFile(MappedFile::open(fileName));
+   if (!mappedFile || mappedFile->getSize() < sizeof(Header)) {
+      return false;
+   }
+
+   Header header;
+   memcpy(&header, mappedFile->getData(), sizeof(header));
+   if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+      return false;
+   }
+
+   if (header.sourceHash != sourceHash) {
+      LOG_DEBUG("Program binary " << fileName << " is stale");
+      return false;
+   }
+
+   if (header.driverHash != getDriverHash()) {
+      LOG_DEBUG("Program binary " << fileName << " is from a different driver");
+      return false;
+   }
+
+   if (header.size > mappedFile->getSize() - sizeof(Header)) {
+      LOG_WARNING("Invalid program binary: " << fileName);
+      return false;
+   }
+
+   // Drivers may still reject binaries (e.g. after an update that didn't change the version string)
+   if (!program.loadBinary(header.format, mappedFile->getData() + sizeof(Header), header.size)) {
+      LOG_DEBUG("Program binary " << fileName << " was rejected by the driver");
+      return false;
+   }
+
+   return true;
+}
+
+bool save(const std::string &fileName, uint64_t sourceHash, const ShaderProgram &program) {
+   ASSERT(!fileName.empty(), "Trying to save program binary to empty file name");
+
+   GLenum format;
+   std::vector<char> binary;
+   if (!program.getBinary(&format, &binary)) {
+      return false;
+   }
+
+   Header header;
+   memcpy(header.magic, MAGIC, sizeof(MAGIC));
+   header.version = VERSION;
+   header.sourceHash = sourceHash;
+   header.driverHash = getDriverHash();
+   header.format = format;
+   header.size = static_cast<uint32_t>(binary.size());
+
+   // Write to a temporary file first, so that other processes never read a partially written binary
+   std::string tempFileName(fileName + ".tmp");
+   {
+      std::ofstream out(tempFileName, std::ofstream::binary);
+      if (!out) {
+         return false;
+      }
+
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      out.write(binary.data(), binary.size());
+
+      if (!out) {
+         out.close();
+         std::remove(tempFileName.c_str());
+         return false;
+      }
+   }
+
+   // Renaming over an existing file fails on Windows
+   std::remove(fileName.c_str());
+   return std::rename(tempFileName.c_str(), fileName.c_str()) == 0;
+}
+
+} // namespace ProgramBinaryCache
@@ -0,0 +1,40 @@
+#ifndef PROGRAM_BINARY_CACHE_H
+#define PROGRAM_BINARY_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ShaderProgram;
+
+/**
+ * Linked shader program binaries (from glGetProgramBinary), which are loaded instead of compiling and linking the
+ * program's shaders. Each file records the hash of the sources and of the driver it was generated with, so that binaries
+ * from changed shaders or a different driver are ignored
+ */
+namespace ProgramBinaryCache {
+
+/**
+ * If the current context can retrieve and load program binaries. Must be called from the main thread
+ */
+bool isSupported();
+
+/**
+ * Hashes the given shader sources (in order), identifying the program built from them
+ */
+uint64_t hashSources(const std::vector<std::string> &sources);
+
+/**
+ * Loads the binary with the given name into the (not yet linked) program, returning false if it is missing, invalid,
+ * stale, or rejected by the driver
+ */
+bool load(const std::string &fileName, uint64_t sourceHash, ShaderProgram &program);
+
+/**
+ * Writes the binary of the given linked program to the file with the given name, returning true on success
+ */
+bool save(const std::string &fileName, uint64_t sourceHash, const ShaderProgram &program);
+
+} // namespace ProgramBinaryCache
+
+#endif
@@ -0,0 +1,185 @@
+#include "Context.h"
+#include "DrawStateCache.h"
+#include "GameObject.h"
+#include "GraphicsComponent.h"
+#include "Material.h"
+#include "Model.h"
+#include "RenderData.h"
+#include "RenderQueue.h"
+#include "ShaderProgram.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+
+namespace {
+
+const int PASS_SHIFT = 62;
+
+// Widths of the state fields (objects past the last slot share it, which only costs some sorting)
+const int PROGRAM_BITS = 10;
+const int MATERIAL_BITS = 12;
+const int TEXTURE_BITS = 12;
+const int MESH_BITS = 12;
+const int STATE_BITS = PROGRAM_BITS + MATERIAL_BITS + TEXTURE_BITS + MESH_BITS;
+
+const int DEPTH_BITS = 16;
+const uint64_t MAX_DEPTH_VALUE = (1 << DEPTH_BITS) - 1;
+
+// Depths are quantized over the range of the camera's projection (anything further away is clipped anyway)
+const float MAX_SORT_DEPTH = 200.0f;
+
+// Fewest objects worth drawing with an instanced draw (which has to upload their transforms first)
+const std::size_t MIN_INSTANCES = 2;
+
+const UniformID DISABLE_NORMAL_OFFSETTING_UNIFORM = ShaderProgram::getUniformID("uDisableNormalOffsetting");
+
+uint64_t getSlot(std::unordered_map<const void*, uint32_t> &slots, const void *object, int bits) {
+   if (!object) {
+      return 0;
+   }
+
+   uint32_t maxSlot = (1u << bits) - 1;
+   std::unordered_map<const void*, uint32_t>::iterator itr = slots.find(object);
+   if (itr == slots.end()) {
+      itr = slots.emplace(object, std::min(static_cast<uint32_t>(slots.size()) + 1, maxSlot)).first;
+   }
+
+   return itr->second;
+}
+
+uint64_t quantizeDepth(float depth) {
+   return static_cast<uint64_t>(glm::clamp(depth / MAX_SORT_DEPTH, 0.0f, 1.0f) * MAX_DEPTH_VALUE);
+}
+
+uint64_t passKey(RenderPass pass) {
+   return static_cast<uint64_t>(pass) << PASS_SHIFT;
+}
+
+bool compareKeys(const RenderQueue::Item &first, const RenderQueue::Item &second) {
+   return first.key < second.key;
+}
+
+} // namespace
+
+RenderQueue::RenderQueue() {
+}
+
+RenderQueue::~RenderQueue() {
+}
+
+void RenderQueue::clear() {
+   items.clear();
+   programSlots.clear();
+   materialSlots.clear();
+   textureSlots.clear();
+   meshSlots.clear();
+}
+
+void RenderQueue::add(RenderPass pass, GameObject &gameObject, float depth) {
+   const Model *model = gameObject.getGraphicsComponent().getModel().get();
+
+   uint64_t program = 0;
+   uint64_t material = 0;
+   uint64_t texture = 0;
+   uint64_t mesh = 0;
+   if (model) {
+      // Objects drawing the same mesh with the same state end up next to each other, so they can share a draw
+      mesh = getSlot(meshSlots, model->getSharedMesh().get(), MESH_BITS);
+
+      // Shadows are drawn with a single program, without materials
+      if (pass != RenderPass::Shadow) {
+         program = getSlot(programSlots, model->getShaderProgram().get(), PROGRAM_BITS);
+
+         for (const SPtr<Material> &modelMaterial : model->getMaterials()) {
+            const Texture *materialTexture = modelMaterial->getTexture();
+            if (materialTexture && !texture) {
+               texture = getSlot(textureSlots, materialTexture, TEXTURE_BITS);
+            } else if (!materialTexture && !material) {
+               material = getSlot(materialSlots, modelMaterial.get(), MATERIAL_BITS);
+            }
+         }
+      }
+   }
+
+   uint64_t state = program << (MATERIAL_BITS + TEXTURE_BITS + MESH_BITS) | material << (TEXTURE_BITS + MESH_BITS) | texture << MESH_BITS | mesh;
+   uint64_t quantizedDepth = quantizeDepth(depth);
+
+   Item item;
+   item.gameObject = &gameObject;
+   if (pass == RenderPass::Transparent) {
+      item.key = passKey(pass) | (MAX_DEPTH_VALUE - quantizedDepth) << STATE_BITS | state;
+   } else {
+      item.key = passKey(pass) | state << DEPTH_BITS | quantizedDepth;
+   }
+
+   items.push_back(item);
+}
+
+void RenderQueue::sort() {
+   std::stable_sort(items.begin(), items.end(), compareKeys);
+}
+
+void RenderQueue::draw(RenderPass pass, RenderData &renderData, const GameObject *camera) {
+   DrawStateCache &stateCache = Context::getInstance().getDrawStateCache();
+   SPtr<ShaderProgram> shadowProgram = pass == RenderPass::Shadow ? renderData.getOverrideProgram() : nullptr;
+
+   stateCache.begin();
+
+   const_iterator passEnd = end(pass);
+   for (const_iterator itr = begin(pass); itr != passEnd;) {
+      GraphicsComponent &graphicsComponent = itr->gameObject->getGraphicsComponent();
+      if (shadowProgram) {
+         shadowProgram->setUniformValue(DISABLE_NORMAL_OFFSETTING_UNIFORM, !graphicsComponent.useNormalOffsetShadows(), true);
+      }
+      renderData.setRenderingCameraObject(camera == itr->gameObject);
+
+      // Gather the following objects that can be drawn along with this one
+      instances.clear();
+      SPtr<Model> model = graphicsComponent.getModel();
+      const_iterator batchEnd = itr + 1;
+      InstanceTransform instance;
+      if (model && model->supportsInstancing(renderData) && graphicsComponent.getInstanceTransform(renderData, instance)) {
+         instances.push_back(instance);
+
+         for (; batchEnd != passEnd; ++batchEnd) {
+            const GraphicsComponent &other = batchEnd->gameObject->getGraphicsComponent();
+            SPtr<Model> otherModel = other.getModel();
+            if (!otherModel || !model->canShareInstancedDraw(*otherModel, renderData)
+               || (shadowProgram && other.useNormalOffsetShadows() != graphicsComponent.useNormalOffsetShadows())
+               || !other.getInstanceTransform(renderData, instance)) {
+               break;
+            }
+
+            instances.push_back(instance);
+         }
+      }
+
+      if (instances.size() >= MIN_INSTANCES) {
+         model->drawInstanced(renderData, instances);
+      } else {
+         batchEnd = itr + 1;
+         graphicsComponent.draw(renderData);
+      }
+
+      itr = batchEnd;
+   }
+
+   stateCache.end();
+}
+
+RenderQueue::const_iterator RenderQueue::begin(RenderPass pass) const {
+   Item first;
+   first.key = passKey(pass);
+   return std::lower_bound(items.begin(), items.end(), first, compareKeys);
+}
+
+RenderQueue::const_iterator RenderQueue::end(RenderPass pass) const {
+   if (pass == RenderPass::Transparent) {
+      return items.end();
+   }
+
+   Item next;
+   next.key = passKey(static_cast<RenderPass>(static_cast<uint8_t>(pass) + 1));
+   return std::lower_bound(items.begin(), items.end(), next, compareKeys);
+}
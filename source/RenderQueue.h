@@ -0,0 +1,91 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include "Model.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class GameObject;
+class RenderData;
+
+enum class RenderPass : uint8_t {
+   Shadow,
+   Opaque,
+   Transparent
+};
+
+/**
+ * Objects to draw in a frame, ordered by 64 bit sort keys so that consecutive draws share as much state as possible.
+ * From the most to the least significant bits, keys hold the pass, then the program, material, texture and mesh, then
+ * the depth (front to back, to make the most of early depth testing). Transparent objects have to blend back to
+ * front, so their keys hold the depth right after the pass instead. Runs of objects drawing the same mesh with the same
+ * state are drawn as instances of a single draw
+ */
+class RenderQueue {
+public:
+   struct Item {
+      uint64_t key;
+      GameObject *gameObject;
+   };
+
+   typedef std::vector<Item>::const_iterator const_iterator;
+
+protected:
+   std::vector<Item> items;
+
+   /**
+    * Small numbers standing in for each distinct program, material, texture and mesh added since the last clear, so
+    * that they fit in the key
+    */
+   std::unordered_map<const void*, uint32_t> programSlots;
+   std::unordered_map<const void*, uint32_t> materialSlots;
+   std::unordered_map<const void*, uint32_t> textureSlots;
+   std::unordered_map<const void*, uint32_t> meshSlots;
+
+   /**
+    * Transforms of the instances in the current batch (reused to avoid reallocating every draw)
+    */
+   std::vector<InstanceTransform> instances;
+
+public:
+   RenderQueue();
+
+   virtual ~RenderQueue();
+
+   void clear();
+
+   /**
+    * Adds the object to the given pass, at the given distance from the viewer
+    */
+   void add(RenderPass pass, GameObject &gameObject, float depth);
+
+   /**
+    * Sorts the items by key (keeping objects with equal keys in the order they were added)
+    */
+   void sort();
+
+   /**
+    * Draws the sorted items in the given pass, skipping redundant state changes and batching runs of objects that can
+    * share an instanced draw. The camera (if any) is the object being rendered from
+    */
+   void draw(RenderPass pass, RenderData &renderData, const GameObject *camera = nullptr);
+
+   /**
+    * Gets the first sorted item in the given pass
+    */
+   const_iterator begin(RenderPass pass) const;
+
+   /**
+    * Gets the item past the last sorted item in the given pass
+    */
+   const_iterator end(RenderPass pass) const;
+
+   std::size_t size() const {
+      return items.size();
+   }
+};
+
+#endif
@@ -3,6 +3,7 @@
 #include "Constants.h"
 #include "Context.h"
 #include "DebugDrawer.h"
+#include "DrawStateCache.h"
 #include "FancyAssert.h"
 #include "GameObject.h"
 #include "GLIncludes.h"
@@ -14,20 +15,28 @@
 #include "PhysicsComponent.h"
 #include "PhysicsManager.h"
 #include "PlayerLogicComponent.h"
+#include "Profiler.h"
 #include "RenderData.h"
+#include "RenderQueue.h"
 #include "Renderer.h"
 #include "Scene.h"
 #include "ShaderProgram.h"
 #include "ShadowMap.h"
 #include "TextureMaterial.h"
 #include "TextureUnitManager.h"
+#include "UniformBlocks.h"
+#include "UniformBuffer.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/transform.hpp>
 
+#include <array>
+#include <chrono>
+#include <cstddef>
 #include <set>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -36,6 +45,22 @@ namespace {
 const float FADE_TIME = 1.0f;
 const float FADE_OUT_DELAY = TIME_TO_NEXT_LEVEL / 2.0f;
 
+template<std::size_t size>
+std::array<UniformID, size> getElementUniformIDs(const std::string &arrayName) {
+   std::array<UniformID, size> ids;
+   for (std::size_t i = 0; i < size; ++i) {
+      std::stringstream ss;
+      ss << arrayName << "[" << i << "]";
+      ids[i] = ShaderProgram::getUniformID(ss.str());
+   }
+
+   return ids;
+}
+
+const std::array<UniformID, UniformBlocks::MAX_SHADOWS> SHADOW_MAP_UNIFORMS = getElementUniformIDs<UniformBlocks::MAX_SHADOWS>("uShadowMaps");
+const std::array<UniformID, UniformBlocks::MAX_CUBE_SHADOWS> CUBE_SHADOW_MAP_UNIFORMS = getElementUniformIDs<UniformBlocks::MAX_CUBE_SHADOWS>("uCubeShadowMaps");
+const UniformID LIGHT_DIR_UNIFORM = ShaderProgram::getUniformID("uLightDir");
+
 bool outside(const std::array<glm::vec3, 8> &aabbPoints, const glm::vec4 &plane) {
    for (const glm::vec3 &point : aabbPoints) {
       if (plane.x * point.x +
@@ -138,14 +163,14 @@ void FrustumChecker::updateFrustum(const glm::mat4 &viewProj) {
 }
 
 bool FrustumChecker::inFrustum(GameObject &gameObject) {
-   if (!gameObject.getPhysicsComponent().getCollisionObject()) {
+   const folly::Optional<AABB> &aabb = gameObject.getPhysicsComponent().getRenderAABB();
+   if (!aabb) {
       // Can't check bounding box, assume we need to draw it
       return true;
    }
 
-   AABB aabb = gameObject.getPhysicsComponent().getAABB();
-   const glm::vec3 &min = aabb.min;
-   const glm::vec3 &max = aabb.max;
+   const glm::vec3 &min = aabb->min;
+   const glm::vec3 &max = aabb->max;
 
    std::array<glm::vec3, 8> aabbPoints({{
       glm::vec3(min.x, min.y, min.z),
@@ -194,6 +219,9 @@ void Renderer::init(float fov, int width, int height, int windowWidth, int windo
 
    shadowMapManager = std::move(UPtr<ShadowMapManager>(new ShadowMapManager(ShadowMap::MAX_SHADOWS, ShadowMap::MAX_LARGE_SHADOWS, ShadowMap::MAX_CUBE_SHADOWS)));
 
+   cameraBuffer = std::move(UPtr<UniformBuffer>(new UniformBuffer(UniformBlockBindings::CAMERA, sizeof(CameraBlock))));
+   lightsBuffer = std::move(UPtr<UniformBuffer>(new UniformBuffer(UniformBlockBindings::LIGHTS, sizeof(LightsBlock))));
+
    onWindowSizeChange(windowWidth, windowHeight);
 
    onFramebufferSizeChange(width, height);
@@ -235,7 +263,11 @@ void Renderer::onWindowSizeChange(int width, int height) {
    updatePixelDensity();
 }
 
-void Renderer::render(Scene &scene) {
+void Renderer::render(const Scene &scene) {
+   PROFILE_ZONE("Renderer::render");
+
+   const SceneSnapshot &snapshot = scene.getSnapshot();
+
    RUN_DEBUG(checkGLError();)
 
    GLbitfield mask = GL_DEPTH_BUFFER_BIT;
@@ -248,11 +280,17 @@ void Renderer::render(Scene &scene) {
    // Free all texture units
    Context::getInstance().getTextureUnitManager().reset();
 
-   renderShadowMaps(scene);
+   cameraCullStats = CullStats();
+   shadowCullStats = CullStats();
 
-   prepareLights(scene);
+   DrawStateCache &stateCache = Context::getInstance().getDrawStateCache();
+   stateCache.resetStats();
 
-   const std::vector<SPtr<GameObject>> &cameras = scene.getCameras();
+   renderShadowMaps(snapshot);
+
+   prepareLights(snapshot);
+
+   const std::vector<SPtr<GameObject>> &cameras = snapshot.cameras;
    if (cameras.empty()) {
       LOG_WARNING("Scene must have camera to render");
    }
@@ -267,62 +305,87 @@ void Renderer::render(Scene &scene) {
       Viewport viewport(getViewport(i, numCameras, width, height));
       glViewport(viewport.x, viewport.y, viewport.width, viewport.height);
 
-      renderFromCamera(scene, *cameras[i], viewport);
+      renderFromCamera(snapshot, *cameras[i], viewport);
    }
 
    glViewport(0, 0, width, height);
 
-   renderFullscreenPost(scene);
+   drawStats = stateCache.getStats();
+
+   renderFullscreenPost(snapshot);
 }
 
-void Renderer::renderShadowMaps(Scene &scene) {
+void Renderer::renderShadowMaps(const SceneSnapshot &snapshot) {
+   PROFILE_ZONE("Renderer::renderShadowMaps");
+
    glDisable(GL_CULL_FACE);
 
-   const std::vector<SPtr<GameObject>> &lights = scene.getLights();
+   const std::vector<SPtr<GameObject>> &lights = snapshot.lights;
    for (SPtr<GameObject> light : lights) {
-      renderShadowMap(scene, light);
+      renderShadowMap(snapshot, light);
    }
 
    glEnable(GL_CULL_FACE);
 }
 
-void Renderer::prepareLights(Scene &scene) {
-   const std::set<SPtr<ShaderProgram>> &shaderPrograms = scene.getShaderPrograms();
-   const std::vector<SPtr<GameObject>> &lights = scene.getLights();
-   GLenum shadowTextureUnit = Context::getInstance().getTextureUnitManager().getReservedShadowUnit();
-   GLenum cubeShadowTextureUnit = Context::getInstance().getTextureUnitManager().getReservedCubeShadowUnit();
+void Renderer::prepareLights(const SceneSnapshot &snapshot) {
+   PROFILE_ZONE("Renderer::prepareLights");
+
+   const std::vector<SPtr<GameObject>> &lights = snapshot.lights;
+   TextureUnitManager &textureUnitManager = Context::getInstance().getTextureUnitManager();
+
+   // Reset shadows to default textures
+   shadowMapUnits.shadowMaps.fill(textureUnitManager.getReservedShadowUnit());
+   shadowMapUnits.cubeShadowMaps.fill(textureUnitManager.getReservedCubeShadowUnit());
+
+   // Render light / shadow info (once for all programs)
+   int numLights = glm::min((int)lights.size(), LightComponent::MAX_LIGHTS);
+   lightsBlock.numLights = numLights;
 
+   int shadowIndex = 0;
+   int cubeShadowIndex = 0;
+   for (int i = 0; i < numLights; ++i) {
+      lights[i]->getLightComponent().draw(lightsBlock, shadowMapUnits, i, shadowIndex, cubeShadowIndex);
+   }
+
+   lightsBuffer->update(&lightsBlock);
+
+   // Shadow map samplers (only uploaded when a shadow map moves to another unit)
+   const std::set<SPtr<ShaderProgram>> &shaderPrograms = snapshot.shaderPrograms;
    for (SPtr<ShaderProgram> shaderProgram : shaderPrograms) {
-      // Reset shadows to default textures
-      if (shaderProgram->hasUniform("uShadows[0].shadowMap")) {
-         for (int i = 0; i < ShadowMap::MAX_SHADOWS; ++i) {
-            std::stringstream ss;
-            ss << "uShadows[" << i << "].shadowMap";
-            shaderProgram->setUniformValue(ss.str(), shadowTextureUnit);
-         }
-         for (int i = 0; i < ShadowMap::MAX_CUBE_SHADOWS; ++i) {
-            std::stringstream ss;
-            ss << "uCubeShadows[" << i << "].shadowMap";
-            shaderProgram->setUniformValue(ss.str(), cubeShadowTextureUnit);
-         }
+      if (!shaderProgram->hasUniform(SHADOW_MAP_UNIFORMS[0])) {
+         continue;
       }
 
-      // Render light / shadow info
-      if (shaderProgram->hasUniform("uNumLights")) {
-         int numLights = glm::min((int)lights.size(), LightComponent::MAX_LIGHTS);
-         shaderProgram->setUniformValue("uNumLights", numLights);
-
-         unsigned int lightIndex = 0;
-         int shadowIndex = 0;
-         int cubeShadowIndex = 0;
-         for (int i = 0; i < numLights; ++i) {
-            lights[i]->getLightComponent().draw(*shaderProgram, lightIndex++, shadowIndex, cubeShadowIndex);
-         }
+      for (int i = 0; i < UniformBlocks::MAX_SHADOWS; ++i) {
+         shaderProgram->setUniformValue(SHADOW_MAP_UNIFORMS[i], shadowMapUnits.shadowMaps[i]);
+      }
+      for (int i = 0; i < UniformBlocks::MAX_CUBE_SHADOWS; ++i) {
+         shaderProgram->setUniformValue(CUBE_SHADOW_MAP_UNIFORMS[i], shadowMapUnits.cubeShadowMaps[i]);
       }
    }
 }
 
-void Renderer::renderShadowMap(Scene &scene, SPtr<GameObject> light) {
+void Renderer::setView(const glm::mat4 &projection, const glm::mat4 &view, const glm::vec3 &position) {
+   cameraBlock.projMatrix = projection;
+   cameraBlock.viewMatrix = view;
+   cameraBlock.cameraPos = position;
+
+   cameraBuffer->update(&cameraBlock);
+}
+
+void Renderer::cullObjects(const SceneSnapshot &snapshot, CullStats &stats) {
+   PROFILE_ZONE("Renderer::cullObjects");
+
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+   visibleObjects.clear();
+   snapshot.objectHierarchy.cull(frustumChecker.getPlanes(), visibleObjects, stats);
+
+   stats.time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Renderer::renderShadowMap(const SceneSnapshot &snapshot, SPtr<GameObject> light) {
    LightComponent &lightComponent = light->getLightComponent();
 
    SPtr<ShadowMap> shadowMap = lightComponent.getShadowMap();
@@ -342,131 +405,133 @@ void Renderer::renderShadowMap(Scene &scene, SPtr<GameObject> light) {
       lightComponent.setShadowMap(shadowMap);
    }
 
+   PROFILE_ZONE("Renderer::renderShadowMap", shadowMap->isCube() ? "cube" : "standard");
+
    shadowMap->enable();
 
    if (shadowMap->isCube()) {
       for (int i = 0; i < 6; ++i) {
          shadowMap->setActiveFace(i);
-         renderShadowMapFace(scene, light, shadowMap->getShadowProgram(), i);
+         renderShadowMapFace(snapshot, light, shadowMap->getShadowProgram(), i);
       }
    } else {
-      renderShadowMapFace(scene, light, shadowMap->getShadowProgram());
+      renderShadowMapFace(snapshot, light, shadowMap->getShadowProgram());
    }
 
    shadowMap->disable();
 }
 
-void Renderer::renderShadowMapFace(Scene &scene, SPtr<GameObject> light, SPtr<ShaderProgram> shadowProgram, int face) {
+void Renderer::renderShadowMapFace(const SceneSnapshot &snapshot, SPtr<GameObject> light, SPtr<ShaderProgram> shadowProgram, int face) {
+   PROFILE_ZONE("Renderer::renderShadowMapFace");
+
    glClear(GL_DEPTH_BUFFER_BIT);
    LightComponent &lightComponent = light->getLightComponent();
 
-   // Projection matrix
+   // Projection / view matrices
    glm::mat4 proj(lightComponent.getProjectionMatrix());
-   shadowProgram->setUniformValue("uProjMatrix", proj);
-
-   // View matrix
    glm::mat4 view(lightComponent.getViewMatrix(face));
-   shadowProgram->setUniformValue("uViewMatrix", view);
+   const glm::vec3 &lightPosition = light->getRenderTransform().position;
+   setView(proj, view, lightPosition);
 
-   shadowProgram->setUniformValue("uLightDir", glm::normalize(lightComponent.getDirection()));
+   shadowProgram->setUniformValue(LIGHT_DIR_UNIFORM, glm::normalize(lightComponent.getRenderDirection()));
 
    // View frustum
    frustumChecker.updateFrustum(proj * view);
+   cullObjects(snapshot, shadowCullStats);
 
    RenderData renderData(RenderState::Shadow);
    renderData.setOverrideProgram(shadowProgram);
 
    // Objects
-   const std::vector<SPtr<GameObject>> &gameObjects = scene.getObjects();
-   for (SPtr<GameObject> gameObject : gameObjects) {
-      if (gameObject == light) {
-         continue;
-      }
-
-      if (frustumChecker.inFrustum(*gameObject)) {
-         shadowProgram->setUniformValue("uDisableNormalOffsetting", !gameObject->getGraphicsComponent().useNormalOffsetShadows(), true);
-         gameObject->getGraphicsComponent().draw(renderData);
+   renderQueue.clear();
+   for (GameObject *gameObject : visibleObjects) {
+      if (gameObject != light.get()) {
+         renderQueue.add(RenderPass::Shadow, *gameObject, glm::distance(lightPosition, gameObject->getRenderTransform().position));
       }
    }
+   renderQueue.sort();
+   renderQueue.draw(RenderPass::Shadow, renderData);
 }
 
-void Renderer::renderFromCamera(Scene &scene, const GameObject &camera, const Viewport &viewport) {
+void Renderer::renderFromCamera(const SceneSnapshot &snapshot, const GameObject &camera, const Viewport &viewport) {
+   PROFILE_ZONE("Renderer::renderFromCamera");
+
    RenderData renderData;
 
    // Set up shaders
    const CameraComponent &cameraComponent = camera.getCameraComponent();
-   const glm::mat4 &viewMatrix = cameraComponent.getViewMatrix();
-   const glm::vec3 &cameraPosition = cameraComponent.getCameraPosition();
-   const std::set<SPtr<ShaderProgram>> &shaderPrograms = scene.getShaderPrograms();
-   for (SPtr<ShaderProgram> shaderProgram : shaderPrograms) {
-      // Projection matrix
-      shaderProgram->setUniformValue("uProjMatrix", projectionMatrix);
-
-      // View matrix
-      shaderProgram->setUniformValue("uViewMatrix", viewMatrix);
-
-      // Camera position
-      shaderProgram->setUniformValue("uCameraPos", cameraPosition, true);
-   }
+   const glm::mat4 &viewMatrix = cameraComponent.getRenderViewMatrix();
+   const glm::vec3 &cameraPosition = cameraComponent.getRenderCameraPosition();
+   setView(projectionMatrix, viewMatrix, cameraPosition);
 
    // Clear if needed
-   SPtr<GameObject> sun = scene.getSun();
+   SPtr<GameObject> sun = snapshot.sun;
    if (!sun) {
       glClear(GL_COLOR_BUFFER_BIT);
    }
 
    // View frustum
    frustumChecker.updateFrustum(projectionMatrix * viewMatrix);
+   cullObjects(snapshot, cameraCullStats);
 
-   // Opaque objects
-   const std::vector<SPtr<GameObject>> &gameObjects = scene.getObjects();
-   for (SPtr<GameObject> gameObject : gameObjects) {
-      renderData.setRenderingCameraObject(&camera == gameObject.get());
+   renderQueue.clear();
+   for (GameObject *gameObject : visibleObjects) {
+      float depth = glm::distance(cameraPosition, gameObject->getRenderTransform().position);
 
-      if (frustumChecker.inFrustum(*gameObject) && !gameObject->getGraphicsComponent().hasTransparency()) {
-         gameObject->getGraphicsComponent().draw(renderData);
+      if (!gameObject->getGraphicsComponent().hasTransparency()) {
+         renderQueue.add(RenderPass::Opaque, *gameObject, depth);
+      } else if (&camera != gameObject) {
+         // Don't render the object that the camera is attached to
+         renderQueue.add(RenderPass::Transparent, *gameObject, depth);
       }
    }
+   renderQueue.sort();
+
+   // Opaque objects
+   {
+      PROFILE_ZONE("Renderer::renderOpaque");
+      renderQueue.draw(RenderPass::Opaque, renderData, &camera);
+   }
 
    // Sky
    if (sun) {
+      PROFILE_ZONE("Renderer::renderSky");
       skyRenderer.render(viewMatrix, projectionMatrix, viewport, glm::vec2((float)width, (float)height), sun);
    }
 
    // Transparent objects
-   for (SPtr<GameObject> gameObject : gameObjects) {
-      // Don't render the object that the camera is attached to
-      if (&camera == gameObject.get()) {
-         continue;
-      }
-
-      if (frustumChecker.inFrustum(*gameObject) && gameObject->getGraphicsComponent().hasTransparency()) {
-         gameObject->getGraphicsComponent().draw(renderData);
-      }
+   {
+      PROFILE_ZONE("Renderer::renderTransparent");
+      renderQueue.draw(RenderPass::Transparent, renderData, &camera);
    }
 
-   if (renderDebug) {
-      renderDebugInfo(scene, viewMatrix);
+   if (renderDebug && snapshot.debugDrawer) {
+      renderDebugInfo(*snapshot.debugDrawer, viewMatrix);
    }
 
-   renderCameraPost(scene, camera, viewport);
+   renderCameraPost(snapshot, camera, viewport);
 }
 
-void Renderer::renderCameraPost(Scene &scene, const GameObject &camera, const Viewport &viewport) {
+void Renderer::renderCameraPost(const SceneSnapshot &snapshot, const GameObject &camera, const Viewport &viewport) {
    PlayerLogicComponent *playerLogic = dynamic_cast<PlayerLogicComponent*>(&camera.getLogicComponent());
 
    if (!playerLogic) {
       return;
    }
 
+   PROFILE_ZONE("Renderer::renderCameraPost");
+
    glDisable(GL_DEPTH_TEST);
 
-   hudRenderer.render(*playerLogic, width, height);
+   {
+      PROFILE_ZONE("HUDRenderer::render");
+      hudRenderer.render(playerLogic->getRenderState(), width, height);
+   }
 
    int playerNum = playerLogic->getPlayerNum();
-   if (scene.getGameState().hasWinner() && scene.getGameState().getWinner() == playerNum) {
-      float runningTime = Context::getInstance().getRunningTime() * 5.0f;
-      float timeSinceEnd = scene.getTimeSinceEnd();
+   if (snapshot.gameState.hasWinner() && snapshot.gameState.getWinner() == playerNum) {
+      float runningTime = snapshot.runningTime * 5.0f;
+      float timeSinceEnd = snapshot.timeSinceEnd;
       float offset = glm::pi<float>() * 2.0f / 3.0f;
       float red = (glm::sin(runningTime) + 1.0f) / 2.0f;
       float green = (glm::sin(runningTime + offset) + 1.0f) / 2.0f;
@@ -475,29 +540,29 @@ void Renderer::renderCameraPost(Scene &scene, const GameObject &camera, const Vi
       postProcessRenderer.render(opacity, glm::vec3(red, green, blue));
    }
 
-   if (!playerLogic->isAlive()) {
-      float opacity = 0.75f * glm::smoothstep(0.0f, 1.0f, playerLogic->timeSinceDeath());
+   const PlayerRenderState &playerState = playerLogic->getRenderState();
+   if (!playerState.alive) {
+      float opacity = 0.75f * glm::smoothstep(0.0f, 1.0f, playerState.timeSinceDeath);
       postProcessRenderer.render(opacity, glm::vec3(0.0f));
    }
 
-   renderScore(scene, *playerLogic, viewport);
+   renderScore(snapshot, *playerLogic, viewport);
 
    glEnable(GL_DEPTH_TEST);
 }
 
-void Renderer::renderScore(Scene &scene, const PlayerLogicComponent &playerLogic, const Viewport &viewport) {
-   const GameSession &session = Context::getInstance().getGameSession();
-   if (!session.currentLevelEnded) {
+void Renderer::renderScore(const SceneSnapshot &snapshot, const PlayerLogicComponent &playerLogic, const Viewport &viewport) {
+   if (!snapshot.levelEnded) {
       return;
    }
 
    int playerNum = playerLogic.getPlayerNum();
-   ASSERT(playerNum >= 0 && playerNum < session.players.size(), "Invalid player number: %d", playerNum);
+   ASSERT(playerNum >= 0 && playerNum < snapshot.scores.size(), "Invalid player number: %d", playerNum);
 
-   float timeSinceEnd = scene.getTimeSinceEnd();
-   int winner = scene.getGameState().getWinner();
+   float timeSinceEnd = snapshot.timeSinceEnd;
+   int winner = snapshot.gameState.getWinner();
 
-   int score = session.players[playerNum].score;
+   int score = snapshot.scores[playerNum];
    FontType type = FontType::Medium;
    std::string suffix;
    if (playerNum == winner) {
@@ -517,22 +582,26 @@ void Renderer::renderScore(Scene &scene, const PlayerLogicComponent &playerLogic
    }
    std::string text(std::to_string(score) + suffix);
 
+   PROFILE_ZONE("Renderer::renderScore");
+
    textRenderer.renderImmediate(viewport.width, viewport.height, 0.5f, 0.5f, text, type);
 }
 
-void Renderer::renderFullscreenPost(Scene &scene) {
+void Renderer::renderFullscreenPost(const SceneSnapshot &snapshot) {
+   PROFILE_ZONE("Renderer::renderFullscreenPost");
+
    glDisable(GL_DEPTH_TEST);
 
    float opacity = 0.0f;
 
    // Fade in
-   float timeSinceStart = scene.getTimeSinceStart();
+   float timeSinceStart = snapshot.timeSinceStart;
    if (timeSinceStart < 1.0f) {
       opacity = 1.0f - glm::smoothstep(0.0f, FADE_TIME, timeSinceStart);
    }
 
    // Fade out
-   float timeSinceEnd = scene.getTimeSinceEnd();
+   float timeSinceEnd = snapshot.timeSinceEnd;
    if (timeSinceEnd - FADE_OUT_DELAY > 0.0f) {
       opacity = glm::smoothstep(0.0f, FADE_TIME, timeSinceEnd - FADE_OUT_DELAY);
    }
@@ -544,17 +613,11 @@ void Renderer::renderFullscreenPost(Scene &scene) {
    glEnable(GL_DEPTH_TEST);
 }
 
-void Renderer::renderDebugInfo(Scene &scene, const glm::mat4 &viewMatrix) {
-   DebugDrawer &debugDrawer = scene.getDebugDrawer();
-
-   // Instruct Bullet to generate debug drawing data
-   scene.getPhysicsManager()->debugDraw();
+void Renderer::renderDebugInfo(const DebugDrawer &debugDrawer, const glm::mat4 &viewMatrix) {
+   PROFILE_ZONE("Renderer::renderDebugInfo");
 
-   // Render the data
+   // The data is generated (and cleared) when the scene is snapshotted
    debugRenderer.render(debugDrawer, viewMatrix, projectionMatrix);
-
-   // Clear the data
-   debugDrawer.clear();
 }
 
 SPtr<Texture> Renderer::renderTextToTexture(const std::string &text, Resolution *resolution) {
@@ -1,21 +1,28 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
+#include "BoundingVolumeHierarchy.h"
 #include "DebugRenderer.h"
+#include "DrawStateCache.h"
 #include "HUDRenderer.h"
 #include "PostProcessRenderer.h"
+#include "RenderQueue.h"
 #include "SkyRenderer.h"
 #include "TextRenderer.h"
+#include "UniformBlocks.h"
+#include "UniformBuffer.h"
 #include "Viewport.h"
 
 #include <glm/glm.hpp>
 
 #include <array>
+#include <vector>
 
 class GameObject;
 class PlayerLogicComponent;
 class ShadowMap;
 class ShadowMapManager;
+struct SceneSnapshot;
 
 class FrustumChecker {
 protected:
@@ -29,6 +36,10 @@ public:
    void updateFrustum(const glm::mat4 &viewProj);
 
    bool inFrustum(GameObject &gameObject);
+
+   const std::array<glm::vec4, 6>& getPlanes() const {
+      return planes;
+   }
 };
 
 class Renderer {
@@ -60,6 +71,27 @@ protected:
 
    FrustumChecker frustumChecker;
 
+   /**
+    * Objects that passed the last culling query (reused to avoid reallocating every pass)
+    */
+   std::vector<GameObject*> visibleObjects;
+
+   /**
+    * Visible objects sorted by the state they draw with (reused to avoid reallocating every pass)
+    */
+   RenderQueue renderQueue;
+
+   /**
+    * Culling work done for cameras / shadow maps in the last rendered frame
+    */
+   CullStats cameraCullStats;
+   CullStats shadowCullStats;
+
+   /**
+    * State changes made by scene draws in the last rendered frame
+    */
+   DrawStats drawStats;
+
    /**
     * Width of the framebuffer (in pixels)
     */
@@ -102,6 +134,15 @@ protected:
 
    UPtr<ShadowMapManager> shadowMapManager;
 
+   /**
+    * Buffers of the uniform blocks shared by the scene's programs, and the data last written to them
+    */
+   UPtr<UniformBuffer> cameraBuffer;
+   UPtr<UniformBuffer> lightsBuffer;
+   CameraBlock cameraBlock;
+   LightsBlock lightsBlock;
+   ShadowMapUnits shadowMapUnits;
+
    /**
     * If debug rendering is enabled
     */
@@ -109,35 +150,48 @@ protected:
 
    void updatePixelDensity();
 
-   void renderShadowMaps(Scene &scene);
+   /**
+    * Fills visibleObjects with the snapshot's objects that may be inside the frustum checker's current frustum
+    */
+   void cullObjects(const SceneSnapshot &snapshot, CullStats &stats);
+
+   void renderShadowMaps(const SceneSnapshot &snapshot);
 
-   void prepareLights(Scene &scene);
+   /**
+    * Writes the lights / shadows of the snapshot to the Lights block, and points each program at the shadow maps
+    */
+   void prepareLights(const SceneSnapshot &snapshot);
 
-   void renderShadowMap(Scene &scene, SPtr<GameObject> light);
+   /**
+    * Writes the given view to the Camera block, for the draws that follow
+    */
+   void setView(const glm::mat4 &projection, const glm::mat4 &view, const glm::vec3 &position);
 
-   void renderShadowMapFace(Scene &scene, SPtr<GameObject> light, SPtr<ShaderProgram> shadowProgram, int face = -1);
+   void renderShadowMap(const SceneSnapshot &snapshot, SPtr<GameObject> light);
+
+   void renderShadowMapFace(const SceneSnapshot &snapshot, SPtr<GameObject> light, SPtr<ShaderProgram> shadowProgram, int face = -1);
 
    /**
     * Renders the scene from the given camera's perspective
     */
-   void renderFromCamera(Scene &scene, const GameObject &camera, const Viewport &viewport);
+   void renderFromCamera(const SceneSnapshot &snapshot, const GameObject &camera, const Viewport &viewport);
 
-   void renderScore(Scene &scene, const PlayerLogicComponent &playerLogic, const Viewport &viewport);
+   void renderScore(const SceneSnapshot &snapshot, const PlayerLogicComponent &playerLogic, const Viewport &viewport);
 
    /**
     * Renders full-screen postprocessing effects
     */
-   void renderFullscreenPost(Scene &scene);
+   void renderFullscreenPost(const SceneSnapshot &snapshot);
 
    /**
     * Renders per-camera postprocessing effetcs
     */
-   void renderCameraPost(Scene &scene, const GameObject &camera, const Viewport &viewport);
+   void renderCameraPost(const SceneSnapshot &snapshot, const GameObject &camera, const Viewport &viewport);
 
    /**
-    * Renders the debug physics information for the scene
+    * Renders the debug physics information captured in the snapshot
     */
-   void renderDebugInfo(Scene &scene, const glm::mat4 &viewMatrix);
+   void renderDebugInfo(const DebugDrawer &debugDrawer, const glm::mat4 &viewMatrix);
 
 public:
    Renderer();
@@ -160,9 +214,9 @@ public:
    void onWindowSizeChange(int width, int height);
 
    /**
-    * Renders the given scene
+    * Renders the given scene, as of its last snapshot (only reads the snapshot, so the scene can tick concurrently)
     */
-   void render(Scene &scene);
+   void render(const Scene &scene);
 
    /**
     * Enables / disables rendering of debug physics information
@@ -197,6 +251,18 @@ public:
       return pixelDensity;
    }
 
+   const CullStats& getCameraCullStats() const {
+      return cameraCullStats;
+   }
+
+   const CullStats& getShadowCullStats() const {
+      return shadowCullStats;
+   }
+
+   const DrawStats& getDrawStats() const {
+      return drawStats;
+   }
+
    SPtr<Texture> renderTextToTexture(const std::string &text, Resolution *resolution = nullptr);
 };
 
@@ -7,22 +7,29 @@
 #include "GameObject.h"
 #include "GraphicsComponent.h"
 #include "InputComponent.h"
+#include "LogHelper.h"
+#include "LogicComponent.h"
 #include "Material.h"
 #include "Model.h"
 #include "PhysicsComponent.h"
 #include "PhysicsManager.h"
 #include "PlayerLogicComponent.h"
 #include "PlayerPhysicsComponent.h"
+#include "Profiler.h"
 #include "Scene.h"
 
 #include <algorithm>
 
 Scene::Scene()
-   : ended(false), physicsManager(std::make_shared<PhysicsManager>()), debugDrawer(new DebugDrawer), ticking(false), timeSinceStart(0.0f), timeSinceEnd(0.0f), timeUntilEnd(-1.0f) {
+   : ended(false), physicsManager(std::make_shared<PhysicsManager>()), debugDrawer(new DebugDrawer), objectPool(*this), players(SceneList::Players), cameras(SceneList::Cameras), lights(SceneList::Lights), objects(SceneList::Objects), ticking(false), timeSinceStart(0.0f), timeSinceEnd(0.0f), timeUntilEnd(-1.0f) {
    RUN_DEBUG(physicsManager->setDebugDrawer(debugDrawer.get());)
 }
 
 Scene::~Scene() {
+   const PoolStats &poolStats = objectPool.getStats();
+   if (poolStats.hits + poolStats.misses > 0) {
+      LOG_INFO("Object pool: " << poolStats.hits << " hits, " << poolStats.misses << " misses (" << (poolStats.hitRate() * 100.0f) << "% hit rate)");
+   }
 }
 
 bool Scene::addToVectors(GameObjectVectors &vectors, SPtr<GameObject> object) {
@@ -33,7 +40,13 @@ bool Scene::addToVectors(GameObjectVectors &vectors, SPtr<GameObject> object) {
       return false;
    }
 
-   vectors.objects.push_back(object);
+   const SlotHandle &handle = object->getSceneHandle(vectors.list);
+   const SPtr<GameObject> *existing = vectors.objects.get(handle);
+   if (existing && *existing == object) {
+      return false;
+   }
+
+   object->setSceneHandle(vectors.list, vectors.objects.insert(object));
    return true;
 }
 
@@ -45,11 +58,19 @@ bool Scene::removeFromVectors(GameObjectVectors &vectors, SPtr<GameObject> objec
       return false;
    }
 
-   vectors.objects.erase(std::remove(vectors.objects.begin(), vectors.objects.end(), object), vectors.objects.end());
+   const SlotHandle &handle = object->getSceneHandle(vectors.list);
+   const SPtr<GameObject> *existing = vectors.objects.get(handle);
+   if (!existing || *existing != object) {
+      return false;
+   }
+
+   vectors.objects.remove(handle);
+   object->setSceneHandle(vectors.list, SlotHandle());
    return true;
 }
 
 void Scene::processPendingObjects() {
+   PROFILE_ZONE("Scene::processPendingObjects");
    ASSERT(!ticking, "Trying to process pending objects during tick (can cause concurrent modification issues)");
 
    // Removals
@@ -97,14 +118,37 @@ void Scene::processPendingObjects() {
    objects.toAdd.clear();
 }
 
+void Scene::rebuildTickLists() {
+   PROFILE_ZONE("Scene::rebuildTickLists");
+
+   tickLists.inputComponents.clear();
+   tickLists.logicComponents.clear();
+   tickLists.callbackObjects.clear();
+
+   for (const SPtr<GameObject> &object : objects.objects.getValues()) {
+      if (object->hasActiveInput()) {
+         tickLists.inputComponents.push_back(&object->getInputComponent());
+      }
+      if (object->hasActiveLogic()) {
+         tickLists.logicComponents.push_back(&object->getLogicComponent());
+      }
+      if (object->hasTickCallback()) {
+         tickLists.callbackObjects.push_back(object.get());
+      }
+   }
+
+   tickLists.dirty = false;
+}
+
 void Scene::updateWinState() {
+   PROFILE_ZONE("Scene::updateWinState");
    if (gameState.hasWinner()) {
       ended = true;
       return;
    }
 
    std::vector<SPtr<GameObject>> livingPlayers(getLivingPlayers());
-   if (livingPlayers.size() == 0 && players.objects.size() > 0) {
+   if (livingPlayers.size() == 0 && !players.objects.empty()) {
       ended = true;
       return;
    }
@@ -123,10 +167,11 @@ void Scene::updateWinState() {
 }
 
 void Scene::updateAudioAttributes() {
+   PROFILE_ZONE("Scene::updateAudioAttributes");
    AudioManager &audioManager = Context::getInstance().getAudioManager();
 
    std::vector<ListenerAttributes> attributes;
-   for (SPtr<GameObject> gameObject : cameras.objects) {
+   for (const SPtr<GameObject> &gameObject : cameras.objects.getValues()) {
       CameraComponent &cameraComponent = gameObject->getCameraComponent();
       PlayerPhysicsComponent *physicsComponent = dynamic_cast<PlayerPhysicsComponent*>(&gameObject->getPhysicsComponent());
 
@@ -147,14 +192,37 @@ void Scene::setWinner(int player) {
 }
 
 void Scene::tick(const float dt) {
+   PROFILE_ZONE("Scene::tick");
+
    processPendingObjects();
+   if (tickLists.dirty) {
+      rebuildTickLists();
+   }
 
    ticking = true;
 
    physicsManager->tick(dt);
 
-   for (SPtr<GameObject> object : objects.objects) {
-      object->tick(dt);
+   // Same work as GameObject::tick(), but one pass per type
+   {
+      PROFILE_ZONE("Scene::tickInput");
+      for (InputComponent *inputComponent : tickLists.inputComponents) {
+         inputComponent->update();
+      }
+   }
+
+   {
+      PROFILE_ZONE("Scene::tickLogic");
+      for (LogicComponent *logicComponent : tickLists.logicComponents) {
+         logicComponent->tick(dt);
+      }
+   }
+
+   {
+      PROFILE_ZONE("Scene::tickCallbacks");
+      for (GameObject *object : tickLists.callbackObjects) {
+         object->runTickCallback(dt);
+      }
    }
 
    updateAudioAttributes();
@@ -174,6 +242,57 @@ void Scene::tick(const float dt) {
    }
 
    ticking = false;
+   tickLists.retiredComponents.clear();
+}
+
+void Scene::snapshot(bool captureDebugDrawing) {
+   PROFILE_ZONE("Scene::snapshot");
+   ASSERT(!ticking, "Trying to snapshot scene during tick");
+
+   renderSnapshot.cameras = cameras.objects.getValues();
+   renderSnapshot.lights = lights.objects.getValues();
+   renderSnapshot.objects = objects.objects.getValues();
+   renderSnapshot.shaderPrograms = shaderPrograms;
+   renderSnapshot.sun = sun;
+
+   // Objects can be in multiple vectors, but snapshotting them more than once is harmless
+   for (const SPtr<GameObject> &camera : cameras.objects.getValues()) {
+      camera->snapshot();
+   }
+   for (const SPtr<GameObject> &light : lights.objects.getValues()) {
+      light->snapshot();
+   }
+   for (const SPtr<GameObject> &object : objects.objects.getValues()) {
+      object->snapshot();
+   }
+   if (sun) {
+      sun->snapshot();
+   }
+
+   renderSnapshot.objectHierarchy.update(renderSnapshot.objects);
+
+   renderSnapshot.gameState = gameState;
+   renderSnapshot.timeSinceStart = timeSinceStart;
+   renderSnapshot.timeSinceEnd = timeSinceEnd;
+
+   const Context &context = Context::getInstance();
+   const GameSession &session = context.getGameSession();
+   renderSnapshot.runningTime = context.getRunningTime();
+   renderSnapshot.levelEnded = session.currentLevelEnded;
+   renderSnapshot.scores.clear();
+   for (const Player &player : session.players) {
+      renderSnapshot.scores.push_back(player.score);
+   }
+
+   // Lights stop rendering (and claiming shadow maps) when their pooled objects are freed, so give the maps back now
+   objectPool.releaseShadowMaps();
+
+   renderSnapshot.debugDrawer = nullptr;
+   if (captureDebugDrawing) {
+      debugDrawer->clear();
+      physicsManager->debugDraw();
+      renderSnapshot.debugDrawer = debugDrawer.get();
+   }
 }
 
 void Scene::addPlayer(SPtr<GameObject> player) {
@@ -193,11 +312,18 @@ void Scene::addObject(SPtr<GameObject> object) {
    if (!addedNow) {
       return;
    }
-
-   object->getPhysicsComponent().addToManager(physicsManager);
+   tickLists.dirty = true;
+
+   // Pooled objects stay in the physics world while they're free, and just need to be enabled again
+   PhysicsComponent &physicsComponent = object->getPhysicsComponent();
+   if (physicsComponent.isInManager(physicsManager)) {
+      physicsComponent.setEnabled(true);
+   } else {
+      physicsComponent.addToManager(physicsManager);
+   }
 
    SPtr<Model> model = object->getGraphicsComponent().getModel();
-   if (model) {
+   if (model && model->getShaderProgram()) {
       shaderPrograms.insert(model->getShaderProgram());
    }
 
@@ -221,8 +347,14 @@ void Scene::removeObject(SPtr<GameObject> object) {
    if (!removedNow) {
       return;
    }
+   tickLists.dirty = true;
 
-   object->getPhysicsComponent().removeFromManager(physicsManager);
+   if (objectPool.owns(*object)) {
+      object->getPhysicsComponent().setEnabled(false);
+      objectPool.onRemoved(*object);
+   } else {
+      object->getPhysicsComponent().removeFromManager(physicsManager);
+   }
 
    // TODO Make shared programs a set of WPtrs?
    // (auto-clean on each tick)
@@ -234,8 +366,13 @@ void Scene::removeObject(SPtr<GameObject> object) {
    object->setScene(WPtr<Scene>());
 }
 
+SPtr<GameObject> Scene::findObject(const SlotHandle &handle) const {
+   const SPtr<GameObject> *object = objects.objects.get(handle);
+   return object ? *object : nullptr;
+}
+
 SPtr<GameObject> Scene::getPlayerByNumber(int playerNum) const {
-   for (SPtr<GameObject> player : players.objects) {
+   for (const SPtr<GameObject> &player : players.objects.getValues()) {
       PlayerLogicComponent *playerLogic = dynamic_cast<PlayerLogicComponent*>(&player->getLogicComponent());
       if (playerLogic && playerNum == playerLogic->getPlayerNum()) {
          return player;
@@ -248,7 +385,7 @@ SPtr<GameObject> Scene::getPlayerByNumber(int playerNum) const {
 std::vector<SPtr<GameObject>> Scene::getLivingPlayers() const {
    std::vector<SPtr<GameObject>> livingPlayers;
 
-   for (SPtr<GameObject> player : players.objects) {
+   for (const SPtr<GameObject> &player : players.objects.getValues()) {
       PlayerLogicComponent *playerLogic = dynamic_cast<PlayerLogicComponent*>(&player->getLogicComponent());
       ASSERT(playerLogic, "Player should have PlayerLogicComponent");
 
@@ -1,13 +1,18 @@
 #ifndef SCENE_H
 #define SCENE_H
 
+#include "BoundingVolumeHierarchy.h"
+#include "GameObject.h"
+#include "GameObjectPool.h"
+#include "SlotMap.h"
 #include "Types.h"
 
 #include <set>
 #include <vector>
 
 class DebugDrawer;
-class GameObject;
+class InputComponent;
+class LogicComponent;
 class MenuLogicComponent;
 class PhysicsManager;
 class PlayerLogicComponent;
@@ -43,10 +48,44 @@ public:
    }
 };
 
+/**
+ * One of the scene's object lists. Objects store their handle in each list they're in, so removal is an O(1) swap with
+ * the last object (an object can only be in one scene at a time)
+ */
 struct GameObjectVectors {
-   std::vector<SPtr<GameObject>> objects;
+   const SceneList list;
+   SlotMap<SPtr<GameObject>> objects;
    std::vector<SPtr<GameObject>> toAdd;
    std::vector<SPtr<GameObject>> toRemove;
+
+   GameObjectVectors(SceneList list)
+      : list(list) {
+   }
+};
+
+/**
+ * What the scene's objects run each tick, in dense per-type arrays (objects with null input / logic components or no
+ * tick callback are left out), so that ticking is a few linear passes rather than a virtual call per component per
+ * object. All input components are updated first, then all logic components, then all tick callbacks (rather than
+ * each object running all three before the next object). Rebuilt before a tick whenever objects are added or removed,
+ * or change what they run
+ */
+struct TickLists {
+   std::vector<InputComponent*> inputComponents;
+   std::vector<LogicComponent*> logicComponents;
+   std::vector<GameObject*> callbackObjects;
+
+   /**
+    * Components replaced while the scene was ticking, kept alive until the tick ends since the lists still point to
+    * them (objects removed while ticking are kept alive by the deferred removal)
+    */
+   std::vector<SPtr<void>> retiredComponents;
+
+   bool dirty;
+
+   TickLists()
+      : dirty(false) {
+   }
 };
 
 enum class MouseEvent {
@@ -58,6 +97,36 @@ enum class MouseEvent {
 
 typedef std::function<void(MenuLogicComponent &menuLogic, MouseEvent event)> ClickFunction;
 
+/**
+ * Everything the renderer reads from a scene (and the game session), captured between ticks so that the scene can
+ * keep ticking while a frame is rendered
+ */
+struct SceneSnapshot {
+   std::vector<SPtr<GameObject>> cameras;
+   std::vector<SPtr<GameObject>> lights;
+   std::vector<SPtr<GameObject>> objects;
+   std::set<SPtr<ShaderProgram>> shaderPrograms;
+   SPtr<GameObject> sun;
+
+   // Culling structure over the objects' render bounds
+   BoundingVolumeHierarchy objectHierarchy;
+
+   GameState gameState;
+   float timeSinceStart;
+   float timeSinceEnd;
+   float runningTime;
+
+   bool levelEnded;
+   std::vector<int> scores;
+
+   // Physics debug drawing data (null unless captured with debug drawing enabled)
+   const DebugDrawer *debugDrawer;
+
+   SceneSnapshot()
+      : timeSinceStart(0.0f), timeSinceEnd(0.0f), runningTime(0.0f), levelEnded(false), debugDrawer(nullptr) {
+   }
+};
+
 struct ClickableObject {
    WPtr<GameObject> gameObject;
    ClickFunction clickFunction;
@@ -75,6 +144,8 @@ protected:
    const SPtr<PhysicsManager> physicsManager;
    const UPtr<DebugDrawer> debugDrawer;
 
+   GameObjectPool objectPool;
+
    std::set<SPtr<ShaderProgram>> shaderPrograms;
 
    SPtr<GameObject> sun;
@@ -85,6 +156,10 @@ protected:
 
    std::vector<ClickableObject> clickableObjects;
 
+   TickLists tickLists;
+
+   SceneSnapshot renderSnapshot;
+
    bool ticking;
 
    float timeSinceStart;
@@ -99,6 +174,8 @@ protected:
 
    void processPendingObjects();
 
+   void rebuildTickLists();
+
    void updateWinState();
 
    void updateAudioAttributes();
@@ -112,6 +189,16 @@ public:
 
    void tick(const float dt);
 
+   /**
+    * Captures the state of the scene (and all objects in it) to be rendered, optionally generating physics debug
+    * drawing data. Must not be called while the scene is ticking
+    */
+   void snapshot(bool captureDebugDrawing);
+
+   const SceneSnapshot& getSnapshot() const {
+      return renderSnapshot;
+   }
+
    const GameState& getGameState() const {
       return gameState;
    }
@@ -124,24 +211,28 @@ public:
       return *debugDrawer;
    }
 
+   GameObjectPool& getObjectPool() {
+      return objectPool;
+   }
+
    SPtr<GameObject> getSun() const {
       return sun;
    }
 
    const std::vector<SPtr<GameObject>>& getPlayers() const {
-      return players.objects;
+      return players.objects.getValues();
    }
 
    const std::vector<SPtr<GameObject>>& getCameras() const {
-      return cameras.objects;
+      return cameras.objects.getValues();
    }
 
    const std::vector<SPtr<GameObject>>& getLights() const {
-      return lights.objects;
+      return lights.objects.getValues();
    }
 
    const std::vector<SPtr<GameObject>>& getObjects() const {
-      return objects.objects;
+      return objects.objects.getValues();
    }
 
    const std::set<SPtr<ShaderProgram>>& getShaderPrograms() const {
@@ -168,6 +259,24 @@ public:
 
    void removeObject(SPtr<GameObject> object);
 
+   /**
+    * Looks up an object by its handle in the scene's object list (see GameObject::getSceneHandle()), returning null if
+    * the object has since been removed
+    */
+   SPtr<GameObject> findObject(const SlotHandle &handle) const;
+
+   /**
+    * Called when an object in the scene changes what it runs each tick (its input / logic component or tick callback),
+    * along with the component it replaced (if any)
+    */
+   void onTickStateChange(SPtr<void> replacedComponent = nullptr) {
+      tickLists.dirty = true;
+
+      if (ticking && replacedComponent) {
+         tickLists.retiredComponents.push_back(replacedComponent);
+      }
+   }
+
    SPtr<GameObject> getPlayerByNumber(int playerNum) const;
 
    std::vector<SPtr<GameObject>> getLivingPlayers() const;
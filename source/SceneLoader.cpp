@@ -11,6 +11,8 @@
 #include "GhostPhysicsComponent.h"
 #include "InputComponent.h"
 #include "InputHandler.h"
+#include "IOUtils.h"
+#include "LevelData.h"
 #include "LightComponent.h"
 #include "LogHelper.h"
 #include "MenuLogicComponent.h"
@@ -44,7 +46,8 @@
 
 namespace {
 
-typedef std::function<SPtr<Scene>(const Context &context)> LoadFunction;
+const std::string LEVEL_DIRECTORY = "levels/";
+const std::string LEVEL_EXTENSION = ".tgil";
 
 SPtr<PhongMaterial> createPhongMaterial(glm::vec3 color, float specular, float shininess, float emission = 0.0f) {
    return std::make_shared<PhongMaterial>(color * 0.3f, color * 0.7f, glm::vec3(specular), color * emission, shininess);
@@ -98,11 +101,12 @@ SPtr<GameObject> createBvhObject(SPtr<Model> model, const glm::vec3 &position, c
    return staticObject;
 }
 
-SPtr<GameObject> createDynamicObject(SPtr<Model> model, const glm::vec3 &position, const glm::vec3 &scale, float friction, float restitution, float mass) {
+SPtr<GameObject> createDynamicObject(SPtr<Model> model, const glm::vec3 &position, const glm::vec3 &scale, float friction, float restitution, float mass, const glm::quat &orientation = glm::quat()) {
    SPtr<GameObject> dynamicObject(std::make_shared<GameObject>());
 
    // Transform
    dynamicObject->setPosition(position);
+   dynamicObject->setOrientation(orientation);
    dynamicObject->setScale(scale);
 
    // Graphics
@@ -299,7 +303,7 @@ const glm::vec3 colors[] = {
    glm::normalize(glm::vec3(0.2f, 1.0f, 0.2f)) * 1.5f
 };
 
-SPtr<Scene> loadBasicScene(const Context &context, glm::vec3 spawnLocations[4], std::function<void(Scene &scene)> callback, bool addPlayers = true) {
+SPtr<Scene> loadBasicScene(const Context &context, const glm::vec3 spawnLocations[4], std::function<void(Scene &scene)> callback, bool addPlayers = true) {
    SPtr<Scene> scene(std::make_shared<Scene>());
    AssetManager &assetManager = context.getAssetManager();
 
@@ -382,18 +386,60 @@ SPtr<Scene> loadBasicScene(const Context &context, glm::vec3 spawnLocations[4],
          scene->addCamera(player);
          scene->addLight(player);
          scene->addObject(player);
+
+         // Build ability objects up front, so that using abilities during the game doesn't allocate
+         PlayerLogicComponent *playerLogic = dynamic_cast<PlayerLogicComponent*>(&player->getLogicComponent());
+         if (playerLogic) {
+            playerLogic->prewarmAbilities(*scene);
+         }
       }
    }
 
    return scene;
 }
 
+uint32_t addPhongModel(LevelData &level, const std::string &meshName, const glm::vec3 &color, float specular, float shininess, float emission = 0.0f) {
+   LevelMaterial material;
+   material.color = color;
+   material.specular = specular;
+   material.shininess = shininess;
+   material.emission = emission;
+
+   return level.addModel(meshName, "shaders/phong", level.addMaterial(material));
+}
+
+void addLevelObject(LevelData &level, uint32_t model, LevelPhysics physics, const glm::vec3 &position, const glm::vec3 &scale, float friction, float restitution, const glm::quat &orientation = glm::quat(), float mass = 0.0f, bool castShadows = true) {
+   LevelObject object;
+   object.model = model;
+   object.physics = physics;
+   object.position = position;
+   object.orientation = orientation;
+   object.scale = scale;
+   object.friction = friction;
+   object.restitution = restitution;
+   object.mass = mass;
+   object.castShadows = castShadows ? 1 : 0;
+
+   level.addObject(object);
+}
+
 } // namespace
 
 namespace SceneLoader {
 
-std::default_random_engine generator;
+unsigned int seed = std::default_random_engine::default_seed;
+std::default_random_engine generator(seed);
 std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+
+void setSeed(unsigned int newSeed) {
+   seed = newSeed;
+   generator.seed(seed);
+}
+
+unsigned int getSeed() {
+   return seed;
+}
+
 glm::quat randomOrientation() {
    return glm::normalize(glm::angleAxis(1.5f, glm::vec3(distribution(generator), distribution(generator), distribution(generator))));
 }
@@ -609,354 +655,257 @@ SPtr<Scene> loadMenuScene(const Context &context) {
    }, false);
 }
 
-SPtr<Scene> loadCenterIslandScene(const Context &context) {
-   glm::vec3 spawnLocations[] = {
-      glm::vec3(-10.0f, 20.0f, 0.0f),
-      glm::vec3(0.0f, 20.0f, 10.0f),
-      glm::vec3(10.0f, 20.0f, 0.0f),
-      glm::vec3(0.0f, 20.0f, -10.0f)
-   };
-
-   return loadBasicScene(context, spawnLocations, [&context](Scene &scene) {
-      AssetManager &assetManager = context.getAssetManager();
-      SPtr<ShaderProgram> phongShaderProgram(assetManager.loadShaderProgram("shaders/phong"));
-
-      SPtr<PhongMaterial> trunkMaterial = createPhongMaterial(glm::vec3(0.36f, 0.27f, 0.11f), 0.2f, 5.0f);
-      SPtr<Mesh> trunkMesh = assetManager.loadMesh("meshes/trunk_lg.obj");
-      SPtr<Model> trunkModel(std::make_shared<Model>(phongShaderProgram, trunkMesh));
-      trunkModel->attachMaterial(trunkMaterial);
-
-      SPtr<PhongMaterial> leavesMaterial = createPhongMaterial(glm::vec3(0.86f, 0.26f, 0.0f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> leavesMesh = assetManager.loadMesh("meshes/leaves_lg.obj");
-      SPtr<Model> leavesModel(std::make_shared<Model>(phongShaderProgram, leavesMesh));
-      leavesModel->attachMaterial(leavesMaterial);
+LevelData buildCenterIslandLevel() {
+   LevelData level;
+   level.setSpawnLocation(0, glm::vec3(-10.0f, 20.0f, 0.0f));
+   level.setSpawnLocation(1, glm::vec3(0.0f, 20.0f, 10.0f));
+   level.setSpawnLocation(2, glm::vec3(10.0f, 20.0f, 0.0f));
+   level.setSpawnLocation(3, glm::vec3(0.0f, 20.0f, -10.0f));
 
-      SPtr<PhongMaterial> rockMaterial = createPhongMaterial(glm::vec3(0.4f, 0.4f, 0.4f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> rockMesh = assetManager.loadMesh("meshes/rock_lg.obj");
-      SPtr<Model> rockModel(std::make_shared<Model>(phongShaderProgram, rockMesh));
-      rockModel->attachMaterial(rockMaterial);
+   uint32_t trunkModel = addPhongModel(level, "meshes/trunk_lg.obj", glm::vec3(0.36f, 0.27f, 0.11f), 0.2f, 5.0f);
+   uint32_t leavesModel = addPhongModel(level, "meshes/leaves_lg.obj", glm::vec3(0.86f, 0.26f, 0.0f) * 1.5f, 0.2f, 5.0f);
+   uint32_t rockModel = addPhongModel(level, "meshes/rock_lg.obj", glm::vec3(0.4f, 0.4f, 0.4f) * 1.5f, 0.2f, 5.0f);
+   uint32_t islandModel = addPhongModel(level, "meshes/island.obj", glm::vec3(0.78f, 0.60f, 0.34f) * 1.5f, 0.2f, 5.0f);
 
-      SPtr<PhongMaterial> islandMaterial = createPhongMaterial(glm::vec3(0.78f, 0.60f, 0.34f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> islandMesh = assetManager.loadMesh("meshes/island.obj");
-      SPtr<Model> islandModel(std::make_shared<Model>(phongShaderProgram, islandMesh));
-      islandModel->attachMaterial(islandMaterial);
+   // Island
+   addLevelObject(level, islandModel, LevelPhysics::Bvh, glm::vec3(0.0f, 3.0f, 0.0f), glm::vec3(5.0f), 1.0f, 0.3f);
 
-      SPtr<PhongMaterial> smallIslandMaterial = createPhongMaterial(glm::vec3(0.78f, 0.60f, 0.34f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> smallIslandMesh = assetManager.loadMesh("meshes/island_sm.obj");
-      SPtr<Model> smallIslandModel(std::make_shared<Model>(phongShaderProgram, smallIslandMesh));
-      smallIslandModel->attachMaterial(smallIslandMaterial);
+   // Trees
 
-      SPtr<PhongMaterial> bridgeMaterial = createPhongMaterial(glm::vec3(0.78f, 0.60f, 0.34f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> bridgeMesh = assetManager.loadMesh("meshes/bridge.obj");
-      SPtr<Model> bridgeModel(std::make_shared<Model>(phongShaderProgram, bridgeMesh));
-      bridgeModel->attachMaterial(bridgeMaterial);
+   glm::vec3 loc(-11.8f, 15.4f, 9.3f);
+   addLevelObject(level, trunkModel, LevelPhysics::Static, loc, glm::vec3(1.0f), 1.0f, 0.3f);
+   addLevelObject(level, leavesModel, LevelPhysics::Static, loc, glm::vec3(1.0f), 1.0f, 0.3f);
 
-      // Island
-      scene.addObject(createBvhObject(islandModel, glm::vec3(0.0f, 3.0f, 0.0f), glm::vec3(5.0f), 1.0f, 0.3f));
+   glm::vec3 loc2(12.3f, 14.7f, -1.9f);
+   addLevelObject(level, trunkModel, LevelPhysics::Static, loc2, glm::vec3(1.0f), 1.0f, 0.3f);
+   addLevelObject(level, leavesModel, LevelPhysics::Static, loc2, glm::vec3(1.0f), 1.0f, 0.3f);
 
-      // Trees
+   glm::vec3 loc3(1.0f, 13.7f, -20.1f);
+   addLevelObject(level, trunkModel, LevelPhysics::Static, loc3, glm::vec3(1.0f), 1.0f, 0.3f);
+   addLevelObject(level, leavesModel, LevelPhysics::Static, loc3, glm::vec3(1.0f), 1.0f, 0.3f);
 
-      glm::vec3 loc(-11.8f, 15.4f, 9.3f);
-      scene.addObject(createStaticObject(trunkModel, loc, glm::vec3(1.0f), 1.0f, 0.3f));
-      scene.addObject(createStaticObject(leavesModel, loc, glm::vec3(1.0f), 1.0f, 0.3f));
+   // Rocks
 
-      glm::vec3 loc2(12.3f, 14.7f, -1.9f);
-      scene.addObject(createStaticObject(trunkModel, loc2, glm::vec3(1.0f), 1.0f, 0.3f));
-      scene.addObject(createStaticObject(leavesModel, loc2, glm::vec3(1.0f), 1.0f, 0.3f));
+   glm::vec3 loc6(-4.6f, 14.0f, -9.9f);
+   glm::quat ori1(glm::normalize(glm::angleAxis(1.5f, glm::vec3(0.4f, 0.6f, 0.1f))));
+   addLevelObject(level, rockModel, LevelPhysics::Static, loc6, glm::vec3(1.0f), 1.0f, 0.3f, ori1);
 
-      glm::vec3 loc3(1.0f, 13.7f, -20.1f);
-      scene.addObject(createStaticObject(trunkModel, loc3, glm::vec3(1.0f), 1.0f, 0.3f));
-      scene.addObject(createStaticObject(leavesModel, loc3, glm::vec3(1.0f), 1.0f, 0.3f));
-
-      // Rocks
+   glm::vec3 loc7(-2.5f, 16.3f, 7.2f);
+   glm::quat ori2(glm::normalize(glm::angleAxis(1.5f, glm::vec3(0.7f, 0.3f, 0.8f))));
+   addLevelObject(level, rockModel, LevelPhysics::Static, loc7, glm::vec3(1.0f), 1.0f, 0.3f, ori2);
 
-      glm::vec3 loc6(-4.6f, 14.0f, -9.9f);
-      glm::quat ori1(glm::normalize(glm::angleAxis(1.5f, glm::vec3(0.4f, 0.6f, 0.1f))));
-      scene.addObject(createStaticObject(rockModel, loc6, glm::vec3(glm::vec3(1.0f)), 1.0f, 0.3f, ori1));
+   glm::vec3 loc8(11.6f, 15.0f, 12.3f);
+   glm::quat ori3(glm::normalize(glm::angleAxis(1.5f, glm::vec3(0.2f, 0.1f, 0.5f))));
+   addLevelObject(level, rockModel, LevelPhysics::Static, loc8, glm::vec3(1.0f), 1.0f, 0.3f, ori3);
 
-      glm::vec3 loc7(-2.5f, 16.3f, 7.2f);
-      glm::quat ori2(glm::normalize(glm::angleAxis(1.5f, glm::vec3(0.7f, 0.3f, 0.8f))));
-      scene.addObject(createStaticObject(rockModel, loc7, glm::vec3(glm::vec3(1.0f)), 1.0f, 0.3f, ori2));
+   glm::vec3 loc9(-18.9f, 15.0f, -0.3f);
+   glm::quat ori4(glm::normalize(glm::angleAxis(1.5f, glm::vec3(0.9f, 0.4f, 0.7f))));
+   addLevelObject(level, rockModel, LevelPhysics::Static, loc9, glm::vec3(1.0f), 1.0f, 0.3f, ori4);
 
-      glm::vec3 loc8(11.6f, 15.0f, 12.3f);
-      glm::quat ori3(glm::normalize(glm::angleAxis(1.5f, glm::vec3(0.2f, 0.1f, 0.5f))));
-      scene.addObject(createStaticObject(rockModel, loc8, glm::vec3(glm::vec3(1.0f)), 1.0f, 0.3f, ori3));
-
-      glm::vec3 loc9(-18.9f, 15.0f, -0.3f);
-      glm::quat ori4(glm::normalize(glm::angleAxis(1.5f, glm::vec3(0.9f, 0.4f, 0.7f))));
-      scene.addObject(createStaticObject(rockModel, loc9, glm::vec3(glm::vec3(1.0f)), 1.0f, 0.3f, ori4));
-   });
+   return level;
 }
 
-SPtr<Scene> loadFourBridgedIslandsScene(const Context &context) {
-   glm::vec3 spawnLocations[] = {
-      glm::vec3(-30.0f, 15.0f, 0.0f),
-      glm::vec3(0.0f, 15.0f, 30.0f),
-      glm::vec3(30.0f, 15.0f, 0.0f),
-      glm::vec3(0.0f, 15.0f, -30.0f)
+LevelData buildFourBridgedIslandsLevel() {
+   LevelData level;
+   level.setSpawnLocation(0, glm::vec3(-30.0f, 15.0f, 0.0f));
+   level.setSpawnLocation(1, glm::vec3(0.0f, 15.0f, 30.0f));
+   level.setSpawnLocation(2, glm::vec3(30.0f, 15.0f, 0.0f));
+   level.setSpawnLocation(3, glm::vec3(0.0f, 15.0f, -30.0f));
+
+   uint32_t trunkModel = addPhongModel(level, "meshes/trunk_lg.obj", glm::vec3(0.36f, 0.27f, 0.11f), 0.2f, 5.0f);
+   uint32_t leavesModel = addPhongModel(level, "meshes/leaves_lg.obj", glm::vec3(0.86f, 0.26f, 0.0f) * 1.5f, 0.2f, 5.0f);
+   uint32_t rockModel = addPhongModel(level, "meshes/rock_lg.obj", glm::vec3(0.4f, 0.4f, 0.4f) * 1.5f, 0.2f, 5.0f);
+   uint32_t islandModel = addPhongModel(level, "meshes/island2.obj", glm::vec3(0.78f, 0.60f, 0.34f) * 1.5f, 0.2f, 5.0f);
+   uint32_t smallIslandModel = addPhongModel(level, "meshes/island_sm.obj", glm::vec3(0.78f, 0.60f, 0.34f) * 1.5f, 0.2f, 5.0f);
+   uint32_t bridgeModel = addPhongModel(level, "meshes/bridge.obj", glm::vec3(0.78f, 0.60f, 0.34f) * 1.5f, 0.2f, 5.0f);
+
+   // Island
+   addLevelObject(level, islandModel, LevelPhysics::Bvh, glm::vec3(0.0f, 3.0f, 0.0f), glm::vec3(0.5f), 1.0f, 0.3f);
+
+   // Spawn islands
+
+   addLevelObject(level, smallIslandModel, LevelPhysics::Bvh, glm::vec3(-30.0f, 10.0f, 0.0f), glm::vec3(1.0f), 1.0f, 0.3f);
+   addLevelObject(level, smallIslandModel, LevelPhysics::Bvh, glm::vec3(30.0f, 10.0f, 0.0f), glm::vec3(1.0f), 1.0f, 0.3f);
+   addLevelObject(level, smallIslandModel, LevelPhysics::Bvh, glm::vec3(0.0f, 10.0f, -30.0f), glm::vec3(1.0f), 1.0f, 0.3f);
+   addLevelObject(level, smallIslandModel, LevelPhysics::Bvh, glm::vec3(0.0f, 10.0f, 30.0f), glm::vec3(1.0f), 1.0f, 0.3f);
+
+   // Bridges
+   glm::quat tilt(glm::angleAxis(glm::radians(23.0f), glm::vec3(0.0f, 0.0f, 1.0f)));
+   addLevelObject(level, bridgeModel, LevelPhysics::Bvh, glm::vec3(18.0f, 5.0f, 0.0f), glm::vec3(1.5f), 1.0f, 0.3f, tilt);
+   addLevelObject(level, bridgeModel, LevelPhysics::Bvh, glm::vec3(-18.0f, 5.0f, 0.0f), glm::vec3(1.5f), 1.0f, 0.3f, glm::angleAxis(glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f)) * tilt);
+   addLevelObject(level, bridgeModel, LevelPhysics::Bvh, glm::vec3(0.0f, 5.0f, 18.0f), glm::vec3(1.5f), 1.0f, 0.3f, glm::angleAxis(glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f)) * tilt);
+   addLevelObject(level, bridgeModel, LevelPhysics::Bvh, glm::vec3(0.0f, 5.0f, -18.0f), glm::vec3(1.5f), 1.0f, 0.3f, glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f)) * tilt);
+
+   // Trees (one in each player's color by their spawn point, plus one in the middle)
+
+   const glm::vec3 playerTreeLocations[] = {
+      glm::vec3(-32.0f, 12.0f, 0.0f),
+      glm::vec3(0.0f, 12.0f, 32.0f),
+      glm::vec3(32.0f, 12.0f, 0.0f),
+      glm::vec3(0.0f, 12.0f, -32.0f)
    };
+   for (int i = 0; i < 4; ++i) {
+      uint32_t playerLeavesModel = addPhongModel(level, "meshes/leaves_lg.obj", colors[i], 0.2f, 5.0f);
+      addLevelObject(level, trunkModel, LevelPhysics::Static, playerTreeLocations[i], glm::vec3(0.75f), 1.0f, 0.3f);
+      addLevelObject(level, playerLeavesModel, LevelPhysics::Static, playerTreeLocations[i], glm::vec3(0.75f), 1.0f, 0.3f);
+   }
 
-   return loadBasicScene(context, spawnLocations, [&context](Scene &scene) {
-      AssetManager &assetManager = context.getAssetManager();
-      SPtr<ShaderProgram> phongShaderProgram(assetManager.loadShaderProgram("shaders/phong"));
-
-      SPtr<PhongMaterial> trunkMaterial = createPhongMaterial(glm::vec3(0.36f, 0.27f, 0.11f), 0.2f, 5.0f);
-      SPtr<Mesh> trunkMesh = assetManager.loadMesh("meshes/trunk_lg.obj");
-      SPtr<Model> trunkModel(std::make_shared<Model>(phongShaderProgram, trunkMesh));
-      trunkModel->attachMaterial(trunkMaterial);
-
-      SPtr<PhongMaterial> leavesMaterial = createPhongMaterial(glm::vec3(0.86f, 0.26f, 0.0f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> leavesMesh = assetManager.loadMesh("meshes/leaves_lg.obj");
-      SPtr<Model> leavesModel(std::make_shared<Model>(phongShaderProgram, leavesMesh));
-      leavesModel->attachMaterial(leavesMaterial);
-
-      SPtr<PhongMaterial> rockMaterial = createPhongMaterial(glm::vec3(0.4f, 0.4f, 0.4f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> rockMesh = assetManager.loadMesh("meshes/rock_lg.obj");
-      SPtr<Model> rockModel(std::make_shared<Model>(phongShaderProgram, rockMesh));
-      rockModel->attachMaterial(rockMaterial);
-
-      SPtr<PhongMaterial> islandMaterial = createPhongMaterial(glm::vec3(0.78f, 0.60f, 0.34f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> islandMesh = assetManager.loadMesh("meshes/island2.obj");
-      SPtr<Model> islandModel(std::make_shared<Model>(phongShaderProgram, islandMesh));
-      islandModel->attachMaterial(islandMaterial);
-
-      SPtr<PhongMaterial> smallIslandMaterial = createPhongMaterial(glm::vec3(0.78f, 0.60f, 0.34f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> smallIslandMesh = assetManager.loadMesh("meshes/island_sm.obj");
-      SPtr<Model> smallIslandModel(std::make_shared<Model>(phongShaderProgram, smallIslandMesh));
-      smallIslandModel->attachMaterial(smallIslandMaterial);
-
-      SPtr<PhongMaterial> bridgeMaterial = createPhongMaterial(glm::vec3(0.78f, 0.60f, 0.34f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> bridgeMesh = assetManager.loadMesh("meshes/bridge.obj");
-      SPtr<Model> bridgeModel(std::make_shared<Model>(phongShaderProgram, bridgeMesh));
-      bridgeModel->attachMaterial(bridgeMaterial);
-
-      // Island
-      scene.addObject(createBvhObject(islandModel, glm::vec3(0.0f, 3.0f, 0.0f), glm::vec3(0.5f), 1.0f, 0.3f));
-
-      // Spawn islands
-
-      scene.addObject(createBvhObject(smallIslandModel, glm::vec3(-30.0f, 10.0f, 0.0f), glm::vec3(1.0f), 1.0f, 0.3f));
-      scene.addObject(createBvhObject(smallIslandModel, glm::vec3(30.0f, 10.0f, 0.0f), glm::vec3(1.0f), 1.0f, 0.3f));
-      scene.addObject(createBvhObject(smallIslandModel, glm::vec3(0.0f, 10.0f, -30.0f), glm::vec3(1.0f), 1.0f, 0.3f));
-      scene.addObject(createBvhObject(smallIslandModel, glm::vec3(0.0f, 10.0f, 30.0f), glm::vec3(1.0f), 1.0f, 0.3f));
-
-      // Bridges
-      glm::quat tilt(glm::angleAxis(glm::radians(23.0f), glm::vec3(0.0f, 0.0f, 1.0f)));
-      scene.addObject(createBvhObject(bridgeModel, glm::vec3(18.0f, 5.0f, 0.0f), glm::vec3(1.5f), 1.0f, 0.3f, tilt));
-      scene.addObject(createBvhObject(bridgeModel, glm::vec3(-18.0f, 5.0f, 0.0f), glm::vec3(1.5f), 1.0f, 0.3f, glm::angleAxis(glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f)) * tilt));
-      scene.addObject(createBvhObject(bridgeModel, glm::vec3(0.0f, 5.0f, 18.0f), glm::vec3(1.5f), 1.0f, 0.3f, glm::angleAxis(glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f)) * tilt));
-      scene.addObject(createBvhObject(bridgeModel, glm::vec3(0.0f, 5.0f, -18.0f), glm::vec3(1.5f), 1.0f, 0.3f, glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f)) * tilt));
-
-      // Trees
+   glm::vec3 loc5(0.0f, 6.0f, 0.0f);
+   addLevelObject(level, trunkModel, LevelPhysics::Static, loc5, glm::vec3(1.5f), 1.0f, 0.3f);
+   addLevelObject(level, leavesModel, LevelPhysics::Static, loc5, glm::vec3(1.5f), 1.0f, 0.3f);
 
-      SPtr<PhongMaterial> leavesMaterialP1 = createPhongMaterial(colors[0], 0.2f, 5.0f);
-      SPtr<Model> leavesModelP1(std::make_shared<Model>(phongShaderProgram, leavesMesh));
-      leavesModelP1->attachMaterial(leavesMaterialP1);
-      glm::vec3 loc(-32.0f, 12.0f, 0.0f);
-      scene.addObject(createStaticObject(trunkModel, loc, glm::vec3(0.75f), 1.0f, 0.3f));
-      scene.addObject(createStaticObject(leavesModelP1, loc, glm::vec3(0.75f), 1.0f, 0.3f));
-
-      SPtr<PhongMaterial> leavesMaterialP2 = createPhongMaterial(colors[1], 0.2f, 5.0f);
-      SPtr<Model> leavesModelP2(std::make_shared<Model>(phongShaderProgram, leavesMesh));
-      leavesModelP2->attachMaterial(leavesMaterialP2);
-      glm::vec3 loc2(0.0f, 12.0f, 32.0f);
-      scene.addObject(createStaticObject(trunkModel, loc2, glm::vec3(0.75f), 1.0f, 0.3f));
-      scene.addObject(createStaticObject(leavesModelP2, loc2, glm::vec3(0.75f), 1.0f, 0.3f));
-
-      SPtr<PhongMaterial> leavesMaterialP3 = createPhongMaterial(colors[2], 0.2f, 5.0f);
-      SPtr<Model> leavesModelP3(std::make_shared<Model>(phongShaderProgram, leavesMesh));
-      leavesModelP3->attachMaterial(leavesMaterialP3);
-      glm::vec3 loc3(32.0f, 12.0f, 0.0f);
-      scene.addObject(createStaticObject(trunkModel, loc3, glm::vec3(0.75f), 1.0f, 0.3f));
-      scene.addObject(createStaticObject(leavesModelP3, loc3, glm::vec3(0.75f), 1.0f, 0.3f));
-
-      SPtr<PhongMaterial> leavesMaterialP4 = createPhongMaterial(colors[3], 0.2f, 5.0f);
-      SPtr<Model> leavesModelP4(std::make_shared<Model>(phongShaderProgram, leavesMesh));
-      leavesModelP4->attachMaterial(leavesMaterialP4);
-      glm::vec3 loc4(0.0f, 12.0f, -32.0f);
-      scene.addObject(createStaticObject(trunkModel, loc4, glm::vec3(0.75f), 1.0f, 0.3f));
-      scene.addObject(createStaticObject(leavesModelP4, loc4, glm::vec3(0.75f), 1.0f, 0.3f));
-
-      glm::vec3 loc5(0.0f, 6.0f, 0.0f);
-      scene.addObject(createStaticObject(trunkModel, loc5, glm::vec3(1.5f), 1.0f, 0.3f));
-      scene.addObject(createStaticObject(leavesModel, loc5, glm::vec3(1.5f), 1.0f, 0.3f));
+   // Rocks
 
-      // Rocks
+   glm::vec3 loc6(-3.6f, 6.6f, -5.4f);
+   glm::quat ori1(glm::normalize(glm::angleAxis(1.5f, glm::vec3(0.4f, 0.6f, 0.1f))));
+   addLevelObject(level, rockModel, LevelPhysics::Static, loc6, glm::vec3(1.0f), 1.0f, 0.3f, ori1);
 
-      glm::vec3 loc6(-3.6f, 6.6f, -5.4f);
-      glm::quat ori1(glm::normalize(glm::angleAxis(1.5f, glm::vec3(0.4f, 0.6f, 0.1f))));
-      scene.addObject(createStaticObject(rockModel, loc6, glm::vec3(glm::vec3(1.0f)), 1.0f, 0.3f, ori1));
+   glm::vec3 loc7(-4.5f, 6.3f, 8.2f);
+   glm::quat ori2(glm::normalize(glm::angleAxis(1.5f, glm::vec3(0.7f, 0.3f, 0.8f))));
+   addLevelObject(level, rockModel, LevelPhysics::Static, loc7, glm::vec3(1.0f), 1.0f, 0.3f, ori2);
 
-      glm::vec3 loc7(-4.5f, 6.3f, 8.2f);
-      glm::quat ori2(glm::normalize(glm::angleAxis(1.5f, glm::vec3(0.7f, 0.3f, 0.8f))));
-      scene.addObject(createStaticObject(rockModel, loc7, glm::vec3(glm::vec3(1.0f)), 1.0f, 0.3f, ori2));
+   glm::vec3 loc8(6.8f, 5.5f, 6.3f);
+   glm::quat ori3(glm::normalize(glm::angleAxis(1.5f, glm::vec3(0.2f, 0.1f, 0.5f))));
+   addLevelObject(level, rockModel, LevelPhysics::Static, loc8, glm::vec3(1.0f), 1.0f, 0.3f, ori3);
 
-      glm::vec3 loc8(6.8f, 5.5f, 6.3f);
-      glm::quat ori3(glm::normalize(glm::angleAxis(1.5f, glm::vec3(0.2f, 0.1f, 0.5f))));
-      scene.addObject(createStaticObject(rockModel, loc8, glm::vec3(glm::vec3(1.0f)), 1.0f, 0.3f, ori3));
-   });
+   return level;
 }
 
-SPtr<Scene> loadGridIslandScene(const Context &context) {
+LevelData buildGridIslandLevel() {
    const float SIZE = 27.0f;
    const float DISTANCE = 13.0f;
    const float PLATFORM_HEIGHT = 15.0f;
    const float HEIGHT_RANGE = 4.0f;
    const float SPAWN_HEIGHT = PLATFORM_HEIGHT + HEIGHT_RANGE + 5.0f;
 
-   glm::vec3 spawnLocations[] = {
-      glm::vec3(-SIZE, SPAWN_HEIGHT, -SIZE),
-      glm::vec3(SIZE, SPAWN_HEIGHT, -SIZE),
-      glm::vec3(-SIZE, SPAWN_HEIGHT, SIZE),
-      glm::vec3(SIZE, SPAWN_HEIGHT, SIZE)
-   };
-
-   return loadBasicScene(context, spawnLocations, [&context, SIZE, DISTANCE, PLATFORM_HEIGHT, HEIGHT_RANGE](Scene &scene) {
-      AssetManager &assetManager = context.getAssetManager();
-      SPtr<ShaderProgram> phongShaderProgram(assetManager.loadShaderProgram("shaders/phong"));
-
-      SPtr<PhongMaterial> trunkMaterial = createPhongMaterial(glm::vec3(0.36f, 0.27f, 0.11f), 0.2f, 5.0f);
-      SPtr<Mesh> trunkMesh = assetManager.loadMesh("meshes/trunk_lg.obj");
-      SPtr<Model> trunkModel(std::make_shared<Model>(phongShaderProgram, trunkMesh));
-      trunkModel->attachMaterial(trunkMaterial);
-
-      SPtr<PhongMaterial> leavesMaterial = createPhongMaterial(glm::vec3(0.86f, 0.26f, 0.0f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> leavesMesh = assetManager.loadMesh("meshes/leaves_lg.obj");
-      SPtr<Model> leavesModel(std::make_shared<Model>(phongShaderProgram, leavesMesh));
-      leavesModel->attachMaterial(leavesMaterial);
-
-      SPtr<PhongMaterial> rockMaterial = createPhongMaterial(glm::vec3(0.4f, 0.4f, 0.4f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> rockMesh = assetManager.loadMesh("meshes/rock_lg.obj");
-      SPtr<Model> rockModel(std::make_shared<Model>(phongShaderProgram, rockMesh));
-      rockModel->attachMaterial(rockMaterial);
-
-      SPtr<PhongMaterial> islandMaterial = createPhongMaterial(glm::vec3(0.78f, 0.60f, 0.34f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> islandMesh = assetManager.loadMesh("meshes/island.obj");
-      SPtr<Model> islandModel(std::make_shared<Model>(phongShaderProgram, islandMesh));
-      islandModel->attachMaterial(islandMaterial);
-
-      SPtr<PhongMaterial> smallIslandMaterial = createPhongMaterial(glm::vec3(0.78f, 0.60f, 0.34f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> smallIslandMesh = assetManager.loadMesh("meshes/island_sm.obj");
-      SPtr<Model> smallIslandModel(std::make_shared<Model>(phongShaderProgram, smallIslandMesh));
-      smallIslandModel->attachMaterial(smallIslandMaterial);
+   LevelData level;
+   level.setSpawnLocation(0, glm::vec3(-SIZE, SPAWN_HEIGHT, -SIZE));
+   level.setSpawnLocation(1, glm::vec3(SIZE, SPAWN_HEIGHT, -SIZE));
+   level.setSpawnLocation(2, glm::vec3(-SIZE, SPAWN_HEIGHT, SIZE));
+   level.setSpawnLocation(3, glm::vec3(SIZE, SPAWN_HEIGHT, SIZE));
+
+   uint32_t trunkModel = addPhongModel(level, "meshes/trunk_lg.obj", glm::vec3(0.36f, 0.27f, 0.11f), 0.2f, 5.0f);
+   uint32_t leavesModel = addPhongModel(level, "meshes/leaves_lg.obj", glm::vec3(0.86f, 0.26f, 0.0f) * 1.5f, 0.2f, 5.0f);
+   uint32_t rockModel = addPhongModel(level, "meshes/rock_lg.obj", glm::vec3(0.4f, 0.4f, 0.4f) * 1.5f, 0.2f, 5.0f);
+   uint32_t smallIslandModel = addPhongModel(level, "meshes/island_sm.obj", glm::vec3(0.78f, 0.60f, 0.34f) * 1.5f, 0.2f, 5.0f);
+
+   // Generated from the seed, so that recordings replay on the same layout
+   std::default_random_engine generator(seed);
+   std::uniform_real_distribution<float> distribution(-HEIGHT_RANGE, HEIGHT_RANGE);
+   std::uniform_real_distribution<float> offsetDistribution(-1.5f, 1.5f);
+   std::uniform_real_distribution<float> scaleDistribution(0.7f, 1.3f);
+   for (float x = -SIZE; x < SIZE; x += DISTANCE) {
+      for (float z = -SIZE; z < SIZE; z += DISTANCE) {
+         float heightDiff = distribution(generator);
+         glm::vec3 loc(glm::vec3(x, PLATFORM_HEIGHT + heightDiff, z));
+         addLevelObject(level, smallIslandModel, LevelPhysics::Bvh, loc, glm::vec3(1.0f), 1.0f, 0.3f);
+
+         // Don't place anything on the spawn points
+         if (glm::abs(x) > SIZE - DISTANCE / 2.0f &&
+             glm::abs(z) > SIZE - DISTANCE / 2.0f) {
+            continue;
+         }
 
-      SPtr<PhongMaterial> bridgeMaterial = createPhongMaterial(glm::vec3(0.78f, 0.60f, 0.34f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> bridgeMesh = assetManager.loadMesh("meshes/bridge.obj");
-      SPtr<Model> bridgeModel(std::make_shared<Model>(phongShaderProgram, bridgeMesh));
-      bridgeModel->attachMaterial(bridgeMaterial);
-
-      std::default_random_engine generator;
-      std::uniform_real_distribution<float> distribution(-HEIGHT_RANGE, HEIGHT_RANGE);
-      std::uniform_real_distribution<float> offsetDistribution(-1.5f, 1.5f);
-      std::uniform_real_distribution<float> scaleDistribution(0.7f, 1.3f);
-      for (float x = -SIZE; x < SIZE; x += DISTANCE) {
-         for (float z = -SIZE; z < SIZE; z += DISTANCE) {
-            float heightDiff = distribution(generator);
-            glm::vec3 loc(glm::vec3(x, PLATFORM_HEIGHT + heightDiff, z));
-            scene.addObject(createBvhObject(smallIslandModel, loc, glm::vec3(1.0f), 1.0f, 0.3f));
-
-            // Don't place anything on the spawn points
-            if (glm::abs(x) > SIZE - DISTANCE / 2.0f &&
-                glm::abs(z) > SIZE - DISTANCE / 2.0f) {
-               continue;
-            }
-
-            // Maybe place a tree
-            float val = distribution(generator);
-            if (val > HEIGHT_RANGE / 4.0f) {
-               float treeScale = scaleDistribution(generator);
-               glm::vec3 treeLoc(loc + glm::vec3(offsetDistribution(generator), 2.5f, offsetDistribution(generator)));
-               scene.addObject(createStaticObject(trunkModel, treeLoc, glm::vec3(treeScale), 1.0f, 0.3f));
-               scene.addObject(createStaticObject(leavesModel, treeLoc, glm::vec3(treeScale), 1.0f, 0.3f));
-            } // Other 50% of the time, place a rock
-            else if (val > 0.0f) {
-               glm::quat ori(glm::normalize(glm::angleAxis(1.5f, glm::vec3(offsetDistribution(generator), offsetDistribution(generator), offsetDistribution(generator)))));
-               scene.addObject(createStaticObject(rockModel, loc + glm::vec3(offsetDistribution(generator), 3.0f, offsetDistribution(generator)), glm::vec3(glm::vec3(scaleDistribution(generator))), 1.0f, 0.3f, ori));
-            }
+         // Values are drawn one per statement, in the order GCC evaluated the arguments they used to be drawn in
+         // (right to left), so that a seed always generates the layout it did before levels were built as LevelData
+
+         // Maybe place a tree
+         float val = distribution(generator);
+         if (val > HEIGHT_RANGE / 4.0f) {
+            float treeScale = scaleDistribution(generator);
+            float treeOffsetZ = offsetDistribution(generator);
+            float treeOffsetX = offsetDistribution(generator);
+            glm::vec3 treeLoc(loc + glm::vec3(treeOffsetX, 2.5f, treeOffsetZ));
+            addLevelObject(level, trunkModel, LevelPhysics::Static, treeLoc, glm::vec3(treeScale), 1.0f, 0.3f);
+            addLevelObject(level, leavesModel, LevelPhysics::Static, treeLoc, glm::vec3(treeScale), 1.0f, 0.3f);
+         } // Other 50% of the time, place a rock
+         else if (val > 0.0f) {
+            float axisZ = offsetDistribution(generator);
+            float axisY = offsetDistribution(generator);
+            float axisX = offsetDistribution(generator);
+            glm::quat ori(glm::normalize(glm::angleAxis(1.5f, glm::vec3(axisX, axisY, axisZ))));
+
+            float rockScale = scaleDistribution(generator);
+            float rockOffsetZ = offsetDistribution(generator);
+            float rockOffsetX = offsetDistribution(generator);
+            glm::vec3 rockLoc(loc + glm::vec3(rockOffsetX, 3.0f, rockOffsetZ));
+            addLevelObject(level, rockModel, LevelPhysics::Static, rockLoc, glm::vec3(rockScale), 1.0f, 0.3f, ori);
          }
       }
-   });
+   }
+
+   return level;
 }
 
-SPtr<Scene> loadPlusScene(const Context &context) {
+LevelData buildPlusLevel() {
    const float SIZE = 40.0f;
-   const float DISTANCE = 13.0f;
    const float PLATFORM_HEIGHT = 15.0f;
    const float HEIGHT_RANGE = 4.0f;
    const float SPAWN_HEIGHT = PLATFORM_HEIGHT + HEIGHT_RANGE + 5.0f;
 
-   glm::vec3 spawnLocations[] = {
-      glm::vec3(-SIZE, SPAWN_HEIGHT, 0.0f),
-      glm::vec3(SIZE, SPAWN_HEIGHT, 0.0f),
-      glm::vec3(0.0f, SPAWN_HEIGHT, -SIZE),
-      glm::vec3(0.0f, SPAWN_HEIGHT, SIZE)
+   LevelData level;
+   level.setSpawnLocation(0, glm::vec3(-SIZE, SPAWN_HEIGHT, 0.0f));
+   level.setSpawnLocation(1, glm::vec3(SIZE, SPAWN_HEIGHT, 0.0f));
+   level.setSpawnLocation(2, glm::vec3(0.0f, SPAWN_HEIGHT, -SIZE));
+   level.setSpawnLocation(3, glm::vec3(0.0f, SPAWN_HEIGHT, SIZE));
+
+   uint32_t trunkModel = addPhongModel(level, "meshes/trunk_lg.obj", glm::vec3(0.36f, 0.27f, 0.11f), 0.2f, 5.0f);
+   uint32_t leavesModel = addPhongModel(level, "meshes/leaves_lg.obj", glm::vec3(0.86f, 0.26f, 0.0f) * 1.5f, 0.2f, 5.0f);
+   uint32_t plusModel = addPhongModel(level, "meshes/plus.obj", glm::vec3(0.78f, 0.60f, 0.34f) * 1.5f, 0.2f, 5.0f);
+
+   addLevelObject(level, plusModel, LevelPhysics::Bvh, glm::vec3(0.0f, 7.0f, 0.0f), glm::vec3(1.0f), 1.0f, 0.3f);
+
+   // Trees (one in each player's color by their spawn point, plus one in the middle)
+
+   const glm::vec3 playerTreeLocations[] = {
+      glm::vec3(-(SIZE + 4.5f), 13.0f, 0.0f),
+      glm::vec3((SIZE + 4.5f), 13.0f, 0.0f),
+      glm::vec3(0.0f, 13.0f, -(SIZE + 4.5f)),
+      glm::vec3(0.0f, 13.0f, (SIZE + 4.5f))
    };
+   for (int i = 0; i < 4; ++i) {
+      uint32_t playerLeavesModel = addPhongModel(level, "meshes/leaves_lg.obj", colors[i], 0.2f, 5.0f);
+      addLevelObject(level, trunkModel, LevelPhysics::Static, playerTreeLocations[i], glm::vec3(0.75f), 1.0f, 0.3f);
+      addLevelObject(level, playerLeavesModel, LevelPhysics::Static, playerTreeLocations[i], glm::vec3(0.75f), 1.0f, 0.3f);
+   }
 
-   return loadBasicScene(context, spawnLocations, [&context, SIZE, DISTANCE, PLATFORM_HEIGHT, HEIGHT_RANGE](Scene &scene) {
-      AssetManager &assetManager = context.getAssetManager();
-      SPtr<ShaderProgram> phongShaderProgram(assetManager.loadShaderProgram("shaders/phong"));
+   glm::vec3 loc5(0.0f, 16.0f, 0.0f);
+   addLevelObject(level, trunkModel, LevelPhysics::Static, loc5, glm::vec3(1.5f), 1.0f, 0.3f);
+   addLevelObject(level, leavesModel, LevelPhysics::Static, loc5, glm::vec3(1.5f), 1.0f, 0.3f);
 
-      SPtr<PhongMaterial> trunkMaterial = createPhongMaterial(glm::vec3(0.36f, 0.27f, 0.11f), 0.2f, 5.0f);
-      SPtr<Mesh> trunkMesh = assetManager.loadMesh("meshes/trunk_lg.obj");
-      SPtr<Model> trunkModel(std::make_shared<Model>(phongShaderProgram, trunkMesh));
-      trunkModel->attachMaterial(trunkMaterial);
+   return level;
+}
 
-      SPtr<PhongMaterial> leavesMaterial = createPhongMaterial(glm::vec3(0.86f, 0.26f, 0.0f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> leavesMesh = assetManager.loadMesh("meshes/leaves_lg.obj");
-      SPtr<Model> leavesModel(std::make_shared<Model>(phongShaderProgram, leavesMesh));
-      leavesModel->attachMaterial(leavesMaterial);
+struct BuiltInLevel {
+   std::string name;
+   std::function<LevelData()> build;
+};
 
-      SPtr<PhongMaterial> rockMaterial = createPhongMaterial(glm::vec3(0.4f, 0.4f, 0.4f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> rockMesh = assetManager.loadMesh("meshes/rock_lg.obj");
-      SPtr<Model> rockModel(std::make_shared<Model>(phongShaderProgram, rockMesh));
-      rockModel->attachMaterial(rockMaterial);
+const std::vector<BuiltInLevel>& getBuiltInLevels() {
+   static const std::vector<BuiltInLevel> levels = {
+      { "center_island", buildCenterIslandLevel },
+      { "four_bridged_islands", buildFourBridgedIslandsLevel },
+      { "grid_island", buildGridIslandLevel },
+      { "plus", buildPlusLevel }
+   };
 
-      SPtr<PhongMaterial> plusMaterial = createPhongMaterial(glm::vec3(0.78f, 0.60f, 0.34f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> plushMesh = assetManager.loadMesh("meshes/plus.obj");
-      SPtr<Model> plusModel(std::make_shared<Model>(phongShaderProgram, plushMesh));
-      plusModel->attachMaterial(plusMaterial);
+   return levels;
+}
 
-      SPtr<PhongMaterial> smallIslandMaterial = createPhongMaterial(glm::vec3(0.78f, 0.60f, 0.34f) * 1.5f, 0.2f, 5.0f);
-      SPtr<Mesh> smallIslandMesh = assetManager.loadMesh("meshes/island_sm.obj");
-      SPtr<Model> smallIslandModel(std::make_shared<Model>(phongShaderProgram, smallIslandMesh));
-      smallIslandModel->attachMaterial(smallIslandMaterial);
+SPtr<Scene> loadCenterIslandScene(const Context &context) {
+   return loadLevel(context, buildCenterIslandLevel());
+}
 
-      scene.addObject(createBvhObject(plusModel, glm::vec3(0.0f, 7.0f, 0.0f), glm::vec3(1.0f), 1.0f, 0.3f));
+SPtr<Scene> loadFourBridgedIslandsScene(const Context &context) {
+   return loadLevel(context, buildFourBridgedIslandsLevel());
+}
 
-      // Trees
+SPtr<Scene> loadGridIslandScene(const Context &context) {
+   return loadLevel(context, buildGridIslandLevel());
+}
 
-      SPtr<PhongMaterial> leavesMaterialP1 = createPhongMaterial(colors[0], 0.2f, 5.0f);
-      SPtr<Model> leavesModelP1(std::make_shared<Model>(phongShaderProgram, leavesMesh));
-      leavesModelP1->attachMaterial(leavesMaterialP1);
-      glm::vec3 loc(-(SIZE + 4.5f), 13.0f, 0.0f);
-      scene.addObject(createStaticObject(trunkModel, loc, glm::vec3(0.75f), 1.0f, 0.3f));
-      scene.addObject(createStaticObject(leavesModelP1, loc, glm::vec3(0.75f), 1.0f, 0.3f));
-
-      SPtr<PhongMaterial> leavesMaterialP2 = createPhongMaterial(colors[1], 0.2f, 5.0f);
-      SPtr<Model> leavesModelP2(std::make_shared<Model>(phongShaderProgram, leavesMesh));
-      leavesModelP2->attachMaterial(leavesMaterialP2);
-      glm::vec3 loc2((SIZE + 4.5f), 13.0f, 0.0f);
-      scene.addObject(createStaticObject(trunkModel, loc2, glm::vec3(0.75f), 1.0f, 0.3f));
-      scene.addObject(createStaticObject(leavesModelP2, loc2, glm::vec3(0.75f), 1.0f, 0.3f));
-
-      SPtr<PhongMaterial> leavesMaterialP3 = createPhongMaterial(colors[2], 0.2f, 5.0f);
-      SPtr<Model> leavesModelP3(std::make_shared<Model>(phongShaderProgram, leavesMesh));
-      leavesModelP3->attachMaterial(leavesMaterialP3);
-      glm::vec3 loc3(0.0f, 13.0f, -(SIZE + 4.5f));
-      scene.addObject(createStaticObject(trunkModel, loc3, glm::vec3(0.75f), 1.0f, 0.3f));
-      scene.addObject(createStaticObject(leavesModelP3, loc3, glm::vec3(0.75f), 1.0f, 0.3f));
-
-      SPtr<PhongMaterial> leavesMaterialP4 = createPhongMaterial(colors[3], 0.2f, 5.0f);
-      SPtr<Model> leavesModelP4(std::make_shared<Model>(phongShaderProgram, leavesMesh));
-      leavesModelP4->attachMaterial(leavesMaterialP4);
-      glm::vec3 loc4(0.0f, 13.0f, (SIZE + 4.5f));
-      scene.addObject(createStaticObject(trunkModel, loc4, glm::vec3(0.75f), 1.0f, 0.3f));
-      scene.addObject(createStaticObject(leavesModelP4, loc4, glm::vec3(0.75f), 1.0f, 0.3f));
-
-      glm::vec3 loc5(0.0f, 16.0f, 0.0f);
-      scene.addObject(createStaticObject(trunkModel, loc5, glm::vec3(1.5f), 1.0f, 0.3f));
-      scene.addObject(createStaticObject(leavesModel, loc5, glm::vec3(1.5f), 1.0f, 0.3f));
-   });
+SPtr<Scene> loadPlusScene(const Context &context) {
+   return loadLevel(context, buildPlusLevel());
 }
 
 SPtr<Scene> loadWinScene(const Context &context) {
@@ -1052,21 +1001,96 @@ SPtr<Scene> loadWinScene(const Context &context) {
    }, false);
 }
 
+SPtr<Scene> loadLevel(const Context &context, const LevelData &level) {
+   return loadBasicScene(context, level.getSpawnLocations().data(), [&context, &level](Scene &scene) {
+      AssetManager &assetManager = context.getAssetManager();
+
+      // Shared resources are created once, then referenced by every object that uses them
+      std::vector<SPtr<Material>> materials;
+      for (const LevelMaterial &material : level.getMaterials()) {
+         materials.push_back(createPhongMaterial(material.color, material.specular, material.shininess, material.emission));
+      }
+
+      std::vector<SPtr<Model>> models;
+      for (const LevelModel &levelModel : level.getModels()) {
+         SPtr<ShaderProgram> shaderProgram(assetManager.loadShaderProgram(level.getString(levelModel.shaderProgram)));
+         SPtr<Mesh> mesh(assetManager.loadMesh(level.getString(levelModel.mesh)));
+
+         SPtr<Model> model(std::make_shared<Model>(shaderProgram, mesh));
+         model->attachMaterial(materials[levelModel.material]);
+         models.push_back(model);
+      }
+
+      for (const LevelObject &object : level.getObjects()) {
+         const SPtr<Model> &model = models[object.model];
+         bool castShadows = object.castShadows != 0;
+
+         switch (object.physics) {
+            case LevelPhysics::Static:
+               scene.addObject(createStaticObject(model, object.position, object.scale, object.friction, object.restitution, object.orientation, castShadows));
+               break;
+            case LevelPhysics::Bvh:
+               scene.addObject(createBvhObject(model, object.position, object.scale, object.friction, object.restitution, object.orientation, castShadows));
+               break;
+            case LevelPhysics::Dynamic:
+               scene.addObject(createDynamicObject(model, object.position, object.scale, object.friction, object.restitution, object.mass, object.orientation));
+               break;
+         }
+      }
+
+      for (const LevelLight &levelLight : level.getLights()) {
+         SPtr<GameObject> light(std::make_shared<GameObject>());
+         light->setPosition(levelLight.position);
+         light->setLightComponent(std::make_shared<LightComponent>(*light, static_cast<LightComponent::LightType>(levelLight.type), levelLight.color, levelLight.direction, levelLight.linearFalloff, levelLight.squareFalloff, levelLight.beamAngle, levelLight.cutoffAngle));
+         scene.addLight(light);
+      }
+   });
+}
+
+SPtr<Scene> loadLevelFile(const Context &context, const std::string &fileName) {
+   UPtr<LevelData> level(LevelData::load(fileName));
+   if (!level) {
+      return nullptr;
+   }
+
+   return loadLevel(context, *level);
+}
+
+bool exportLevels(const std::string &directory) {
+   bool success = true;
+   for (const BuiltInLevel &builtInLevel : getBuiltInLevels()) {
+      std::string fileName(directory + "/" + builtInLevel.name + LEVEL_EXTENSION);
+      if (builtInLevel.build().save(fileName)) {
+         LOG_INFO("Exported level: " << fileName);
+      } else {
+         LOG_WARNING("Unable to export level: " << fileName);
+         success = false;
+      }
+   }
+
+   return success;
+}
+
 SPtr<Scene> loadNextLevel(const Context &context) {
-   static std::vector<LoadFunction> loadFunctions;
    static int index = 0;
 
-   if (loadFunctions.empty()) {
-      loadFunctions.push_back(loadCenterIslandScene);
-      loadFunctions.push_back(loadFourBridgedIslandsScene);
-      loadFunctions.push_back(loadGridIslandScene);
-      loadFunctions.push_back(loadPlusScene);
-   }
+   const std::vector<BuiltInLevel> &levels = getBuiltInLevels();
+   const BuiltInLevel &builtInLevel = levels[index];
+   index = (index + 1) % levels.size();
+
+   // Level files in the data directory take the place of the built-in levels, so levels can be edited without recompiling
+   std::string fileName(LEVEL_DIRECTORY + builtInLevel.name + LEVEL_EXTENSION);
+   folly::Optional<IOUtils::DataFile> levelFile(IOUtils::readDataFile(fileName));
+   if (levelFile) {
+      UPtr<LevelData> level(LevelData::loadFromMemory(levelFile->data, levelFile->size, fileName));
+      if (level) {
+         return loadLevel(context, *level);
+      }
 
-   const LoadFunction &function = loadFunctions[index];
-   index = (index + 1) % loadFunctions.size();
+      LOG_WARNING("Falling back to built-in level: " << builtInLevel.name);
+   }
 
-   return function(context);
+   return loadLevel(context, builtInLevel.build());
 }
 
 } // namespace SceneLoader
@@ -3,19 +3,49 @@
 
 #include "Types.h"
 
+#include <string>
 #include <vector>
 
 class Context;
+class LevelData;
 class Scene;
 
 namespace SceneLoader {
 
+/**
+ * Sets the seed used to randomly generate level content
+ */
+void setSeed(unsigned int seed);
+
+unsigned int getSeed();
+
 SPtr<Scene> loadMenuScene(const Context &context);
 
 SPtr<Scene> loadWinScene(const Context &context);
 
+/**
+ * Loads the grid island level directly (the densest level, which makes it the usual culling workload)
+ */
+SPtr<Scene> loadGridIslandScene(const Context &context);
+
 SPtr<Scene> loadNextLevel(const Context &context);
 
+/**
+ * Builds the level described by the given data
+ */
+SPtr<Scene> loadLevel(const Context &context, const LevelData &level);
+
+/**
+ * Loads the level file with the given name, returning null if it can't be read
+ */
+SPtr<Scene> loadLevelFile(const Context &context, const std::string &fileName);
+
+/**
+ * Writes the built-in levels to level files in the given directory (with the current seed). Level files placed in the
+ * data directory's "levels" folder replace the built-in levels
+ */
+bool exportLevels(const std::string &directory);
+
 } // namespace SceneLoader
 
 #endif
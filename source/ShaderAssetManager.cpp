@@ -1,22 +1,37 @@
 #include "FancyAssert.h"
 #include "IOUtils.h"
 #include "LogHelper.h"
+#include "OSUtils.h"
+#include "Profiler.h"
+#include "ProgramBinaryCache.h"
 #include "Shader.h"
 #include "ShaderAssetManager.h"
 #include "ShaderProgram.h"
 
+#include <algorithm>
+#include <chrono>
+#include <unordered_set>
+#include <vector>
+
 #define GLSL(source) "#version 330 core\n" #source
 
 namespace {
 
+const char* BINARY_DIRECTORY_NAME = "shader_cache";
+const char* BINARY_EXTENSION = ".tgip";
+
 const std::string VERTEX_EXTENSION = ".vert";
 const std::string GEOMETRY_EXTENSION = ".geom";
 const std::string FRAGMENT_EXTENSION = ".frag";
 
 const std::string DEFAULT_VERTEX_SOURCE = GLSL(
+   layout(std140) uniform Camera {
+      mat4 uProjMatrix;
+      mat4 uViewMatrix;
+      vec3 uCameraPos;
+   };
+
    uniform mat4 uModelMatrix;
-   uniform mat4 uViewMatrix;
-   uniform mat4 uProjMatrix;
 
    in vec3 aPosition;
 
@@ -185,73 +200,219 @@ SPtr<ShaderProgram> getDefaultShaderProgram() {
    return defaultShaderProgram;
 }
 
+struct ShaderFile {
+   std::string fileName;
+   GLenum type;
+};
+
+/**
+ * Gets the shaders that make up the program with the given name (in attachment order)
+ */
+std::vector<ShaderFile> getShaderFiles(const std::string &fileName) {
+   static const std::pair<const std::string*, GLenum> STAGES[] = {
+      { &VERTEX_EXTENSION, GL_VERTEX_SHADER },
+      { &GEOMETRY_EXTENSION, GL_GEOMETRY_SHADER },
+      { &FRAGMENT_EXTENSION, GL_FRAGMENT_SHADER }
+   };
+
+   std::vector<ShaderFile> shaderFiles;
+   for (const std::pair<const std::string*, GLenum> &stage : STAGES) {
+      ShaderFile shaderFile = { fileName + *stage.first, stage.second };
+      if (IOUtils::canReadData(shaderFile.fileName)) {
+         shaderFiles.push_back(shaderFile);
+      }
+   }
+
+   return shaderFiles;
+}
+
+/**
+ * Hashes the sources of the given shaders, returning none if any of them can't be read
+ */
+folly::Optional<uint64_t> hashShaderSources(const std::vector<ShaderFile> &shaderFiles) {
+   std::vector<std::string> sources;
+   for (const ShaderFile &shaderFile : shaderFiles) {
+      folly::Optional<std::string> source = IOUtils::readFromDataFile(shaderFile.fileName);
+      if (!source) {
+         return folly::none;
+      }
+
+      sources.push_back(shaderFile.fileName);
+      sources.push_back(*source);
+   }
+
+   return ProgramBinaryCache::hashSources(sources);
+}
+
+std::string getBinaryFileName(const std::string &directory, const std::string &fileName) {
+   // Flatten the program's path into a single file name
+   std::string flatFileName(fileName);
+   std::replace(flatFileName.begin(), flatFileName.end(), '/', '_');
+   std::replace(flatFileName.begin(), flatFileName.end(), '\\', '_');
+
+   return directory + "/" + flatFileName + BINARY_EXTENSION;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+   return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
 } // namespace
 
-ShaderAssetManager::ShaderAssetManager() {
+ShaderAssetManager::ShaderAssetManager(bool useBinaryCache) {
+   if (useBinaryCache) {
+      binaryDirectory = OSUtils::createAppDataSubdirectory(BINARY_DIRECTORY_NAME);
+      if (!binaryDirectory) {
+         LOG_WARNING("Unable to create shader cache directory");
+      }
+   }
 }
 
 ShaderAssetManager::~ShaderAssetManager() {
 }
 
+SPtr<Shader> ShaderAssetManager::findShader(const std::string &fileName) {
+   std::lock_guard<std::mutex> lock(mutex);
+
+   ShaderMap::iterator itr = shaderMap.find(fileName);
+   return itr == shaderMap.end() ? nullptr : itr->second;
+}
+
+SPtr<ShaderProgram> ShaderAssetManager::findShaderProgram(const std::string &name) {
+   std::lock_guard<std::mutex> lock(mutex);
+
+   ShaderProgramMap::iterator itr = shaderProgramMap.find(name);
+   return itr == shaderProgramMap.end() ? nullptr : itr->second;
+}
+
 SPtr<Shader> ShaderAssetManager::loadShader(const std::string &fileName, const GLenum type) {
+   bool usedDefault = false;
+   return loadShader(fileName, type, &usedDefault);
+}
+
+SPtr<Shader> ShaderAssetManager::loadShader(const std::string &fileName, const GLenum type, bool *usedDefault) {
    ASSERT(type == GL_VERTEX_SHADER || type == GL_GEOMETRY_SHADER || type == GL_FRAGMENT_SHADER, "Invalid shader type: %i", type);
 
-   if (shaderMap.count(fileName) > 0) {
-      return shaderMap[fileName];
+   SPtr<Shader> cachedShader = findShader(fileName);
+   if (cachedShader) {
+      return cachedShader;
    }
 
+   PROFILE_ZONE("ShaderAssetManager::loadShader", fileName);
+
+   sourceStatuses[fileName] = IOUtils::getDataFileStatus(fileName);
    folly::Optional<std::string> source = IOUtils::readFromDataFile(fileName);
    if (!source) {
       LOG_WARNING("Unable to load shader from file \"" << fileName << "\", reverting to default shader");
+      *usedDefault = true;
       return getDefaultShader(type);
    }
 
    SPtr<Shader> shader(std::make_shared<Shader>(type));
    if (!shader->compile(*source)) {
       LOG_WARNING("Unable to compile " << getShaderTypeName(shader->getType()) << " shader loaded from file \"" << fileName << "\", reverting to default shader. Error message: \"" << getShaderCompileError(shader) << "\"");
+      *usedDefault = true;
       shader = getDefaultShader(type);
    }
 
+   std::lock_guard<std::mutex> lock(mutex);
    shaderMap[fileName] = shader;
    return shader;
 }
 
+bool ShaderAssetManager::attachShaders(const std::string &fileName, ShaderProgram &shaderProgram) {
+   bool usedDefault = false;
+   for (const ShaderFile &shaderFile : getShaderFiles(fileName)) {
+      shaderProgram.attach(loadShader(shaderFile.fileName, shaderFile.type, &usedDefault));
+   }
+
+   return !usedDefault;
+}
+
 SPtr<ShaderProgram> ShaderAssetManager::loadShaderProgram(const std::string &fileName) {
-   if (shaderProgramMap.count(fileName) > 0) {
-      return shaderProgramMap[fileName];
+   SPtr<ShaderProgram> cachedShaderProgram = findShaderProgram(fileName);
+   if (cachedShaderProgram) {
+      return cachedShaderProgram;
    }
 
-   SPtr<ShaderProgram> shaderProgram = std::make_shared<ShaderProgram>();
-   std::string vertexFileName = fileName + VERTEX_EXTENSION;
-   std::string geometryFileName = fileName + GEOMETRY_EXTENSION;
-   std::string fragmentFileName = fileName + FRAGMENT_EXTENSION;
+   PROFILE_ZONE("ShaderAssetManager::loadShaderProgram", fileName);
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
-   if (IOUtils::canReadData(vertexFileName)) {
-      shaderProgram->attach(loadShader(vertexFileName, GL_VERTEX_SHADER));
+   // Shaders of programs read from the binary cache are never compiled, so their files are watched from here
+   std::vector<ShaderFile> shaderFiles(getShaderFiles(fileName));
+   for (const ShaderFile &shaderFile : shaderFiles) {
+      sourceStatuses[shaderFile.fileName] = IOUtils::getDataFileStatus(shaderFile.fileName);
    }
 
-   if (IOUtils::canReadData(geometryFileName)) {
-      shaderProgram->attach(loadShader(geometryFileName, GL_GEOMETRY_SHADER));
+   folly::Optional<std::string> binaryFileName;
+   folly::Optional<uint64_t> sourceHash;
+   if (binaryDirectory && ProgramBinaryCache::isSupported()) {
+      sourceHash = hashShaderSources(shaderFiles);
+      if (sourceHash) {
+         binaryFileName = getBinaryFileName(*binaryDirectory, fileName);
+      }
+   }
+
+   // Warm load: skip compiling and linking entirely
+   SPtr<ShaderProgram> shaderProgram = std::make_shared<ShaderProgram>();
+   if (binaryFileName && ProgramBinaryCache::load(*binaryFileName, *sourceHash, *shaderProgram)) {
+      LOG_DEBUG("Loaded '" << fileName << "' shader program from binary in " << (secondsSince(start) * 1000.0) << " ms");
+
+      std::lock_guard<std::mutex> lock(mutex);
+      ++stats.numPrograms;
+      ++stats.numProgramsFromBinary;
+      stats.loadTime += secondsSince(start);
+      shaderProgramMap[fileName] = shaderProgram;
+      return shaderProgram;
    }
 
-   if (IOUtils::canReadData(fragmentFileName)) {
-      shaderProgram->attach(loadShader(fragmentFileName, GL_FRAGMENT_SHADER));
+   // Cold load: compile and link, then (re)generate the binary
+   if (binaryFileName) {
+      // The program object may have been left in a failed state by a rejected binary
+      shaderProgram = std::make_shared<ShaderProgram>();
+      shaderProgram->setBinaryRetrievable();
    }
 
+   bool compiled = attachShaders(fileName, *shaderProgram);
+
    if (!shaderProgram->link()) {
       LOG_WARNING("Unable to link '" << fileName << "' shader program, reverting to default shader program. Error message: \"" << getShaderLinkError(shaderProgram) << "\"");
       shaderProgram = getDefaultShaderProgram();
+   } else if (binaryFileName && compiled && !ProgramBinaryCache::save(*binaryFileName, *sourceHash, *shaderProgram)) {
+      // Programs that fell back to default shaders aren't stored, so that the errors are reported again next time
+      LOG_WARNING("Unable to write program binary: " << *binaryFileName);
    }
 
+   LOG_DEBUG("Compiled '" << fileName << "' shader program in " << (secondsSince(start) * 1000.0) << " ms");
+
+   std::lock_guard<std::mutex> lock(mutex);
+   ++stats.numPrograms;
+   stats.loadTime += secondsSince(start);
    shaderProgramMap[fileName] = shaderProgram;
    return shaderProgram;
 }
 
-void ShaderAssetManager::reloadShaders() {
-   // TODO Only reload if files have been updated (check file modification time)
+int ShaderAssetManager::reloadChangedShaders() {
+   PROFILE_ZONE("ShaderAssetManager::reloadChangedShaders");
 
-   for (ShaderMap::iterator itr = shaderMap.begin(); itr != shaderMap.end(); ++itr) {
-      const std::string& fileName = itr->first;
+   std::unordered_set<std::string> changedFileNames;
+   for (std::pair<const std::string, folly::Optional<OSUtils::FileStatus>> &entry : sourceStatuses) {
+      folly::Optional<OSUtils::FileStatus> status(IOUtils::getDataFileStatus(entry.first));
+      if (status != entry.second) {
+         changedFileNames.insert(entry.first);
+         entry.second = status;
+      }
+   }
+
+   if (changedFileNames.empty()) {
+      return 0;
+   }
+
+   for (const std::string &fileName : changedFileNames) {
+      ShaderMap::iterator itr = shaderMap.find(fileName);
+      if (itr == shaderMap.end()) {
+         continue;
+      }
       SPtr<Shader> shader = itr->second;
 
       folly::Optional<std::string> source = IOUtils::readFromDataFile(fileName);
@@ -271,12 +432,49 @@ void ShaderAssetManager::reloadShaders() {
       }
    }
 
+   int numRelinked = 0;
    for (ShaderProgramMap::iterator itr = shaderProgramMap.begin(); itr != shaderProgramMap.end(); ++itr) {
       const std::string& fileName = itr->first;
       SPtr<ShaderProgram> shaderProgram = itr->second;
 
+      std::vector<ShaderFile> shaderFiles(getShaderFiles(fileName));
+      bool changed = std::any_of(shaderFiles.begin(), shaderFiles.end(), [&changedFileNames](const ShaderFile &shaderFile) {
+         return changedFileNames.count(shaderFile.fileName) > 0;
+      });
+      if (!changed) {
+         continue;
+      }
+
+      // Programs read from the binary cache have no shaders yet, so compile theirs like every other program's
+      if (!shaderProgram->hasShaders()) {
+         attachShaders(fileName, *shaderProgram);
+      }
+
       if (!shaderProgram->link()) {
          LOG_WARNING("Unable to link '" << fileName << "' shader program. Error message: \"" << getShaderLinkError(shaderProgram) << "\"");
+      } else {
+         ++numRelinked;
+      }
+   }
+
+   return numRelinked;
+}
+
+ShaderStats ShaderAssetManager::getStats() {
+   std::lock_guard<std::mutex> lock(mutex);
+   return stats;
+}
+
+AssetMemoryUsage ShaderAssetManager::getMemoryUsage() {
+   std::lock_guard<std::mutex> lock(mutex);
+
+   AssetMemoryUsage usage;
+   for (const std::pair<const std::string, SPtr<ShaderProgram>> &entry : shaderProgramMap) {
+      ++usage.numAssets;
+      if (entry.second.use_count() == 1) {
+         ++usage.numUnreferenced;
       }
    }
+
+   return usage;
 }
@@ -1,9 +1,14 @@
 #ifndef SHADER_ASSET_MANAGER_H
 #define SHADER_ASSET_MANAGER_H
 
+#include "AssetMemory.h"
 #include "GLIncludes.h"
+#include "OSUtils.h"
 #include "Types.h"
 
+#include <folly/Optional.h>
+
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
@@ -13,30 +18,90 @@ class ShaderProgram;
 typedef std::unordered_map<std::string, SPtr<Shader>> ShaderMap;
 typedef std::unordered_map<std::string, SPtr<ShaderProgram>> ShaderProgramMap;
 
+/**
+ * Shader program counts and load time, accumulated since the manager was created
+ */
+struct ShaderStats {
+   long numPrograms;
+   long numProgramsFromBinary;
+   double loadTime;
+
+   ShaderStats()
+      : numPrograms(0), numProgramsFromBinary(0), loadTime(0.0) {
+   }
+};
+
+/**
+ * Shaders are only ever loaded (and compiled) on the main thread, but cached shaders can be looked up from any thread
+ */
 class ShaderAssetManager {
 protected:
+   std::mutex mutex;
    ShaderMap shaderMap;
    ShaderProgramMap shaderProgramMap;
+   ShaderStats stats;
+
+   /**
+    * Status of each shader source file, as of when it was last compiled (or its program was read from the binary cache)
+    */
+   std::unordered_map<std::string, folly::Optional<OSUtils::FileStatus>> sourceStatuses;
+
+   /**
+    * Directory that linked program binaries are cached in (none if they aren't cached)
+    */
+   folly::Optional<std::string> binaryDirectory;
+
+   /**
+    * Loads the shader with the given file name and type, setting usedDefault if it had to be replaced with the default
+    * shader
+    */
+   SPtr<Shader> loadShader(const std::string &fileName, const GLenum type, bool *usedDefault);
+
+   /**
+    * Attaches the shaders of the program with the given name, returning false if any of them had to be replaced with the
+    * default shader
+    */
+   bool attachShaders(const std::string &fileName, ShaderProgram &shaderProgram);
 
 public:
-   ShaderAssetManager();
+   ShaderAssetManager(bool useBinaryCache = true);
 
    virtual ~ShaderAssetManager();
 
+   /**
+    * Gets the cached shader with the given file name, or null if it hasn't been loaded
+    */
+   SPtr<Shader> findShader(const std::string &fileName);
+
+   /**
+    * Gets the cached shader program with the given name, or null if it hasn't been loaded
+    */
+   SPtr<ShaderProgram> findShaderProgram(const std::string &name);
+
    /**
     * Loads the shader with the given file name and type, using a cached version if possible
     */
    SPtr<Shader> loadShader(const std::string &fileName, const GLenum type);
 
    /**
-    * Loads the shader program comprised of shaders with the given name (and their respective extensions), using a cached version if possible
+    * Loads the shader program comprised of shaders with the given name (and their respective extensions), using a cached version if possible.
+    * Programs are read from the binary cache when their sources haven't changed, otherwise they are compiled and linked
     */
    SPtr<ShaderProgram> loadShaderProgram(const std::string &name);
 
    /**
-    * Reloads all mapped shaders from source
+    * Recompiles the shaders whose source files changed since they were compiled, and relinks the programs that use
+    * them. Returns the number of programs relinked
+    */
+   int reloadChangedShaders();
+
+   ShaderStats getStats();
+
+   /**
+    * Gets the number of cached shader programs. Programs are never evicted (every scene uses the same few), and their
+    * memory belongs to the driver, so no bytes are reported
     */
-   void reloadShaders();
+   AssetMemoryUsage getMemoryUsage();
 };
 
 #endif
@@ -6,16 +6,61 @@
 
 #include <glm/gtc/type_ptr.hpp>
 
+#include <mutex>
+#include <sstream>
+
+namespace {
+
+struct UniformBlockBinding {
+   const char *name;
+   GLuint binding;
+};
+
+const UniformBlockBinding UNIFORM_BLOCK_BINDINGS[] = {
+   { "Camera", UniformBlockBindings::CAMERA },
+   { "Lights", UniformBlockBindings::LIGHTS },
+};
+
+/**
+ * Names interned as uniform IDs. IDs are resolved by materials built while levels load in the background, as well as
+ * by programs and renderers on the main thread, so the table is locked on every access
+ */
+struct UniformNameTable {
+   std::mutex mutex;
+   std::unordered_map<std::string, UniformID> ids;
+   std::vector<std::string> names;
+};
+
+UniformNameTable& getUniformNameTable() {
+   // Function-local, so that it exists before IDs are resolved by other files' static initializers
+   static UniformNameTable table;
+   return table;
+}
+
+} // namespace
+
 // Uniform
 
-Uniform::Uniform(const GLint location, const GLenum type, const std::string &name)
-   : location(location), type(type), name(name), dirty(false) {
+long Uniform::numUploads = 0;
+
+Uniform::Uniform(const GLint location, const GLenum type, const std::string &name, std::vector<Uniform*> *dirtyList)
+   : location(location), type(type), name(name), dirty(false), dirtyList(dirtyList), queued(false) {
 }
 
 Uniform::~Uniform() {
 }
 
+void Uniform::setDirty(bool dirty) {
+   this->dirty = dirty;
+
+   if (dirty && !queued && dirtyList) {
+      dirtyList->push_back(this);
+      queued = true;
+   }
+}
+
 void Uniform::commit() {
+   queued = false;
    if (!dirty) {
       return;
    }
@@ -56,11 +101,12 @@ void Uniform::commit() {
 
    activeData = pendingData;
    dirty = false;
+   ++numUploads;
 }
 
 void Uniform::setValue(bool value) {
    ASSERT(type == GL_BOOL);
-   dirty = activeData.boolVal != value;
+   setDirty(activeData.boolVal != value);
    pendingData.boolVal = value;
 }
 
@@ -73,7 +119,7 @@ void Uniform::setValue(int value) {
           type == GL_SAMPLER_1D_SHADOW ||
           type == GL_SAMPLER_2D_SHADOW ||
           type == GL_SAMPLER_CUBE_SHADOW);
-   dirty = activeData.intVal != value;
+   setDirty(activeData.intVal != value);
    pendingData.intVal = value;
 }
 
@@ -83,34 +129,40 @@ void Uniform::setValue(GLenum value) {
 
 void Uniform::setValue(float value) {
    ASSERT(type == GL_FLOAT);
-   dirty = activeData.floatVal != value;
+   setDirty(activeData.floatVal != value);
    pendingData.floatVal = value;
 }
 
 void Uniform::setValue(const glm::vec2 &value) {
    ASSERT(type == GL_FLOAT_VEC2);
-   dirty = activeData.vec2Val != value;
+   setDirty(activeData.vec2Val != value);
    pendingData.vec2Val = value;
 }
 
 void Uniform::setValue(const glm::vec3 &value) {
    ASSERT(type == GL_FLOAT_VEC3);
-   dirty = activeData.vec3Val != value;
+   setDirty(activeData.vec3Val != value);
    pendingData.vec3Val = value;
 }
 
 void Uniform::setValue(const glm::vec4 &value) {
    ASSERT(type == GL_FLOAT_VEC4);
-   dirty = activeData.vec4Val != value;
+   setDirty(activeData.vec4Val != value);
    pendingData.vec4Val = value;
 }
 
 void Uniform::setValue(const glm::mat4 &value) {
    ASSERT(type == GL_FLOAT_MAT4);
-   dirty = activeData.mat4Val != value;
+   setDirty(activeData.mat4Val != value);
    pendingData.mat4Val = value;
 }
 
+long Uniform::resetNumUploads() {
+   long count = numUploads;
+   numUploads = 0;
+   return count;
+}
+
 // ShaderProgram
 
 ShaderProgram::ShaderProgram()
@@ -140,6 +192,15 @@ bool ShaderProgram::link() {
       return false;
    }
 
+   loadUniforms();
+   return true;
+}
+
+void ShaderProgram::loadUniforms() {
+   uniforms.clear();
+   uniformsByID.clear();
+   dirtyUniforms.clear();
+
    GLint numUniforms;
    glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &numUniforms);
 
@@ -153,16 +214,91 @@ bool ShaderProgram::link() {
 
       if (length < 1 || size < 1) {
          LOG_WARNING("Unable to get active uniform: " << i);
-      } else {
-         std::string name(nameBuf);
-         GLint location = glGetUniformLocation(id, name.c_str());
-         uniforms[name] = std::make_shared<Uniform>(location, type, name);
+         continue;
+      }
+
+      std::string name(nameBuf);
+      GLint location = glGetUniformLocation(id, name.c_str());
+      if (location == -1) {
+         // Members of uniform blocks are set through their buffers
+         continue;
+      }
+
+      if (size == 1) {
+         addUniform(location, type, name);
+         continue;
+      }
+
+      // Arrays of basic types are reported once (as "name[0]"), so add each element
+      std::string arrayName = name.substr(0, name.rfind('['));
+      for (GLint element = 0; element < size; ++element) {
+         std::stringstream ss;
+         ss << arrayName << "[" << element << "]";
+         const std::string &elementName = ss.str();
+
+         addUniform(glGetUniformLocation(id, elementName.c_str()), type, elementName);
       }
    }
 
+   for (const UniformBlockBinding &blockBinding : UNIFORM_BLOCK_BINDINGS) {
+      GLuint blockIndex = glGetUniformBlockIndex(id, blockBinding.name);
+      if (blockIndex != GL_INVALID_INDEX) {
+         glUniformBlockBinding(id, blockIndex, blockBinding.binding);
+      }
+   }
+}
+
+void ShaderProgram::addUniform(const GLint location, const GLenum type, const std::string &name) {
+   SPtr<Uniform> uniform(std::make_shared<Uniform>(location, type, name, &dirtyUniforms));
+   uniforms[name] = uniform;
+
+   UniformID uniformID = getUniformID(name);
+   if (static_cast<std::size_t>(uniformID) >= uniformsByID.size()) {
+      uniformsByID.resize(uniformID + 1, nullptr);
+   }
+   uniformsByID[uniformID] = uniform.get();
+}
+
+void ShaderProgram::warnMissingUniform(UniformID id) {
+   warnMissingUniform(getUniformName(id));
+}
+
+void ShaderProgram::warnMissingUniform(const std::string &name) {
+   LOG_WARNING("Uniform with given name doesn't exist: " << name);
+}
+
+void ShaderProgram::setBinaryRetrievable() {
+   glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+bool ShaderProgram::loadBinary(GLenum format, const void *binary, GLsizei length) {
+   glProgramBinary(id, format, binary, length);
+
+   GLint linkStatus;
+   glGetProgramiv(id, GL_LINK_STATUS, &linkStatus);
+   if (linkStatus != GL_TRUE) {
+      return false;
+   }
+
+   loadUniforms();
    return true;
 }
 
+bool ShaderProgram::getBinary(GLenum *format, std::vector<char> *binary) const {
+   GLint length = 0;
+   glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+   if (length < 1) {
+      return false;
+   }
+
+   binary->resize(length);
+   GLsizei writtenLength = 0;
+   glGetProgramBinary(id, length, &writtenLength, format, binary->data());
+   binary->resize(writtenLength);
+
+   return writtenLength > 0;
+}
+
 void ShaderProgram::use() const {
    if (id != context.getActiveShaderProgramID()) {
       glUseProgram(id);
@@ -170,6 +306,38 @@ void ShaderProgram::use() const {
    }
 }
 
+UniformID ShaderProgram::getUniformID(const std::string &name) {
+   UniformNameTable &table = getUniformNameTable();
+   std::lock_guard<std::mutex> lock(table.mutex);
+
+   std::unordered_map<std::string, UniformID>::iterator itr = table.ids.find(name);
+   if (itr != table.ids.end()) {
+      return itr->second;
+   }
+
+   UniformID uniformID = static_cast<UniformID>(table.names.size());
+   table.ids.emplace(name, uniformID);
+   table.names.push_back(name);
+
+   return uniformID;
+}
+
+UniformID ShaderProgram::findUniformID(const std::string &name) {
+   UniformNameTable &table = getUniformNameTable();
+   std::lock_guard<std::mutex> lock(table.mutex);
+
+   std::unordered_map<std::string, UniformID>::const_iterator itr = table.ids.find(name);
+   return itr == table.ids.end() ? INVALID_UNIFORM_ID : itr->second;
+}
+
+std::string ShaderProgram::getUniformName(UniformID id) {
+   UniformNameTable &table = getUniformNameTable();
+   std::lock_guard<std::mutex> lock(table.mutex);
+   ASSERT(id >= 0 && static_cast<std::size_t>(id) < table.names.size(), "Invalid uniform ID: %d", id);
+
+   return table.names[id];
+}
+
 bool ShaderProgram::hasUniform(const std::string &name) const {
    return uniforms.count(name) > 0;
 }
@@ -182,7 +350,8 @@ SPtr<Uniform> ShaderProgram::getUniform(const std::string &name) const {
 void ShaderProgram::commit() {
    use();
 
-   for (UniformMap::iterator itr = uniforms.begin(); itr != uniforms.end(); ++itr) {
-      itr->second->commit();
+   for (Uniform *uniform : dirtyUniforms) {
+      uniform->commit();
    }
+   dirtyUniforms.clear();
 }
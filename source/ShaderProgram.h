@@ -7,6 +7,7 @@
 
 #include <glm/glm.hpp>
 
+#include <cstddef>
 #include <cstring>
 #include <string>
 #include <unordered_map>
@@ -22,10 +23,27 @@ enum Attributes : GLint {
    NORMAL = 1,
    TEX_COORD = 2,
    COLOR = 3,
+
+   // Per-instance matrices (each taking four consecutive locations, one per column)
+   INSTANCE_MODEL_MATRIX = 4,
+   INSTANCE_NORMAL_MATRIX = 8,
 };
 
 } // namespace ShaderAttributes
 
+namespace UniformBlockBindings {
+
+/**
+ * Binding points of the uniform blocks shared by programs (bound to the block with the matching name when a program is
+ * loaded)
+ */
+enum Bindings : GLuint {
+   CAMERA = 0,
+   LIGHTS = 1,
+};
+
+} // namespace UniformBlockBindings
+
 union UniformData {
    bool boolVal;
    int intVal;
@@ -43,6 +61,14 @@ union UniformData {
    }
 };
 
+/**
+ * Handle of a uniform name, interned once (see ShaderProgram::getUniformID()) so that setting a uniform doesn't hash
+ * its name. The same name has the same ID in every program
+ */
+typedef int UniformID;
+
+const UniformID INVALID_UNIFORM_ID = -1;
+
 class Uniform {
 protected:
    const GLint location;
@@ -52,8 +78,19 @@ protected:
    UniformData pendingData;
    bool dirty;
 
+   /**
+    * Uniforms of the owning program waiting to be committed, and whether this one is among them
+    */
+   std::vector<Uniform*> *dirtyList;
+   bool queued;
+
+   // Number of values uploaded to GL since the last reset (only accessed on the main thread)
+   static long numUploads;
+
+   void setDirty(bool dirty);
+
 public:
-   Uniform(const GLint location, const GLenum type, const std::string &name);
+   Uniform(const GLint location, const GLenum type, const std::string &name, std::vector<Uniform*> *dirtyList = nullptr);
 
    virtual ~Uniform();
 
@@ -72,7 +109,7 @@ public:
    }
 
    UniformData& getPendingData() {
-      dirty = true;
+      setDirty(true);
       return pendingData;
    }
 
@@ -95,6 +132,11 @@ public:
    void setValue(const glm::vec4 &value);
 
    void setValue(const glm::mat4 &value);
+
+   /**
+    * Returns the number of values uploaded by all uniforms since the last reset, and resets it
+    */
+   static long resetNumUploads();
 };
 
 typedef std::unordered_map<std::string, SPtr<Uniform>> UniformMap;
@@ -116,6 +158,16 @@ protected:
     */
    UniformMap uniforms;
 
+   /**
+    * The program's uniforms, indexed by ID (null for IDs that the program doesn't use)
+    */
+   std::vector<Uniform*> uniformsByID;
+
+   /**
+    * Uniforms set to new values since the last commit
+    */
+   std::vector<Uniform*> dirtyUniforms;
+
    Context &context;
 
    /**
@@ -123,6 +175,21 @@ protected:
     */
    void use() const;
 
+   /**
+    * Finds all active uniforms of the (linked) program, and binds its uniform blocks to their binding points
+    */
+   void loadUniforms();
+
+   void addUniform(const GLint location, const GLenum type, const std::string &name);
+
+   Uniform* findUniform(UniformID id) const {
+      return id >= 0 && static_cast<std::size_t>(id) < uniformsByID.size() ? uniformsByID[id] : nullptr;
+   }
+
+   static void warnMissingUniform(UniformID id);
+
+   static void warnMissingUniform(const std::string &name);
+
 public:
    ShaderProgram();
 
@@ -145,36 +212,100 @@ public:
     */
    bool link();
 
+   /**
+    * Returns whether any shaders are attached (programs loaded from a binary have none)
+    */
+   bool hasShaders() const {
+      return !shaders.empty();
+   }
+
+   /**
+    * Asks the driver to keep the binary of the program when it is linked, so that it can be retrieved with getBinary()
+    */
+   void setBinaryRetrievable();
+
+   /**
+    * Loads a binary previously retrieved with getBinary() (on the same driver) instead of linking shaders
+    */
+   bool loadBinary(GLenum format, const void *binary, GLsizei length);
+
+   /**
+    * Retrieves the binary of the linked program, returning false if the driver doesn't provide one
+    */
+   bool getBinary(GLenum *format, std::vector<char> *binary) const;
+
+   /**
+    * Gets the ID of the uniform with the given name, interning the name if it hasn't been seen yet (meant to be called
+    * once per name, e.g. when initializing constants, rather than per draw). Thread safe
+    */
+   static UniformID getUniformID(const std::string &name);
+
+   /**
+    * Gets the ID of the uniform with the given name without interning it, returning INVALID_UNIFORM_ID if no program
+    * or constant has used the name yet. Thread safe
+    */
+   static UniformID findUniformID(const std::string &name);
+
+   /**
+    * Gets the name of the uniform with the given ID. Thread safe
+    */
+   static std::string getUniformName(UniformID id);
+
    /**
     * Returns whether the program has a uniform with the given name
     */
    bool hasUniform(const std::string &name) const;
 
+   /**
+    * Returns whether the program has a uniform with the given ID
+    */
+   bool hasUniform(UniformID id) const {
+      return findUniform(id) != nullptr;
+   }
+
    /**
     * Gets the uniform with the given name
     */
    SPtr<Uniform> getUniform(const std::string &name) const;
 
    /**
-    * Commits the values of all uniforms in the shader program
+    * Makes the program active and commits the values of the uniforms set since the last commit
     */
    void commit();
 
    /**
-    * Sets the value of the uniform with the given name
+    * Sets the value of the uniform with the given ID
+    */
+   template<typename T>
+   void setUniformValue(UniformID id, const T &value, bool ignoreFailure = false) {
+      Uniform *uniform = findUniform(id);
+      if (!uniform) {
+         if (!ignoreFailure) {
+            warnMissingUniform(id);
+         }
+
+         return;
+      }
+
+      uniform->setValue(value);
+   }
+
+   /**
+    * Sets the value of the uniform with the given name (looking up its ID, so prefer resolving the ID once for
+    * uniforms set every draw)
     */
    template<typename T>
    void setUniformValue(const std::string &name, const T &value, bool ignoreFailure = false) {
-      UniformMap::iterator itr = uniforms.find(name);
-      if (itr == uniforms.end()) {
+      Uniform *uniform = findUniform(findUniformID(name));
+      if (!uniform) {
          if (!ignoreFailure) {
-            LOG_WARNING("Uniform with given name doesn't exist: " << name);
+            warnMissingUniform(name);
          }
 
          return;
       }
 
-      itr->second->setValue(value);
+      uniform->setValue(value);
    }
 };
 
@@ -29,39 +29,31 @@ const float FORCE = 110.0f;
 const float LIFE_TIME = 0.25f;
 const float SCALE = 2.4f;
 
-} // namespace
-
-ShoveAbility::ShoveAbility(GameObject &gameObject)
-   : Ability(gameObject, COOLDOWN) {
-}
+// Shoves don't outlive the cooldown, so one per player is enough
+const int NUM_PREWARMED_SHOVES = 1;
 
-ShoveAbility::~ShoveAbility() {
-}
+enum PooledObjectType {
+   Shove
+};
 
-bool ShoveAbility::use() {
-   if (isOnCooldown()) {
-      return false;
+glm::vec3 getColor(GameObject &gameObject) {
+   glm::vec3 color(1.0f, 0.35f, 0.15f);
+   PlayerLogicComponent *playerLogic = dynamic_cast<PlayerLogicComponent*>(&gameObject.getLogicComponent());
+   if (playerLogic) {
+      color = playerLogic->getColor();
    }
 
-   SPtr<Scene> scene = gameObject.getScene().lock();
-   if (!scene) {
-      return false;
-   }
+   return color;
+}
 
+SPtr<GameObject> createShove(const glm::vec3 &color) {
    SPtr<GameObject> shove(std::make_shared<GameObject>());
-
-   shove->setPosition(gameObject.getPosition() + gameObject.getCameraComponent().getFrontVector());
    shove->setScale(glm::vec3(SCALE));
 
    AssetManager &assetManager = Context::getInstance().getAssetManager();
 
    // Graphics
    SPtr<Mesh> mesh = assetManager.loadMesh("meshes/force_attack.obj");
-   glm::vec3 color(1.0f, 0.35f, 0.15f);
-   PlayerLogicComponent *playerLogic = dynamic_cast<PlayerLogicComponent*>(&gameObject.getLogicComponent());
-   if (playerLogic) {
-      color = playerLogic->getColor();
-   }
    SPtr<ShaderProgram> shaderProgram(assetManager.loadShaderProgram("shaders/phong"));
    SPtr<Material> material(std::make_shared<PhongMaterial>(color * 0.2f, color * 0.8f, glm::vec3(0.2f), color * 0.2f, 50.0f));
    SPtr<Model> model(std::make_shared<Model>(shaderProgram, mesh));
@@ -71,27 +63,65 @@ bool ShoveAbility::use() {
    shove->getGraphicsComponent().setNormalOffsetShadows(false);
 
    // Light
-   shove->setLightComponent(std::make_shared<LightComponent>(*shove, LightComponent::Spot, color * 2.0f, gameObject.getCameraComponent().getFrontVector(), 0.0f, 0.02f, 0.5f, 0.6f));
+   shove->setLightComponent(std::make_shared<LightComponent>(*shove, LightComponent::Spot, color * 2.0f, glm::vec3(0.0f, 0.0f, -1.0f), 0.0f, 0.02f, 0.5f, 0.6f));
 
    // Physics
    shove->setPhysicsComponent(std::make_shared<GhostPhysicsComponent>(*shove, false, CollisionGroup::Default | CollisionGroup::Characters | CollisionGroup::Debries | CollisionGroup::Projectiles));
 
+   // Audio (pooled objects are added to the scene on every use, so the sound plays each time)
+   SPtr<AudioComponent> audioComponent(std::make_shared<AudioComponent>(*shove));
+   audioComponent->registerSoundEvent(Event::SET_SCENE, SoundGroup::SHOVE);
+   shove->setAudioComponent(audioComponent);
+
+   return shove;
+}
+
+} // namespace
+
+ShoveAbility::ShoveAbility(GameObject &gameObject)
+   : Ability(gameObject, COOLDOWN) {
+}
+
+ShoveAbility::~ShoveAbility() {
+}
+
+void ShoveAbility::prewarm(Scene &scene) {
+   glm::vec3 color(getColor(gameObject));
+   scene.getObjectPool().prewarm(PoolKey(this, Shove), NUM_PREWARMED_SHOVES, [&color]() {
+      return createShove(color);
+   });
+}
+
+bool ShoveAbility::use() {
+   if (isOnCooldown()) {
+      return false;
+   }
+
+   SPtr<Scene> scene = gameObject.getScene().lock();
+   if (!scene) {
+      return false;
+   }
+
+   glm::vec3 color(getColor(gameObject));
+   SPtr<GameObject> shove(scene->getObjectPool().acquire(PoolKey(this, Shove), [&color]() {
+      return createShove(color);
+   }));
+
+   shove->setPosition(gameObject.getPosition() + gameObject.getCameraComponent().getFrontVector());
+   shove->setOrientation(glm::quat());
+   shove->getLightComponent().setDirection(gameObject.getCameraComponent().getFrontVector());
+
    // Logic
    const float startTime = Context::getInstance().getRunningTime();
-   WPtr<GameObject> wShove(shove);
    GameObject &player = gameObject; // TODO Dangerous - if the "shove" lives longer than the player, this reference will be invalid!
-   shove->setTickCallback([&player, startTime, wShove](GameObject &gameObject, const float dt) {
+   shove->setTickCallback([&player, startTime](GameObject &gameObject, const float dt) {
       SPtr<Scene> scene = gameObject.getScene().lock();
       if (!scene) {
          return;
       }
 
       if (Context::getInstance().getRunningTime() - startTime > LIFE_TIME) {
-         SPtr<GameObject> shove(wShove.lock());
-         if (shove) {
-            scene->removeObject(shove);
-            scene->removeLight(shove);
-         }
+         scene->getObjectPool().release(gameObject);
       }
 
       btCollisionObject *collisionObject = gameObject.getPhysicsComponent().getCollisionObject();
@@ -145,11 +175,6 @@ bool ShoveAbility::use() {
       }
    });
 
-   // Audio
-   SPtr<AudioComponent> audioComponent(std::make_shared<AudioComponent>(*shove));
-   audioComponent->registerSoundEvent(Event::SET_SCENE, SoundGroup::SHOVE);
-   shove->setAudioComponent(audioComponent);
-
    scene->addLight(shove);
    scene->addObject(shove);
 
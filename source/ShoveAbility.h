@@ -9,6 +9,8 @@ public:
 
    virtual ~ShoveAbility();
 
+   virtual void prewarm(Scene &scene);
+
    virtual bool use();
 };
 
@@ -0,0 +1,62 @@
+#include "FancyAssert.h"
+#include "Profiler.h"
+#include "SimulationThread.h"
+
+SimulationThread::SimulationThread()
+   : working(false), stopping(false), thread(&SimulationThread::run, this) {
+}
+
+SimulationThread::~SimulationThread() {
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+   }
+   condition.notify_all();
+
+   thread.join();
+}
+
+void SimulationThread::run() {
+   while (true) {
+      std::function<void()> currentWork;
+
+      {
+         std::unique_lock<std::mutex> lock(mutex);
+         condition.wait(lock, [this] { return working || stopping; });
+
+         if (stopping && !working) {
+            return;
+         }
+
+         currentWork = work;
+      }
+
+      {
+         PROFILE_ZONE("SimulationThread::run");
+         currentWork();
+      }
+
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+         working = false;
+         work = nullptr;
+      }
+      condition.notify_all();
+   }
+}
+
+void SimulationThread::start(std::function<void()> work) {
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      ASSERT(!working, "Trying to start simulation work while previous work is running");
+
+      this->work = work;
+      working = true;
+   }
+   condition.notify_all();
+}
+
+void SimulationThread::wait() {
+   std::unique_lock<std::mutex> lock(mutex);
+   condition.wait(lock, [this] { return !working; });
+}
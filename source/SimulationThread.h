@@ -0,0 +1,40 @@
+#ifndef SIMULATION_THREAD_H
+#define SIMULATION_THREAD_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * A worker thread that runs one batch of work (a frame's worth of ticks) at a time, so that it can overlap with
+ * rendering on the main thread
+ */
+class SimulationThread {
+protected:
+   std::mutex mutex;
+   std::condition_variable condition;
+   std::function<void()> work;
+   bool working;
+   bool stopping;
+   std::thread thread;
+
+   void run();
+
+public:
+   SimulationThread();
+
+   virtual ~SimulationThread();
+
+   /**
+    * Starts running the given work on the thread. The previous work must have finished (see wait())
+    */
+   void start(std::function<void()> work);
+
+   /**
+    * Blocks until the current work (if any) has finished
+    */
+   void wait();
+};
+
+#endif
@@ -32,7 +32,7 @@ void SkyRenderer::init() {
 }
 
 void SkyRenderer::render(const glm::mat4 &view, const glm::mat4 &proj, const Viewport &viewport, const glm::vec2 &framebufferResolution, SPtr<GameObject> sun) {
-   const glm::vec3 &pos = -sun->getLightComponent().getDirection();
+   const glm::vec3 &pos = -sun->getLightComponent().getRenderDirection();
    xyPlane->getShaderProgram()->setUniformValue("uLightDir", pos);
 
    xyPlane->getShaderProgram()->setUniformValue("uInvProjMatrix", glm::inverse(proj));
@@ -0,0 +1,137 @@
+#ifndef SLOT_MAP_H
+#define SLOT_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * Refers to a value in a SlotMap. Each slot's generation is bumped whenever its value is removed, so stale handles are
+ * detected instead of referring to whatever value reuses the slot
+ */
+struct SlotHandle {
+   static const uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+   uint32_t index;
+   uint32_t generation;
+
+   SlotHandle()
+      : index(INVALID_INDEX), generation(0) {
+   }
+
+   SlotHandle(uint32_t index, uint32_t generation)
+      : index(index), generation(generation) {
+   }
+
+   bool operator==(const SlotHandle &other) const {
+      return index == other.index && generation == other.generation;
+   }
+
+   bool operator!=(const SlotHandle &other) const {
+      return !(*this == other);
+   }
+};
+
+/**
+ * Stores values contiguously (in no particular order), with O(1) insertion, removal (by swapping the last value into
+ * the hole), and lookup by handle
+ */
+template<class T>
+class SlotMap {
+private:
+   struct Slot {
+      // Index of the slot's value (or of the next free slot, if the slot is free)
+      uint32_t index;
+      uint32_t generation;
+   };
+
+   std::vector<T> values;
+   std::vector<uint32_t> valueSlots;
+   std::vector<Slot> slots;
+   uint32_t freeSlot;
+
+   bool isLive(const SlotHandle &handle) const {
+      // Freeing a slot bumps its generation, so a matching generation means the slot is in use
+      return handle.index < slots.size() && slots[handle.index].generation == handle.generation;
+   }
+
+public:
+   SlotMap()
+      : freeSlot(SlotHandle::INVALID_INDEX) {
+   }
+
+   SlotHandle insert(const T &value) {
+      uint32_t slotIndex;
+      if (freeSlot != SlotHandle::INVALID_INDEX) {
+         slotIndex = freeSlot;
+         freeSlot = slots[slotIndex].index;
+      } else {
+         slotIndex = static_cast<uint32_t>(slots.size());
+         slots.push_back({ 0, 0 });
+      }
+
+      slots[slotIndex].index = static_cast<uint32_t>(values.size());
+      values.push_back(value);
+      valueSlots.push_back(slotIndex);
+
+      return SlotHandle(slotIndex, slots[slotIndex].generation);
+   }
+
+   /**
+    * Removes the value the handle refers to, moving the last value into its place. Returns false if the handle is stale
+    */
+   bool remove(const SlotHandle &handle) {
+      if (!isLive(handle)) {
+         return false;
+      }
+
+      Slot &slot = slots[handle.index];
+      uint32_t lastIndex = static_cast<uint32_t>(values.size() - 1);
+      if (slot.index != lastIndex) {
+         values[slot.index] = std::move(values[lastIndex]);
+         valueSlots[slot.index] = valueSlots[lastIndex];
+         slots[valueSlots[slot.index]].index = slot.index;
+      }
+      values.pop_back();
+      valueSlots.pop_back();
+
+      ++slot.generation;
+      slot.index = freeSlot;
+      freeSlot = handle.index;
+
+      return true;
+   }
+
+   bool contains(const SlotHandle &handle) const {
+      return isLive(handle);
+   }
+
+   /**
+    * Returns the value the handle refers to, or null if the handle is stale
+    */
+   T* get(const SlotHandle &handle) {
+      return isLive(handle) ? &values[slots[handle.index].index] : nullptr;
+   }
+
+   const T* get(const SlotHandle &handle) const {
+      return isLive(handle) ? &values[slots[handle.index].index] : nullptr;
+   }
+
+   /**
+    * All values, contiguous. Removals reorder them
+    */
+   const std::vector<T>& getValues() const {
+      return values;
+   }
+
+   std::size_t size() const {
+      return values.size();
+   }
+
+   bool empty() const {
+      return values.empty();
+   }
+};
+
+#endif
@@ -2,157 +2,389 @@
 #include "FancyAssert.h"
 #include "IOUtils.h"
 #include "LogHelper.h"
+#include "OSUtils.h"
+#include "Profiler.h"
 #include "TextureAssetManager.h"
+#include "TextureCache.h"
+#include "TextureImage.h"
+#include "UploadQueue.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_ASSERT ASSERT
 #include <stb/stb_image.h>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <future>
+#include <utility>
+#include <vector>
+
 namespace {
 
-struct ImageInfo {
-   int width;
-   int height;
-   int composition;
-   unsigned char *pixels;
-};
+const char* CACHE_DIRECTORY_NAME = "texture_cache";
+const char* CACHE_EXTENSION = ".tgit";
 
-ImageInfo getDefaultImageInfo() {
-   ImageInfo defaultImageInfo;
+// In the order of the GL_TEXTURE_CUBE_MAP_* face targets
+const std::array<const char*, 6> CUBEMAP_FACE_NAMES = {{ "right", "left", "up", "down", "back", "front" }};
 
-   defaultImageInfo.pixels = stbi_load_from_memory(DEFAULT_IMAGE_SOURCE, DEFAULT_IMAGE_SOURCE_SIZE, &defaultImageInfo.width, &defaultImageInfo.height, &defaultImageInfo.composition, 0);
+SPtr<TextureImage> getDefaultImage(bool compress) {
+   int width, height, composition;
+   unsigned char *pixels = stbi_load_from_memory(DEFAULT_IMAGE_SOURCE, DEFAULT_IMAGE_SOURCE_SIZE, &width, &height, &composition, 0);
 
-   if (!defaultImageInfo.pixels) {
+   if (!pixels) {
       LOG_FATAL("Unable to load default texture");
    }
 
-   return defaultImageInfo;
-}
-
-ImageInfo loadImage(const std::string &fileName) {
-   ImageInfo info;
+   SPtr<TextureImage> image(TextureImage::create(pixels, width, height, composition, compress));
+   stbi_image_free(pixels);
 
-   std::string dataFileName(IOUtils::dataPath(fileName));
-   info.pixels = stbi_load(dataFileName.c_str(), &info.width, &info.height, &info.composition, 0);
+   return image;
+}
 
-   if (!info.pixels) {
-      LOG_WARNING("Unable to load image from file: " << dataFileName);
-      info = getDefaultImageInfo();
-   }
+std::string getCacheFileName(const std::string &directory, const std::string &fileName) {
+   // Flatten the image's path into a single file name
+   std::string flatFileName(fileName);
+   std::replace(flatFileName.begin(), flatFileName.end(), '/', '_');
+   std::replace(flatFileName.begin(), flatFileName.end(), '\\', '_');
 
-   return info;
+   return directory + "/" + flatFileName + CACHE_EXTENSION;
 }
 
-bool getFormat(const ImageInfo &info, GLint *format) {
-   switch (info.composition) {
-      case 1:
-         *format = GL_R8;
-         return true;
-      case 2:
-         *format = GL_RG16;
-         return true;
-      case 3:
-         *format = GL_RGB;
-         return true;
-      case 4:
-         *format = GL_RGBA;
-         return true;
-      default:
-         *format = GL_RGBA;
-         return false;
-   }
+double secondsSince(std::chrono::steady_clock::time_point start) {
+   return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 }
 
 } // namespace
 
-TextureAssetManager::TextureAssetManager() {
+TextureAssetManager::TextureAssetManager(UploadQueue &uploadQueue, bool useCache)
+   : uploadQueue(uploadQueue) {
    // Load images bottom-to-top (since that is how OpenGL expects textures)
    stbi_set_flip_vertically_on_load(true);
+
+   if (useCache) {
+      cacheDirectory = OSUtils::createAppDataSubdirectory(CACHE_DIRECTORY_NAME);
+      if (!cacheDirectory) {
+         LOG_WARNING("Unable to create texture cache directory");
+      }
+   }
 }
 
 TextureAssetManager::~TextureAssetManager() {
 }
 
-SPtr<Texture> TextureAssetManager::loadTexture(const std::string &fileName, TextureWrap::Type wrap) {
-   if (textureMap.count(fileName)) {
-      return textureMap.at(fileName);
+SPtr<TextureImage> TextureAssetManager::loadImage(const std::string &fileName, bool compress, folly::Optional<OSUtils::FileStatus> *sourceStatus) {
+   *sourceStatus = IOUtils::getDataFileStatus(fileName);
+   folly::Optional<std::string> cacheFileName;
+   if (cacheDirectory && *sourceStatus) {
+      cacheFileName = getCacheFileName(*cacheDirectory, fileName);
    }
 
-   ImageInfo info = loadImage(fileName);
+   // Warm load: map the cache
+   if (cacheFileName) {
+      SPtr<TextureImage> image(TextureCache::load(*cacheFileName, **sourceStatus, compress));
+      if (image) {
+         std::lock_guard<std::mutex> lock(mutex);
+         ++stats.numImagesCached;
+         return image;
+      }
+   }
+
+   // Cold load: decode, generate mipmaps and compress, then (re)generate the cache
+   folly::Optional<IOUtils::DataFile> dataFile(IOUtils::readDataFile(fileName));
+   if (!dataFile) {
+      LOG_WARNING("Unable to read image file: " << fileName);
+      return nullptr;
+   }
 
-   GLint format;
-   if (!getFormat(info, &format)) {
+   int width, height, composition;
+   unsigned char *pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(dataFile->data), static_cast<int>(dataFile->size), &width, &height, &composition, 0);
+   if (!pixels) {
+      LOG_WARNING("Unable to load image from file: " << fileName);
+      return nullptr;
+   }
+
+   if (composition < 1 || composition > 4) {
       LOG_WARNING("Unsupported image composition for image: " << fileName);
+      stbi_image_free(pixels);
+      return nullptr;
+   }
+
+   SPtr<TextureImage> image(TextureImage::create(pixels, width, height, composition, compress));
+   stbi_image_free(pixels);
 
-      info = getDefaultImageInfo();
-      if (!getFormat(info, &format)) {
-         LOG_FATAL("Unsupported image composition for default image");
+   if (cacheFileName && !TextureCache::save(*cacheFileName, *image, **sourceStatus)) {
+      LOG_WARNING("Unable to write texture cache: " << *cacheFileName);
+   }
+
+   std::lock_guard<std::mutex> lock(mutex);
+   ++stats.numImagesDecoded;
+   return image;
+}
+
+SPtr<Texture> TextureAssetManager::loadTexture(const std::string &fileName, TextureWrap::Type wrap) {
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      TextureMap::iterator itr = textureMap.find(fileName);
+      if (itr != textureMap.end()) {
+         usages[itr->second.get()].lastUse = std::chrono::steady_clock::now();
+         return itr->second;
       }
    }
 
-   SPtr<Texture> texture(std::make_shared<Texture>(GL_TEXTURE_2D));
-   texture->bind();
+   PROFILE_ZONE("TextureAssetManager::loadTexture", fileName);
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+   bool compress = TextureImage::isCompressionSupported();
+   folly::Optional<OSUtils::FileStatus> sourceStatus;
+   SPtr<TextureImage> image(loadImage(fileName, compress, &sourceStatus));
+   if (!image) {
+      image = getDefaultImage(compress);
+   }
+
+   SPtr<Texture> texture;
+   bool created = false;
+   uploadQueue.run([this, &texture, &created, &fileName, &image, &sourceStatus, wrap]() {
+      // Another thread may have loaded the same texture in the meantime (the check happens here so that textures are
+      // only ever created and deleted on the main thread)
+      std::lock_guard<std::mutex> lock(mutex);
+      TextureMap::iterator itr = textureMap.find(fileName);
+      if (itr != textureMap.end()) {
+         texture = itr->second;
+         return;
+      }
 
-   glTexImage2D(GL_TEXTURE_2D, 0, format, info.width, info.height, 0, format, GL_UNSIGNED_BYTE, info.pixels);
+      texture = std::make_shared<Texture>(GL_TEXTURE_2D);
+      texture->bind();
 
-   // TODO Make configurable
-   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
-   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+      image->upload(GL_TEXTURE_2D);
 
-   texture->unbind();
+      // TODO Make configurable
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
 
-   stbi_image_free(info.pixels);
+      texture->unbind();
+
+      textureMap[fileName] = texture;
+      imageSources[fileName] = { texture, GL_TEXTURE_2D, sourceStatus, image->getDataSize() };
+      usages[texture.get()] = { image->getDataSize(), std::chrono::steady_clock::now() };
+      created = true;
+   });
+
+   if (created) {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++stats.numTextures;
+      stats.gpuBytes += image->getDataSize();
+      stats.uncompressedBytes += image->getUncompressedSize();
+      stats.loadTime += secondsSince(start);
+   }
 
-   textureMap[fileName] = texture;
    return texture;
 }
 
 SPtr<Texture> TextureAssetManager::loadCubemap(const std::string &path, const std::string &extension) {
-   if (cubemapMap.count(path)) {
-      return cubemapMap.at(path);
-   }
-
-   const std::string &rightName = "/right." + extension;
-   const std::string &leftName = "/left." + extension;
-   const std::string &upName = "/up." + extension;
-   const std::string &downName = "/down." + extension;
-   const std::string &backName = "/back." + extension;
-   const std::string &frontName = "/front." + extension;
-
-   ImageInfo right = loadImage(path + rightName);
-   ImageInfo left = loadImage(path + leftName);
-   ImageInfo up = loadImage(path + upName);
-   ImageInfo down = loadImage(path + downName);
-   ImageInfo back = loadImage(path + backName);
-   ImageInfo front = loadImage(path + frontName);
-
-   SPtr<Texture> cubemap(std::make_shared<Texture>(GL_TEXTURE_CUBE_MAP));
-   cubemap->bind();
-
-   glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_RGB, right.width, right.height, 0, GL_RGB, GL_UNSIGNED_BYTE, right.pixels);
-   glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_X, 0, GL_RGB, left.width, left.height, 0, GL_RGB, GL_UNSIGNED_BYTE, left.pixels);
-   glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_Y, 0, GL_RGB, up.width, up.height, 0, GL_RGB, GL_UNSIGNED_BYTE, up.pixels);
-   glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_Y, 0, GL_RGB, down.width, down.height, 0, GL_RGB, GL_UNSIGNED_BYTE, down.pixels);
-   glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_Z, 0, GL_RGB, back.width, back.height, 0, GL_RGB, GL_UNSIGNED_BYTE, back.pixels);
-   glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_Z, 0, GL_RGB, front.width, front.height, 0, GL_RGB, GL_UNSIGNED_BYTE, front.pixels);
-
-   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-   cubemap->unbind();
-
-   stbi_image_free(right.pixels);
-   stbi_image_free(left.pixels);
-   stbi_image_free(up.pixels);
-   stbi_image_free(down.pixels);
-   stbi_image_free(back.pixels);
-   stbi_image_free(front.pixels);
-
-   cubemapMap[path] = cubemap;
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      CubemapMap::iterator itr = cubemapMap.find(path);
+      if (itr != cubemapMap.end()) {
+         usages[itr->second.get()].lastUse = std::chrono::steady_clock::now();
+         return itr->second;
+      }
+   }
+
+   PROFILE_ZONE("TextureAssetManager::loadCubemap", path);
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+   // Decode the faces in parallel (decoding dominates, and each face is independent)
+   bool compress = TextureImage::isCompressionSupported();
+   std::array<std::string, 6> faceNames;
+   std::array<folly::Optional<OSUtils::FileStatus>, 6> faceStatuses;
+   std::array<std::future<SPtr<TextureImage>>, 6> faceFutures;
+   for (std::size_t i = 0; i < faceFutures.size(); ++i) {
+      faceNames[i] = path + "/" + CUBEMAP_FACE_NAMES[i] + "." + extension;
+      faceFutures[i] = std::async(std::launch::async, [this, &faceNames, &faceStatuses, i, compress]() {
+         return loadImage(faceNames[i], compress, &faceStatuses[i]);
+      });
+   }
+
+   std::array<SPtr<TextureImage>, 6> faces;
+   for (std::size_t i = 0; i < faces.size(); ++i) {
+      faces[i] = faceFutures[i].get();
+      if (!faces[i]) {
+         faces[i] = getDefaultImage(compress);
+      }
+   }
+
+   SPtr<Texture> cubemap;
+   bool created = false;
+   uploadQueue.run([&]() {
+      std::lock_guard<std::mutex> lock(mutex);
+      CubemapMap::iterator itr = cubemapMap.find(path);
+      if (itr != cubemapMap.end()) {
+         cubemap = itr->second;
+         return;
+      }
+
+      cubemap = std::make_shared<Texture>(GL_TEXTURE_CUBE_MAP);
+      cubemap->bind();
+
+      TextureUsage &usage = usages[cubemap.get()];
+      usage.gpuBytes = 0;
+      usage.lastUse = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i < faces.size(); ++i) {
+         GLenum target = static_cast<GLenum>(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i);
+         faces[i]->upload(target);
+         imageSources[faceNames[i]] = { cubemap, target, faceStatuses[i], faces[i]->getDataSize() };
+         usage.gpuBytes += faces[i]->getDataSize();
+      }
+
+      glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+      glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+      cubemap->unbind();
+
+      cubemapMap[path] = cubemap;
+      created = true;
+   });
+
+   if (created) {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++stats.numCubemaps;
+      for (const SPtr<TextureImage> &face : faces) {
+         stats.gpuBytes += face->getDataSize();
+         stats.uncompressedBytes += face->getUncompressedSize();
+      }
+      stats.loadTime += secondsSince(start);
+   }
+
    return cubemap;
 }
+
+TextureStats TextureAssetManager::getStats() {
+   std::lock_guard<std::mutex> lock(mutex);
+   return stats;
+}
+
+int TextureAssetManager::reloadChangedTextures() {
+   std::vector<std::pair<std::string, ImageSource>> changedSources;
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (const std::pair<const std::string, ImageSource> &entry : imageSources) {
+         if (IOUtils::getDataFileStatus(entry.first) != entry.second.status) {
+            changedSources.push_back(entry);
+         }
+      }
+   }
+
+   bool compress = TextureImage::isCompressionSupported();
+   int numReloaded = 0;
+   for (const std::pair<std::string, ImageSource> &changedSource : changedSources) {
+      const std::string &fileName = changedSource.first;
+      const ImageSource &source = changedSource.second;
+      PROFILE_ZONE("TextureAssetManager::reloadImage", fileName);
+
+      folly::Optional<OSUtils::FileStatus> sourceStatus;
+      SPtr<TextureImage> image(loadImage(fileName, compress, &sourceStatus));
+
+      if (image) {
+         // Upload into the existing texture, so that everything using it sees the change (unless it was evicted)
+         uploadQueue.run([this, &fileName, &source, &image, &numReloaded]() {
+            SPtr<Texture> texture(source.texture.lock());
+            if (!texture) {
+               return;
+            }
+
+            texture->bind();
+            image->upload(source.target);
+            texture->unbind();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            TextureUsage &usage = usages[texture.get()];
+            usage.gpuBytes = usage.gpuBytes - source.gpuBytes + image->getDataSize();
+            imageSources[fileName].gpuBytes = image->getDataSize();
+            ++numReloaded;
+         });
+      } else {
+         LOG_WARNING("Unable to reload image \"" << fileName << "\", keeping the old version");
+      }
+
+      // Only try again once the file changes again (on failure, it is probably still being written)
+      std::lock_guard<std::mutex> lock(mutex);
+      std::unordered_map<std::string, ImageSource>::iterator itr = imageSources.find(fileName);
+      if (itr != imageSources.end()) {
+         itr->second.status = sourceStatus;
+      }
+   }
+
+   return numReloaded;
+}
+
+AssetMemoryUsage TextureAssetManager::getMemoryUsage() {
+   std::lock_guard<std::mutex> lock(mutex);
+
+   AssetMemoryUsage usage;
+   for (const TextureMap *map : { &textureMap, &cubemapMap }) {
+      for (const std::pair<const std::string, SPtr<Texture>> &entry : *map) {
+         ++usage.numAssets;
+         if (entry.second.use_count() == 1) {
+            ++usage.numUnreferenced;
+         }
+         usage.gpuBytes += usages[entry.second.get()].gpuBytes;
+      }
+   }
+
+   return usage;
+}
+
+std::vector<EvictionCandidate> TextureAssetManager::getEvictionCandidates() {
+   std::lock_guard<std::mutex> lock(mutex);
+
+   std::vector<EvictionCandidate> candidates;
+   for (TextureMap *map : { &textureMap, &cubemapMap }) {
+      for (const std::pair<const std::string, SPtr<Texture>> &entry : *map) {
+         if (entry.second.use_count() != 1) {
+            continue;
+         }
+
+         const TextureUsage &usage = usages[entry.second.get()];
+         EvictionCandidate candidate;
+         candidate.name = entry.first;
+         candidate.bytes = usage.gpuBytes;
+         candidate.lastUse = usage.lastUse;
+
+         std::string name(entry.first);
+         candidate.evict = [this, map, name]() {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            // A background scene load may have picked the texture up since the candidates were collected
+            TextureMap::iterator itr = map->find(name);
+            if (itr == map->end() || itr->second.use_count() != 1) {
+               return false;
+            }
+
+            usages.erase(itr->second.get());
+            map->erase(itr);
+
+            // Stop watching the files of the deleted texture
+            for (std::unordered_map<std::string, ImageSource>::iterator sourceItr = imageSources.begin(); sourceItr != imageSources.end();) {
+               if (sourceItr->second.texture.expired()) {
+                  sourceItr = imageSources.erase(sourceItr);
+               } else {
+                  ++sourceItr;
+               }
+            }
+
+            return true;
+         };
+
+         candidates.push_back(candidate);
+      }
+   }
+
+   return candidates;
+}
@@ -1,11 +1,23 @@
 #ifndef TEXTURE_ASSET_MANAGER_H
 #define TEXTURE_ASSET_MANAGER_H
 
+#include "AssetMemory.h"
 #include "GLIncludes.h"
+#include "OSUtils.h"
 #include "Texture.h"
+#include "Types.h"
 
+#include <folly/Optional.h>
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+class TextureImage;
+class UploadQueue;
 
 namespace TextureWrap {
 
@@ -21,19 +33,109 @@ enum Type {
 typedef std::unordered_map<std::string, SPtr<Texture>> TextureMap;
 typedef std::unordered_map<std::string, SPtr<Texture>> CubemapMap;
 
+/**
+ * Texture counts, memory and load time, accumulated since the manager was created
+ */
+struct TextureStats {
+   long numTextures;
+   long numCubemaps;
+   long numImagesCached;
+   long numImagesDecoded;
+
+   /**
+    * Size of every uploaded level (including mipmaps, after compression)
+    */
+   std::size_t gpuBytes;
+
+   /**
+    * Size the same images would take as single uncompressed levels
+    */
+   std::size_t uncompressedBytes;
+
+   double loadTime;
+
+   TextureStats()
+      : numTextures(0), numCubemaps(0), numImagesCached(0), numImagesDecoded(0), gpuBytes(0), uncompressedBytes(0),
+        loadTime(0.0) {
+   }
+};
+
+/**
+ * Thread safe, so that scenes can be loaded in the background. Images are decoded (or mapped from the texture cache) on
+ * the calling thread, and only uploaded on the main thread
+ */
 class TextureAssetManager {
 protected:
+   UploadQueue &uploadQueue;
+   std::mutex mutex;
    TextureMap textureMap;
    CubemapMap cubemapMap;
+   TextureStats stats;
+
+   /**
+    * The texture (or cubemap face) that an image file was uploaded to, the status of the file when it was loaded, and
+    * the size of the uploaded image
+    */
+   struct ImageSource {
+      WPtr<Texture> texture;
+      GLenum target;
+      folly::Optional<OSUtils::FileStatus> status;
+      std::size_t gpuBytes;
+   };
+
+   std::unordered_map<std::string, ImageSource> imageSources;
+
+   /**
+    * Memory used by a cached texture or cubemap, and when it was last requested
+    */
+   struct TextureUsage {
+      std::size_t gpuBytes;
+      std::chrono::steady_clock::time_point lastUse;
+   };
+
+   std::unordered_map<const Texture*, TextureUsage> usages;
+
+   /**
+    * Directory that decoded images are cached in (none if they aren't cached)
+    */
+   folly::Optional<std::string> cacheDirectory;
+
+   /**
+    * Maps the image from the texture cache, or decodes it (and caches the result). Returns null if the image can't be
+    * decoded. The status of the image file is stored in sourceStatus
+    */
+   SPtr<TextureImage> loadImage(const std::string &fileName, bool compress, folly::Optional<OSUtils::FileStatus> *sourceStatus);
 
 public:
-   TextureAssetManager();
+   TextureAssetManager(UploadQueue &uploadQueue, bool useCache = true);
 
    virtual ~TextureAssetManager();
 
    SPtr<Texture> loadTexture(const std::string &fileName, TextureWrap::Type wrap);
 
+   /**
+    * Loads the six faces of the cubemap in parallel
+    */
    SPtr<Texture> loadCubemap(const std::string &path, const std::string &extension);
+
+   TextureStats getStats();
+
+   /**
+    * Decodes the images whose files changed since they were loaded, and uploads them to their existing textures (on the
+    * main thread, so this must not be called from the simulation thread). Returns the number of images reloaded
+    */
+   int reloadChangedTextures();
+
+   /**
+    * Gets the memory used by the cached textures and cubemaps (those only referenced by the cache count as unreferenced)
+    */
+   AssetMemoryUsage getMemoryUsage();
+
+   /**
+    * Gets the cached textures and cubemaps that only the cache references. Must be called from the main thread, as must
+    * the candidates' evict functions (since evicting a texture deletes it)
+    */
+   std::vector<EvictionCandidate> getEvictionCandidates();
 };
 
 #endif
@@ -0,0 +1,165 @@
+#include "FancyAssert.h"
+#include "LogHelper.h"
+#include "MappedFile.h"
+#include "TextureCache.h"
+#include "TextureImage.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace TextureCache {
+
+namespace {
+
+const char MAGIC[4] = { 'T', 'G', 'I', 'T' };
+
+// Bump whenever the layout, mip filtering or compression changes, so that existing caches are regenerated
+const uint32_t VERSION = 1;
+
+// The pixel data starts on a 16 byte boundary (the mapping itself is page aligned)
+const uint32_t BLOCK_ALIGNMENT = 16;
+
+// Anything larger is certainly not a valid mip chain
+const uint32_t MAX_LEVELS = 32;
+
+// Larger than any GL implementation supports (and small enough that level sizes can't overflow)
+const uint32_t MAX_DIMENSION = 1 << 16;
+
+struct Header {
+   char magic[4];
+   uint32_t version;
+   int64_t sourceModificationTime;
+   int64_t sourceSize;
+   uint32_t width;
+   uint32_t height;
+   uint32_t components;
+   uint32_t compressed;
+   uint32_t numLevels;
+   uint32_t dataOffset;
+};
+
+static_assert(sizeof(Header) % BLOCK_ALIGNMENT == 0, "Texture cache header must keep the level table aligned");
+static_assert(sizeof(TextureImage::Level) == 4 * sizeof(uint32_t), "Texture cache level table must be tightly packed");
+
+uint32_t align(uint32_t offset) {
+   return (offset + BLOCK_ALIGNMENT - 1) & ~(BLOCK_ALIGNMENT - 1);
+}
+
+} // namespace
+
+SPtr<TextureImage> load(const std::string &fileName, const OSUtils::FileStatus &sourceStatus, bool compress) {
+   ASSERT(!fileName.empty(), "Trying to load texture cache from empty file name");
+
+   SPtr<MappedFile> mappedFile(MappedFile::open(fileName));
+   if (!mappedFile || mappedFile->getSize() < sizeof(Header)) {
+      return nullptr;
+   }
+
+   Header header;
+   memcpy(&header, mappedFile->getData(), sizeof(header));
+   if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+      return nullptr;
+   }
+
+   if (header.sourceModificationTime != sourceStatus.modificationTime || header.sourceSize != sourceStatus.size) {
+      LOG_DEBUG("Texture cache " << fileName << " is stale");
+      return nullptr;
+   }
+
+   // Only RGB images are ever compressed
+   bool shouldBeCompressed = compress && header.components == 3;
+   if ((header.compressed != 0) != shouldBeCompressed) {
+      LOG_DEBUG("Texture cache " << fileName << " has the wrong compression");
+      return nullptr;
+   }
+
+   std::size_t size = mappedFile->getSize();
+   std::size_t tableEnd = sizeof(Header) + header.numLevels * sizeof(TextureImage::Level);
+   if (header.numLevels == 0 || header.numLevels > MAX_LEVELS || header.components < 1 || header.components > 4
+      || header.width == 0 || header.width > MAX_DIMENSION || header.height == 0 || header.height > MAX_DIMENSION
+      || tableEnd > header.dataOffset || header.dataOffset % BLOCK_ALIGNMENT != 0 || header.dataOffset > size) {
+      LOG_WARNING("Invalid texture cache: " << fileName);
+      return nullptr;
+   }
+
+   std::vector<TextureImage::Level> levels(header.numLevels);
+   memcpy(levels.data(), mappedFile->getData() + sizeof(Header), header.numLevels * sizeof(TextureImage::Level));
+
+   // GL reads as many bytes as the dimensions call for (whatever the recorded size), so each level must be exactly the
+   // expected mip of the image, and lie within the mapping. The chain must also be complete, down to 1x1
+   const TextureImage::Level &lastLevel = levels.back();
+   if (lastLevel.width != 1 || lastLevel.height != 1) {
+      LOG_WARNING("Invalid texture cache: " << fileName);
+      return nullptr;
+   }
+
+   std::size_t dataSize = size - header.dataOffset;
+   uint32_t levelWidth = header.width;
+   uint32_t levelHeight = header.height;
+   for (std::size_t i = 0; i < levels.size(); ++i) {
+      const TextureImage::Level &level = levels[i];
+      bool smallest = levelWidth == 1 && levelHeight == 1;
+      if (level.width != levelWidth || level.height != levelHeight || (smallest && i + 1 != levels.size())
+         || level.size != TextureImage::getLevelSize(levelWidth, levelHeight, header.components, header.compressed != 0)
+         || level.offset > dataSize || level.size > dataSize - level.offset) {
+         LOG_WARNING("Invalid texture cache: " << fileName);
+         return nullptr;
+      }
+
+      levelWidth = std::max(1u, levelWidth / 2);
+      levelHeight = std::max(1u, levelHeight / 2);
+   }
+
+   const unsigned char *data = reinterpret_cast<const unsigned char*>(mappedFile->getData() + header.dataOffset);
+   return std::make_shared<TextureImage>(mappedFile, data, header.width, header.height, header.components, header.compressed != 0, levels);
+}
+
+bool save(const std::string &fileName, const TextureImage &image, const OSUtils::FileStatus &sourceStatus) {
+   ASSERT(!fileName.empty(), "Trying to save texture cache to empty file name");
+
+   const std::vector<TextureImage::Level> &levels = image.getLevels();
+
+   Header header;
+   memcpy(header.magic, MAGIC, sizeof(MAGIC));
+   header.version = VERSION;
+   header.sourceModificationTime = sourceStatus.modificationTime;
+   header.sourceSize = sourceStatus.size;
+   header.width = image.getWidth();
+   header.height = image.getHeight();
+   header.components = image.getComponents();
+   header.compressed = image.isCompressed() ? 1 : 0;
+   header.numLevels = static_cast<uint32_t>(levels.size());
+   header.dataOffset = align(sizeof(Header) + header.numLevels * sizeof(TextureImage::Level));
+
+   std::size_t tableSize = levels.size() * sizeof(TextureImage::Level);
+   static const char padding[BLOCK_ALIGNMENT] = {};
+
+   // Write to a temporary file first, so that other processes never map a partially written cache
+   std::string tempFileName(fileName + ".tmp");
+   {
+      std::ofstream out(tempFileName, std::ofstream::binary);
+      if (!out) {
+         return false;
+      }
+
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      out.write(reinterpret_cast<const char*>(levels.data()), tableSize);
+      out.write(padding, header.dataOffset - sizeof(header) - tableSize);
+      out.write(reinterpret_cast<const char*>(image.getData()), image.getDataSize());
+
+      if (!out) {
+         out.close();
+         std::remove(tempFileName.c_str());
+         return false;
+      }
+   }
+
+   // Renaming over an existing file fails on Windows
+   std::remove(fileName.c_str());
+   return std::rename(tempFileName.c_str(), fileName.c_str()) == 0;
+}
+
+} // namespace TextureCache
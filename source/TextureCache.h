@@ -0,0 +1,31 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include "OSUtils.h"
+#include "Types.h"
+
+#include <string>
+
+class TextureImage;
+
+/**
+ * Binary texture cache files, holding decoded, flipped and mipmapped (and possibly compressed) images which are
+ * memory-mapped and uploaded as-is instead of decoding the source PNG / JPG. Each file records the status of the source
+ * file it was generated from, so that stale caches are ignored
+ */
+namespace TextureCache {
+
+/**
+ * Maps the cache file with the given name, returning null if it is missing, invalid, was generated from a source file
+ * with a different status, or doesn't match the requested compression
+ */
+SPtr<TextureImage> load(const std::string &fileName, const OSUtils::FileStatus &sourceStatus, bool compress);
+
+/**
+ * Writes the given image to the cache file with the given name, returning true on success
+ */
+bool save(const std::string &fileName, const TextureImage &image, const OSUtils::FileStatus &sourceStatus);
+
+} // namespace TextureCache
+
+#endif
@@ -0,0 +1,292 @@
+#include "FancyAssert.h"
+#include "MappedFile.h"
+#include "TextureImage.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const int BLOCK_DIMENSION = 4;
+const uint32_t BC1_BLOCK_SIZE = 8;
+
+void getFormats(int components, GLint *internalFormat, GLenum *format) {
+   switch (components) {
+      case 1:
+         *internalFormat = GL_R8;
+         *format = GL_RED;
+         break;
+      case 2:
+         *internalFormat = GL_RG8;
+         *format = GL_RG;
+         break;
+      case 3:
+         *internalFormat = GL_RGB8;
+         *format = GL_RGB;
+         break;
+      case 4:
+      default:
+         *internalFormat = GL_RGBA8;
+         *format = GL_RGBA;
+         break;
+   }
+}
+
+/**
+ * Box filters the given level down to half its size (odd edges are clamped)
+ */
+void downsample(const unsigned char *source, uint32_t width, uint32_t height, int components, unsigned char *destination) {
+   uint32_t levelWidth = std::max(1u, width / 2);
+   uint32_t levelHeight = std::max(1u, height / 2);
+
+   for (uint32_t y = 0; y < levelHeight; ++y) {
+      const unsigned char *row0 = source + std::min(2 * y, height - 1) * width * components;
+      const unsigned char *row1 = source + std::min(2 * y + 1, height - 1) * width * components;
+
+      for (uint32_t x = 0; x < levelWidth; ++x) {
+         uint32_t x0 = std::min(2 * x, width - 1) * components;
+         uint32_t x1 = std::min(2 * x + 1, width - 1) * components;
+
+         for (int c = 0; c < components; ++c) {
+            int sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+            *destination++ = static_cast<unsigned char>((sum + 2) / 4);
+         }
+      }
+   }
+}
+
+uint16_t packRgb565(const int color[3]) {
+   return static_cast<uint16_t>(((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3));
+}
+
+void unpackRgb565(uint16_t packed, int color[3]) {
+   int r = (packed >> 11) & 0x1F;
+   int g = (packed >> 5) & 0x3F;
+   int b = packed & 0x1F;
+
+   color[0] = (r << 3) | (r >> 2);
+   color[1] = (g << 2) | (g >> 4);
+   color[2] = (b << 3) | (b >> 2);
+}
+
+/**
+ * Compresses one 4x4 block of RGB pixels to BC1. The endpoints are the (slightly inset) corners of the block's color
+ * bounding box, along the diagonal that the colors are correlated on
+ */
+void compressBlock(const unsigned char *pixels, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, unsigned char *out) {
+   int block[16][3];
+   int minColor[3] = { 255, 255, 255 };
+   int maxColor[3] = { 0, 0, 0 };
+   int mean[3] = { 0, 0, 0 };
+
+   for (int i = 0; i < 16; ++i) {
+      uint32_t x = std::min(blockX * BLOCK_DIMENSION + i % BLOCK_DIMENSION, width - 1);
+      uint32_t y = std::min(blockY * BLOCK_DIMENSION + i / BLOCK_DIMENSION, height - 1);
+      const unsigned char *pixel = pixels + (y * width + x) * 3;
+
+      for (int c = 0; c < 3; ++c) {
+         block[i][c] = pixel[c];
+         minColor[c] = std::min(minColor[c], block[i][c]);
+         maxColor[c] = std::max(maxColor[c], block[i][c]);
+         mean[c] += block[i][c];
+      }
+   }
+
+   // Flip the channels that decrease while the widest channel increases
+   int widest = 0;
+   for (int c = 1; c < 3; ++c) {
+      if (maxColor[c] - minColor[c] > maxColor[widest] - minColor[widest]) {
+         widest = c;
+      }
+   }
+   for (int c = 0; c < 3; ++c) {
+      mean[c] /= 16;
+   }
+   for (int c = 0; c < 3; ++c) {
+      int covariance = 0;
+      for (int i = 0; i < 16; ++i) {
+         covariance += (block[i][widest] - mean[widest]) * (block[i][c] - mean[c]);
+      }
+      if (covariance < 0) {
+         std::swap(minColor[c], maxColor[c]);
+      }
+   }
+
+   // Inset the endpoints, since the extremes are usually outliers
+   for (int c = 0; c < 3; ++c) {
+      int inset = (maxColor[c] - minColor[c]) / 16;
+      maxColor[c] -= inset;
+      minColor[c] += inset;
+   }
+
+   uint16_t color0 = packRgb565(maxColor);
+   uint16_t color1 = packRgb565(minColor);
+   if (color0 < color1) {
+      // The first endpoint has to be larger, otherwise the block is decoded with only three colors
+      std::swap(color0, color1);
+   }
+
+   int palette[4][3];
+   unpackRgb565(color0, palette[0]);
+   unpackRgb565(color1, palette[1]);
+   for (int c = 0; c < 3; ++c) {
+      palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+   }
+
+   uint32_t indices = 0;
+   if (color0 != color1) {
+      for (int i = 0; i < 16; ++i) {
+         int bestIndex = 0;
+         int bestDistance = 0;
+
+         for (int p = 0; p < 4; ++p) {
+            int distance = 0;
+            for (int c = 0; c < 3; ++c) {
+               int difference = block[i][c] - palette[p][c];
+               distance += difference * difference;
+            }
+
+            if (p == 0 || distance < bestDistance) {
+               bestIndex = p;
+               bestDistance = distance;
+            }
+         }
+
+         indices |= static_cast<uint32_t>(bestIndex) << (2 * i);
+      }
+   }
+
+   // Little endian
+   out[0] = color0 & 0xFF;
+   out[1] = color0 >> 8;
+   out[2] = color1 & 0xFF;
+   out[3] = color1 >> 8;
+   for (int i = 0; i < 4; ++i) {
+      out[4 + i] = (indices >> (8 * i)) & 0xFF;
+   }
+}
+
+void compressLevel(const unsigned char *pixels, uint32_t width, uint32_t height, unsigned char *out) {
+   uint32_t blocksWide = (width + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+   uint32_t blocksHigh = (height + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+
+   for (uint32_t blockY = 0; blockY < blocksHigh; ++blockY) {
+      for (uint32_t blockX = 0; blockX < blocksWide; ++blockX) {
+         compressBlock(pixels, width, height, blockX, blockY, out);
+         out += BC1_BLOCK_SIZE;
+      }
+   }
+}
+
+} // namespace
+
+TextureImage::TextureImage(int width, int height, int components, bool compressed)
+   : width(width), height(height), components(components), compressed(compressed), data(nullptr) {
+}
+
+TextureImage::TextureImage(const SPtr<MappedFile> &mappedFile, const unsigned char *data, int width, int height,
+                           int components, bool compressed, const std::vector<Level> &levels)
+   : width(width), height(height), components(components), compressed(compressed), levels(levels),
+     mappedFile(mappedFile), data(data) {
+   ASSERT(mappedFile && data, "Invalid mapped texture data");
+}
+
+TextureImage::~TextureImage() {
+}
+
+// static
+SPtr<TextureImage> TextureImage::create(const unsigned char *pixels, int width, int height, int components, bool compress) {
+   ASSERT(pixels && width > 0 && height > 0, "Invalid image");
+   ASSERT(components >= 1 && components <= 4, "Invalid image composition: %d", components);
+
+   // Only opaque RGB images are compressed, since BC1 has (at most) one bit of alpha
+   bool compressed = compress && components == 3;
+   SPtr<TextureImage> image(new TextureImage(width, height, components, compressed));
+
+   // Lay out the levels first, so that the data is only allocated once
+   uint32_t levelWidth = width;
+   uint32_t levelHeight = height;
+   uint32_t offset = 0;
+   while (true) {
+      Level level;
+      level.width = levelWidth;
+      level.height = levelHeight;
+      level.offset = offset;
+      level.size = static_cast<uint32_t>(getLevelSize(levelWidth, levelHeight, components, compressed));
+      image->levels.push_back(level);
+      offset += level.size;
+
+      if (levelWidth == 1 && levelHeight == 1) {
+         break;
+      }
+      levelWidth = std::max(1u, levelWidth / 2);
+      levelHeight = std::max(1u, levelHeight / 2);
+   }
+   image->ownedData.resize(offset);
+
+   // Each level is filtered from the one above it (uncompressed), then compressed if needed
+   std::vector<unsigned char> source(pixels, pixels + image->getUncompressedSize());
+   std::vector<unsigned char> next;
+   for (std::size_t i = 0; i < image->levels.size(); ++i) {
+      const Level &level = image->levels[i];
+
+      if (compressed) {
+         compressLevel(source.data(), level.width, level.height, &image->ownedData[level.offset]);
+      } else {
+         memcpy(&image->ownedData[level.offset], source.data(), level.size);
+      }
+
+      if (i + 1 < image->levels.size()) {
+         const Level &nextLevel = image->levels[i + 1];
+         next.resize(nextLevel.width * nextLevel.height * components);
+         downsample(source.data(), level.width, level.height, components, next.data());
+         source.swap(next);
+      }
+   }
+
+   image->data = image->ownedData.data();
+   return image;
+}
+
+// static
+uint64_t TextureImage::getLevelSize(uint32_t width, uint32_t height, int components, bool compressed) {
+   if (compressed) {
+      uint64_t blocksWide = (static_cast<uint64_t>(width) + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+      uint64_t blocksHigh = (static_cast<uint64_t>(height) + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+      return blocksWide * blocksHigh * BC1_BLOCK_SIZE;
+   }
+
+   return static_cast<uint64_t>(width) * height * components;
+}
+
+// static
+bool TextureImage::isCompressionSupported() {
+   return GLAD_GL_EXT_texture_compression_s3tc != 0;
+}
+
+void TextureImage::upload(GLenum target) const {
+   GLint internalFormat;
+   GLenum format;
+   getFormats(components, &internalFormat, &format);
+
+   // Rows of the smaller levels (and of odd sized RGB images) aren't 4 byte aligned
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+   for (std::size_t i = 0; i < levels.size(); ++i) {
+      const Level &level = levels[i];
+      GLint levelIndex = static_cast<GLint>(i);
+
+      if (compressed) {
+         glCompressedTexImage2D(target, levelIndex, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, level.width, level.height, 0, level.size, data + level.offset);
+      } else {
+         glTexImage2D(target, levelIndex, internalFormat, level.width, level.height, 0, format, GL_UNSIGNED_BYTE, data + level.offset);
+      }
+   }
+
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+std::size_t TextureImage::getDataSize() const {
+   return levels.empty() ? 0 : levels.back().offset + levels.back().size;
+}
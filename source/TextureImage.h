@@ -0,0 +1,108 @@
+#ifndef TEXTURE_IMAGE_H
+#define TEXTURE_IMAGE_H
+
+#include "GLIncludes.h"
+#include "Types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class MappedFile;
+
+/**
+ * A decoded image with its full mip chain, stored bottom-to-top (the way OpenGL expects it), ready to be uploaded as-is.
+ * Opaque images can be compressed to BC1 (S3TC DXT1) blocks
+ */
+class TextureImage {
+public:
+   struct Level {
+      uint32_t width;
+      uint32_t height;
+      uint32_t offset;
+      uint32_t size;
+   };
+
+protected:
+   int width;
+   int height;
+   int components;
+   bool compressed;
+   std::vector<Level> levels;
+
+   /**
+    * Pixel data of every level, either owned or mapped from a texture cache file
+    */
+   std::vector<unsigned char> ownedData;
+   SPtr<MappedFile> mappedFile;
+   const unsigned char *data;
+
+   TextureImage(int width, int height, int components, bool compressed);
+
+public:
+   /**
+    * Wraps pixel data mapped from a texture cache file (the levels must lie within the mapping)
+    */
+   TextureImage(const SPtr<MappedFile> &mappedFile, const unsigned char *data, int width, int height, int components,
+                bool compressed, const std::vector<Level> &levels);
+
+   virtual ~TextureImage();
+
+   /**
+    * Builds the mip chain of the given bottom-to-top pixels, compressing it if requested (and the image is opaque)
+    */
+   static SPtr<TextureImage> create(const unsigned char *pixels, int width, int height, int components, bool compress);
+
+   /**
+    * Size of a level with the given dimensions, as stored on the GPU (tightly packed rows, or 8 bytes per 4x4 BC1 block)
+    */
+   static uint64_t getLevelSize(uint32_t width, uint32_t height, int components, bool compressed);
+
+   /**
+    * If BC1 compressed textures can be uploaded with the current context
+    */
+   static bool isCompressionSupported();
+
+   /**
+    * Uploads every level to the given target of the bound texture (a 2D texture, or one face of a cube map)
+    */
+   void upload(GLenum target) const;
+
+   int getWidth() const {
+      return width;
+   }
+
+   int getHeight() const {
+      return height;
+   }
+
+   int getComponents() const {
+      return components;
+   }
+
+   bool isCompressed() const {
+      return compressed;
+   }
+
+   const std::vector<Level>& getLevels() const {
+      return levels;
+   }
+
+   const unsigned char* getData() const {
+      return data;
+   }
+
+   /**
+    * Size of every level, as stored on the GPU
+    */
+   std::size_t getDataSize() const;
+
+   /**
+    * Size the image would take on the GPU as a single uncompressed level
+    */
+   std::size_t getUncompressedSize() const {
+      return static_cast<std::size_t>(width) * height * components;
+   }
+};
+
+#endif
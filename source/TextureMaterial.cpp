@@ -1,4 +1,5 @@
 #include "Context.h"
+#include "DrawStateCache.h"
 #include "Mesh.h"
 #include "ShaderProgram.h"
 #include "Texture.h"
@@ -8,7 +9,7 @@
 #include <string>
 
 TextureMaterial::TextureMaterial(SPtr<Texture> texture, const std::string &textureUniformName)
-   : texture(texture), textureUniformName(textureUniformName) {
+   : texture(texture), textureUniform(ShaderProgram::getUniformID(textureUniformName)) {
 }
 
 TextureMaterial::~TextureMaterial() {
@@ -21,10 +22,9 @@ void TextureMaterial::apply(ShaderProgram &shaderProgram) {
 
    textureUnit = Context::getInstance().getTextureUnitManager().get();
 
-   shaderProgram.setUniformValue(textureUniformName, textureUnit);
+   shaderProgram.setUniformValue(textureUniform, textureUnit);
 
-   glActiveTexture(GL_TEXTURE0 + textureUnit);
-   texture->bind();
+   Context::getInstance().getDrawStateCache().bindTexture(textureUnit, *texture);
 }
 
 void TextureMaterial::disable() {
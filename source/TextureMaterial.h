@@ -3,8 +3,8 @@
 
 #include "GLIncludes.h"
 #include "Material.h"
+#include "ShaderProgram.h"
 
-class ShaderProgram;
 class Texture;
 
 class TextureMaterial : public Material {
@@ -15,8 +15,8 @@ protected:
    // The texture unit
    GLenum textureUnit;
 
-   // Name of the texture uniform
-   std::string textureUniformName;
+   // The texture uniform
+   UniformID textureUniform;
 
 public:
    TextureMaterial(SPtr<Texture> texture, const std::string &textureUniformName);
@@ -27,6 +27,10 @@ public:
 
    virtual void disable();
 
+   virtual const Texture* getTexture() const {
+      return texture.get();
+   }
+
    void setTexture(SPtr<Texture> texture);
 };
 
@@ -32,11 +32,27 @@ const float LIFE_TIME = 0.1f;
 const float PROJECTILE_SCALE = 0.3f;
 const float EXPLOSION_SCALE = 2.5f;
 
-SPtr<GameObject> createExplosion(const glm::vec3 &position, const float scale, const glm::vec3 &color) {
-   SPtr<GameObject> explosion(std::make_shared<GameObject>());
+// Enough for a player to keep throwing without the pools having to grow
+const int NUM_PREWARMED_PROJECTILES = 4;
+const int NUM_PREWARMED_EXPLOSIONS = 2;
 
-   explosion->setPosition(position);
-   explosion->setScale(glm::vec3(scale));
+enum PooledObjectType {
+   Projectile,
+   Explosion
+};
+
+glm::vec3 getColor(GameObject &gameObject) {
+   glm::vec3 color(1.0f, 0.75f, 0.15f);
+   PlayerLogicComponent *playerLogic = dynamic_cast<PlayerLogicComponent*>(&gameObject.getLogicComponent());
+   if (playerLogic) {
+      color = playerLogic->getColor();
+   }
+
+   return color;
+}
+
+SPtr<GameObject> createExplosion(const glm::vec3 &color) {
+   SPtr<GameObject> explosion(std::make_shared<GameObject>());
 
    AssetManager &assetManager = Context::getInstance().getAssetManager();
 
@@ -55,10 +71,26 @@ SPtr<GameObject> createExplosion(const glm::vec3 &position, const float scale, c
    // Physics
    explosion->setPhysicsComponent(std::make_shared<GhostPhysicsComponent>(*explosion, false, CollisionGroup::Default | CollisionGroup::Characters | CollisionGroup::Debries | CollisionGroup::Projectiles));
 
+   // Audio
+   SPtr<AudioComponent> audioComponent(std::make_shared<AudioComponent>(*explosion));
+   audioComponent->registerSoundEvent(Event::SET_SCENE, SoundGroup::EXPLOSION);
+   explosion->setAudioComponent(audioComponent);
+
+   return explosion;
+}
+
+void spawnExplosion(Scene &scene, const void *poolOwner, const glm::vec3 &position, const glm::vec3 &color) {
+   SPtr<GameObject> explosion(scene.getObjectPool().acquire(PoolKey(poolOwner, Explosion), [&color]() {
+      return createExplosion(color);
+   }));
+
+   explosion->setPosition(position);
+   explosion->setScale(glm::vec3(1.0f));
+   explosion->getLightComponent().setSquareFalloff(0.1f);
+
    // Logic
    const float startTime = Context::getInstance().getRunningTime();
-   WPtr<GameObject> wExplosion(explosion);
-   explosion->setTickCallback([startTime, wExplosion](GameObject &gameObject, const float dt) {
+   explosion->setTickCallback([startTime](GameObject &gameObject, const float dt) {
       SPtr<Scene> scene = gameObject.getScene().lock();
       if (!scene) {
          return;
@@ -67,18 +99,12 @@ SPtr<GameObject> createExplosion(const glm::vec3 &position, const float scale, c
       float time = glm::smoothstep(startTime, startTime + LIFE_TIME, Context::getInstance().getRunningTime());
       float scale = EXPLOSION_SCALE * time + PROJECTILE_SCALE;
 
-      SPtr<GameObject> explosion(wExplosion.lock());
-      if (!explosion) {
-         return;
-      }
-
       float falloff = 0.1f - 0.09f * time;
-      explosion->getLightComponent().setSquareFalloff(falloff);
-      explosion->setScale(glm::vec3(scale));
+      gameObject.getLightComponent().setSquareFalloff(falloff);
+      gameObject.setScale(glm::vec3(scale));
 
       if (time >= 1.0f) {
-         scene->removeObject(explosion);
-         scene->removeLight(explosion);
+         scene->getObjectPool().release(gameObject);
       }
 
       btCollisionObject *collisionObject = gameObject.getPhysicsComponent().getCollisionObject();
@@ -111,49 +137,17 @@ SPtr<GameObject> createExplosion(const glm::vec3 &position, const float scale, c
       }
    });
 
-   // Audio
-   SPtr<AudioComponent> audioComponent(std::make_shared<AudioComponent>(*explosion));
-   audioComponent->registerSoundEvent(Event::SET_SCENE, SoundGroup::EXPLOSION);
-   explosion->setAudioComponent(audioComponent);
-
-   return explosion;
+   scene.addLight(explosion);
+   scene.addObject(explosion);
 }
 
-} // namespace
-
-ThrowAbility::ThrowAbility(GameObject &gameObject)
-   : Ability(gameObject, COOLDOWN) {
-}
-
-ThrowAbility::~ThrowAbility() {
-}
-
-bool ThrowAbility::use() {
-   if (isOnCooldown()) {
-      return false;
-   }
-
-   SPtr<Scene> scene = gameObject.getScene().lock();
-   if (!scene) {
-      return false;
-   }
-
-   const glm::vec3 &position = gameObject.getCameraComponent().getCameraPosition();
-   const glm::vec3 &front = gameObject.getCameraComponent().getFrontVector();
-   const glm::vec3 &right = gameObject.getCameraComponent().getRightVector();
-
+SPtr<GameObject> createProjectile(GameObject &creator, const glm::vec3 &color, const void *poolOwner) {
    SPtr<GameObject> projectile(std::make_shared<GameObject>());
-   projectile->setPosition(position + front + right * 0.25f);
    projectile->setScale(glm::vec3(PROJECTILE_SCALE));
 
    // Graphics
-   SPtr<Model> playerModel = gameObject.getGraphicsComponent().getModel();
+   SPtr<Model> playerModel = creator.getGraphicsComponent().getModel();
    SPtr<Mesh> mesh = Context::getInstance().getAssetManager().loadMesh("meshes/rock_attack.obj");
-   glm::vec3 color(1.0f, 0.75f, 0.15f);
-   PlayerLogicComponent *playerLogic = dynamic_cast<PlayerLogicComponent*>(&gameObject.getLogicComponent());
-   if (playerLogic) {
-      color = playerLogic->getColor();
-   }
    SPtr<Material> material(std::make_shared<PhongMaterial>(color * 0.2f, color * 0.6f, glm::vec3(0.2f), color * 0.2f, 50.0f));
    SPtr<Model> model(std::make_shared<Model>(playerModel->getShaderProgram(), mesh));
    model->attachMaterial(material);
@@ -166,13 +160,10 @@ bool ThrowAbility::use() {
    projectileRigidBody->setFriction(1.0f);
    projectileRigidBody->setRollingFriction(0.25f);
    projectileRigidBody->setRestitution(0.5f);
-   projectileRigidBody->applyCentralForce(toBt(front * 100.0f));
 
    // Logic
    SPtr<ProjectileLogicComponent> logic(std::make_shared<ProjectileLogicComponent>(*projectile));
-   WPtr<GameObject> wProjectile(projectile);
-   GameObject &creator = gameObject;
-   logic->setCollisionCallback([wProjectile, color, &creator](GameObject &gameObject, const btCollisionObject *objectCollidedWidth, const float dt) {
+   logic->setCollisionCallback([color, &creator, poolOwner](GameObject &gameObject, const btCollisionObject *objectCollidedWidth, const float dt) {
       if (objectCollidedWidth == creator.getPhysicsComponent().getCollisionObject()) {
          return;
       }
@@ -182,16 +173,8 @@ bool ThrowAbility::use() {
          return;
       }
 
-      SPtr<GameObject> projectile = wProjectile.lock();
-      if (!projectile) {
-         return;
-      }
-
-      scene->removeObject(projectile);
-
-      SPtr<GameObject> explosion(createExplosion(projectile->getPosition(), 1.0f, color));
-      scene->addLight(explosion);
-      scene->addObject(explosion);
+      scene->getObjectPool().release(gameObject);
+      spawnExplosion(*scene, poolOwner, gameObject.getPosition(), color);
    });
    projectile->setLogicComponent(logic);
 
@@ -200,6 +183,56 @@ bool ThrowAbility::use() {
    audioComponent->registerSoundEvent(Event::SET_SCENE, SoundGroup::THROW);
    projectile->setAudioComponent(audioComponent);
 
+   return projectile;
+}
+
+} // namespace
+
+ThrowAbility::ThrowAbility(GameObject &gameObject)
+   : Ability(gameObject, COOLDOWN) {
+}
+
+ThrowAbility::~ThrowAbility() {
+}
+
+void ThrowAbility::prewarm(Scene &scene) {
+   glm::vec3 color(getColor(gameObject));
+   GameObjectPool &objectPool = scene.getObjectPool();
+
+   objectPool.prewarm(PoolKey(this, Projectile), NUM_PREWARMED_PROJECTILES, [this, &color]() {
+      return createProjectile(gameObject, color, this);
+   });
+   objectPool.prewarm(PoolKey(this, Explosion), NUM_PREWARMED_EXPLOSIONS, [&color]() {
+      return createExplosion(color);
+   });
+}
+
+bool ThrowAbility::use() {
+   if (isOnCooldown()) {
+      return false;
+   }
+
+   SPtr<Scene> scene = gameObject.getScene().lock();
+   if (!scene) {
+      return false;
+   }
+
+   const glm::vec3 &position = gameObject.getCameraComponent().getCameraPosition();
+   const glm::vec3 &front = gameObject.getCameraComponent().getFrontVector();
+   const glm::vec3 &right = gameObject.getCameraComponent().getRightVector();
+
+   glm::vec3 color(getColor(gameObject));
+   SPtr<GameObject> projectile(scene->getObjectPool().acquire(PoolKey(this, Projectile), [this, &color]() {
+      return createProjectile(gameObject, color, this);
+   }));
+
+   projectile->setPosition(position + front + right * 0.25f);
+   projectile->setOrientation(glm::quat());
+
+   // Forces applied to a free pooled object are kept until it is added to the scene
+   btRigidBody *projectileRigidBody = dynamic_cast<btRigidBody*>(projectile->getPhysicsComponent().getCollisionObject());
+   projectileRigidBody->applyCentralForce(toBt(front * 100.0f));
+
    scene->addObject(projectile);
 
    resetTimeSinceLastUse();
@@ -9,6 +9,8 @@ public:
 
    virtual ~ThrowAbility();
 
+   virtual void prewarm(Scene &scene);
+
    virtual bool use();
 };
 
@@ -2,6 +2,12 @@
 #include "ShaderProgram.h"
 #include "TimeMaterial.h"
 
+namespace {
+
+const UniformID TIME_UNIFORM = ShaderProgram::getUniformID("uTime");
+
+} // namespace
+
 TimeMaterial::TimeMaterial() {
 }
 
@@ -10,7 +16,7 @@ TimeMaterial::~TimeMaterial() {
 
 void TimeMaterial::apply(ShaderProgram &shaderProgram) {
    float time = Context::getInstance().getRunningTime();
-   shaderProgram.setUniformValue("uTime", time);
+   shaderProgram.setUniformValue(TIME_UNIFORM, time);
 }
 
 void TimeMaterial::disable() {
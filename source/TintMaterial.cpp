@@ -1,6 +1,13 @@
 #include "ShaderProgram.h"
 #include "TintMaterial.h"
 
+namespace {
+
+const UniformID OPACITY_UNIFORM = ShaderProgram::getUniformID("uOpacity");
+const UniformID TINT_UNIFORM = ShaderProgram::getUniformID("uTint");
+
+} // namespace
+
 TintMaterial::TintMaterial(float opacity, const glm::vec3 &tint)
    : opacity(opacity), tint(tint) {
 }
@@ -9,8 +16,8 @@ TintMaterial::~TintMaterial() {
 }
 
 void TintMaterial::apply(ShaderProgram &shaderProgram) {
-   shaderProgram.setUniformValue("uOpacity", opacity);
-   shaderProgram.setUniformValue("uTint", tint);
+   shaderProgram.setUniformValue(OPACITY_UNIFORM, opacity);
+   shaderProgram.setUniformValue(TINT_UNIFORM, tint);
 }
 
 void TintMaterial::disable() {
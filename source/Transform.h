@@ -3,6 +3,8 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/quaternion.hpp>
+#include <glm/gtx/transform.hpp>
 
 struct Transform {
    glm::quat orientation;
@@ -11,6 +13,13 @@ struct Transform {
 
    Transform()
       : orientation(), position(0.0f), scale(1.0f) {}
+
+   /**
+    * Translation * rotation * scale
+    */
+   glm::mat4 toMatrix() const {
+      return glm::translate(position) * glm::toMat4(orientation) * glm::scale(scale);
+   }
 };
 
 #endif
@@ -0,0 +1,92 @@
+#ifndef UNIFORM_BLOCKS_H
+#define UNIFORM_BLOCKS_H
+
+#include "GLIncludes.h"
+#include "LightComponent.h"
+#include "ShadowMap.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+
+/*
+ * Copies of the uniform blocks shared by the scene's programs, laid out to match std140 (each vec3 is followed by a
+ * scalar, and arrays / blocks are padded to multiples of 16 bytes) so that they can be uploaded as they are. They
+ * have to be kept in sync with the blocks declared in the shaders
+ */
+
+namespace UniformBlocks {
+
+const int MAX_SHADOWS = ShadowMap::MAX_SHADOWS + ShadowMap::MAX_LARGE_SHADOWS;
+const int MAX_CUBE_SHADOWS = ShadowMap::MAX_CUBE_SHADOWS;
+
+} // namespace UniformBlocks
+
+/**
+ * The Camera block, written once per view (each camera's viewport, and each shadow map face)
+ */
+struct CameraBlock {
+   glm::mat4 projMatrix;
+   glm::mat4 viewMatrix;
+   glm::vec3 cameraPos;
+   float padding;
+
+   CameraBlock()
+      : padding(0.0f) {
+   }
+};
+
+/**
+ * A light in the Lights block (the shadow indices are -1 if the light doesn't cast shadows)
+ */
+struct LightData {
+   glm::vec3 color;
+   int32_t type;
+   glm::vec3 position;
+   float linearFalloff;
+   glm::vec3 direction;
+   float squareFalloff;
+   float beamAngle;
+   float cutoffAngle;
+   int32_t shadowIndex;
+   int32_t cubeShadowIndex;
+};
+
+/**
+ * The Lights block, written once per frame
+ */
+struct LightsBlock {
+   LightData lights[LightComponent::MAX_LIGHTS];
+
+   /**
+    * Biased projection * view matrix of each standard shadow map
+    */
+   glm::mat4 shadowMatrices[UniformBlocks::MAX_SHADOWS];
+
+   /**
+    * Near (x) and far (y) planes of each cube shadow map
+    */
+   glm::vec4 cubeShadowPlanes[UniformBlocks::MAX_CUBE_SHADOWS];
+
+   int32_t numLights;
+   int32_t padding[3];
+
+   LightsBlock()
+      : lights(), cubeShadowPlanes(), numLights(0), padding() {
+   }
+};
+
+static_assert(sizeof(CameraBlock) == 144, "CameraBlock doesn't match the std140 layout");
+static_assert(sizeof(LightData) == 64, "LightData doesn't match the std140 layout");
+static_assert(sizeof(LightsBlock) == 1040, "LightsBlock doesn't match the std140 layout");
+
+/**
+ * Texture units of the shadow maps, set on each program (samplers can't be stored in uniform blocks)
+ */
+struct ShadowMapUnits {
+   std::array<GLenum, UniformBlocks::MAX_SHADOWS> shadowMaps;
+   std::array<GLenum, UniformBlocks::MAX_CUBE_SHADOWS> cubeShadowMaps;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#include "UniformBuffer.h"
+
+#include <cstring>
+
+long UniformBuffer::numUploads = 0;
+
+UniformBuffer::UniformBuffer(GLuint binding, GLsizeiptr size)
+   : binding(binding), size(size), activeData(size), uploaded(false) {
+   glGenBuffers(1, &bufferID);
+   glBindBuffer(GL_UNIFORM_BUFFER, bufferID);
+   glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_STREAM_DRAW);
+   glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+   glBindBufferBase(GL_UNIFORM_BUFFER, binding, bufferID);
+}
+
+UniformBuffer::~UniformBuffer() {
+   glDeleteBuffers(1, &bufferID);
+}
+
+void UniformBuffer::update(const void *data) {
+   // Like uniforms, skip uploading data that is already in the buffer
+   if (uploaded && memcmp(activeData.data(), data, size) == 0) {
+      return;
+   }
+
+   // Respecifying the whole buffer orphans the old storage, so that draws still reading it don't stall the upload
+   glBindBuffer(GL_UNIFORM_BUFFER, bufferID);
+   glBufferData(GL_UNIFORM_BUFFER, size, data, GL_STREAM_DRAW);
+
+   memcpy(activeData.data(), data, size);
+   uploaded = true;
+   ++numUploads;
+}
+
+long UniformBuffer::resetNumUploads() {
+   long count = numUploads;
+   numUploads = 0;
+   return count;
+}
@@ -0,0 +1,48 @@
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include "GLIncludes.h"
+
+#include <vector>
+
+/**
+ * A buffer backing a uniform block, bound to a fixed binding point so that every program using the block reads the
+ * same data. Updating it once replaces what used to be a uniform upload per program
+ */
+class UniformBuffer {
+protected:
+   GLuint bufferID;
+   const GLuint binding;
+   const GLsizeiptr size;
+
+   /**
+    * Data last uploaded to the buffer (if any)
+    */
+   std::vector<char> activeData;
+   bool uploaded;
+
+   // Number of updates since the last reset (only accessed on the main thread)
+   static long numUploads;
+
+public:
+   UniformBuffer(GLuint binding, GLsizeiptr size);
+
+   virtual ~UniformBuffer();
+
+   /**
+    * Replaces the contents of the buffer with the given data (which must be as large as the buffer), unless they're
+    * already the same
+    */
+   void update(const void *data);
+
+   GLuint getBinding() const {
+      return binding;
+   }
+
+   /**
+    * Returns the number of updates made to all uniform buffers since the last reset, and resets it
+    */
+   static long resetNumUploads();
+};
+
+#endif
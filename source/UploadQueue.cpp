@@ -0,0 +1,60 @@
+#include "FancyAssert.h"
+#include "Profiler.h"
+#include "UploadQueue.h"
+
+UploadQueue::UploadQueue()
+   : mainThreadID(std::this_thread::get_id()) {
+}
+
+UploadQueue::~UploadQueue() {
+}
+
+bool UploadQueue::onMainThread() const {
+   return std::this_thread::get_id() == mainThreadID;
+}
+
+void UploadQueue::run(const std::function<void()> &task) {
+   if (onMainThread()) {
+      task();
+      return;
+   }
+
+   std::packaged_task<void()> packagedTask(task);
+   std::future<void> result = packagedTask.get_future();
+
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      tasks.push_back(std::move(packagedTask));
+   }
+   condition.notify_all();
+
+   result.get();
+}
+
+void UploadQueue::process() {
+   ASSERT(onMainThread(), "Trying to process uploads off of the main thread");
+
+   std::deque<std::packaged_task<void()>> pendingTasks;
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      pendingTasks.swap(tasks);
+   }
+
+   if (pendingTasks.empty()) {
+      return;
+   }
+
+   PROFILE_ZONE("UploadQueue::process");
+   for (std::packaged_task<void()> &task : pendingTasks) {
+      task();
+   }
+}
+
+void UploadQueue::waitAndProcess(std::chrono::milliseconds maxWait) {
+   {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait_for(lock, maxWait, [this] { return !tasks.empty(); });
+   }
+
+   process();
+}
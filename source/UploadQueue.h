@@ -0,0 +1,50 @@
+#ifndef UPLOAD_QUEUE_H
+#define UPLOAD_QUEUE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+/**
+ * Runs GL work (uploads, shader compilation) requested by other threads on the main thread, which owns the GL context
+ */
+class UploadQueue {
+protected:
+   const std::thread::id mainThreadID;
+   std::mutex mutex;
+   std::condition_variable condition;
+   std::deque<std::packaged_task<void()>> tasks;
+
+public:
+   /**
+    * Must be constructed on the main thread
+    */
+   UploadQueue();
+
+   virtual ~UploadQueue();
+
+   bool onMainThread() const;
+
+   /**
+    * Runs the given work on the main thread, blocking until it has finished (runs it immediately if called from the main
+    * thread). The main thread has to be processing the queue, so this must not be called from the simulation thread
+    */
+   void run(const std::function<void()> &task);
+
+   /**
+    * Runs all pending work. Must be called from the main thread
+    */
+   void process();
+
+   /**
+    * Waits up to the given time for work to be requested, then runs all pending work. Must be called from the main
+    * thread
+    */
+   void waitAndProcess(std::chrono::milliseconds maxWait);
+};
+
+#endif
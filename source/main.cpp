@@ -1,14 +1,28 @@
+#include "AssetManager.h"
+#include "AssetPack.h"
 #include "Constants.h"
 #include "Context.h"
+#include "GameObject.h"
 #include "GLIncludes.h"
+#include "IOUtils.h"
 #include "LogHelper.h"
+#include "Mesh.h"
 #include "OSUtils.h"
+#include "Profiler.h"
 #include "Renderer.h"
 #include "Scene.h"
+#include "SceneLoader.h"
+#include "ShaderProgram.h"
+#include "SimulationThread.h"
+#include "UniformBuffer.h"
 
 #include <glm/glm.hpp>
 
+#include <chrono>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
 
 namespace {
 
@@ -16,6 +30,22 @@ const int WINDOW_WIDTH = 1280;
 const int WINDOW_HEIGHT = 720;
 const float FOV = 70.0f;
 
+const char *HEADLESS_ARG = "--headless";
+const char *RECORD_ARG = "--record";
+const char *REPLAY_ARG = "--replay";
+const char *PROFILE_ARG = "--profile";
+const char *NO_PIPELINE_ARG = "--no-pipeline";
+const char *FRAME_STATS_ARG = "--frame-stats";
+const char *EXPORT_LEVELS_ARG = "--export-levels";
+const char *FLOAT_VERTICES_ARG = "--float-vertices";
+const char *PACK_ASSETS_ARG = "--pack-assets";
+const char *LOOSE_FILES_ARG = "--loose-files";
+const char *ASSET_BUDGET_ARG = "--asset-budget";
+const char *DATA_PACK_FILE_NAME = DATA_DIR ".pack";
+const long DEFAULT_HEADLESS_TICKS = 60 * 60 * 10; // Ten minutes of game time
+const long HEADLESS_REPORT_INTERVAL = 60 * 60; // Log throughput once per minute of game time
+const double FRAME_STATS_INTERVAL = 5.0; // Seconds
+
 void errorCallback(int error, const char* description) {
    LOG_FATAL("GLFW error " << error << ": " << description);
 }
@@ -34,6 +64,147 @@ void windowSizeCallback(GLFWwindow *window, int width, int height) {
    Context::getInstance().getRenderer().onWindowSizeChange(width, height);
 }
 
+struct Arguments {
+   bool headless;
+   long numHeadlessTicks;
+   bool pipeline;
+   bool logFrameStats;
+   bool quantizeVertices;
+   bool useDataPack;
+   std::string exportLevelsDirectory;
+   std::string packAssetsFileName;
+   LaunchOptions launchOptions;
+
+   Arguments()
+      : headless(false), numHeadlessTicks(DEFAULT_HEADLESS_TICKS), pipeline(true), logFrameStats(false), quantizeVertices(true), useDataPack(true) {
+   }
+};
+
+/**
+ * Frame timing, accumulated between logs
+ */
+struct FrameStats {
+   double intervalStart;
+   int numFrames;
+   int numPipelinedFrames;
+   long numTicks;
+   long numMatrixRecomputes;
+   long numUniformUploads;
+   long numUniformBufferUploads;
+   double waitTime;
+   CullStats cameraCullStats;
+   CullStats shadowCullStats;
+   DrawStats drawStats;
+
+   FrameStats(double now)
+      : intervalStart(now), numFrames(0), numPipelinedFrames(0), numTicks(0), numMatrixRecomputes(0), numUniformUploads(0), numUniformBufferUploads(0), waitTime(0.0) {
+   }
+
+   void logCullStats(const char *pass, const CullStats &stats) const {
+      LOG_INFO(pass << " culling: " << ((double)stats.numQueries / numFrames) << " queries/frame, " << ((double)stats.numVisible / numFrames) << " visible/frame, " << ((double)stats.numCulled / numFrames) << " culled/frame, " << ((double)stats.numNodesVisited / numFrames) << " nodes visited/frame, " << (stats.time * 1000.0 / numFrames) << " ms/frame");
+   }
+
+   void log(double now) {
+      double seconds = now - intervalStart;
+      LOG_INFO(numFrames / seconds << " frames/sec (" << (seconds * 1000.0 / numFrames) << " ms/frame), " << numTicks / seconds << " ticks/sec, " << (waitTime * 1000.0 / numFrames) << " ms/frame waiting on ticks, " << numPipelinedFrames << "/" << numFrames << " frames pipelined, " << ((double)numMatrixRecomputes / numFrames) << " matrix recomputes/frame");
+      logCullStats("Camera", cameraCullStats);
+      logCullStats("Shadow", shadowCullStats);
+      LOG_INFO("Scene drawing: " << ((double)drawStats.numDraws / numFrames) << " draws/frame (" << ((double)drawStats.numInstancedDraws / numFrames) << " instanced, drawing " << ((double)drawStats.numInstances / numFrames) << " objects), " << ((double)drawStats.numProgramChanges / numFrames) << " program changes/frame, " << ((double)drawStats.numVertexArrayBinds / numFrames) << " vertex array binds/frame, " << ((double)drawStats.numTextureBinds / numFrames) << " texture binds/frame, " << ((double)drawStats.numRedundantCalls / numFrames) << " redundant GL calls skipped/frame");
+      LOG_INFO("Uniforms: " << ((double)numUniformUploads / numFrames) << " uniform uploads/frame, " << ((double)numUniformBufferUploads / numFrames) << " uniform buffer updates/frame");
+
+      *this = FrameStats(now);
+   }
+};
+
+/**
+ * Parses "--headless [ticks]", "--record <file>", "--replay <file>", "--profile <file>", "--no-pipeline",
+ * "--frame-stats", "--export-levels <directory>", "--float-vertices", "--pack-assets <file>", "--loose-files", and
+ * "--asset-budget <megabytes>"
+ */
+Arguments parseArgs(int argc, char *argv[]) {
+   Arguments arguments;
+
+   for (int i = 1; i < argc; ++i) {
+      bool hasNext = i + 1 < argc;
+
+      if (strcmp(argv[i], HEADLESS_ARG) == 0) {
+         arguments.headless = true;
+
+         if (hasNext) {
+            long parsedTicks = strtol(argv[i + 1], nullptr, 10);
+            if (parsedTicks > 0) {
+               arguments.numHeadlessTicks = parsedTicks;
+               ++i;
+            }
+         }
+      } else if (strcmp(argv[i], RECORD_ARG) == 0 && hasNext) {
+         arguments.launchOptions.recordFileName = argv[++i];
+      } else if (strcmp(argv[i], REPLAY_ARG) == 0 && hasNext) {
+         arguments.launchOptions.replayFileName = argv[++i];
+      } else if (strcmp(argv[i], PROFILE_ARG) == 0 && hasNext) {
+         arguments.launchOptions.profileFileName = argv[++i];
+      } else if (strcmp(argv[i], NO_PIPELINE_ARG) == 0) {
+         arguments.pipeline = false;
+      } else if (strcmp(argv[i], FRAME_STATS_ARG) == 0) {
+         arguments.logFrameStats = true;
+      } else if (strcmp(argv[i], EXPORT_LEVELS_ARG) == 0 && hasNext) {
+         arguments.exportLevelsDirectory = argv[++i];
+      } else if (strcmp(argv[i], FLOAT_VERTICES_ARG) == 0) {
+         arguments.quantizeVertices = false;
+      } else if (strcmp(argv[i], PACK_ASSETS_ARG) == 0 && hasNext) {
+         arguments.packAssetsFileName = argv[++i];
+      } else if (strcmp(argv[i], LOOSE_FILES_ARG) == 0) {
+         arguments.useDataPack = false;
+      } else if (strcmp(argv[i], ASSET_BUDGET_ARG) == 0 && hasNext) {
+         long megabytes = strtol(argv[++i], nullptr, 10);
+         if (megabytes > 0) {
+            arguments.launchOptions.assetMemoryBudget = static_cast<std::size_t>(megabytes) * 1024 * 1024;
+         } else {
+            LOG_WARNING("Ignoring invalid asset budget: " << argv[i]);
+         }
+      } else {
+         LOG_WARNING("Ignoring unknown argument: " << argv[i]);
+      }
+   }
+
+   return arguments;
+}
+
+/**
+ * Runs the simulation as fast as possible with no window, GL context, or audio, logging the tick throughput
+ */
+int runHeadless(long numTicks, const LaunchOptions &launchOptions) {
+   typedef std::chrono::high_resolution_clock Clock;
+
+   LOG_INFO("Running headless for " << numTicks << " ticks");
+
+   Context::load(nullptr, launchOptions);
+   Context &context = Context::getInstance();
+
+   const float dt = 1.0f / 60.0f;
+   Clock::time_point start = Clock::now();
+   Clock::time_point intervalStart = start;
+
+   for (long tick = 1; tick <= numTicks; ++tick) {
+      context.beginFrame();
+      context.tick(dt);
+
+      if (tick % HEADLESS_REPORT_INTERVAL == 0) {
+         Clock::time_point now = Clock::now();
+         double seconds = std::chrono::duration<double>(now - intervalStart).count();
+         LOG_INFO("Ticks " << (tick - HEADLESS_REPORT_INTERVAL + 1) << "-" << tick << ": " << (HEADLESS_REPORT_INTERVAL / seconds) << " ticks/sec");
+         intervalStart = now;
+      }
+   }
+
+   double totalSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+   context.onExit();
+
+   LOG_INFO("Simulated " << numTicks << " ticks in " << totalSeconds << " seconds (" << (numTicks / totalSeconds) << " ticks/sec, " << (totalSeconds * 1000.0 / numTicks) << " ms/tick)");
+
+   return EXIT_SUCCESS;
+}
+
 } // namespace
 
 #ifdef _WIN32
@@ -41,12 +212,40 @@ int CALLBACK WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLi
 #else
 int main(int argc, char *argv[]) {
 #endif
+   std::chrono::steady_clock::time_point launchTime = std::chrono::steady_clock::now();
+
    LOG_INFO(PROJECT_NAME << " " << VERSION_TYPE << " " << VERSION_MAJOR << "." << VERSION_MINOR << "." << VERSION_MICRO << "." << VERSION_BUILD);
 
    if (!OSUtils::fixWorkingDirectory()) {
       LOG_ERROR("Unable to fix working directory");
    }
 
+#ifdef _WIN32
+   int argc = __argc;
+   char **argv = __argv;
+#endif
+   Arguments arguments = parseArgs(argc, argv);
+
+   // Full precision vertices make it possible to compare rendering output against the quantized format
+   Mesh::setQuantizationEnabled(arguments.quantizeVertices);
+
+   if (!arguments.exportLevelsDirectory.empty()) {
+      return SceneLoader::exportLevels(arguments.exportLevelsDirectory) ? EXIT_SUCCESS : EXIT_FAILURE;
+   }
+
+   if (!arguments.packAssetsFileName.empty()) {
+      return AssetPack::build(DATA_DIR, arguments.packAssetsFileName) ? EXIT_SUCCESS : EXIT_FAILURE;
+   }
+
+   // Read data files from the pack if one was built (loose files are still used for anything it doesn't contain)
+   if (arguments.useDataPack && IOUtils::mountDataPack(DATA_PACK_FILE_NAME)) {
+      LOG_INFO("Reading data files from " << DATA_PACK_FILE_NAME << " (pass " << LOOSE_FILES_ARG << " to edit loose files instead)");
+   }
+
+   if (arguments.headless) {
+      return runHeadless(arguments.numHeadlessTicks, arguments.launchOptions);
+   }
+
    glfwSetErrorCallback(errorCallback);
    int glfwInitRes = glfwInit();
    if (!glfwInitRes) {
@@ -76,7 +275,7 @@ int main(int argc, char *argv[]) {
       LOG_FATAL("Unable to initialize glad");
    }
 
-   Context::load(window);
+   Context::load(window, arguments.launchOptions);
    Context &context = Context::getInstance();
    Renderer &renderer = context.getRenderer();
 
@@ -96,26 +295,89 @@ int main(int argc, char *argv[]) {
    // Make sure we tick at least once before rendering, to allow things to be set up
    double accumulator = dt;
 
+   SimulationThread simulationThread;
+   FrameStats frameStats(lastTime);
+   bool firstFrame = true;
+
    while (!glfwWindowShouldClose(window)) {
+      PROFILE_ZONE("Frame");
+
+      // Everything up to the snapshot reads or changes the simulation, so the last frame's ticks have to finish first
+      double waitStart = glfwGetTime();
+      {
+         PROFILE_ZONE("WaitForTicks");
+         simulationThread.wait();
+      }
+      frameStats.waitTime += glfwGetTime() - waitStart;
+
+      glfwPollEvents();
+
       // Calculate the frame time
       double now = glfwGetTime();
       double frameTime = glm::min(now - lastTime, 0.25); // Cap the frame time to .25 seconds to prevent spiraling
       lastTime = now;
 
+      int numTicks = 0;
       accumulator += frameTime;
       while (accumulator >= dt) {
-         context.tick(dt);
+         ++numTicks;
 
          accumulator -= dt;
       }
 
-      renderer.render(context.getScene());
+      context.beginFrame();
 
-      glfwSwapBuffers(window);
+      Scene &scene = context.getScene();
+      bool captureDebugDrawing = renderer.debugRenderingEnabled();
+      std::function<void()> tick = [&context, numTicks, dt]() {
+         for (int i = 0; i < numTicks; ++i) {
+            context.tick(dt);
+         }
+      };
 
-      glfwPollEvents();
+      if (arguments.pipeline && context.canTickConcurrently()) {
+         // Render the results of the last frame's ticks while this frame's ticks run
+         scene.snapshot(captureDebugDrawing);
+         simulationThread.start(tick);
+
+         ++frameStats.numPipelinedFrames;
+      } else {
+         tick();
+         scene.snapshot(captureDebugDrawing);
+      }
+
+      renderer.render(scene);
+
+      {
+         PROFILE_ZONE("SwapBuffers");
+         glfwSwapBuffers(window);
+      }
+
+      if (firstFrame) {
+         // Includes creating the window, loading the first scene, and compiling (or reading cached) shader programs
+         ShaderStats shaderStats(context.getAssetManager().getShaderStats());
+         IOUtils::DataFileStats dataFileStats(IOUtils::getDataFileStats());
+         LOG_INFO("First frame after " << (std::chrono::duration<double>(std::chrono::steady_clock::now() - launchTime).count() * 1000.0) << " ms (" << shaderStats.numPrograms << " shader programs, " << shaderStats.numProgramsFromBinary << " read from binary cache, " << (shaderStats.loadTime * 1000.0) << " ms loading shaders, " << dataFileStats.numPackLookups << " data files read from the asset pack, " << dataFileStats.numFileAccesses << " opened or checked on disk)");
+         firstFrame = false;
+      }
+
+      ++frameStats.numFrames;
+      frameStats.numTicks += numTicks;
+      frameStats.numMatrixRecomputes += GameObject::resetNumMatrixRecomputes();
+      frameStats.numUniformUploads += Uniform::resetNumUploads();
+      frameStats.numUniformBufferUploads += UniformBuffer::resetNumUploads();
+      frameStats.cameraCullStats.add(renderer.getCameraCullStats());
+      frameStats.shadowCullStats.add(renderer.getShadowCullStats());
+      frameStats.drawStats.add(renderer.getDrawStats());
+      if (arguments.logFrameStats && now - frameStats.intervalStart >= FRAME_STATS_INTERVAL) {
+         frameStats.log(now);
+         context.getAssetManager().logMemoryReport();
+      }
    }
 
+   simulationThread.wait();
+   context.onExit();
+
    glfwDestroyWindow(window);
    glfwTerminate();
 